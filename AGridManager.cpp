@@ -1,192 +1,1444 @@
 #include "AGridManager.h"
 #include "AGridTile.h"
+#include "UnitCharacter.h"
+#include "GridOverlayComponent.h"
+#include "TBBoardSubsystem.h"
+#include "TBMemoryTracker.h"
+#include "TBStateHash.h"
+#include "TBTelemetry.h"
+#include "TurnStatsComponent.h"
+#include "UnitEntityManager.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
 
 AGridManager::AGridManager()
 {
-    PrimaryActorTick.bCanEverTick = false;
+    // Only ticks while a time-sliced generation is running, or to stream chunks
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+    
+    Overlay = CreateDefaultSubobject<UGridOverlayComponent>(TEXT("Overlay"));
 }
 
 void AGridManager::BeginPlay()
 {
     Super::BeginPlay();
     
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->RegisterGrid(this);
+    }
+    
     // Optionally auto-generate grid on BeginPlay
     // Uncomment if you want automatic generation
     // if (TileClass) GenerateGrid();
 }
 
+void AGridManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->UnregisterGrid(this);
+    }
+    LoadedChunks.Empty();
+    TilePool.Empty();
+    LayerTiles.Empty();
+    EntityManagers.Empty();
+    Super::EndPlay(EndPlayReason);
+}
+
+void AGridManager::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+    
+    if (GenerationPhase != EGridGenerationPhase::Idle)
+    {
+        StepGeneration(GenerationBudgetMs / 1000.0);
+        return;
+    }
+    
+    if (bStreamChunks && bIsGridReady)
+    {
+        TimeSinceStreamingUpdate += DeltaSeconds;
+        if (TimeSinceStreamingUpdate >= StreamingUpdateInterval)
+        {
+            TimeSinceStreamingUpdate = 0.0f;
+            UpdateStreaming();
+        }
+    }
+}
+
+void AGridManager::BeginNewTurn()
+{
+    ++TurnNumber;
+    FTBTelemetry::Record(ETBTelemetryEvent::TurnStarted, 0, TurnNumber, (int32)(uint32)StateHash, (int32)(uint32)(StateHash >> 32));
+}
+
 void AGridManager::GenerateGrid()
 {
     if (!TileClass) return;
     
-    // Clear existing tiles
-    for (AGridTile* Tile : Tiles)
+    // Tiles are unusable from here until generation completes
+    bIsGridReady = false;
+    GenerationPhase = EGridGenerationPhase::DestroyOld;
+    GenerationCursor = 0;
+    GenerationWorkDone = 0;
+    
+    // Streamed grids generate terrain per chunk and spawn no tiles up front
+    const int32 NumChunks = FMath::DivideAndRoundUp(GridWidth, FGridChunkStore::ChunkSize) * FMath::DivideAndRoundUp(GridHeight, FGridChunkStore::ChunkSize);
+    GenerationWorkTotal = Tiles.Num() + (bStreamChunks ? 2 * NumChunks : 3 * GridWidth * GridHeight);
+    GenerationWorkTotal += FGridPathfinder::GetLandmarkBuildSteps(GetLandmarkCount());
+    DestroyStreamedTiles();
+    
+    if (bTimeSlicedGeneration)
     {
-        if (Tile) Tile->Destroy();
+        SetActorTickEnabled(true);
+        return;
     }
-    Tiles.Empty();
     
-    // Spawn tiles
-    FVector BaseLocation = GetActorLocation();
-    for (int32 Y = 0; Y < GridHeight; ++Y)
+    StepGeneration(TNumericLimits<double>::Max());
+}
+
+void AGridManager::InitializeTileTerrain_Implementation(AGridTile* Tile)
+{
+    // Default terrain is whatever the tile class sets up
+}
+
+void AGridManager::StepGeneration(double BudgetSeconds)
+{
+    LLM_SCOPE_BYTAG(TB_Grid);
+    const double StartTime = FPlatformTime::Seconds();
+    auto OutOfTime = [StartTime, BudgetSeconds]()
     {
-        for (int32 X = 0; X < GridWidth; ++X)
+        return FPlatformTime::Seconds() - StartTime >= BudgetSeconds;
+    };
+    
+    const int32 NumTiles = GridWidth * GridHeight;
+    while (GenerationPhase != EGridGenerationPhase::Idle)
+    {
+        switch (GenerationPhase)
         {
-            FVector TileLocation = BaseLocation + FVector(X * TileSize, Y * TileSize, 0.0f);
-            FActorSpawnParameters SpawnParams;
-            SpawnParams.Owner = this;
+        case EGridGenerationPhase::DestroyOld:
+            // Clear existing tiles
+            while (GenerationCursor < Tiles.Num())
+            {
+                if (Tiles[GenerationCursor]) Tiles[GenerationCursor]->Destroy();
+                ++GenerationCursor;
+                ++GenerationWorkDone;
+                if (OutOfTime()) break;
+            }
+            if (GenerationCursor < Tiles.Num()) break;
+            
+            Tiles.Empty(bStreamChunks ? 0 : NumTiles);
+            ChunkStore.Init(bStreamChunks ? GridWidth : 0, bStreamChunks ? GridHeight : 0, DefaultTerrain);
+            GenerationCursor = 0;
+            GenerationPhase = EGridGenerationPhase::SpawnTiles;
+            continue;
             
-            AGridTile* NewTile = GetWorld()->SpawnActor<AGridTile>(TileClass, TileLocation, FRotator::ZeroRotator, SpawnParams);
-            if (NewTile)
+        case EGridGenerationPhase::SpawnTiles:
+            if (bStreamChunks)
             {
-                NewTile->X = X;
-                NewTile->Y = Y;
+                // Terrain only; chunk actors are spawned by UpdateStreaming
+                while (GenerationCursor < ChunkStore.NumChunks())
+                {
+                    const FIntPoint Chunk = ChunkStore.GetChunkCoords(GenerationCursor);
+                    GenerateChunkTerrain(Chunk.X, Chunk.Y);
+                    ChunkStore.CompactChunk(GenerationCursor);
+                    ++GenerationCursor;
+                    ++GenerationWorkDone;
+                    if (OutOfTime()) break;
+                }
+                if (GenerationCursor < ChunkStore.NumChunks()) break;
+                
+                GenerationCursor = 0;
+                InitDerivedData();
+                GenerationPhase = EGridGenerationPhase::BuildDerivedData;
+                continue;
+            }
+            
+            // Spawn tiles in row-major order (a failed spawn keeps its slot as nullptr so indices stay Y * Width + X)
+            while (GenerationCursor < NumTiles)
+            {
+                const int32 X = GenerationCursor % GridWidth;
+                const int32 Y = GenerationCursor / GridWidth;
+                FActorSpawnParameters SpawnParams;
+                SpawnParams.Owner = this;
+                
+                AGridTile* NewTile = GetWorld()->SpawnActor<AGridTile>(TileClass, GetTileLocation(X, Y), FRotator::ZeroRotator, SpawnParams);
+                if (NewTile)
+                {
+                    NewTile->X = X;
+                    NewTile->Y = Y;
+                }
                 Tiles.Add(NewTile);
+                ++GenerationCursor;
+                ++GenerationWorkDone;
+                if (OutOfTime()) break;
+            }
+            if (GenerationCursor < NumTiles) break;
+            
+            GenerationCursor = 0;
+            GenerationPhase = EGridGenerationPhase::AssignTerrain;
+            continue;
+            
+        case EGridGenerationPhase::AssignTerrain:
+            while (GenerationCursor < Tiles.Num())
+            {
+                if (Tiles[GenerationCursor]) InitializeTileTerrain(Tiles[GenerationCursor]);
+                ++GenerationCursor;
+                ++GenerationWorkDone;
+                if (OutOfTime()) break;
+            }
+            if (GenerationCursor < Tiles.Num()) break;
+            
+            GenerationCursor = 0;
+            GenerationPhase = EGridGenerationPhase::BuildDerivedData;
+            InitDerivedData();
+            continue;
+            
+        case EGridGenerationPhase::BuildDerivedData:
+            if (bStreamChunks)
+            {
+                // Straight from the chunk store (no actors, so no occupants yet)
+                while (GenerationCursor < ChunkStore.NumChunks())
+                {
+                    AddChunkToDerivedData(GenerationCursor, true, true);
+                    ++GenerationCursor;
+                    ++GenerationWorkDone;
+                    if (OutOfTime()) break;
+                }
+                if (GenerationCursor < ChunkStore.NumChunks()) break;
+            }
+            else
+            {
+                while (GenerationCursor < Tiles.Num())
+                {
+                    AddTileToDerivedData(Tiles[GenerationCursor]);
+                    ++GenerationCursor;
+                    ++GenerationWorkDone;
+                    if (OutOfTime()) break;
+                }
+                if (GenerationCursor < Tiles.Num()) break;
             }
+            
+            Pathfinder.BeginBuildLandmarks(GetLandmarkCount());
+            GenerationPhase = EGridGenerationPhase::BuildLandmarks;
+            continue;
+            
+        case EGridGenerationPhase::BuildLandmarks:
+        {
+            // Each step is a full-grid Dijkstra, so a slice may end after any of them
+            bool bLandmarksDone = false;
+            while (!bLandmarksDone)
+            {
+                bLandmarksDone = Pathfinder.StepBuildLandmarks();
+                ++GenerationWorkDone;
+                if (OutOfTime()) break;
+            }
+            if (!bLandmarksDone) break;
+            
+            BuildRegions();
+            RebuildLayers();
+            GenerationPhase = EGridGenerationPhase::Idle;
+            continue;
+        }
+            
+        default:
+            GenerationPhase = EGridGenerationPhase::Idle;
+            continue;
+        }
+        
+        // Budget exhausted mid-phase; resume next tick
+        OnGenerationProgress.Broadcast(GenerationWorkTotal > 0 ? (float)GenerationWorkDone / GenerationWorkTotal : 0.0f);
+        return;
+    }
+    
+    bIsGridReady = true;
+    SetActorTickEnabled(bStreamChunks);
+    if (bStreamChunks)
+    {
+        TimeSinceStreamingUpdate = 0.0f;
+        UpdateStreaming();
+    }
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->NotifyBoardGenerated(this);
+    }
+    OnGenerationProgress.Broadcast(1.0f);
+    OnGridGenerated.Broadcast();
+}
+
+void AGridManager::InitDerivedData()
+{
+    Visibility.Init(GridWidth, GridHeight);
+    Occupancy.Init(GridWidth, GridHeight);
+    BumpBoardGeneration();
+    StateHash = 0;
+    Pathfinder.Init(GridWidth, GridHeight, Connectivity);
+    if (Overlay) Overlay->Init(GridWidth, GridHeight, GetActorLocation(), TileSize, bStreamChunks ? OverlayWindowChunks * FGridChunkStore::ChunkSize : 0);
+}
+
+void AGridManager::AddTileToDerivedData(AGridTile* Tile)
+{
+    if (!Tile) return;
+    
+    Pathfinder.SetTileCost(Tile->Y * GridWidth + Tile->X, GetTileNavCost(Tile));
+    if (Tile->bBlocksSight)
+    {
+        Visibility.SetBlocksSight(Tile->X, Tile->Y, true);
+    }
+    if (Tile->Occupant)
+    {
+        NotifyOccupantChanged(Tile);
+        
+        AUnitCharacter* Unit = Cast<AUnitCharacter>(Tile->Occupant);
+        if (Unit && Unit->CurrentTile == Tile)
+        {
+            UpdateUnitVisibility(Unit);
         }
     }
 }
 
 AGridTile* AGridManager::GetTileAt(int32 X, int32 Y) const
 {
+    if (!bIsGridReady) return nullptr;
     if (X < 0 || X >= GridWidth || Y < 0 || Y >= GridHeight) return nullptr;
+    if (bStreamChunks)
+    {
+        const FGridLoadedChunk* Loaded = LoadedChunks.Find(ChunkStore.GetChunkIndex(X, Y));
+        return Loaded ? Loaded->Tiles[FGridChunkStore::GetLocalIndex(X, Y)] : nullptr;
+    }
     int32 Index = Y * GridWidth + X;
     if (Index < 0 || Index >= Tiles.Num()) return nullptr;
     return Tiles[Index];
 }
 
-TArray<AGridTile*> AGridManager::GetNeighbors(AGridTile* Tile) const
+FVector AGridManager::GetTileLocation(int32 X, int32 Y) const
 {
-    TArray<AGridTile*> Neighbors;
-    if (!Tile) return Neighbors;
-    
-    // Four directions: up, down, left, right
-    AGridTile* Up = GetTileAt(Tile->X, Tile->Y - 1);
-    AGridTile* Down = GetTileAt(Tile->X, Tile->Y + 1);
-    AGridTile* Left = GetTileAt(Tile->X - 1, Tile->Y);
-    AGridTile* Right = GetTileAt(Tile->X + 1, Tile->Y);
+    if (Connectivity == EGridConnectivity::Hex6)
+    {
+        // Odd rows shift half a tile right; rows pack at sqrt(3)/2 spacing
+        return GetActorLocation() + FVector((X + 0.5f * (Y & 1)) * TileSize, Y * TileSize * 0.8660254f, 0.0f);
+    }
+    return GetActorLocation() + FVector(X * TileSize, Y * TileSize, 0.0f);
+}
+
+FIntPoint AGridManager::GetTileCoordsAt(const FVector& Location) const
+{
+    if (TileSize <= 0.0f) return FIntPoint::ZeroValue;
     
-    if (Up && Up->bIsWalkable) Neighbors.Add(Up);
-    if (Down && Down->bIsWalkable) Neighbors.Add(Down);
-    if (Left && Left->bIsWalkable) Neighbors.Add(Left);
-    if (Right && Right->bIsWalkable) Neighbors.Add(Right);
+    const FVector Local = Location - GetActorLocation();
+    if (Connectivity == EGridConnectivity::Hex6)
+    {
+        const int32 Y = FMath::RoundToInt(Local.Y / (TileSize * 0.8660254f));
+        return FIntPoint(FMath::RoundToInt(Local.X / TileSize - 0.5f * (Y & 1)), Y);
+    }
+    return FIntPoint(FMath::RoundToInt(Local.X / TileSize), FMath::RoundToInt(Local.Y / TileSize));
+}
+
+AGridTile* AGridManager::LoadTileAt(int32 X, int32 Y)
+{
+    if (!bStreamChunks) return GetTileAt(X, Y);
+    if (!bIsGridReady || !ChunkStore.IsValidTile(X, Y)) return nullptr;
     
-    return Neighbors;
+    FGridLoadedChunk& Loaded = LoadChunk(ChunkStore.GetChunkIndex(X, Y));
+    return Loaded.Tiles[FGridChunkStore::GetLocalIndex(X, Y)];
 }
 
-int32 AGridManager::GetManhattanDistance(AGridTile* A, AGridTile* B) const
+FGridTileTerrain AGridManager::GetTerrainAt(int32 X, int32 Y) const
 {
-    if (!A || !B) return 0;
-    return FMath::Abs(A->X - B->X) + FMath::Abs(A->Y - B->Y);
+    if (bStreamChunks)
+    {
+        return ChunkStore.IsValidTile(X, Y) ? ChunkStore.Get(X, Y) : DefaultTerrain;
+    }
+    
+    FGridTileTerrain Terrain = DefaultTerrain;
+    const int32 Index = Y * GridWidth + X;
+    if (X >= 0 && X < GridWidth && Tiles.IsValidIndex(Index) && Tiles[Index])
+    {
+        Terrain = MakeTerrain(Tiles[Index]);
+    }
+    return Terrain;
 }
 
-TArray<AGridTile*> AGridManager::FindPath(AGridTile* Start, AGridTile* End) const
+void AGridManager::SetTerrainAt(int32 X, int32 Y, const FGridTileTerrain& Terrain)
 {
-    TArray<AGridTile*> Path;
-    if (!Start || !End) return Path;
-    if (Start == End) return Path;
+    if (X < 0 || X >= GridWidth || Y < 0 || Y >= GridHeight) return;
     
-    // A* pathfinding implementation using smart pointers for safe memory management
-    TArray<FPathNode*> OpenSet;
-    TArray<FPathNode*> ClosedSet;
-    TMap<AGridTile*, TSharedPtr<FPathNode>> NodeMap;
+    if (AGridTile* Tile = GetTileAt(X, Y))
+    {
+        BeginTerrainEdit();
+        SetTileTerrain(Tile, Terrain.bIsWalkable, Terrain.MovementCost);
+        if (Tile->bBlocksSight != Terrain.bBlocksSight)
+        {
+            SetTileBlocksSight(Tile, Terrain.bBlocksSight);
+        }
+        EndTerrainEdit();
+        return;
+    }
+    if (!bStreamChunks || !ChunkStore.IsValidTile(X, Y)) return;
     
-    // Create start node
-    TSharedPtr<FPathNode> StartNode = MakeShared<FPathNode>();
-    StartNode->Tile = Start;
-    StartNode->GCost = 0;
-    StartNode->HCost = GetManhattanDistance(Start, End);
-    StartNode->Parent = nullptr;
+    // Tile without an actor: the store is the only copy, and path/sight data follow it once built
+    const bool bBlockedSight = ChunkStore.Get(X, Y).bBlocksSight;
+    ChunkStore.Set(X, Y, Terrain);
+    if (bIsGridReady)
+    {
+        BeginTerrainEdit();
+        Pathfinder.SetTileCostDeferred(Y * GridWidth + X, GetTerrainNavCost(Terrain));
+        if (bBlockedSight != Terrain.bBlocksSight)
+        {
+            Visibility.SetBlocksSightDeferred(X, Y, Terrain.bBlocksSight);
+        }
+        MarkTerrainDirty(X, Y);
+        EndTerrainEdit();
+    }
+}
+
+void AGridManager::GenerateChunkTerrain_Implementation(int32 ChunkX, int32 ChunkY)
+{
+    // Default: every tile keeps DefaultTerrain
+}
+
+FGridTileTerrain AGridManager::MakeTerrain(const AGridTile* Tile)
+{
+    FGridTileTerrain Terrain;
+    Terrain.MovementCost = (uint8)FMath::Clamp(Tile->MovementCost, 0, 255);
+    Terrain.bIsWalkable = Tile->bIsWalkable;
+    Terrain.bBlocksSight = Tile->bBlocksSight;
+    return Terrain;
+}
+
+void AGridManager::SyncLoadedTilesToStore()
+{
+    if (!bStreamChunks) return;
     
-    OpenSet.Add(StartNode.Get());
-    NodeMap.Add(Start, StartNode);
+    // Blueprints may have edited tile properties directly; the store must match before a rebuild reads it
+    ForEachLoadedTile([this](const AGridTile* Tile)
+    {
+        ChunkStore.Set(Tile->X, Tile->Y, MakeTerrain(Tile));
+    });
+}
+
+FGridLoadedChunk& AGridManager::LoadChunk(int32 Chunk) const
+{
+    FGridLoadedChunk& Loaded = LoadedChunks.FindOrAdd(Chunk);
+    Loaded.LastUsedTime = GetWorld()->GetTimeSeconds();
+    if (Loaded.Tiles.Num()) return Loaded;
     
-    FPathNode* CurrentNode = nullptr;
+    LLM_SCOPE_BYTAG(TB_Grid);
+    Loaded.Tiles.Init(nullptr, FGridChunkStore::TilesPerChunk);
     
-    while (OpenSet.Num() > 0)
+    const FIntPoint Coords = ChunkStore.GetChunkCoords(Chunk);
+    const int32 MinX = Coords.X * FGridChunkStore::ChunkSize;
+    const int32 MinY = Coords.Y * FGridChunkStore::ChunkSize;
+    const int32 MaxX = FMath::Min(MinX + FGridChunkStore::ChunkSize, GridWidth);
+    const int32 MaxY = FMath::Min(MinY + FGridChunkStore::ChunkSize, GridHeight);
+    for (int32 Y = MinY; Y < MaxY; ++Y)
     {
-        // Find node with lowest FCost
-        CurrentNode = OpenSet[0];
-        for (FPathNode* Node : OpenSet)
+        for (int32 X = MinX; X < MaxX; ++X)
         {
-            if (Node->FCost() < CurrentNode->FCost() || 
-                (Node->FCost() == CurrentNode->FCost() && Node->HCost < CurrentNode->HCost))
+            AGridTile* Tile = TilePool.Num() ? TilePool.Pop() : nullptr;
+            if (Tile)
+            {
+                Tile->SetActorLocation(GetTileLocation(X, Y));
+                Tile->SetActorHiddenInGame(false);
+                Tile->SetActorEnableCollision(true);
+            }
+            else
             {
-                CurrentNode = Node;
+                FActorSpawnParameters SpawnParams;
+                SpawnParams.Owner = const_cast<AGridManager*>(this);
+                Tile = GetWorld()->SpawnActor<AGridTile>(TileClass, GetTileLocation(X, Y), FRotator::ZeroRotator, SpawnParams);
+                if (!Tile) continue;
             }
+            
+            const FGridTileTerrain& Terrain = ChunkStore.Get(X, Y);
+            Tile->X = X;
+            Tile->Y = Y;
+            Tile->bIsWalkable = Terrain.bIsWalkable;
+            Tile->MovementCost = Terrain.MovementCost;
+            Tile->bBlocksSight = Terrain.bBlocksSight;
+            Loaded.Tiles[FGridChunkStore::GetLocalIndex(X, Y)] = Tile;
         }
+    }
+    return Loaded;
+}
+
+void AGridManager::UnloadChunk(int32 Chunk)
+{
+    FGridLoadedChunk Loaded;
+    if (!LoadedChunks.RemoveAndCopyValue(Chunk, Loaded)) return;
+    
+    for (AGridTile* Tile : Loaded.Tiles)
+    {
+        if (!Tile) continue;
         
-        OpenSet.Remove(CurrentNode);
-        ClosedSet.Add(CurrentNode);
+        // Terrain edited directly on the actor survives the unload
+        ChunkStore.Set(Tile->X, Tile->Y, MakeTerrain(Tile));
+        Tile->Occupant = nullptr;
         
-        // Found the end
-        if (CurrentNode->Tile == End)
+        if (TilePool.Num() < MaxPooledTiles)
         {
-            break;
+            Tile->SetActorHiddenInGame(true);
+            Tile->SetActorEnableCollision(false);
+            TilePool.Add(Tile);
         }
-        
-        // Check neighbors
-        TArray<AGridTile*> Neighbors = GetNeighbors(CurrentNode->Tile);
-        for (AGridTile* NeighborTile : Neighbors)
+        else
         {
-            // Skip if occupied (unless it's the destination)
-            if (NeighborTile->Occupant && NeighborTile != End)
-            {
-                continue;
-            }
-            
-            // Check if in closed set
-            bool bInClosedSet = false;
-            for (FPathNode* ClosedNode : ClosedSet)
-            {
-                if (ClosedNode->Tile == NeighborTile)
-                {
-                    bInClosedSet = true;
-                    break;
-                }
-            }
-            if (bInClosedSet) continue;
-            
-            int32 NewGCost = CurrentNode->GCost + NeighborTile->MovementCost;
-            
-            FPathNode* NeighborNode = nullptr;
-            TSharedPtr<FPathNode>* NeighborNodePtr = NodeMap.Find(NeighborTile);
-            if (NeighborNodePtr)
+            Tile->Destroy();
+        }
+    }
+    ChunkStore.CompactChunk(Chunk);
+}
+
+void AGridManager::DestroyStreamedTiles()
+{
+    for (const TPair<int32, FGridLoadedChunk>& Pair : LoadedChunks)
+    {
+        for (AGridTile* Tile : Pair.Value.Tiles)
+        {
+            if (Tile) Tile->Destroy();
+        }
+    }
+    for (AGridTile* Tile : TilePool)
+    {
+        if (Tile) Tile->Destroy();
+    }
+    LoadedChunks.Empty();
+    TilePool.Empty();
+}
+
+void AGridManager::UpdateStreaming()
+{
+    if (!bStreamChunks || !bIsGridReady || ChunkStore.NumChunks() == 0) return;
+    
+    UWorld* World = GetWorld();
+    const double Now = World->GetTimeSeconds();
+    
+    // Streaming sources in tile coordinates: every unit standing on this grid, and the camera
+    TArray<FIntPoint, TInlineAllocator<64>> Sources;
+    if (const UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->ForEachUnit([this, &Sources](const AUnitCharacter* Unit)
+        {
+            const AGridTile* Tile = Unit->CurrentTile;
+            if (Tile && Tile->GetGridManager() == this)
             {
-                NeighborNode = NeighborNodePtr->Get();
+                Sources.Add(FIntPoint(Tile->X, Tile->Y));
             }
-            
-            if (!NeighborNode || NewGCost < NeighborNode->GCost)
+        });
+    }
+    APlayerController* PC = World->GetFirstPlayerController();
+    if (PC && PC->PlayerCameraManager)
+    {
+        Sources.Add(GetTileCoordsAt(PC->PlayerCameraManager->GetCameraLocation()));
+        UpdateOverlayWindow(Sources.Last());
+    }
+    
+    // Wanted chunk -> distance in chunks to the nearest source (sources off the grid stream its nearest edge)
+    TMap<int32, int32> Wanted;
+    const int32 Radius = FMath::Max(0, StreamRadiusChunks);
+    for (const FIntPoint& Source : Sources)
+    {
+        const int32 SourceChunkX = FMath::Clamp(Source.X, 0, GridWidth - 1) >> FGridChunkStore::ChunkShift;
+        const int32 SourceChunkY = FMath::Clamp(Source.Y, 0, GridHeight - 1) >> FGridChunkStore::ChunkShift;
+        for (int32 ChunkY = FMath::Max(0, SourceChunkY - Radius); ChunkY <= FMath::Min(ChunkStore.GetNumChunksY() - 1, SourceChunkY + Radius); ++ChunkY)
+        {
+            for (int32 ChunkX = FMath::Max(0, SourceChunkX - Radius); ChunkX <= FMath::Min(ChunkStore.GetNumChunksX() - 1, SourceChunkX + Radius); ++ChunkX)
             {
-                if (!NeighborNode)
-                {
-                    TSharedPtr<FPathNode> NewNode = MakeShared<FPathNode>();
-                    NewNode->Tile = NeighborTile;
-                    NeighborNode = NewNode.Get();
-                    NodeMap.Add(NeighborTile, NewNode);
-                    OpenSet.Add(NeighborNode);
-                }
-                
-                NeighborNode->GCost = NewGCost;
-                NeighborNode->HCost = GetManhattanDistance(NeighborTile, End);
-                NeighborNode->Parent = CurrentNode;
+                const int32 Distance = FMath::Max(FMath::Abs(ChunkX - SourceChunkX), FMath::Abs(ChunkY - SourceChunkY));
+                int32& Best = Wanted.FindOrAdd(ChunkY * ChunkStore.GetNumChunksX() + ChunkX, MAX_int32);
+                Best = FMath::Min(Best, Distance);
             }
         }
     }
     
-    // Reconstruct path
-    if (CurrentNode && CurrentNode->Tile == End)
+    // Unload chunks nothing has wanted for a while; a chunk with an occupied tile stays
+    TArray<int32> ToUnload;
+    for (TPair<int32, FGridLoadedChunk>& Pair : LoadedChunks)
+    {
+        if (Wanted.Contains(Pair.Key))
+        {
+            Pair.Value.LastUsedTime = Now;
+            continue;
+        }
+        if (Now - Pair.Value.LastUsedTime < ChunkKeepAliveSeconds) continue;
+        
+        const bool bOccupied = Pair.Value.Tiles.ContainsByPredicate([](const AGridTile* Tile) { return Tile && Tile->Occupant; });
+        if (!bOccupied)
+        {
+            ToUnload.Add(Pair.Key);
+        }
+    }
+    for (int32 Chunk : ToUnload)
+    {
+        UnloadChunk(Chunk);
+    }
+    
+    // Load missing chunks nearest first, within the time budget
+    TArray<TPair<int32, int32>> ToLoad;
+    for (const TPair<int32, int32>& Pair : Wanted)
     {
-        FPathNode* Node = CurrentNode;
-        while (Node)
+        if (!LoadedChunks.Contains(Pair.Key))
         {
-            Path.Insert(Node->Tile, 0);
-            Node = Node->Parent;
+            ToLoad.Emplace(Pair.Value, Pair.Key);
         }
     }
+    ToLoad.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B) { return A.Key < B.Key; });
+    
+    const double StartTime = FPlatformTime::Seconds();
+    for (const TPair<int32, int32>& Entry : ToLoad)
+    {
+        LoadChunk(Entry.Value);
+        if ((FPlatformTime::Seconds() - StartTime) * 1000.0 >= StreamingBudgetMs) break;
+    }
+}
+
+TArray<AGridTile*> AGridManager::GetNeighbors(AGridTile* Tile) const
+{
+    TArray<AGridTile*> Neighbors;
+    if (!bIsGridReady || !Tile) return Neighbors;
+    
+    Pathfinder.ForEachWalkableNeighbor(Tile->Y * GridWidth + Tile->X, [this, &Neighbors](int32 Index)
+    {
+        if (AGridTile* Neighbor = GetTileByIndex(Index)) Neighbors.Add(Neighbor);
+    });
+    return Neighbors;
+}
+
+TArray<AGridTile*> AGridManager::GetReachableTiles(AGridTile* Origin, int32 MaxCost) const
+{
+    TArray<AGridTile*> Reachable;
+    if (!bIsGridReady || !Origin) return Reachable;
+    
+    TArray<int32> Indices;
+    Pathfinder.GetReachableTiles(Origin->Y * GridWidth + Origin->X, MaxCost, &Occupancy, Indices);
+    Reachable.Reserve(Indices.Num());
+    for (int32 Index : Indices)
+    {
+        // Streamed grids: tiles in unloaded chunks have no actor to return
+        if (AGridTile* Tile = GetTileByIndex(Index)) Reachable.Add(Tile);
+    }
+    return Reachable;
+}
+
+int32 AGridManager::GetManhattanDistance(AGridTile* A, AGridTile* B) const
+{
+    if (!A || !B) return 0;
+    return FMath::Abs(A->X - B->X) + FMath::Abs(A->Y - B->Y);
+}
+
+TArray<AGridTile*> AGridManager::FindPath(AGridTile* Start, AGridTile* End) const
+{
+    TArray<AGridTile*> Path;
+    FGridPath GridPath;
+    if (!FindGridPath(Start, End, GridPath)) return Path;
     
-    // Automatic cleanup via TSharedPtr - no manual delete needed
+    Path.Reserve(GridPath.Num());
+    if (!bStreamChunks)
+    {
+        GridPath.ForEachTile([this, &Path](int32 Index) { Path.Add(Tiles[Index]); });
+        return Path;
+    }
     
+    // A path may leave the loaded area; its chunks are streamed in so every step has a tile actor
+    GridPath.ForEachTile([this, &Path](int32 Index)
+    {
+        const int32 X = Index % GridWidth;
+        const int32 Y = Index / GridWidth;
+        Path.Add(LoadChunk(ChunkStore.GetChunkIndex(X, Y)).Tiles[FGridChunkStore::GetLocalIndex(X, Y)]);
+    });
     return Path;
 }
+
+bool AGridManager::FindGridPath(const AGridTile* Start, const AGridTile* End, FGridPath& OutPath) const
+{
+    OutPath.Reset();
+    if (!bIsGridReady) return false;
+    if (!Start || !End) return false;
+    if (Start == End) return false;
+    
+    // A* over tile indices; occupied tiles block except the destination
+    const int32 StartIndex = Start->Y * GridWidth + Start->X;
+    const int32 GoalIndex = End->Y * GridWidth + End->X;
+    
+    // No search can succeed between regions (which lag behind the terrain while an edit group is open)
+    const bool bConnected = TerrainEditDepth > 0 || !Regions.IsBuilt() || Regions.AreConnected(StartIndex, GoalIndex);
+    if (!FTBTelemetry::IsRecording())
+    {
+        return bConnected && Pathfinder.FindPath(StartIndex, GoalIndex, &Occupancy, OutPath);
+    }
+
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    const bool bFound = bConnected && Pathfinder.FindPath(StartIndex, GoalIndex, &Occupancy, OutPath);
+    const int32 Nanoseconds = (int32)FMath::Min(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) * 1.0e9, (double)MAX_int32);
+    FTBTelemetry::Record(ETBTelemetryEvent::PathRequest, StartIndex, GoalIndex, OutPath.Num(), Nanoseconds, bFound ? 1 : 0);
+    return bFound;
+}
+
+void AGridManager::PlanUnitMoves(const TArray<AUnitCharacter*>& Units, const TArray<AGridTile*>& Goals, TArray<FGridPath>& OutPaths)
+{
+    OutPaths.SetNum(Units.Num());
+    for (FGridPath& Path : OutPaths)
+    {
+        Path.Reset();
+    }
+    if (!bIsGridReady) return;
+    
+    // Units not on this grid get an empty request and stay
+    MoveRequests.Reset();
+    const int32 CostScale = Pathfinder.GetCostScale();
+    for (int32 Index = 0; Index < Units.Num(); ++Index)
+    {
+        FGridMoveRequest& Request = MoveRequests.AddDefaulted_GetRef();
+        const AUnitCharacter* Unit = Units[Index];
+        if (!Unit || !Unit->TurnStats || !Unit->CurrentTile || Unit->CurrentTile->GetGridManager() != this) continue;
+        
+        const AGridTile* Goal = Goals.IsValidIndex(Index) ? Goals[Index] : nullptr;
+        Request.Start = Unit->CurrentTile->Y * GridWidth + Unit->CurrentTile->X;
+        Request.Goal = Goal ? Goal->Y * GridWidth + Goal->X : Request.Start;
+        Request.MaxCost = Unit->TurnStats->MovementPoints * CostScale;
+    }
+    
+    MovePlanner.Plan(Pathfinder, &Occupancy, MoveRequests, PlannedMoves);
+    for (int32 Index = 0; Index < Units.Num(); ++Index)
+    {
+        Swap(OutPaths[Index], PlannedMoves[Index].Path);
+        
+        // Destinations need a tile actor to be confirmed on
+        const int32 Destination = OutPaths[Index].GetGoal();
+        if (bStreamChunks && OutPaths[Index].IsMove())
+        {
+            LoadTileAt(Destination % GridWidth, Destination / GridWidth);
+        }
+    }
+}
+
+int32 AGridManager::GetTileNavCost(const AGridTile* Tile)
+{
+    return Tile && Tile->bIsWalkable ? FMath::Max(0, Tile->MovementCost) : FGridPathfinder::Blocked;
+}
+
+int32 AGridManager::GetTerrainNavCost(const FGridTileTerrain& Terrain)
+{
+    return Terrain.bIsWalkable ? (int32)Terrain.MovementCost : FGridPathfinder::Blocked;
+}
+
+void AGridManager::SetTileTerrain(AGridTile* Tile, bool bWalkable, int32 MovementCost)
+{
+    if (!Tile) return;
+    Tile->bIsWalkable = bWalkable;
+    Tile->MovementCost = MovementCost;
+    
+    // Upper layers are read back by RebuildLayers
+    if (Tile->Layer != 0) return;
+    if (bStreamChunks)
+    {
+        ChunkStore.Set(Tile->X, Tile->Y, MakeTerrain(Tile));
+    }
+    if (bIsGridReady)
+    {
+        BeginTerrainEdit();
+        Pathfinder.SetTileCostDeferred(Tile->Y * GridWidth + Tile->X, GetTileNavCost(Tile));
+        MarkTerrainDirty(Tile->X, Tile->Y);
+        EndTerrainEdit();
+    }
+}
+
+void AGridManager::UpdateOverlayWindow(const FIntPoint& CameraTile)
+{
+    if (!Overlay) return;
+    
+    const FIntPoint Min = Overlay->GetWindowMin();
+    const FIntPoint Size = Overlay->GetWindowSize();
+    const int32 Margin = FGridChunkStore::ChunkSize;
+    const bool bInside = CameraTile.X >= Min.X + Margin && CameraTile.X < Min.X + Size.X - Margin
+        && CameraTile.Y >= Min.Y + Margin && CameraTile.Y < Min.Y + Size.Y - Margin;
+    if (bInside) return;
+    
+    // Chunk-aligned (so hex rows keep their parity) and clamped to the grid
+    const int32 AlignMask = ~(FGridChunkStore::ChunkSize - 1);
+    const int32 MinX = FMath::Clamp(CameraTile.X - Size.X / 2, 0, GridWidth - Size.X) & AlignMask;
+    const int32 MinY = FMath::Clamp(CameraTile.Y - Size.Y / 2, 0, GridHeight - Size.Y) & AlignMask;
+    if (MinX != Min.X || MinY != Min.Y)
+    {
+        Overlay->SetWindow(MinX, MinY, GetTileLocation(MinX, MinY));
+    }
+}
+
+void AGridManager::AddChunkToDerivedData(int32 Chunk, bool bPathCosts, bool bSightBlockers)
+{
+    const FIntPoint Coords = ChunkStore.GetChunkCoords(Chunk);
+    const int32 MinX = Coords.X * FGridChunkStore::ChunkSize;
+    const int32 MinY = Coords.Y * FGridChunkStore::ChunkSize;
+    if (ChunkStore.IsChunkUniform(Chunk))
+    {
+        const FGridTileTerrain& Terrain = ChunkStore.Get(MinX, MinY);
+        if (!Terrain.bIsWalkable) bPathCosts = false;
+        if (!Terrain.bBlocksSight) bSightBlockers = false;
+    }
+    if (!bPathCosts && !bSightBlockers) return;
+    
+    const int32 MaxX = FMath::Min(MinX + FGridChunkStore::ChunkSize, GridWidth);
+    const int32 MaxY = FMath::Min(MinY + FGridChunkStore::ChunkSize, GridHeight);
+    for (int32 Y = MinY; Y < MaxY; ++Y)
+    {
+        for (int32 X = MinX; X < MaxX; ++X)
+        {
+            const FGridTileTerrain& Terrain = ChunkStore.Get(X, Y);
+            if (bPathCosts)
+            {
+                Pathfinder.SetTileCost(Y * GridWidth + X, GetTerrainNavCost(Terrain));
+            }
+            if (bSightBlockers && Terrain.bBlocksSight)
+            {
+                Visibility.SetBlocksSight(X, Y, true);
+            }
+        }
+    }
+}
+
+void AGridManager::RebuildNavigation()
+{
+    LLM_SCOPE_BYTAG(TB_Grid);
+    Pathfinder.Init(GridWidth, GridHeight, Connectivity);
+    if (bStreamChunks)
+    {
+        SyncLoadedTilesToStore();
+        for (int32 Chunk = 0; Chunk < ChunkStore.NumChunks(); ++Chunk)
+        {
+            AddChunkToDerivedData(Chunk, true, false);
+        }
+    }
+    else
+    {
+        for (AGridTile* Tile : Tiles)
+        {
+            if (Tile)
+            {
+                Pathfinder.SetTileCost(Tile->Y * GridWidth + Tile->X, GetTileNavCost(Tile));
+            }
+        }
+    }
+    Pathfinder.BuildLandmarks(GetLandmarkCount());
+    BuildRegions();
+    RebuildLayers();
+}
+
+SIZE_T AGridManager::GetAllocatedSize() const
+{
+    SIZE_T Size = ChunkStore.GetAllocatedSize() + Pathfinder.GetAllocatedSize() + Pathfinder.GetScratchAllocatedSize()
+        + Occupancy.GetAllocatedSize() + Visibility.GetAllocatedSize() + Visibility.GetCacheAllocatedSize()
+        + Regions.GetAllocatedSize() + MovePlanner.GetAllocatedSize();
+    if (Overlay)
+    {
+        Size += Overlay->GetAllocatedSize();
+    }
+    Size += Tiles.GetAllocatedSize() + TilePool.GetAllocatedSize() + LoadedChunks.GetAllocatedSize();
+    for (const TPair<int32, FGridLoadedChunk>& Pair : LoadedChunks)
+    {
+        Size += Pair.Value.Tiles.GetAllocatedSize();
+    }
+    Size += Layers.GetAllocatedSize() + LayerTiles.GetAllocatedSize() + LayerPortals.GetAllocatedSize();
+    return Size + DirtyTerrainTiles.GetAllocatedSize() + EntityManagers.GetAllocatedSize();
+}
+
+void AGridManager::RebuildLayers()
+{
+    LLM_SCOPE_BYTAG(TB_Grid);
+    LayerTiles.Reset();
+    
+    // Every layer is a dense pathfinder and every portal end keeps cost fields over its layer, which streamed world
+    // maps cannot afford
+    if (NumLayers <= 1 || bStreamChunks)
+    {
+        Layers.Init(0, 0, 0);
+        return;
+    }
+    
+    Layers.Init(NumLayers, GridWidth, GridHeight, Connectivity);
+    FGridPathfinder& Ground = Layers.GetLayer(0);
+    for (AGridTile* Tile : Tiles)
+    {
+        if (Tile)
+        {
+            Ground.SetTileCost(Tile->Y * GridWidth + Tile->X, GetTileNavCost(Tile));
+        }
+    }
+    
+    // Layer tiles are placed in the level, so they belong to no grid until one picks them up here
+    for (TActorIterator<AGridTile> It(GetWorld()); It; ++It)
+    {
+        AGridTile* Tile = *It;
+        if (Tile->Layer <= 0 || Tile->Layer >= NumLayers) continue;
+        if (Tile->X < 0 || Tile->X >= GridWidth || Tile->Y < 0 || Tile->Y >= GridHeight) continue;
+        if (Tile->GetOwner() && Tile->GetOwner() != this) continue;
+        
+        LayerTiles.Add(FIntVector(Tile->X, Tile->Y, Tile->Layer), Tile);
+        Layers.GetLayer(Tile->Layer).SetTileCost(Tile->Y * GridWidth + Tile->X, GetTileNavCost(Tile));
+    }
+    
+    for (const FGridPortal& Portal : LayerPortals)
+    {
+        Layers.AddPortal(Portal);
+    }
+    Layers.BuildPortalGraph();
+}
+
+void AGridManager::AddLayerPortal(AGridTile* From, AGridTile* To, int32 Cost, bool bTwoWay)
+{
+    if (!From || !To || From == To) return;
+    
+    FGridPortal Portal;
+    Portal.From = FGridLayerTile(From->Layer, From->Y * GridWidth + From->X);
+    Portal.To = FGridLayerTile(To->Layer, To->Y * GridWidth + To->X);
+    Portal.Cost = FMath::Max(0, Cost);
+    Portal.bTwoWay = bTwoWay;
+    LayerPortals.Add(Portal);
+}
+
+AGridTile* AGridManager::GetLayerTileAt(int32 X, int32 Y, int32 Layer) const
+{
+    if (Layer == 0) return GetTileAt(X, Y);
+    AGridTile* const* Tile = LayerTiles.Find(FIntVector(X, Y, Layer));
+    return Tile ? *Tile : nullptr;
+}
+
+TArray<AGridTile*> AGridManager::FindLayeredPath(AGridTile* Start, AGridTile* End) const
+{
+    TArray<AGridTile*> Path;
+    if (!bIsGridReady || !Start || !End || Layers.NumLayers() == 0) return Path;
+    
+    FGridLayerPath LayerPath;
+    const FGridLayerTile From(Start->Layer, Start->Y * GridWidth + Start->X);
+    const FGridLayerTile To(End->Layer, End->Y * GridWidth + End->X);
+    if (!Layers.FindPath(From, To, LayerPath)) return Path;
+    
+    Path.Reserve(LayerPath.Num());
+    for (const FGridLayerPathStep& Step : LayerPath.Steps)
+    {
+        Path.Add(GetLayerTileAt(Step.Tile.TileIndex % GridWidth, Step.Tile.TileIndex / GridWidth, Step.Tile.Layer));
+    }
+    return Path;
+}
+
+TArray<AGridTile*> AGridManager::GetLayeredReachableTiles(AGridTile* Origin, int32 MaxCost) const
+{
+    TArray<AGridTile*> Reachable;
+    if (!bIsGridReady || !Origin || Layers.NumLayers() == 0) return Reachable;
+    
+    TArray<FGridLayerTile> LayerTilesInRange;
+    Layers.GetReachableTiles(FGridLayerTile(Origin->Layer, Origin->Y * GridWidth + Origin->X), MaxCost, LayerTilesInRange);
+    Reachable.Reserve(LayerTilesInRange.Num());
+    for (const FGridLayerTile& Tile : LayerTilesInRange)
+    {
+        if (AGridTile* LayerTile = GetLayerTileAt(Tile.TileIndex % GridWidth, Tile.TileIndex / GridWidth, Tile.Layer))
+        {
+            Reachable.Add(LayerTile);
+        }
+    }
+    return Reachable;
+}
+
+int32 AGridManager::GetLandmarkCount() const
+{
+    return bUseLandmarkHeuristic && !bStreamChunks ? NumLandmarks : 0;
+}
+
+void AGridManager::BuildRegions()
+{
+    if (bStreamChunks)
+    {
+        Regions.Reset();
+        return;
+    }
+    Regions.Build(Pathfinder);
+}
+
+void AGridManager::BeginTerrainEdit()
+{
+    if (TerrainEditDepth++ == 0)
+    {
+        DirtyTerrainTiles.Reset();
+    }
+}
+
+void AGridManager::EndTerrainEdit()
+{
+    if (TerrainEditDepth == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s: EndTerrainEdit without a matching BeginTerrainEdit"), *GetName());
+        return;
+    }
+    if (--TerrainEditDepth == 0)
+    {
+        CommitTerrainEdit();
+    }
+}
+
+void AGridManager::ApplyTerrainChanges(const TArray<FGridTerrainChange>& Changes)
+{
+    BeginTerrainEdit();
+    for (const FGridTerrainChange& Change : Changes)
+    {
+        SetTerrainAt(Change.X, Change.Y, Change.Terrain);
+    }
+    EndTerrainEdit();
+}
+
+EGridConnection AGridManager::AreTilesConnected(AGridTile* A, AGridTile* B) const
+{
+    if (!bIsGridReady || !A || !B) return EGridConnection::NotConnected;
+    
+    const int32 StartIndex = A->Y * GridWidth + A->X;
+    const int32 GoalIndex = B->Y * GridWidth + B->X;
+    if (Regions.IsBuilt())
+    {
+        return Regions.AreConnected(StartIndex, GoalIndex) ? EGridConnection::Connected : EGridConnection::NotConnected;
+    }
+    if (StartIndex == GoalIndex)
+    {
+        return Pathfinder.GetTileCost(StartIndex) >= 0 ? EGridConnection::Connected : EGridConnection::NotConnected;
+    }
+    
+    // Streamed grids keep no labels; search on terrain alone, within the budget
+    FGridPath Path;
+    FGridPathStats Stats;
+    if (Pathfinder.FindPath(StartIndex, GoalIndex, nullptr, Path, &Stats, FMath::Max(1, ConnectionSearchBudget)))
+    {
+        return EGridConnection::Connected;
+    }
+    return Stats.bOutOfBudget ? EGridConnection::Unknown : EGridConnection::NotConnected;
+}
+
+void AGridManager::MarkTerrainDirty(int32 X, int32 Y)
+{
+    const FIntPoint Tile(X, Y);
+    if (DirtyTerrainTiles.Num() == 0)
+    {
+        DirtyTerrainBounds = FIntRect(Tile, Tile);
+    }
+    else
+    {
+        DirtyTerrainBounds.Include(Tile);
+    }
+    DirtyTerrainTiles.Add(Y * GridWidth + X);
+}
+
+void AGridManager::CommitTerrainEdit()
+{
+    if (DirtyTerrainTiles.Num() == 0) return;
+    
+    LLM_SCOPE_BYTAG(TB_Grid);
+    if (Visibility.FlushBlockers())
+    {
+        BumpBoardGeneration();
+    }
+    if (bIsGridReady)
+    {
+        Pathfinder.FlushTileCosts();
+        if (Regions.IsBuilt())
+        {
+            Regions.Update(Pathfinder, DirtyTerrainTiles);
+        }
+        RefreshPreviewsOnDirtyTerrain();
+    }
+    DirtyTerrainTiles.Reset();
+    
+    if (bIsGridReady)
+    {
+        // Reachability drawn with the old costs is dropped; whoever drew it redraws from OnTerrainChanged
+        if (Overlay)
+        {
+            Overlay->ClearLayer(EGridOverlayLayer::Reachable);
+        }
+        OnTerrainChanged.Broadcast(DirtyTerrainBounds.Min, DirtyTerrainBounds.Max);
+    }
+}
+
+void AGridManager::RefreshPreviewsOnDirtyTerrain()
+{
+    const UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this);
+    if (!Board) return;
+    
+    // Collected first so the registry is not walked while previews are redone
+    TArray<AUnitCharacter*, TInlineAllocator<8>> Stale;
+    Board->ForEachUnit([this, &Stale](AUnitCharacter* Unit)
+    {
+        if (Unit->GetPreviewGrid() != this) return;
+        
+        bool bCrossesEdit = false;
+        Unit->GetPreviewPath().ForEachTile([this, &bCrossesEdit](int32 Index)
+        {
+            const int32 X = Index % GridWidth;
+            const int32 Y = Index / GridWidth;
+            bCrossesEdit = bCrossesEdit
+                || (X >= DirtyTerrainBounds.Min.X && X <= DirtyTerrainBounds.Max.X
+                    && Y >= DirtyTerrainBounds.Min.Y && Y <= DirtyTerrainBounds.Max.Y
+                    && DirtyTerrainTiles.Contains(Index));
+        });
+        if (bCrossesEdit)
+        {
+            Stale.Add(Unit);
+        }
+    });
+    
+    for (AUnitCharacter* Unit : Stale)
+    {
+        Unit->RefreshPreviewMove();
+    }
+}
+
+bool AGridManager::HasLineOfSight(AGridTile* From, AGridTile* To, int32 Range)
+{
+    if (!From || !To) return false;
+    return Visibility.HasLineOfSight(From->X, From->Y, To->X, To->Y, Range);
+}
+
+bool AGridManager::IsTileVisibleToTeam(int32 TeamId, AGridTile* Tile)
+{
+    if (!Tile) return false;
+    return Visibility.IsVisibleToTeam(TeamId, Tile->X, Tile->Y);
+}
+
+void AGridManager::SetTileBlocksSight(AGridTile* Tile, bool bBlocks)
+{
+    if (!Tile) return;
+    Tile->bBlocksSight = bBlocks;
+    
+    // Sight is ground-only
+    if (Tile->Layer != 0) return;
+    if (bStreamChunks)
+    {
+        ChunkStore.Set(Tile->X, Tile->Y, MakeTerrain(Tile));
+    }
+    BeginTerrainEdit();
+    Visibility.SetBlocksSightDeferred(Tile->X, Tile->Y, bBlocks);
+    MarkTerrainDirty(Tile->X, Tile->Y);
+    EndTerrainEdit();
+}
+
+void AGridManager::UpdateUnitVisibility(AUnitCharacter* Unit)
+{
+    if (!Unit || !Unit->CurrentTile) return;
+    Visibility.UpdateViewer(Unit->GetUniqueID(), Unit->TeamId, Unit->CurrentTile->X, Unit->CurrentTile->Y, Unit->SightRange);
+}
+
+void AGridManager::RemoveUnitVisibility(AUnitCharacter* Unit)
+{
+    if (!Unit) return;
+    Visibility.RemoveViewer(Unit->GetUniqueID());
+}
+
+void AGridManager::RebuildVisibility()
+{
+    Visibility.Init(GridWidth, GridHeight);
+    BumpBoardGeneration();
+    if (bStreamChunks)
+    {
+        SyncLoadedTilesToStore();
+        for (int32 Chunk = 0; Chunk < ChunkStore.NumChunks(); ++Chunk)
+        {
+            AddChunkToDerivedData(Chunk, false, true);
+        }
+    }
+    else
+    {
+        for (AGridTile* Tile : Tiles)
+        {
+            if (Tile && Tile->bBlocksSight)
+            {
+                Visibility.SetBlocksSight(Tile->X, Tile->Y, true);
+            }
+        }
+    }
+    
+    // Units keep their views across a rebuild
+    ForEachLoadedTile([this](AGridTile* Tile)
+    {
+        AUnitCharacter* Unit = Cast<AUnitCharacter>(Tile->Occupant);
+        if (Unit && Unit->CurrentTile == Tile)
+        {
+            UpdateUnitVisibility(Unit);
+        }
+    });
+}
+
+TArray<AGridTile*> AGridManager::GetTargetsInRange(AGridTile* Origin, int32 Range, int32 TeamId, ETargetFilter Filter) const
+{
+    TArray<AGridTile*> Targets;
+    if (!Origin) return Targets;
+    
+    const bool bEnemies = Filter == ETargetFilter::Enemies;
+    const bool bAllies = Filter == ETargetFilter::Allies;
+    Occupancy.ForEachUnitInRange(Origin->X, Origin->Y, Range, TeamId, bEnemies, bAllies, [this, &Targets](int32 X, int32 Y)
+    {
+        if (AGridTile* Tile = GetTileAt(X, Y))
+        {
+            Targets.Add(Tile);
+        }
+    });
+    return Targets;
+}
+
+bool AGridManager::IsUnitTargetInRange(AGridTile* Origin, AGridTile* Target, int32 Range) const
+{
+    if (!Origin || !Target) return false;
+    return Occupancy.IsUnitInRange(Origin->X, Origin->Y, Range, Target->X, Target->Y);
+}
+
+bool AGridManager::IsTileOccupied(AGridTile* Tile) const
+{
+    if (!Tile) return false;
+    return Tile->Occupant != nullptr || Occupancy.IsOccupied(Tile->X, Tile->Y);
+}
+
+void AGridManager::SetTileUnitOccupancy(AGridTile* Tile, int32 TeamId, bool bOccupied)
+{
+    if (!Tile || Tile->Occupant) return;
+    SetUnitOccupancyAt(Tile->X, Tile->Y, TeamId, bOccupied);
+}
+
+void AGridManager::SetUnitOccupancyAt(int32 X, int32 Y, int32 TeamId, bool bOccupied)
+{
+    if (X < 0 || X >= GridWidth || Y < 0 || Y >= GridHeight) return;
+    
+    // An actor standing on a loaded tile owns its occupancy
+    const AGridTile* Tile = GetTileAt(X, Y);
+    if (Tile && Tile->Occupant) return;
+    
+    const bool bWasOccupied = Occupancy.IsOccupied(X, Y);
+    if (bOccupied)
+    {
+        Occupancy.SetOccupied(X, Y, TeamId, true);
+    }
+    else
+    {
+        Occupancy.ClearTile(X, Y);
+    }
+    BumpBoardGeneration();
+    
+    // Data-only entities enter the state hash through the occupancy bit only
+    if (bWasOccupied != Occupancy.IsOccupied(X, Y))
+    {
+        StateHash ^= TBStateHash::Key(ETBStateField::Occupied, Y * GridWidth + X, 0);
+    }
+}
+
+uint32 AGridManager::GetTargetingVersion() const
+{
+    const UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this);
+    return Board ? Board->GetBoardGeneration() : 0;
+}
+
+void AGridManager::BumpBoardGeneration()
+{
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->BumpBoardGeneration();
+    }
+}
+
+void AGridManager::NotifyOccupantChanged(AGridTile* Tile, AActor* OldOccupant)
+{
+    if (!Tile) return;
+    
+    const int32 TileIndex = Tile->Y * GridWidth + Tile->X;
+    const bool bWasOccupied = Occupancy.IsOccupied(Tile->X, Tile->Y);
+    
+    // Units leave and enter the state hash with the tile they stand on
+    if (const AUnitCharacter* OldUnit = Cast<AUnitCharacter>(OldOccupant))
+    {
+        StateHash ^= OldUnit->GetStateHashContribution(TileIndex);
+    }
+    
+    if (!Tile->Occupant)
+    {
+        Occupancy.ClearTile(Tile->X, Tile->Y);
+    }
+    else
+    {
+        const AUnitCharacter* Unit = Cast<AUnitCharacter>(Tile->Occupant);
+        Occupancy.SetOccupied(Tile->X, Tile->Y, Unit ? Unit->TeamId : INDEX_NONE, Unit != nullptr);
+        if (Unit)
+        {
+            StateHash ^= Unit->GetStateHashContribution(TileIndex);
+        }
+    }
+    BumpBoardGeneration();
+    
+    if (bWasOccupied != Occupancy.IsOccupied(Tile->X, Tile->Y))
+    {
+        StateHash ^= TBStateHash::Key(ETBStateField::Occupied, TileIndex, 0);
+    }
+}
+
+uint64 AGridManager::ComputeStateHash() const
+{
+    uint64 Hash = 0;
+    for (int32 Y = 0; Y < GridHeight; ++Y)
+    {
+        for (int32 X = 0; X < GridWidth; ++X)
+        {
+            if (Occupancy.IsOccupied(X, Y))
+            {
+                Hash ^= TBStateHash::Key(ETBStateField::Occupied, Y * GridWidth + X, 0);
+            }
+        }
+    }
+    ForEachLoadedTile([this, &Hash](const AGridTile* Tile)
+    {
+        if (const AUnitCharacter* Unit = Cast<AUnitCharacter>(Tile->Occupant))
+        {
+            Hash ^= Unit->GetStateHashContribution(Tile->Y * GridWidth + Tile->X);
+        }
+    });
+    return Hash;
+}
+
+bool AGridManager::ValidateStateHash(const TCHAR* Context)
+{
+    // Mid-generation the bitboards and tiles are not in step yet
+    if (!bIsGridReady || !TBStateHash::IsValidationEnabled()) return true;
+    
+    const uint64 Recomputed = ComputeStateHash();
+    if (Recomputed == StateHash) return true;
+    
+    UE_LOG(LogTemp, Error, TEXT("State hash mismatch after %s on turn %d: incremental %016llx, recomputed %016llx"),
+        Context, TurnNumber, StateHash, Recomputed);
+    StateHash = Recomputed;
+    return false;
+}
+
+void AGridManager::RebuildOccupancy()
+{
+    Occupancy.Init(GridWidth, GridHeight);
+    BumpBoardGeneration();
+    StateHash = 0;
+    ForEachLoadedTile([this](AGridTile* Tile)
+    {
+        if (Tile->Occupant)
+        {
+            NotifyOccupantChanged(Tile);
+        }
+    });
+    
+    // Entities without a proxy have no tile actor to read back. Also picks up managers whose Grid was set after
+    // their BeginPlay.
+    EntityManagers.Reset();
+    if (UWorld* World = GetWorld())
+    {
+        for (TActorIterator<AUnitEntityManager> It(World); It; ++It)
+        {
+            if (It->Grid == this)
+            {
+                EntityManagers.Add(*It);
+                It->RestoreOccupancy();
+            }
+        }
+    }
+}
+
+void AGridManager::RegisterEntityManager(AUnitEntityManager* Manager)
+{
+    if (Manager)
+    {
+        EntityManagers.AddUnique(Manager);
+    }
+}
+
+void AGridManager::UnregisterEntityManager(AUnitEntityManager* Manager)
+{
+    EntityManagers.Remove(Manager);
+}
+
+namespace
+{
+    // Streamed ocean maps with scattered islands: everything the grid manager allocates after generation and a few
+    // searches, against what bounding-box path costs and search scratch alone would take
+    void RunStreamedGridMemoryBenchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        if (!World) return;
+
+        const int32 Sizes[] = { 256, 1024, 4096 };
+        constexpr int32 NumSearches = 8;
+        constexpr int32 SearchBudget = 65536;
+        const FTransform Hidden(FVector(0.0f, 0.0f, -10000.0f));
+
+        FGridTileTerrain Ocean;
+        Ocean.bIsWalkable = false;
+        FGridTileTerrain Land;
+        FGridTileTerrain Forest;
+        Forest.MovementCost = 2;
+        Forest.bBlocksSight = true;
+
+        for (int32 Size : Sizes)
+        {
+            AGridManager* Grid = World->SpawnActorDeferred<AGridManager>(AGridManager::StaticClass(), Hidden);
+            if (!Grid) continue;
+            Grid->TileClass = AGridTile::StaticClass();
+            Grid->GridWidth = Size;
+            Grid->GridHeight = Size;
+            Grid->bStreamChunks = true;
+            Grid->StreamRadiusChunks = 0;
+            Grid->DefaultTerrain = Ocean;
+            Grid->FinishSpawning(Hidden);
+            Grid->GenerateGrid();
+
+            // About 3% land, as in tb.Bench.GridChunks
+            FRandomStream Random(Size);
+            TArray<FIntPoint> IslandCenters;
+            const int32 NumIslands = FMath::Max(2, Size * Size / 40000);
+            Grid->BeginTerrainEdit();
+            for (int32 Island = 0; Island < NumIslands; ++Island)
+            {
+                const int32 CX = Random.RandRange(0, Size - 1);
+                const int32 CY = Random.RandRange(0, Size - 1);
+                const int32 Radius = Random.RandRange(8, 40);
+                IslandCenters.Add(FIntPoint(CX, CY));
+                for (int32 Y = FMath::Max(0, CY - Radius); Y <= FMath::Min(Size - 1, CY + Radius); ++Y)
+                {
+                    for (int32 X = FMath::Max(0, CX - Radius); X <= FMath::Min(Size - 1, CX + Radius); ++X)
+                    {
+                        if (FMath::Square(X - CX) + FMath::Square(Y - CY) > Radius * Radius) continue;
+                        Grid->SetTerrainAt(X, Y, Random.FRand() < 0.2f ? Forest : Land);
+                    }
+                }
+            }
+            Grid->EndTerrainEdit();
+
+            // Island to island: each search fills scratch over the island it starts on
+            FGridPath Path;
+            for (int32 Search = 0; Search < NumSearches && Search + 1 < IslandCenters.Num(); ++Search)
+            {
+                const FIntPoint& From = IslandCenters[Search];
+                const FIntPoint& To = IslandCenters[Search + 1];
+                Grid->GetPathfinder().FindPath(From.Y * Size + From.X, To.Y * Size + To.X, nullptr, Path, nullptr, SearchBudget);
+            }
+
+            const double MB = 1024.0 * 1024.0;
+            const FGridPathfinder& Pathfinder = Grid->GetPathfinder();
+            const double DenseMB = (double)(Size + 2) * (Size + 2) * (sizeof(int32) + 16) / MB;
+            UE_LOG(LogTemp, Display, TEXT("StreamedGrid %4dx%-4d: %8.2f MB total (terrain %.2f, path %.2f, scratch %.2f, occupancy %.2f, sight %.2f, overlay %.2f), dense path costs and scratch %8.2f MB"),
+                Size, Size, Grid->GetAllocatedSize() / MB, Grid->GetChunkStore().GetAllocatedSize() / MB,
+                Pathfinder.GetAllocatedSize() / MB, Pathfinder.GetScratchAllocatedSize() / MB, Grid->GetOccupancy().GetAllocatedSize() / MB,
+                Grid->GetVisibility().GetAllocatedSize() / MB, Grid->Overlay ? Grid->Overlay->GetAllocatedSize() / MB : 0.0, DenseMB);
+
+            // Streamed tile actors are owned by the grid but outlive it
+            for (TActorIterator<AGridTile> It(World); It; ++It)
+            {
+                if (It->GetOwner() == Grid) It->Destroy();
+            }
+            Grid->Destroy();
+        }
+    }
+
+    FAutoConsoleCommandWithWorldAndArgs StreamedGridMemoryBenchmarkCommand(
+        TEXT("tb.Bench.GridStreaming"),
+        TEXT("Total memory of streamed grid managers on mostly-ocean maps from 256x256 to 4096x4096"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunStreamedGridMemoryBenchmark));
+}
@@ -2,9 +2,85 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GridVisibility.h"
+#include "GridOccupancy.h"
+#include "GridPathfinding.h"
+#include "GridCooperativePlanner.h"
+#include "GridChunkStore.h"
+#include "GridRegions.h"
+#include "GridLayers.h"
 #include "AGridManager.generated.h"
 
 class AGridTile;
+class AUnitCharacter;
+class AUnitEntityManager;
+class UGridOverlayComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGridGenerationProgress, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnGridGenerated);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnGridTerrainChanged, FIntPoint, DirtyMin, FIntPoint, DirtyMax);
+
+// Stages of (possibly time-sliced) grid generation
+UENUM(BlueprintType)
+enum class EGridGenerationPhase : uint8
+{
+    Idle,
+    DestroyOld,
+    SpawnTiles,
+    AssignTerrain,
+    BuildDerivedData,
+    // One landmark Dijkstra per step, then the region labels
+    BuildLandmarks
+};
+
+// Which units a range query returns, relative to the querying team
+UENUM(BlueprintType)
+enum class ETargetFilter : uint8
+{
+    Enemies,
+    Allies,
+    Any
+};
+
+// Answer of AGridManager::AreTilesConnected
+UENUM(BlueprintType)
+enum class EGridConnection : uint8
+{
+    Connected,
+    NotConnected,
+    // Streamed grids only: the search ran out of ConnectionSearchBudget before settling it
+    Unknown
+};
+
+// Tile actors of one streamed-in chunk
+USTRUCT()
+struct FGridLoadedChunk
+{
+    GENERATED_BODY()
+
+    // FGridChunkStore::TilesPerChunk slots by local index; nullptr past the grid edge
+    UPROPERTY()
+    TArray<AGridTile*> Tiles;
+
+    // World time the chunk was last wanted by a streaming source or loaded on demand
+    double LastUsedTime = 0.0;
+};
+
+// One tile's new terrain in a batch edit
+USTRUCT(BlueprintType)
+struct FGridTerrainChange
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    int32 X = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    int32 Y = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    FGridTileTerrain Terrain;
+};
 
 UCLASS()
 class DENEME_API AGridManager : public AActor
@@ -25,47 +101,448 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
     float TileSize = 100.0f;
     
+    // Square 4-way, square 8-way (octile) or hex (odd-r rows); applied on generation
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    EGridConnectivity Connectivity = EGridConnectivity::Square4;
+    
+    // Seed for all gameplay rolls in this match (replicate/record it for replays and verification)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Match")
+    int64 MatchSeed = 0;
+    
+    // Current turn number, part of every roll's key
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Match")
+    int32 TurnNumber = 0;
+    
+    // Advance the turn counter (call once per turn, before units reset)
+    UFUNCTION(BlueprintCallable, Category = "Match")
+    void BeginNewTurn();
+    
     // Tile class to spawn
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
     TSubclassOf<AGridTile> TileClass;
     
-    // All tiles in the grid (2D array stored as 1D)
+    // All tiles in the grid (2D array stored as 1D). Empty when bStreamChunks is set; use GetTileAt / ForEachLoadedTile.
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid")
     TArray<AGridTile*> Tiles;
     
-    // Generate the grid at runtime
+    // World-scale maps: keep terrain in sparse 32x32 chunks and only spawn tile actors for chunks near units and the camera.
+    // Terrain comes from GenerateChunkTerrain instead of InitializeTileTerrain; tiles of unloaded chunks have no actor.
+    // Path costs, search scratch, occupancy and sight data are paged, so they only hold memory around walkable land,
+    // searched areas and units; there are no landmarks or region labels.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming")
+    bool bStreamChunks = false;
+    
+    // Terrain of every tile before GenerateChunkTerrain runs (e.g. ocean)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming")
+    FGridTileTerrain DefaultTerrain;
+    
+    // Chunks within this many chunks (Chebyshev) of a unit or the camera are kept loaded
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming", meta = (ClampMin = "0"))
+    int32 StreamRadiusChunks = 2;
+    
+    // Seconds a chunk stays loaded after nothing wants it any more (avoids churn at the edge of the radius)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming")
+    float ChunkKeepAliveSeconds = 5.0f;
+    
+    // The highlight overlay's mask covers this many chunks square around the camera instead of the whole map; it is
+    // re-centred (and cleared) when the camera gets within a chunk of its edge
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming", meta = (ClampMin = "1"))
+    int32 OverlayWindowChunks = 8;
+    
+    // Seconds between streaming updates
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming")
+    float StreamingUpdateInterval = 0.25f;
+    
+    // Game thread time per streaming update spent loading chunks (at least one chunk is loaded per update)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming", meta = (ClampMin = "0.1"))
+    float StreamingBudgetMs = 4.0f;
+    
+    // Hidden tile actors kept for reuse when chunks unload; the rest are destroyed
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Streaming")
+    int32 MaxPooledTiles = 4096;
+    
+    // Per-chunk terrain hook for streamed grids, called once per chunk during generation. Write terrain with SetTerrainAt.
+    UFUNCTION(BlueprintNativeEvent, Category = "Grid|Streaming")
+    void GenerateChunkTerrain(int32 ChunkX, int32 ChunkY);
+    
+    // Terrain of any tile, loaded or not
+    UFUNCTION(BlueprintCallable, Category = "Grid|Streaming")
+    FGridTileTerrain GetTerrainAt(int32 X, int32 Y) const;
+    
+    // Change terrain of any tile (usable from GenerateChunkTerrain); updates the tile actor and path/sight data if present
+    UFUNCTION(BlueprintCallable, Category = "Grid|Streaming")
+    void SetTerrainAt(int32 X, int32 Y, const FGridTileTerrain& Terrain);
+    
+    // GetTileAt, loading the tile's chunk first if needed (streamed grids)
+    UFUNCTION(BlueprintCallable, Category = "Grid|Streaming")
+    AGridTile* LoadTileAt(int32 X, int32 Y);
+    
+    // Load chunks around units and the camera and unload the ones nothing has wanted for ChunkKeepAliveSeconds
+    UFUNCTION(BlueprintCallable, Category = "Grid|Streaming")
+    void UpdateStreaming();
+    
+    UFUNCTION(BlueprintPure, Category = "Grid|Streaming")
+    int32 GetNumLoadedChunks() const { return LoadedChunks.Num(); }
+    
+    const FGridChunkStore& GetChunkStore() const { return ChunkStore; }
+    const TArray<AGridTile*>& GetTilePool() const { return TilePool; }
+    
+    // Bytes held by the grid's own data: terrain store, path costs and search scratch, sight, occupancy, regions,
+    // move planner, overlay mask and tile bookkeeping. Tile actors themselves are not counted.
+    SIZE_T GetAllocatedSize() const;
+    
+    // Calls Fn(AGridTile*) for every tile actor in the grid (all tiles, or those of loaded chunks when streaming)
+    template <typename FuncType>
+    void ForEachLoadedTile(FuncType&& Fn) const
+    {
+        for (AGridTile* Tile : Tiles)
+        {
+            if (Tile) Fn(Tile);
+        }
+        for (const TPair<int32, FGridLoadedChunk>& Pair : LoadedChunks)
+        {
+            for (AGridTile* Tile : Pair.Value.Tiles)
+            {
+                if (Tile) Fn(Tile);
+            }
+        }
+    }
+    
+    // Reachable/path/targetable/threat highlights, drawn by one material and uploaded once per frame
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid|Overlay")
+    UGridOverlayComponent* Overlay;
+    
+    // Spread generation across frames instead of doing it all in one call
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Generation")
+    bool bTimeSlicedGeneration = false;
+    
+    // Game thread time spent generating per frame when time-sliced
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Generation", meta = (ClampMin = "0.1"))
+    float GenerationBudgetMs = 4.0f;
+    
+    // Fired after each generation slice with progress in [0, 1]
+    UPROPERTY(BlueprintAssignable, Category = "Grid|Generation")
+    FOnGridGenerationProgress OnGenerationProgress;
+    
+    // Fired once the grid and all derived data are ready
+    UPROPERTY(BlueprintAssignable, Category = "Grid|Generation")
+    FOnGridGenerated OnGridGenerated;
+    
+    // Generate the grid at runtime (returns immediately when bTimeSlicedGeneration is set)
     UFUNCTION(BlueprintCallable, Category = "Grid")
     void GenerateGrid();
     
-    // Get tile at specific coordinates
+    // False while generation is in progress; GetTileAt and FindPath return nothing until then
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    bool IsGridReady() const { return bIsGridReady; }
+    
+    // Per-tile terrain hook, called once for every spawned tile during generation
+    UFUNCTION(BlueprintNativeEvent, Category = "Grid|Generation")
+    void InitializeTileTerrain(AGridTile* Tile);
+    
+    virtual void Tick(float DeltaSeconds) override;
+    
+    // Get tile at specific coordinates (nullptr for tiles of unloaded chunks when streaming)
     UFUNCTION(BlueprintCallable, Category = "Grid")
     AGridTile* GetTileAt(int32 X, int32 Y) const;
     
-    // Get neighboring tiles (up, down, left, right)
+    // World location of a tile's center, whether or not it has an actor
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    FVector GetTileLocation(int32 X, int32 Y) const;
+    
+    // Tile coordinates nearest to a world location (not clamped to the grid)
+    FIntPoint GetTileCoordsAt(const FVector& Location) const;
+    
+    // Get walkable neighboring tiles for the grid's connectivity
     UFUNCTION(BlueprintCallable, Category = "Grid")
     TArray<AGridTile*> GetNeighbors(AGridTile* Tile) const;
     
-    // Find path between two tiles using A* algorithm
+    // Tiles a unit on Origin can reach spending at most MaxCost movement (occupied tiles block)
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    TArray<AGridTile*> GetReachableTiles(AGridTile* Origin, int32 MaxCost) const;
+    
+    // Find path between two tiles using A* algorithm. On streamed grids the chunks the path crosses are loaded.
     UFUNCTION(BlueprintCallable, Category = "Grid")
     TArray<AGridTile*> FindPath(AGridTile* Start, AGridTile* End) const;
     
+    // FindPath into a caller-owned buffer (tile indices with cumulative cost); no allocation once OutPath has grown
+    bool FindGridPath(const AGridTile* Start, const AGridTile* End, FGridPath& OutPath) const;
+    
+    // Stacked layers on dense grids (ignored when streaming). Layer 0 is the generated ground; tiles placed with
+    // AGridTile::Layer 1..NumLayers-1 form the layers above, joined by AddLayerPortal. Layered queries ignore
+    // occupants, and occupancy and sight stay on the ground layer.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Layers", meta = (ClampMin = "1", ClampMax = "8"))
+    int32 NumLayers = 1;
+    
+    // Re-read ground costs, upper-layer tiles and portals and rebuild the portal graph. Runs after generation and
+    // RebuildNavigation; call it after placing layer tiles or portals, or after terrain edits layered queries should see.
+    UFUNCTION(BlueprintCallable, Category = "Grid|Layers")
+    void RebuildLayers();
+    
+    // Stairs, ladder or ramp from one tile to another (usually on different layers); used from the next RebuildLayers
+    UFUNCTION(BlueprintCallable, Category = "Grid|Layers")
+    void AddLayerPortal(AGridTile* From, AGridTile* To, int32 Cost = 1, bool bTwoWay = true);
+    
+    // Tile on any layer (GetTileAt for layer 0)
+    UFUNCTION(BlueprintPure, Category = "Grid|Layers")
+    AGridTile* GetLayerTileAt(int32 X, int32 Y, int32 Layer) const;
+    
+    // Cheapest path across layers, start to end; empty if there is none
+    UFUNCTION(BlueprintCallable, Category = "Grid|Layers")
+    TArray<AGridTile*> FindLayeredPath(AGridTile* Start, AGridTile* End) const;
+    
+    // Tiles on any layer reachable from Origin spending at most MaxCost movement
+    UFUNCTION(BlueprintCallable, Category = "Grid|Layers")
+    TArray<AGridTile*> GetLayeredReachableTiles(AGridTile* Origin, int32 MaxCost) const;
+    
+    const FGridLayers& GetLayers() const { return Layers; }
+    
+    // Plan moves for a batch of units at once (e.g. an AI team's turn): unit i heads for Goals[i] as far as its movement
+    // points allow, routed around the others so that no two share a tile at any step and confirming the moves in array
+    // order never finds a destination taken. OutPaths[i] is only the start tile (not IsMove) when unit i stays put,
+    // and empty when it is not on this grid.
+    void PlanUnitMoves(const TArray<AUnitCharacter*>& Units, const TArray<AGridTile*>& Goals, TArray<FGridPath>& OutPaths);
+    
+    const FGridCooperativePlanner& GetMovePlanner() const { return MovePlanner; }
+    
+    // Tile for an index Y * GridWidth + X (as used by FGridPath), or nullptr
+    AGridTile* GetTileByIndex(int32 Index) const { return GridWidth > 0 && Index >= 0 ? GetTileAt(Index % GridWidth, Index / GridWidth) : nullptr; }
+    
+    // Guide FindPath with landmark (ALT) distance bounds instead of plain Manhattan distance (applied on generation/RebuildNavigation)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Pathfinding")
+    bool bUseLandmarkHeuristic = true;
+    
+    // Landmarks chosen at generation; each costs 4 bytes per tile. Streamed grids use none (see bStreamChunks).
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Pathfinding", meta = (ClampMin = "0", ClampMax = "32"))
+    int32 NumLandmarks = 8;
+    
+    // Change walkability/cost of a tile at runtime; path data and landmark tables are updated locally
+    UFUNCTION(BlueprintCallable, Category = "Grid|Pathfinding")
+    void SetTileTerrain(AGridTile* Tile, bool bWalkable, int32 MovementCost);
+    
+    // Re-read bIsWalkable/MovementCost from every tile and re-pick landmarks (after editing tiles directly)
+    UFUNCTION(BlueprintCallable, Category = "Grid|Pathfinding")
+    void RebuildNavigation();
+    
+    const FGridPathfinder& GetPathfinder() const { return Pathfinder; }
+    
+    // Group terrain edits (collapsing bridges, floods, walls): SetTileTerrain, SetTerrainAt and SetTileBlocksSight
+    // change tiles right away, and landmark tables, regions and sight data are brought up to date once, when the
+    // outermost EndTerrainEdit closes the group. Calls nest; an edit outside a group is a group of its own.
+    UFUNCTION(BlueprintCallable, Category = "Grid|Terrain")
+    void BeginTerrainEdit();
+    
+    UFUNCTION(BlueprintCallable, Category = "Grid|Terrain")
+    void EndTerrainEdit();
+    
+    // SetTerrainAt for every change, as one group
+    UFUNCTION(BlueprintCallable, Category = "Grid|Terrain")
+    void ApplyTerrainChanges(const TArray<FGridTerrainChange>& Changes);
+    
+    // Fired once per group with the bounds of the tiles it changed (refresh cached paths, reachability and highlights)
+    UPROPERTY(BlueprintAssignable, Category = "Grid|Terrain")
+    FOnGridTerrainChanged OnTerrainChanged;
+    
+    // Whether any path joins two tiles on terrain alone (units ignored). O(1) from the region labels, where FindPath
+    // returns early when not. Streamed grids have no labels and search instead, giving up with Unknown after
+    // ConnectionSearchBudget tiles.
+    UFUNCTION(BlueprintCallable, Category = "Grid|Terrain")
+    EGridConnection AreTilesConnected(AGridTile* A, AGridTile* B) const;
+    
+    // Tiles AreTilesConnected may expand on a streamed grid before answering Unknown
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Terrain", meta = (ClampMin = "1"))
+    int32 ConnectionSearchBudget = 65536;
+    
+    // Connected walkable regions, current as of the last closed terrain edit group
+    const FGridRegions& GetRegions() const { return Regions; }
+    
     // Calculate Manhattan distance between two tiles
     UFUNCTION(BlueprintCallable, Category = "Grid")
     int32 GetManhattanDistance(AGridTile* A, AGridTile* B) const;
+    
+    // Line of sight within Range (Manhattan), blocked by tiles with bBlocksSight. Cached per origin tile.
+    UFUNCTION(BlueprintCallable, Category = "Visibility")
+    bool HasLineOfSight(AGridTile* From, AGridTile* To, int32 Range);
+    
+    // Fog of war: whether any unit of the team currently sees the tile
+    UFUNCTION(BlueprintCallable, Category = "Visibility")
+    bool IsTileVisibleToTeam(int32 TeamId, AGridTile* Tile);
+    
+    // Change a tile's sight blocking; only views whose radius covers the tile are recomputed
+    UFUNCTION(BlueprintCallable, Category = "Visibility")
+    void SetTileBlocksSight(AGridTile* Tile, bool bBlocks);
+    
+    // Register or refresh a unit's field of view (called when it commits to a tile)
+    UFUNCTION(BlueprintCallable, Category = "Visibility")
+    void UpdateUnitVisibility(AUnitCharacter* Unit);
+    
+    UFUNCTION(BlueprintCallable, Category = "Visibility")
+    void RemoveUnitVisibility(AUnitCharacter* Unit);
+    
+    // Re-read bBlocksSight from every tile (after editing tiles directly in Blueprint)
+    UFUNCTION(BlueprintCallable, Category = "Visibility")
+    void RebuildVisibility();
+    
+    FGridVisibility& GetVisibility() { return Visibility; }
+    
+    // Tiles holding units within Manhattan Range of Origin, filtered by team (bitboard query, no tile scan)
+    UFUNCTION(BlueprintCallable, Category = "Targeting")
+    TArray<AGridTile*> GetTargetsInRange(AGridTile* Origin, int32 Range, int32 TeamId, ETargetFilter Filter) const;
+    
+    // True if Target holds a unit and lies within Manhattan Range of Origin
+    UFUNCTION(BlueprintCallable, Category = "Targeting")
+    bool IsUnitTargetInRange(AGridTile* Origin, AGridTile* Target, int32 Range) const;
+    
+    // Occupied by an actor or by a data-only unit entity
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    bool IsTileOccupied(AGridTile* Tile) const;
+    
+    // Entity managers whose Grid is this grid. They register from BeginPlay; RebuildOccupancy re-reads the level.
+    const TArray<AUnitEntityManager*>& GetEntityManagers() const { return EntityManagers; }
+    void RegisterEntityManager(AUnitEntityManager* Manager);
+    void UnregisterEntityManager(AUnitEntityManager* Manager);
+    
+    // Occupancy for units without an actor on the tile (see AUnitEntityManager)
+    void SetTileUnitOccupancy(AGridTile* Tile, int32 TeamId, bool bOccupied);
+    
+    // Same by coordinates, for entities on tiles whose chunk is not loaded
+    void SetUnitOccupancyAt(int32 X, int32 Y, int32 TeamId, bool bOccupied);
+    
+    // Called by AGridTile::SetOccupant to refresh the occupancy bitboards and state hash for that tile
+    void NotifyOccupantChanged(AGridTile* Tile, AActor* OldOccupant = nullptr);
+    
+    // Re-read every tile's occupant, and every data-only entity of this grid, into the bitboards
+    UFUNCTION(BlueprintCallable, Category = "Targeting")
+    void RebuildOccupancy();
+    
+    const FGridOccupancy& GetOccupancy() const { return Occupancy; }
+    
+    // Changes whenever occupancy or sight blockers change; results of targeting queries can be cached against it.
+    // This is the board subsystem's generation counter, which the grid bumps on those changes.
+    uint32 GetTargetingVersion() const;
+    
+    // Zobrist hash of the battle state (occupied tiles, and tile, HP, MP/AP and casts left of every unit standing on a
+    // tile), kept up to date with O(1) XORs as that state changes. Equal on every machine in the same state.
+    uint64 GetStateHash() const { return StateHash; }
+    
+    // The same hash built from scratch
+    uint64 ComputeStateHash() const;
+    
+    // Apply a TBStateHash key delta for a change made outside the grid (unit stats)
+    void ToggleStateHash(uint64 Delta) { StateHash ^= Delta; }
+    
+    // With tb.StateHash.Validate set, compare against ComputeStateHash and log (then adopt) the recomputed hash
+    // on a mismatch. Returns false on a mismatch.
+    bool ValidateStateHash(const TCHAR* Context);
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     
 private:
-    // Helper for A* pathfinding
-    struct FPathNode
-    {
-        AGridTile* Tile;
-        FPathNode* Parent;
-        int32 GCost; // Distance from start
-        int32 HCost; // Heuristic distance to end
-        int32 FCost() const { return GCost + HCost; }
-        
-        FPathNode() : Tile(nullptr), Parent(nullptr), GCost(0), HCost(0) {}
-    };
+    // Run generation until done or until the time budget runs out
+    void StepGeneration(double BudgetSeconds);
+    
+    // Fold one tile's blockers/occupant into the visibility and occupancy data
+    void AddTileToDerivedData(AGridTile* Tile);
+    
+    // Streamed grids: write one chunk's stored terrain into the path costs and (optionally) sight blockers. A uniform
+    // chunk that is unwalkable and sees through (open ocean) matches the initial data and is skipped.
+    void AddChunkToDerivedData(int32 Chunk, bool bPathCosts, bool bSightBlockers);
+    
+    // Streamed grids: move the overlay window to the camera once it nears the window's edge
+    void UpdateOverlayWindow(const FIntPoint& CameraTile);
+    
+    // Spawn (or take from the pool) the actors of one chunk and give them their stored terrain. Const because tile
+    // actors only mirror ChunkStore, so queries such as FindPath may stream chunks in.
+    FGridLoadedChunk& LoadChunk(int32 Chunk) const;
+    
+    // Write the chunk's tile terrain back to the store and pool or destroy its actors
+    void UnloadChunk(int32 Chunk);
+    
+    void DestroyStreamedTiles();
+    
+    // Write terrain edited directly on loaded tile actors back to the store (streamed grids)
+    void SyncLoadedTilesToStore();
+    
+    // Size the visibility, occupancy, path and overlay data for the current grid
+    void InitDerivedData();
+    
+    // Landmark tables and region labels hold a few bytes for every tile of the bounding box, which world-scale streamed
+    // grids cannot afford: they search with the plain heuristic and no region early-out
+    int32 GetLandmarkCount() const;
+    void BuildRegions();
+    
+    // Record a tile changed by the open terrain edit group
+    void MarkTerrainDirty(int32 X, int32 Y);
+    
+    // Bring landmark tables, regions, sight data and move previews up to date with the closed group and notify listeners
+    void CommitTerrainEdit();
+    
+    // Re-search every move preview on this grid whose path crosses a tile of the closed group
+    void RefreshPreviewsOnDirtyTerrain();
+    
+    // Chunks loaded with their tile actors, by chunk index (see LoadChunk for why these are mutable)
+    UPROPERTY()
+    mutable TMap<int32, FGridLoadedChunk> LoadedChunks;
+    
+    // Hidden tile actors from unloaded chunks
+    UPROPERTY()
+    mutable TArray<AGridTile*> TilePool;
+    
+    UPROPERTY(Transient)
+    TArray<AUnitEntityManager*> EntityManagers;
+    
+    // Terrain of every tile when streaming
+    FGridChunkStore ChunkStore;
+    
+    float TimeSinceStreamingUpdate = 0.0f;
+    
+    bool bIsGridReady = false;
+    EGridGenerationPhase GenerationPhase = EGridGenerationPhase::Idle;
+    int32 GenerationCursor = 0;
+    int32 GenerationWorkDone = 0;
+    int32 GenerationWorkTotal = 0;
+    
+    // Line of sight cache and per-team visible sets
+    FGridVisibility Visibility;
+    
+    // Occupancy or sight blockers changed: bump the board generation that GetTargetingVersion reads
+    void BumpBoardGeneration();
+    
+    // Per-team occupancy bitboards mirroring AGridTile::Occupant
+    FGridOccupancy Occupancy;
+    
+    // See GetStateHash
+    uint64 StateHash = 0;
+    
+    // Terrain costs and landmark tables used by FindPath
+    FGridPathfinder Pathfinder;
+    
+    // Walkable regions over Pathfinder's costs
+    FGridRegions Regions;
+    
+    // Every layer's costs and the portal graph; empty unless NumLayers > 1 on a dense grid
+    FGridLayers Layers;
+    
+    // Upper-layer tiles by (X, Y, Layer); ground tiles are in Tiles
+    UPROPERTY(Transient)
+    TMap<FIntVector, AGridTile*> LayerTiles;
+    
+    // Portals from AddLayerPortal, re-added on every RebuildLayers
+    TArray<FGridPortal> LayerPortals;
+    
+    // Open terrain edit groups, and the tiles changed since the outermost one opened
+    int32 TerrainEditDepth = 0;
+    TArray<int32> DirtyTerrainTiles;
+    FIntRect DirtyTerrainBounds;
+    
+    // Batch move planning for PlanUnitMoves, with its request and result buffers
+    FGridCooperativePlanner MovePlanner;
+    TArray<FGridMoveRequest> MoveRequests;
+    TArray<FGridPlannedMove> PlannedMoves;
+    
+    static int32 GetTileNavCost(const AGridTile* Tile);
+    static int32 GetTerrainNavCost(const FGridTileTerrain& Terrain);
+    static FGridTileTerrain MakeTerrain(const AGridTile* Tile);
 };
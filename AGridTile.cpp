@@ -1,4 +1,6 @@
 #include "AGridTile.h"
+#include "AGridManager.h"
+#include "GameplayEventBus.h"
 #include "Components/SceneComponent.h"
 
 AGridTile::AGridTile()
@@ -25,3 +27,21 @@ bool AGridTile::IsAvailable() const
 {
     return bIsWalkable && (Occupant == nullptr);
 }
+
+void AGridTile::SetOccupant(AActor* NewOccupant)
+{
+    if (Occupant == NewOccupant) return;
+    AActor* OldOccupant = Occupant;
+    Occupant = NewOccupant;
+    
+    if (AGridManager* Grid = GetGridManager())
+    {
+        Grid->NotifyOccupantChanged(this, OldOccupant);
+    }
+    UGameplayEventBus::Post(this, EGameplayEventType::OccupancyChanged, this, OldOccupant ? 1 : 0, NewOccupant ? 1 : 0, NewOccupant);
+}
+
+AGridManager* AGridTile::GetGridManager() const
+{
+    return Cast<AGridManager>(GetOwner());
+}
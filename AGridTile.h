@@ -4,6 +4,8 @@
 #include "GameFramework/Actor.h"
 #include "AGridTile.generated.h"
 
+class AGridManager;
+
 UCLASS()
 class DENEME_API AGridTile : public AActor
 {
@@ -23,15 +25,25 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
     int32 Y = 0;
     
-    // Whether this tile is walkable
+    // Stacked layer the tile is on (0 = the generated ground). Bridges and upper floors are tiles placed by hand on
+    // higher layers; see AGridManager::NumLayers.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid", meta = (ClampMin = "0"))
+    int32 Layer = 0;
+    
+    // Whether this tile is walkable. Change at runtime via AGridManager::SetTileTerrain; pathfinding reads a snapshot,
+    // so direct writes are ignored until AGridManager::RebuildNavigation.
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
     bool bIsWalkable = true;
     
-    // Actor currently occupying this tile
+    // Whether this tile blocks line of sight (walls, pillars). Change at runtime via AGridManager::SetTileBlocksSight.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    bool bBlocksSight = false;
+    
+    // Actor currently occupying this tile (change it through SetOccupant)
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Grid")
     AActor* Occupant = nullptr;
     
-    // Cost to move into this tile (default 1)
+    // Cost to move into this tile (default 1). Same snapshot rule as bIsWalkable.
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
     int32 MovementCost = 1;
     
@@ -42,6 +54,14 @@ public:
     // Check if this tile is available (walkable and unoccupied)
     UFUNCTION(BlueprintCallable, Category = "Grid")
     bool IsAvailable() const;
+    
+    // Set the occupant and keep the grid manager's occupancy bitboards in sync
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void SetOccupant(AActor* NewOccupant);
+    
+    // Grid manager that spawned this tile (nullptr for hand-placed tiles)
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    AGridManager* GetGridManager() const;
 
 protected:
     virtual void BeginPlay() override;
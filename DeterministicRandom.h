@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Counter-based random numbers (Widynski's "Squares" generator).
+// A roll is a pure function of (match seed, turn, caster, ability, target, sequence), so it can be
+// computed on any thread, in any order, and reproduced bit-for-bit by replays and the server.
+// Integer math only; no floating point is involved in any roll.
+namespace DeterministicRandom
+{
+    // SplitMix64 finalizer, used to spread structured inputs over all 64 bits
+    FORCEINLINE uint64 Mix64(uint64 Value)
+    {
+        Value += 0x9E3779B97F4A7C15ull;
+        Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+        return Value ^ (Value >> 31);
+    }
+
+    // Squares needs a key with well-mixed, non-zero bits; derive one from the match seed
+    FORCEINLINE uint64 MakeKey(uint64 MatchSeed)
+    {
+        return Mix64(MatchSeed ^ 0x5851F42D4C957F2Dull) | 1ull;
+    }
+
+    // Pack the identity of a roll into the generator's counter
+    FORCEINLINE uint64 MakeCounter(int32 Turn, int32 CasterId, int32 AbilityId, int32 TargetId, int32 Sequence)
+    {
+        uint64 Counter = Mix64(((uint64)(uint32)Turn << 32) | (uint32)CasterId);
+        Counter = Mix64(Counter ^ (((uint64)(uint32)AbilityId << 32) | (uint32)Sequence));
+        return Mix64(Counter ^ (uint32)TargetId);
+    }
+
+    FORCEINLINE uint32 Squares32(uint64 Counter, uint64 Key)
+    {
+        uint64 X = Counter * Key;
+        const uint64 Y = X;
+        const uint64 Z = Y + Key;
+        X = X * X + Y; X = (X >> 32) | (X << 32);
+        X = X * X + Z; X = (X >> 32) | (X << 32);
+        X = X * X + Y; X = (X >> 32) | (X << 32);
+        return (uint32)((X * X + Z) >> 32);
+    }
+
+    // Uniform integer in [Min, Max] (inclusive) from a 32-bit draw, via multiply-shift
+    FORCEINLINE int32 ToRange(uint32 Draw, int32 Min, int32 Max)
+    {
+        if (Max <= Min) return Min;
+        const uint64 Span = (uint64)((int64)Max - (int64)Min + 1);
+        return (int32)((int64)Min + (int64)((Draw * Span) >> 32));
+    }
+
+    FORCEINLINE int32 RollRange(uint64 MatchSeed, int32 Turn, int32 CasterId, int32 AbilityId, int32 TargetId, int32 Sequence, int32 Min, int32 Max)
+    {
+        return ToRange(Squares32(MakeCounter(Turn, CasterId, AbilityId, TargetId, Sequence), MakeKey(MatchSeed)), Min, Max);
+    }
+}
@@ -0,0 +1,244 @@
+#include "GameplayEventBus.h"
+#include "GameplayEventBusBenchmark.h"
+#include "UnitCharacter.h"
+#include "TurnStatsComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+void FGameplayEventQueue::Post(EGameplayEventType Type, UObject* Subject, int32 OldValue, int32 NewValue, UObject* Related)
+{
+    // Deaths are never merged; everything else collapses per (subject, type)
+    if (Type != EGameplayEventType::Died)
+    {
+        const TPair<const UObject*, uint8> Key(Subject, (uint8)Type);
+        if (const int32* Existing = PendingIndex.Find(Key))
+        {
+            FGameplayEvent& Event = Pending[*Existing];
+            Event.NewValue = Type == EGameplayEventType::ModifiersChanged ? Event.NewValue | NewValue : NewValue;
+            Event.Related = Related;
+            return;
+        }
+        PendingIndex.Add(Key, Pending.Num());
+    }
+
+    FGameplayEvent& Event = Pending.AddDefaulted_GetRef();
+    Event.Type = Type;
+    Event.Subject = Subject;
+    Event.Related = Related;
+    Event.OldValue = OldValue;
+    Event.NewValue = NewValue;
+}
+
+void FGameplayEventQueue::Flush(TArray<FGameplayEvent>& OutDelivered)
+{
+    OutDelivered.Reset();
+    if (Pending.Num() == 0) return;
+
+    // Drop value changes that cancelled out within the frame (e.g. damage then heal), for the types that opted in.
+    // Whatever survives reaches listeners up to ~2 frames after the change: the bus flushes on its own tick (the next
+    // frame for changes posted after it ticked), and the HUD then defers its text rebuild to the following tick.
+    OutDelivered.Reserve(Pending.Num());
+    for (FGameplayEvent& Event : Pending)
+    {
+        if (!DropsUnchanged(Event.Type) || Event.OldValue != Event.NewValue)
+        {
+            OutDelivered.Add(MoveTemp(Event));
+        }
+    }
+
+    // Listeners may post again while we deliver; those go to the next flush
+    Pending.Reset();
+    PendingIndex.Reset();
+
+    // One batch per type, in posting order within the type
+    OutDelivered.StableSort([](const FGameplayEvent& A, const FGameplayEvent& B) { return A.Type < B.Type; });
+
+    int32 Start = 0;
+    while (Start < OutDelivered.Num())
+    {
+        const EGameplayEventType Type = OutDelivered[Start].Type;
+        int32 End = Start + 1;
+        while (End < OutDelivered.Num() && OutDelivered[End].Type == Type) ++End;
+
+        FOnGameplayEventBatch& Listeners = NativeListeners[(int32)Type];
+        if (Listeners.IsBound())
+        {
+            Listeners.Broadcast(TArrayView<const FGameplayEvent>(OutDelivered.GetData() + Start, End - Start));
+        }
+        Start = End;
+    }
+}
+
+void FGameplayEventQueue::SetDropUnchanged(EGameplayEventType Type, bool bDrop)
+{
+    const uint32 Bit = 1u << (uint32)Type;
+    DropUnchangedTypes = bDrop ? (DropUnchangedTypes | Bit) : (DropUnchangedTypes & ~Bit);
+}
+
+UGameplayEventBus* UGameplayEventBus::Get(const UObject* WorldContextObject)
+{
+    UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+    return World ? World->GetSubsystem<UGameplayEventBus>() : nullptr;
+}
+
+bool UGameplayEventBus::Post(const UObject* WorldContextObject, EGameplayEventType Type, UObject* Subject, int32 OldValue, int32 NewValue, UObject* Related)
+{
+    UGameplayEventBus* Bus = Get(WorldContextObject);
+    if (!Bus) return false;
+    Bus->Queue.Post(Type, Subject, OldValue, NewValue, Related);
+    return true;
+}
+
+FDelegateHandle UGameplayEventBus::AddNativeListener(EGameplayEventType Type, FOnGameplayEventBatch::FDelegate&& Delegate)
+{
+    return Queue.OnEvents(Type).Add(MoveTemp(Delegate));
+}
+
+void UGameplayEventBus::RemoveNativeListener(EGameplayEventType Type, FDelegateHandle Handle)
+{
+    Queue.OnEvents(Type).Remove(Handle);
+}
+
+void UGameplayEventBus::Tick(float DeltaTime)
+{
+    FlushEvents();
+}
+
+TStatId UGameplayEventBus::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayEventBus, STATGROUP_Tickables);
+}
+
+void UGameplayEventBus::FlushEvents()
+{
+    if (Queue.NumPending() == 0) return;
+
+    Queue.Flush(Delivered);
+    if (Delivered.Num() == 0) return;
+
+    if (OnGameplayEvents.IsBound())
+    {
+        OnGameplayEvents.Broadcast(Delivered);
+    }
+
+    // Per-actor delegates still fire for existing Blueprint/UI bindings, once per subject per frame
+    TSet<const UTurnStatsComponent*, DefaultKeyFuncs<const UTurnStatsComponent*>, TInlineSetAllocator<16>> StatsNotified;
+    for (const FGameplayEvent& Event : Delivered)
+    {
+        if (!IsValid(Event.Subject)) continue;
+
+        switch (Event.Type)
+        {
+        case EGameplayEventType::HPChanged:
+            if (AUnitCharacter* Unit = Cast<AUnitCharacter>(Event.Subject))
+            {
+                Unit->OnHPChanged.Broadcast(Event.NewValue);
+            }
+            break;
+
+        case EGameplayEventType::MovementPointsChanged:
+        case EGameplayEventType::ActionPointsChanged:
+        case EGameplayEventType::ModifiersChanged:
+            if (UTurnStatsComponent* Stats = Cast<UTurnStatsComponent>(Event.Subject))
+            {
+                bool bAlreadyNotified = false;
+                StatsNotified.Add(Stats, &bAlreadyNotified);
+                if (!bAlreadyNotified)
+                {
+                    Stats->OnStatsChanged.Broadcast();
+                }
+
+                // A new maximum changes the HP display even when HP itself stayed put
+                if (Event.Type == EGameplayEventType::ModifiersChanged && (Event.NewValue & (1 << (int32)ETBStat::MaxHP)))
+                {
+                    if (AUnitCharacter* Unit = Cast<AUnitCharacter>(Stats->GetOwner()))
+                    {
+                        Unit->OnHPChanged.Broadcast(Unit->HP);
+                    }
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+    Delivered.Reset();
+}
+
+namespace
+{
+    // Cost of one frame's worth of HP changes: reflective per-change broadcasts vs. one coalesced native batch
+    void RunEventBusBenchmark()
+    {
+        const int32 EventCounts[] = { 1, 100, 10000 };
+        constexpr int32 NumListeners = 4;
+        constexpr int32 NumFrames = 50;
+
+        TArray<UGameplayEventBenchmarkListener*> Listeners;
+        FOnHPChanged Reflective;
+        for (int32 Index = 0; Index < NumListeners; ++Index)
+        {
+            UGameplayEventBenchmarkListener* Listener = NewObject<UGameplayEventBenchmarkListener>();
+            Listener->AddToRoot();
+            Reflective.AddDynamic(Listener, &UGameplayEventBenchmarkListener::HandleHPChanged);
+            Listeners.Add(Listener);
+        }
+
+        // Subjects only serve as coalescing keys here
+        TArray<UObject*> Subjects;
+        for (int32 Index = 0; Index < 100; ++Index)
+        {
+            UObject* Subject = NewObject<UGameplayEventBenchmarkListener>();
+            Subject->AddToRoot();
+            Subjects.Add(Subject);
+        }
+
+        FGameplayEventQueue Queue;
+        TArray<FGameplayEvent> Delivered;
+        int64 NativeSum = 0;
+        for (int32 Index = 0; Index < NumListeners; ++Index)
+        {
+            Queue.OnEvents(EGameplayEventType::HPChanged).AddLambda([&NativeSum](TArrayView<const FGameplayEvent> Events)
+            {
+                for (const FGameplayEvent& Event : Events) NativeSum += Event.NewValue;
+            });
+        }
+
+        for (int32 EventCount : EventCounts)
+        {
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+            {
+                for (int32 Index = 0; Index < EventCount; ++Index)
+                {
+                    Reflective.Broadcast(Index);
+                }
+            }
+            const double ReflectiveUs = (FPlatformTime::Seconds() - StartTime) * 1.0e6 / NumFrames;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+            {
+                for (int32 Index = 0; Index < EventCount; ++Index)
+                {
+                    Queue.Post(EGameplayEventType::HPChanged, Subjects[Index % Subjects.Num()], 100, Index);
+                }
+                Queue.Flush(Delivered);
+            }
+            const double BusUs = (FPlatformTime::Seconds() - StartTime) * 1.0e6 / NumFrames;
+
+            UE_LOG(LogTemp, Display, TEXT("EventBus %5d events/frame, %d listeners: dynamic multicast %9.2f us, coalesced bus %9.2f us (%d delivered)"),
+                EventCount, NumListeners, ReflectiveUs, BusUs, Delivered.Num());
+        }
+
+        for (UGameplayEventBenchmarkListener* Listener : Listeners) Listener->RemoveFromRoot();
+        for (UObject* Subject : Subjects) Subject->RemoveFromRoot();
+    }
+
+    FAutoConsoleCommand EventBusBenchmarkCommand(
+        TEXT("tb.Bench.EventBus"),
+        TEXT("Compare dynamic multicast broadcasts with the coalescing event bus at 1, 100 and 10000 events per frame"),
+        FConsoleCommandDelegate::CreateStatic(&RunEventBusBenchmark));
+}
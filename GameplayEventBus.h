@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayEventBus.generated.h"
+
+UENUM(BlueprintType)
+enum class EGameplayEventType : uint8
+{
+    HPChanged,
+    Died,
+    MovementPointsChanged,
+    ActionPointsChanged,
+    OccupancyChanged,
+    ModifiersChanged,
+
+    Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct FGameplayEvent
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Events")
+    EGameplayEventType Type = EGameplayEventType::HPChanged;
+
+    // Unit for HP/death, UTurnStatsComponent for MP/AP/modifiers, AGridTile for occupancy
+    UPROPERTY(BlueprintReadOnly, Category = "Events")
+    UObject* Subject = nullptr;
+
+    // New occupant for OccupancyChanged
+    UPROPERTY(BlueprintReadOnly, Category = "Events")
+    UObject* Related = nullptr;
+
+    // Value before the first change this frame and after the last one. For ModifiersChanged, NewValue is the mask
+    // (1 << ETBStat) of every stat whose modifiers changed this frame.
+    UPROPERTY(BlueprintReadOnly, Category = "Events")
+    int32 OldValue = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Events")
+    int32 NewValue = 0;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnGameplayEventBatch, TArrayView<const FGameplayEvent> /*Events*/);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGameplayEvents, const TArray<FGameplayEvent>&, Events);
+
+// Coalescing event queue. Repeated events of one type for one subject collapse into a single
+// event (first OldValue, last NewValue), and flushing hands each native listener one batch per type.
+// Independent of any world so headless code and benchmarks can use it directly.
+USTRUCT()
+struct DENEME_API FGameplayEventQueue
+{
+    GENERATED_BODY()
+
+    void Post(EGameplayEventType Type, UObject* Subject, int32 OldValue, int32 NewValue, UObject* Related = nullptr);
+
+    // Deliver pending events to native listeners grouped by type; delivered events are moved to OutDelivered
+    void Flush(TArray<FGameplayEvent>& OutDelivered);
+
+    FOnGameplayEventBatch& OnEvents(EGameplayEventType Type) { return NativeListeners[(int32)Type]; }
+
+    // Whether Flush drops events of Type whose value ended where it started (e.g. damage then heal in one frame).
+    // On for HPChanged, MovementPointsChanged and ActionPointsChanged; a type whose listeners care about the event
+    // itself rather than the value must stay off.
+    void SetDropUnchanged(EGameplayEventType Type, bool bDrop);
+    bool DropsUnchanged(EGameplayEventType Type) const { return (DropUnchangedTypes & (1u << (uint32)Type)) != 0; }
+
+    int32 NumPending() const { return Pending.Num(); }
+
+private:
+    // UPROPERTY so a subject destroyed before the flush is nulled instead of dangling
+    UPROPERTY()
+    TArray<FGameplayEvent> Pending;
+
+    // (Subject, Type) -> index in Pending
+    TMap<TPair<const UObject*, uint8>, int32> PendingIndex;
+
+    FOnGameplayEventBatch NativeListeners[(int32)EGameplayEventType::Count];
+
+    // Bit per EGameplayEventType, see SetDropUnchanged
+    uint32 DropUnchangedTypes = (1u << (uint32)EGameplayEventType::HPChanged)
+        | (1u << (uint32)EGameplayEventType::MovementPointsChanged)
+        | (1u << (uint32)EGameplayEventType::ActionPointsChanged);
+};
+
+// Per-world gameplay event bus. Unit, stats and tile changes are posted here instead of broadcasting
+// immediately; once per frame the bus delivers coalesced batches to native listeners, one Blueprint
+// broadcast with the whole batch, and finally the per-actor OnHPChanged / OnStatsChanged delegates.
+UCLASS()
+class DENEME_API UGameplayEventBus : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UGameplayEventBus* Get(const UObject* WorldContextObject);
+
+    // Queue an event on the context's world bus. Returns false if there is no bus (caller should broadcast directly).
+    static bool Post(const UObject* WorldContextObject, EGameplayEventType Type, UObject* Subject, int32 OldValue, int32 NewValue, UObject* Related = nullptr);
+
+    // Native fast path: called with every coalesced event of Type once per frame
+    FDelegateHandle AddNativeListener(EGameplayEventType Type, FOnGameplayEventBatch::FDelegate&& Delegate);
+    void RemoveNativeListener(EGameplayEventType Type, FDelegateHandle Handle);
+
+    // See FGameplayEventQueue::SetDropUnchanged
+    void SetDropUnchanged(EGameplayEventType Type, bool bDrop) { Queue.SetDropUnchanged(Type, bDrop); }
+
+    // Blueprint path: one broadcast per frame with all events
+    UPROPERTY(BlueprintAssignable, Category = "Events")
+    FOnGameplayEvents OnGameplayEvents;
+
+    // Deliver pending events now instead of waiting for the end of the frame
+    UFUNCTION(BlueprintCallable, Category = "Events")
+    void FlushEvents();
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+private:
+    UPROPERTY()
+    FGameplayEventQueue Queue;
+
+    UPROPERTY()
+    TArray<FGameplayEvent> Delivered;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "GameplayEventBusBenchmark.generated.h"
+
+// Reflective listener used by the tb.Bench.EventBus microbenchmark (GameplayEventBus.cpp only)
+UCLASS()
+class UGameplayEventBenchmarkListener : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    UFUNCTION()
+    void HandleHPChanged(int32 NewHP) { Sum += NewHP; }
+
+    int64 Sum = 0;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Dense bitset over grid tile indices (Y * GridWidth + X), 64 tiles per word.
+struct FGridBitset
+{
+    TArray<uint64> Words;
+    int32 NumBits = 0;
+
+    void Init(int32 InNumBits)
+    {
+        NumBits = FMath::Max(0, InNumBits);
+        Words.Init(0, (NumBits + 63) / 64);
+    }
+
+    void Reset()
+    {
+        if (Words.Num()) FMemory::Memzero(Words.GetData(), Words.Num() * sizeof(uint64));
+    }
+
+    bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumBits; }
+
+    bool Test(int32 Index) const
+    {
+        return IsValidIndex(Index) && (Words[Index >> 6] & (1ull << (Index & 63))) != 0;
+    }
+
+    void Set(int32 Index)
+    {
+        if (IsValidIndex(Index)) Words[Index >> 6] |= (1ull << (Index & 63));
+    }
+
+    void Clear(int32 Index)
+    {
+        if (IsValidIndex(Index)) Words[Index >> 6] &= ~(1ull << (Index & 63));
+    }
+
+    void SetTo(int32 Index, bool bValue)
+    {
+        if (bValue) Set(Index);
+        else Clear(Index);
+    }
+
+    int32 CountSetBits() const
+    {
+        int32 Count = 0;
+        for (uint64 Word : Words) Count += FMath::CountBits(Word);
+        return Count;
+    }
+
+    // Calls Fn(Index) for every set bit, lowest index first
+    template <typename FuncType>
+    void ForEachSetBit(FuncType&& Fn) const
+    {
+        for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+        {
+            uint64 Word = Words[WordIndex];
+            while (Word)
+            {
+                const int32 Bit = (int32)FMath::CountTrailingZeros64(Word);
+                Fn(WordIndex * 64 + Bit);
+                Word &= Word - 1;
+            }
+        }
+    }
+};
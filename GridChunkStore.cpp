@@ -0,0 +1,155 @@
+#include "GridChunkStore.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+void FGridChunkStore::Init(int32 InWidth, int32 InHeight, const FGridTileTerrain& Fill)
+{
+    Width = FMath::Max(0, InWidth);
+    Height = FMath::Max(0, InHeight);
+    NumChunksX = FMath::DivideAndRoundUp(Width, ChunkSize);
+    NumChunksY = FMath::DivideAndRoundUp(Height, ChunkSize);
+
+    Chunks.Reset();
+    Chunks.SetNum(NumChunksX * NumChunksY);
+    for (FChunk& Chunk : Chunks)
+    {
+        Chunk.Uniform = Fill;
+    }
+}
+
+void FGridChunkStore::Set(int32 X, int32 Y, const FGridTileTerrain& Terrain)
+{
+    if (!IsValidTile(X, Y)) return;
+
+    FChunk& Chunk = Chunks[GetChunkIndex(X, Y)];
+    if (Chunk.Tiles.Num() == 0)
+    {
+        if (Chunk.Uniform == Terrain) return;
+        Chunk.Tiles.Init(Chunk.Uniform, TilesPerChunk);
+    }
+    Chunk.Tiles[GetLocalIndex(X, Y)] = Terrain;
+}
+
+void FGridChunkStore::FillChunk(int32 Chunk, const FGridTileTerrain& Terrain)
+{
+    if (!Chunks.IsValidIndex(Chunk)) return;
+    Chunks[Chunk].Uniform = Terrain;
+    Chunks[Chunk].Tiles.Empty();
+}
+
+bool FGridChunkStore::CompactChunk(int32 Chunk)
+{
+    if (!Chunks.IsValidIndex(Chunk)) return false;
+
+    FChunk& Data = Chunks[Chunk];
+    if (Data.Tiles.Num() == 0) return false;
+
+    // Only tiles inside the grid count; the padding of edge chunks is never read
+    const FIntPoint Coords = GetChunkCoords(Chunk);
+    const int32 MaxX = FMath::Min(ChunkSize, Width - Coords.X * ChunkSize);
+    const int32 MaxY = FMath::Min(ChunkSize, Height - Coords.Y * ChunkSize);
+    const FGridTileTerrain& First = Data.Tiles[0];
+    for (int32 LocalY = 0; LocalY < MaxY; ++LocalY)
+    {
+        for (int32 LocalX = 0; LocalX < MaxX; ++LocalX)
+        {
+            if (Data.Tiles[(LocalY << ChunkShift) | LocalX] != First) return false;
+        }
+    }
+
+    Data.Uniform = First;
+    Data.Tiles.Empty();
+    return true;
+}
+
+int32 FGridChunkStore::CompactAll()
+{
+    int32 NumFreed = 0;
+    for (int32 Chunk = 0; Chunk < Chunks.Num(); ++Chunk)
+    {
+        NumFreed += CompactChunk(Chunk) ? 1 : 0;
+    }
+    return NumFreed;
+}
+
+int32 FGridChunkStore::GetNumDetailedChunks() const
+{
+    int32 Count = 0;
+    for (const FChunk& Chunk : Chunks)
+    {
+        Count += Chunk.Tiles.Num() ? 1 : 0;
+    }
+    return Count;
+}
+
+SIZE_T FGridChunkStore::GetAllocatedSize() const
+{
+    SIZE_T Size = Chunks.GetAllocatedSize();
+    for (const FChunk& Chunk : Chunks)
+    {
+        Size += Chunk.Tiles.GetAllocatedSize();
+    }
+    return Size;
+}
+
+namespace
+{
+    // Overworld-style maps (ocean with scattered islands): chunked store vs one terrain struct and one tile pointer per tile
+    void RunChunkStoreBenchmark()
+    {
+        const int32 Sizes[] = { 256, 1024, 4096 };
+        constexpr int32 NumLookups = 1 << 22;
+
+        FGridTileTerrain Ocean;
+        Ocean.bIsWalkable = false;
+        FGridTileTerrain Land;
+        FGridTileTerrain Forest;
+        Forest.MovementCost = 2;
+        Forest.bBlocksSight = true;
+
+        for (int32 Size : Sizes)
+        {
+            FRandomStream Random(Size);
+            FGridChunkStore Store;
+            Store.Init(Size, Size, Ocean);
+
+            // About 3% land: round islands of radius 8-40 with forest patches
+            const int32 NumIslands = FMath::Max(1, Size * Size / 40000);
+            int64 LandTiles = 0;
+            for (int32 Island = 0; Island < NumIslands; ++Island)
+            {
+                const int32 CX = Random.RandRange(0, Size - 1);
+                const int32 CY = Random.RandRange(0, Size - 1);
+                const int32 Radius = Random.RandRange(8, 40);
+                for (int32 Y = FMath::Max(0, CY - Radius); Y <= FMath::Min(Size - 1, CY + Radius); ++Y)
+                {
+                    for (int32 X = FMath::Max(0, CX - Radius); X <= FMath::Min(Size - 1, CX + Radius); ++X)
+                    {
+                        if (FMath::Square(X - CX) + FMath::Square(Y - CY) > Radius * Radius) continue;
+                        LandTiles += Store.Get(X, Y).bIsWalkable ? 0 : 1;
+                        Store.Set(X, Y, Random.FRand() < 0.2f ? Forest : Land);
+                    }
+                }
+            }
+            Store.CompactAll();
+
+            const double StartTime = FPlatformTime::Seconds();
+            int64 Walkable = 0;
+            for (int32 Lookup = 0; Lookup < NumLookups; ++Lookup)
+            {
+                Walkable += Store.Get(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1)).bIsWalkable ? 1 : 0;
+            }
+            const double LookupNs = (FPlatformTime::Seconds() - StartTime) * 1.0e9 / NumLookups;
+
+            const double DenseMB = (double)Size * Size * (sizeof(FGridTileTerrain) + sizeof(void*)) / (1024.0 * 1024.0);
+            UE_LOG(LogTemp, Display, TEXT("ChunkStore %4dx%-4d: %5.1f%% land, %5d of %6d chunks detailed, %8.2f MB (dense %8.2f MB), %.1f ns per lookup (%lld walkable)"),
+                Size, Size, 100.0 * LandTiles / ((double)Size * Size), Store.GetNumDetailedChunks(), Store.NumChunks(),
+                Store.GetAllocatedSize() / (1024.0 * 1024.0), DenseMB, LookupNs, Walkable);
+        }
+    }
+
+    FAutoConsoleCommand ChunkStoreBenchmarkCommand(
+        TEXT("tb.Bench.GridChunks"),
+        TEXT("Memory and lookup cost of chunked sparse terrain on mostly-ocean maps from 256x256 to 4096x4096"),
+        FConsoleCommandDelegate::CreateStatic(&RunChunkStoreBenchmark));
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridChunkStore.generated.h"
+
+// Terrain of one tile as kept by FGridChunkStore (the data an AGridTile actor is built from)
+USTRUCT(BlueprintType)
+struct FGridTileTerrain
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    uint8 MovementCost = 1;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    bool bIsWalkable = true;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid")
+    bool bBlocksSight = false;
+
+    bool operator==(const FGridTileTerrain& Other) const
+    {
+        return MovementCost == Other.MovementCost && bIsWalkable == Other.bIsWalkable && bBlocksSight == Other.bBlocksSight;
+    }
+    bool operator!=(const FGridTileTerrain& Other) const { return !(*this == Other); }
+};
+
+// Terrain for maps too large to keep an actor (or even a struct) per tile. The grid is cut into
+// ChunkSize x ChunkSize chunks; a chunk whose tiles are all alike (open ocean, empty plains) stores that
+// one value, and only chunks with variation hold per-tile data. Memory follows the detailed area, not the bounding box.
+class DENEME_API FGridChunkStore
+{
+public:
+    static constexpr int32 ChunkShift = 5;
+    static constexpr int32 ChunkSize = 1 << ChunkShift;
+    static constexpr int32 TilesPerChunk = ChunkSize * ChunkSize;
+
+    // Every chunk starts uniform with Fill
+    void Init(int32 InWidth, int32 InHeight, const FGridTileTerrain& Fill);
+
+    int32 GetWidth() const { return Width; }
+    int32 GetHeight() const { return Height; }
+    int32 GetNumChunksX() const { return NumChunksX; }
+    int32 GetNumChunksY() const { return NumChunksY; }
+    int32 NumChunks() const { return Chunks.Num(); }
+
+    bool IsValidTile(int32 X, int32 Y) const { return X >= 0 && X < Width && Y >= 0 && Y < Height; }
+
+    // Chunk index (row-major over chunks) holding tile (X, Y)
+    int32 GetChunkIndex(int32 X, int32 Y) const { return (Y >> ChunkShift) * NumChunksX + (X >> ChunkShift); }
+    FIntPoint GetChunkCoords(int32 Chunk) const { return FIntPoint(Chunk % NumChunksX, Chunk / NumChunksX); }
+
+    // Index of (X, Y) within its chunk
+    static int32 GetLocalIndex(int32 X, int32 Y) { return ((Y & (ChunkSize - 1)) << ChunkShift) | (X & (ChunkSize - 1)); }
+
+    const FGridTileTerrain& Get(int32 X, int32 Y) const
+    {
+        const FChunk& Chunk = Chunks[GetChunkIndex(X, Y)];
+        return Chunk.Tiles.Num() ? Chunk.Tiles[GetLocalIndex(X, Y)] : Chunk.Uniform;
+    }
+
+    // Splits a uniform chunk into per-tile data on the first differing write
+    void Set(int32 X, int32 Y, const FGridTileTerrain& Terrain);
+
+    // Make a whole chunk uniform again
+    void FillChunk(int32 Chunk, const FGridTileTerrain& Terrain);
+
+    bool IsChunkUniform(int32 Chunk) const { return Chunks[Chunk].Tiles.Num() == 0; }
+
+    // Drop the per-tile data of a chunk whose tiles have all become equal; returns true if it did
+    bool CompactChunk(int32 Chunk);
+
+    // CompactChunk over every chunk; returns how many were freed
+    int32 CompactAll();
+
+    int32 GetNumDetailedChunks() const;
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    struct FChunk
+    {
+        // Terrain of every tile while Tiles is empty
+        FGridTileTerrain Uniform;
+
+        // TilesPerChunk entries (row-major within the chunk), or empty when uniform
+        TArray<FGridTileTerrain> Tiles;
+    };
+
+    int32 Width = 0;
+    int32 Height = 0;
+    int32 NumChunksX = 0;
+    int32 NumChunksY = 0;
+    TArray<FChunk> Chunks;
+};
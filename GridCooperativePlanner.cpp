@@ -0,0 +1,515 @@
+#include "GridCooperativePlanner.h"
+#include "GridOccupancy.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+    // Lowest F first; on ties the deeper node (higher G), then the earlier step
+    struct FCoopOpenLess
+    {
+        template <typename EntryType>
+        bool operator()(const EntryType& A, const EntryType& B) const
+        {
+            if (A.F != B.F) return A.F < B.F;
+            if (A.G != B.G) return A.G > B.G;
+            return A.Step < B.Step;
+        }
+    };
+}
+
+void FGridCooperativePlanner::ResetTileData(int32 NumTiles)
+{
+    if (TileStamp.Num() != NumTiles)
+    {
+        TileStamp.Init(0, NumTiles);
+        RestingAgent.SetNumUninitialized(NumTiles);
+        RestingFrom.SetNumUninitialized(NumTiles);
+        LastPassStep.SetNumUninitialized(NumTiles);
+        StartAgent.SetNumUninitialized(NumTiles);
+        Heuristic.SetNumUninitialized(NumTiles);
+        HeuristicStamp.Init(0, NumTiles);
+        PlanStamp = 0;
+        SearchStamp = 0;
+    }
+    if (++PlanStamp == 0)
+    {
+        TileStamp.Init(0, NumTiles);
+        PlanStamp = 1;
+    }
+}
+
+void FGridCooperativePlanner::TouchTile(int32 Tile)
+{
+    if (IsTouched(Tile)) return;
+    TileStamp[Tile] = PlanStamp;
+    RestingAgent[Tile] = INDEX_NONE;
+    RestingFrom[Tile] = MAX_int32;
+    LastPassStep[Tile] = INDEX_NONE;
+    StartAgent[Tile] = INDEX_NONE;
+}
+
+void FGridCooperativePlanner::Plan(const FGridPathfinder& Pathfinder, const FGridOccupancy* Occupancy, TArrayView<const FGridMoveRequest> Requests,
+    TArray<FGridPlannedMove>& OutMoves, FGridCooperativePlanStats* OutStats)
+{
+    const int32 NumTiles = Pathfinder.NumTiles();
+    Width = Pathfinder.GetWidth();
+    ResetTileData(NumTiles);
+    Reservations.Reset();
+
+    OutMoves.SetNum(Requests.Num());
+    FGridCooperativePlanStats Stats;
+
+    // Every unit holds its start until it has been planned
+    for (int32 Agent = 0; Agent < Requests.Num(); ++Agent)
+    {
+        const int32 Start = Requests[Agent].Start;
+        if (Start < 0 || Start >= NumTiles) continue;
+        TouchTile(Start);
+        StartAgent[Start] = Agent;
+        RestingAgent[Start] = Agent;
+        RestingFrom[Start] = 0;
+    }
+
+    for (int32 Agent = 0; Agent < Requests.Num(); ++Agent)
+    {
+        FGridPlannedMove& Move = OutMoves[Agent];
+        Move.Path.Reset();
+        Move.EnterSteps.Reset();
+        Move.NumWaits = 0;
+
+        const int32 Start = Requests[Agent].Start;
+        if (Start < 0 || Start >= NumTiles || StartAgent[Start] != Agent)
+        {
+            ++Stats.NumStayed;
+            continue;
+        }
+
+        Stats.NodesExpanded += PlanOne(Pathfinder, Occupancy, Agent, Requests[Agent], Move);
+        Stats.NumWaits += Move.NumWaits;
+        Stats.NumStayed += Move.Path.IsMove() ? 0 : 1;
+    }
+
+    if (OutStats)
+    {
+        *OutStats = Stats;
+    }
+}
+
+int32 FGridCooperativePlanner::PlanOne(const FGridPathfinder& Pathfinder, const FGridOccupancy* Occupancy, int32 Agent, const FGridMoveRequest& Request, FGridPlannedMove& Move)
+{
+    if (++SearchStamp == 0)
+    {
+        HeuristicStamp.Init(0, HeuristicStamp.Num());
+        SearchStamp = 1;
+    }
+    Nodes.Reset();
+    OpenHeap.Reset();
+
+    const int32 Start = Request.Start;
+    const int32 Goal = Request.Goal >= 0 && Request.Goal < Pathfinder.NumTiles() ? Request.Goal : Start;
+    const int32 MaxCost = FMath::Max(0, Request.MaxCost);
+
+    // Staying put is always allowed: nobody else may pass or stop on a start that has not been planned yet
+    const uint64 StartKey = MakeKey(Start, 0);
+    Nodes.Add(StartKey, FNode());
+    OpenHeap.HeapPush({ GetHeuristic(Pathfinder, Start, Goal), 0, 0, Start }, FCoopOpenLess());
+
+    uint64 BestKey = StartKey;
+    int32 BestH = GetHeuristic(Pathfinder, Start, Goal);
+    int32 BestG = 0;
+    int32 BestStep = 0;
+
+    int32 NumExpanded = 0;
+    while (OpenHeap.Num() > 0)
+    {
+        FOpenEntry Current;
+        OpenHeap.HeapPop(Current, FCoopOpenLess(), false);
+
+        const uint64 CurrentKey = MakeKey(Current.Tile, Current.Step);
+        FNode& CurrentNode = Nodes.FindChecked(CurrentKey);
+        if (CurrentNode.bClosed || CurrentNode.G != Current.G) continue;
+        CurrentNode.bClosed = true;
+        ++NumExpanded;
+
+        // The closest tile to the goal the unit can stop on; with a consistent heuristic the goal itself is
+        // popped with its cheapest cost first
+        if (CanRest(Agent, Current.Tile, Current.Step))
+        {
+            const int32 H = GetHeuristic(Pathfinder, Current.Tile, Goal);
+            if (H < BestH || (H == BestH && (Current.G < BestG || (Current.G == BestG && Current.Step < BestStep))))
+            {
+                BestKey = CurrentKey;
+                BestH = H;
+                BestG = Current.G;
+                BestStep = Current.Step;
+            }
+            if (Current.Tile == Goal) break;
+        }
+
+        if (Current.Step >= Window) continue;
+        const int32 NextStep = Current.Step + 1;
+
+        auto Push = [this, &Pathfinder, Goal, CurrentKey, NextStep](int32 Tile, int32 G)
+        {
+            const uint64 Key = MakeKey(Tile, NextStep);
+            FNode* Node = Nodes.Find(Key);
+            if (Node && (Node->bClosed || Node->G <= G)) return;
+            if (!Node) Node = &Nodes.Add(Key, FNode());
+            Node->G = G;
+            Node->ParentKey = CurrentKey;
+            OpenHeap.HeapPush({ G + GetHeuristic(Pathfinder, Tile, Goal), G, NextStep, Tile }, FCoopOpenLess());
+        };
+
+        // Wait a step (free: waiting spends no movement points)
+        if (CanEnter(Agent, Current.Tile, Current.Tile, NextStep))
+        {
+            Push(Current.Tile, Current.G);
+        }
+
+        Pathfinder.ForEachWalkableEdge(Current.Tile, [&](int32 Neighbor, int32 Weight)
+        {
+            const int32 NewG = Current.G + Weight;
+            if (NewG > MaxCost || IsStaticallyBlocked(Occupancy, Neighbor)) return;
+            if (!CanEnter(Agent, Current.Tile, Neighbor, NextStep)) return;
+            Push(Neighbor, NewG);
+        });
+    }
+
+    // Walk back from the chosen state; consecutive states on one tile are waits
+    TArray<uint64, TInlineAllocator<32>> States;
+    for (uint64 Key = BestKey; Key != MAX_uint64; Key = Nodes.FindChecked(Key).ParentKey)
+    {
+        States.Add(Key);
+    }
+
+    Move.Path.CostScale = Pathfinder.GetCostScale();
+    int32 PreviousTile = INDEX_NONE;
+    for (int32 Index = States.Num() - 1; Index >= 0; --Index)
+    {
+        const int32 Tile = (int32)(uint32)States[Index];
+        const int32 Step = (int32)(States[Index] >> 32);
+        if (Tile == PreviousTile)
+        {
+            ++Move.NumWaits;
+        }
+        else
+        {
+            Move.Path.Steps.Add({ Tile, Nodes.FindChecked(States[Index]).G });
+            Move.EnterSteps.Add(Step);
+            PreviousTile = Tile;
+        }
+
+        // Reserve the tile for this step
+        Reservations.Add(States[Index], Agent);
+        TouchTile(Tile);
+        LastPassStep[Tile] = FMath::Max(LastPassStep[Tile], Step);
+    }
+    if (!Move.Path.IsMove())
+    {
+        Move.NumWaits = 0;
+    }
+
+    // Park on the destination from arrival on
+    const int32 Destination = Move.Path.GetGoal();
+    if (Destination != Start && RestingAgent[Start] == Agent)
+    {
+        RestingAgent[Start] = INDEX_NONE;
+        RestingFrom[Start] = MAX_int32;
+    }
+    RestingAgent[Destination] = Agent;
+    RestingFrom[Destination] = BestStep;
+
+    return NumExpanded;
+}
+
+bool FGridCooperativePlanner::CanEnter(int32 Agent, int32 FromTile, int32 Tile, int32 Step) const
+{
+    const int32* Holder = Reservations.Find(MakeKey(Tile, Step));
+    if (Holder && *Holder != Agent) return false;
+
+    if (IsTouched(Tile) && RestingAgent[Tile] != INDEX_NONE && RestingAgent[Tile] != Agent && RestingFrom[Tile] <= Step) return false;
+
+    // No swapping places with a unit coming the other way
+    if (FromTile != Tile)
+    {
+        const int32* Oncoming = Reservations.Find(MakeKey(Tile, Step - 1));
+        if (Oncoming && *Oncoming != Agent)
+        {
+            const int32* OncomingNext = Reservations.Find(MakeKey(FromTile, Step));
+            if (OncomingNext && *OncomingNext == *Oncoming) return false;
+        }
+    }
+    return true;
+}
+
+bool FGridCooperativePlanner::CanRest(int32 Agent, int32 Tile, int32 Step) const
+{
+    if (!IsTouched(Tile)) return true;
+    if (RestingAgent[Tile] != INDEX_NONE && RestingAgent[Tile] != Agent) return false;
+
+    // Units planned earlier must be done passing through
+    return LastPassStep[Tile] < Step;
+}
+
+bool FGridCooperativePlanner::IsStaticallyBlocked(const FGridOccupancy* Occupancy, int32 Tile) const
+{
+    if (!Occupancy || !Occupancy->IsOccupied(Tile % Width, Tile / Width)) return false;
+    return !IsTouched(Tile) || StartAgent[Tile] == INDEX_NONE;
+}
+
+int32 FGridCooperativePlanner::GetHeuristic(const FGridPathfinder& Pathfinder, int32 Tile, int32 Goal)
+{
+    if (HeuristicStamp[Tile] != SearchStamp)
+    {
+        HeuristicStamp[Tile] = SearchStamp;
+        Heuristic[Tile] = Pathfinder.EstimateCost(Tile, Goal);
+    }
+    return Heuristic[Tile];
+}
+
+int32 FGridCooperativePlanner::CountConflicts(TArrayView<const FGridPlannedMove> Moves)
+{
+    int32 LastStep = 0;
+    for (const FGridPlannedMove& Move : Moves)
+    {
+        if (Move.EnterSteps.Num()) LastStep = FMath::Max(LastStep, Move.EnterSteps.Last());
+    }
+
+    TSet<uint64> Pairs;
+    auto AddPair = [&Pairs](int32 A, int32 B)
+    {
+        Pairs.Add(((uint64)FMath::Min(A, B) << 32) | (uint32)FMath::Max(A, B));
+    };
+
+    // Tile of each move at the previous and current step
+    TArray<int32> Cursor;
+    Cursor.Init(0, Moves.Num());
+    TMap<int32, int32> PreviousAt;
+    TMap<int32, int32> CurrentAt;
+    TArray<int32> PreviousTile;
+    PreviousTile.Init(INDEX_NONE, Moves.Num());
+    for (int32 Step = 0; Step <= LastStep; ++Step)
+    {
+        CurrentAt.Reset();
+        for (int32 MoveIndex = 0; MoveIndex < Moves.Num(); ++MoveIndex)
+        {
+            const FGridPlannedMove& Move = Moves[MoveIndex];
+            if (Move.Path.Num() == 0) continue;
+            int32& At = Cursor[MoveIndex];
+            while (At + 1 < Move.Path.Num() && Move.EnterSteps[At + 1] <= Step) ++At;
+            const int32 Tile = Move.Path.Steps[At].TileIndex;
+
+            if (const int32* Other = CurrentAt.Find(Tile))
+            {
+                AddPair(*Other, MoveIndex);
+            }
+            else
+            {
+                CurrentAt.Add(Tile, MoveIndex);
+            }
+
+            // Swapped with whoever stood here a step ago and now stands where this move came from
+            // (moves with a lower index are already at this step, so each swap is found once)
+            const int32 FromTile = PreviousTile[MoveIndex];
+            if (FromTile != INDEX_NONE && FromTile != Tile)
+            {
+                const int32* Other = PreviousAt.Find(Tile);
+                if (Other && *Other < MoveIndex && Moves[*Other].Path.Steps[Cursor[*Other]].TileIndex == FromTile)
+                {
+                    AddPair(*Other, MoveIndex);
+                }
+            }
+        }
+
+        for (int32 MoveIndex = 0; MoveIndex < Moves.Num(); ++MoveIndex)
+        {
+            if (Moves[MoveIndex].Path.Num())
+            {
+                PreviousTile[MoveIndex] = Moves[MoveIndex].Path.Steps[Cursor[MoveIndex]].TileIndex;
+            }
+        }
+        Swap(PreviousAt, CurrentAt);
+    }
+    return Pairs.Num();
+}
+
+SIZE_T FGridCooperativePlanner::GetAllocatedSize() const
+{
+    return Reservations.GetAllocatedSize() + TileStamp.GetAllocatedSize() + RestingAgent.GetAllocatedSize() + RestingFrom.GetAllocatedSize()
+        + LastPassStep.GetAllocatedSize() + StartAgent.GetAllocatedSize() + Heuristic.GetAllocatedSize() + HeuristicStamp.GetAllocatedSize()
+        + Nodes.GetAllocatedSize() + OpenHeap.GetAllocatedSize();
+}
+
+namespace
+{
+    constexpr int32 BenchSize = 128;
+
+    // Where a unit ends when it takes the prefix of Path it can pay for, backing off from tiles taken in Occupancy
+    int32 TruncatePath(FGridPath& Path, int32 MaxCost, const FGridOccupancy& Occupancy)
+    {
+        int32 Last = 0;
+        while (Last + 1 < Path.Num() && Path.Steps[Last + 1].CumulativeCost <= MaxCost) ++Last;
+        while (Last > 0 && Occupancy.IsOccupied(Path.Steps[Last].TileIndex % BenchSize, Path.Steps[Last].TileIndex / BenchSize)) --Last;
+        Path.Steps.SetNum(Last + 1, false);
+        return Path.GetGoal();
+    }
+
+    // Timed move for a path walked one tile per step from step 0
+    void ToTimedMove(const FGridPath& Path, int32 Start, FGridPlannedMove& OutMove)
+    {
+        OutMove.Path = Path;
+        if (OutMove.Path.Num() == 0) OutMove.Path.Steps.Add({ Start, 0 });
+        OutMove.EnterSteps.Reset();
+        for (int32 Index = 0; Index < OutMove.Path.Num(); ++Index) OutMove.EnterSteps.Add(Index);
+        OutMove.NumWaits = 0;
+    }
+
+    // Confirm moves in order the way ConfirmPlacement does: a destination found occupied is a failed confirm.
+    // Returns the number of failed confirms; failed moves stay on their start.
+    int32 ExecuteMoves(TArrayView<const FGridPlannedMove> Moves, FGridOccupancy& Occupancy, TArray<int32>& OutFailed)
+    {
+        OutFailed.Reset();
+        for (int32 Index = 0; Index < Moves.Num(); ++Index)
+        {
+            const FGridPath& Path = Moves[Index].Path;
+            if (!Path.IsMove()) continue;
+            const int32 Start = Path.GetStart();
+            const int32 Goal = Path.GetGoal();
+            if (Occupancy.IsOccupied(Goal % BenchSize, Goal / BenchSize))
+            {
+                OutFailed.Add(Index);
+                continue;
+            }
+            Occupancy.ClearTile(Start % BenchSize, Start / BenchSize);
+            Occupancy.SetOccupied(Goal % BenchSize, Goal / BenchSize, 0, true);
+        }
+        return OutFailed.Num();
+    }
+
+    // One team of 50 closes in on an enemy line through a cluttered field, all moves planned before any is confirmed:
+    // FindPath per unit against the starting board, then re-planning every failed confirm, versus one cooperative pass
+    void RunCooperativePlannerBenchmark()
+    {
+        constexpr int32 NumRounds = 50;
+        constexpr int32 NumUnits = 50;
+        constexpr int32 NumEnemies = 20;
+        constexpr int32 MovementPoints = 8;
+
+        FRandomStream Random(1234);
+        FGridPathfinder Nav;
+        Nav.Init(BenchSize, BenchSize);
+        for (int32 Index = 0; Index < BenchSize * BenchSize; ++Index)
+        {
+            const float Roll = Random.FRand();
+            Nav.SetTileCost(Index, Roll < 0.08f ? FGridPathfinder::Blocked : (Roll < 0.2f ? 2 : 1));
+        }
+        Nav.BuildLandmarks(8);
+
+        FGridCooperativePlanner Planner;
+        FGridPath Path;
+        TArray<FGridMoveRequest> Requests;
+        TArray<FGridPlannedMove> SequentialMoves;
+        TArray<FGridPlannedMove> CooperativeMoves;
+        TArray<int32> Failed;
+
+        double SequentialMs = 0.0;
+        double CooperativeMs = 0.0;
+        int64 SequentialFailures = 0;
+        int64 SequentialStillFailed = 0;
+        int64 SequentialCollisions = 0;
+        int64 CooperativeFailures = 0;
+        int64 CooperativeCollisions = 0;
+        int64 SequentialMoved = 0;
+        int64 CooperativeMoved = 0;
+        int64 NodesExpanded = 0;
+        int64 Waits = 0;
+
+        for (int32 Round = 0; Round < NumRounds; ++Round)
+        {
+            // Team in a 16x16 box on the left, enemies in a column 10-14 tiles to the right
+            FGridOccupancy Board;
+            Board.Init(BenchSize, BenchSize);
+            const int32 BoxX = Random.RandRange(4, BenchSize - 40);
+            const int32 BoxY = Random.RandRange(4, BenchSize - 24);
+            TArray<int32> Enemies;
+            while (Enemies.Num() < NumEnemies)
+            {
+                const int32 Tile = (BoxY + Random.RandRange(0, 15)) * BenchSize + BoxX + 26 + Random.RandRange(0, 4);
+                if (Nav.GetTileCost(Tile) < 0 || Board.IsOccupied(Tile % BenchSize, Tile / BenchSize)) continue;
+                Board.SetOccupied(Tile % BenchSize, Tile / BenchSize, 1, true);
+                Enemies.Add(Tile);
+            }
+            Requests.Reset();
+            while (Requests.Num() < NumUnits)
+            {
+                const int32 Tile = (BoxY + Random.RandRange(0, 15)) * BenchSize + BoxX + Random.RandRange(0, 15);
+                if (Nav.GetTileCost(Tile) < 0 || Board.IsOccupied(Tile % BenchSize, Tile / BenchSize)) continue;
+                Board.SetOccupied(Tile % BenchSize, Tile / BenchSize, 0, true);
+                Requests.Add({ Tile, Enemies[Random.RandHelper(NumEnemies)], MovementPoints * Nav.GetCostScale() });
+            }
+
+            // Sequential: every unit plans alone against the starting board, then confirms in order
+            SequentialMoves.SetNum(NumUnits);
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 Index = 0; Index < NumUnits; ++Index)
+            {
+                const FGridMoveRequest& Request = Requests[Index];
+                Path.Reset();
+                if (Nav.FindPath(Request.Start, Request.Goal, &Board, Path)) TruncatePath(Path, Request.MaxCost, Board);
+                ToTimedMove(Path, Request.Start, SequentialMoves[Index]);
+            }
+            SequentialMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+            SequentialCollisions += FGridCooperativePlanner::CountConflicts(SequentialMoves);
+
+            FGridOccupancy SequentialBoard = Board;
+            SequentialFailures += ExecuteMoves(SequentialMoves, SequentialBoard, Failed);
+
+            // Each failed confirm refunds and re-plans against the board as it is now
+            StartTime = FPlatformTime::Seconds();
+            for (int32 Index : Failed)
+            {
+                const FGridMoveRequest& Request = Requests[Index];
+                Path.Reset();
+                if (Nav.FindPath(Request.Start, Request.Goal, &SequentialBoard, Path)) TruncatePath(Path, Request.MaxCost, SequentialBoard);
+                ToTimedMove(Path, Request.Start, SequentialMoves[Index]);
+                const int32 Goal = SequentialMoves[Index].Path.GetGoal();
+                if (!SequentialMoves[Index].Path.IsMove() || SequentialBoard.IsOccupied(Goal % BenchSize, Goal / BenchSize))
+                {
+                    ++SequentialStillFailed;
+                    continue;
+                }
+                SequentialBoard.ClearTile(Request.Start % BenchSize, Request.Start / BenchSize);
+                SequentialBoard.SetOccupied(Goal % BenchSize, Goal / BenchSize, 0, true);
+            }
+            SequentialMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+            for (const FGridPlannedMove& Move : SequentialMoves) SequentialMoved += Move.Path.IsMove() ? 1 : 0;
+
+            // Cooperative: one pass, then the same in-order confirms
+            FGridCooperativePlanStats Stats;
+            StartTime = FPlatformTime::Seconds();
+            Planner.Plan(Nav, &Board, Requests, CooperativeMoves, &Stats);
+            CooperativeMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+            CooperativeCollisions += FGridCooperativePlanner::CountConflicts(CooperativeMoves);
+            NodesExpanded += Stats.NodesExpanded;
+            Waits += Stats.NumWaits;
+            CooperativeMoved += NumUnits - Stats.NumStayed;
+
+            FGridOccupancy CooperativeBoard = Board;
+            CooperativeFailures += ExecuteMoves(CooperativeMoves, CooperativeBoard, Failed);
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("CoopPlanner %d units x %d batches, %d MP, %dx%d:"), NumUnits, NumRounds, MovementPoints, BenchSize, BenchSize);
+        UE_LOG(LogTemp, Display, TEXT("    sequential FindPath: %.3f ms per batch, %.1f failed confirms (%.1f still failing after re-plan), %.1f colliding pairs in step-by-step playback, %.1f units moved"),
+            SequentialMs / NumRounds, (double)SequentialFailures / NumRounds, (double)SequentialStillFailed / NumRounds,
+            (double)SequentialCollisions / NumRounds, (double)SequentialMoved / NumRounds);
+        UE_LOG(LogTemp, Display, TEXT("    cooperative:         %.3f ms per batch, %.1f failed confirms, %.1f colliding pairs, %.1f units moved, %.1f waits, %lld nodes, %.1f KB scratch"),
+            CooperativeMs / NumRounds, (double)CooperativeFailures / NumRounds, (double)CooperativeCollisions / NumRounds,
+            (double)CooperativeMoved / NumRounds, (double)Waits / NumRounds, NodesExpanded / NumRounds, Planner.GetAllocatedSize() / 1024.0);
+    }
+
+    FAutoConsoleCommand CooperativePlannerBenchmarkCommand(
+        TEXT("tb.Bench.CoopPlanner"),
+        TEXT("Plan 50-unit batches with one cooperative pass vs FindPath per unit; reports time, failed confirms and collisions"),
+        FConsoleCommandDelegate::CreateStatic(&RunCooperativePlannerBenchmark));
+}
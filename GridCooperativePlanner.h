@@ -0,0 +1,124 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+
+class FGridOccupancy;
+
+// One unit's move: from Start toward Goal, spending at most MaxCost (search cost units, i.e. movement points times
+// FGridPathfinder::GetCostScale). A Goal that is out of reach or occupied is approached as closely as possible.
+struct FGridMoveRequest
+{
+    int32 Start = INDEX_NONE;
+    int32 Goal = INDEX_NONE;
+    int32 MaxCost = 0;
+};
+
+// Result for one request. Path holds the tiles walked (waits left out), so it can go straight to
+// AUnitCharacter::RequestPreviewMove; it is only the start tile when the unit stays. EnterSteps[i] is the move
+// step at which Path's i-th tile is entered, for animating the units of a batch together without overlaps.
+struct FGridPlannedMove
+{
+    FGridPath Path;
+    TArray<int32> EnterSteps;
+
+    // Move steps spent waiting for other units to pass
+    int32 NumWaits = 0;
+};
+
+struct FGridCooperativePlanStats
+{
+    int32 NodesExpanded = 0;
+    int32 NumWaits = 0;
+
+    // Units that end where they started
+    int32 NumStayed = 0;
+};
+
+// Plans the moves of a batch of units together (windowed cooperative A*, WHCA*). Units are planned one after another
+// in request order; each searches space-time states (tile, move step) and reserves the tiles it passes at each step
+// plus its destination from arrival on, and later units route around those reservations. Start tiles of units not
+// planned yet are treated as taken, so no unit ends on another's tile, no two units share a tile at a step and no
+// two swap places. Confirming the moves in request order therefore never finds a destination occupied.
+// Tiles occupied in the occupancy boards are impassable unless they are the start of a unit in the batch.
+class DENEME_API FGridCooperativePlanner
+{
+public:
+    // Move steps (tiles entered plus waits) searched per unit while reservations apply
+    int32 Window = 16;
+
+    // OutMoves receives one entry per request, in the same order
+    void Plan(const FGridPathfinder& Pathfinder, const FGridOccupancy* Occupancy, TArrayView<const FGridMoveRequest> Requests,
+        TArray<FGridPlannedMove>& OutMoves, FGridCooperativePlanStats* OutStats = nullptr);
+
+    // Pairs of moves that collide when played step by step (same tile at the same step, or swapping tiles), with
+    // every unit waiting on its start before its first step and staying on its last tile after its last step.
+    // Zero for Plan's output; used to compare against paths planned one unit at a time.
+    static int32 CountConflicts(TArrayView<const FGridPlannedMove> Moves);
+
+    // Bytes held by the reservation table and search scratch
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    struct FNode
+    {
+        int32 G = 0;
+        uint64 ParentKey = MAX_uint64;
+        bool bClosed = false;
+    };
+
+    struct FOpenEntry
+    {
+        int32 F;
+        int32 G;
+        int32 Step;
+        int32 Tile;
+    };
+
+    static uint64 MakeKey(int32 Tile, int32 Step) { return ((uint64)(uint32)Step << 32) | (uint32)Tile; }
+
+    // Search one request against the current reservations; fills Move and returns the number of nodes expanded
+    int32 PlanOne(const FGridPathfinder& Pathfinder, const FGridOccupancy* Occupancy, int32 Agent, const FGridMoveRequest& Request, FGridPlannedMove& Move);
+
+    // Whether Agent may enter Tile at Step coming from FromTile
+    bool CanEnter(int32 Agent, int32 FromTile, int32 Tile, int32 Step) const;
+
+    // Whether Agent may stop on Tile from Step on for the rest of the batch
+    bool CanRest(int32 Agent, int32 Tile, int32 Step) const;
+
+    // Blocked in the occupancy boards by something other than a unit of this batch
+    bool IsStaticallyBlocked(const FGridOccupancy* Occupancy, int32 Tile) const;
+
+    // Estimated cost from Tile to the current goal, cached per tile for the current request
+    int32 GetHeuristic(const FGridPathfinder& Pathfinder, int32 Tile, int32 Goal);
+
+    // Size the per-tile data and start a new plan stamp
+    void ResetTileData(int32 NumTiles);
+
+    // Give Tile its defaults for this plan if it has not been written yet
+    void TouchTile(int32 Tile);
+    bool IsTouched(int32 Tile) const { return TileStamp[Tile] == PlanStamp; }
+
+    int32 Width = 0;
+
+    // (tile, step) -> agent passing through it
+    TMap<uint64, int32> Reservations;
+
+    // Per tile, valid while TileStamp matches PlanStamp: agent parked on it (and from which step), the last step
+    // any planned agent passes through it, and the agent starting on it
+    TArray<uint32> TileStamp;
+    TArray<int32> RestingAgent;
+    TArray<int32> RestingFrom;
+    TArray<int32> LastPassStep;
+    TArray<int32> StartAgent;
+    uint32 PlanStamp = 0;
+
+    // Heuristic cache for the current request
+    TArray<int32> Heuristic;
+    TArray<uint32> HeuristicStamp;
+    uint32 SearchStamp = 0;
+
+    // Space-time search state of the current request, by MakeKey
+    TMap<uint64, FNode> Nodes;
+    TArray<FOpenEntry> OpenHeap;
+};
@@ -0,0 +1,522 @@
+#include "GridLayers.h"
+#include "Algo/Reverse.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+    struct FNodeEntry
+    {
+        int32 Cost;
+        int32 Node;
+    };
+
+    struct FNodeLess
+    {
+        bool operator()(const FNodeEntry& A, const FNodeEntry& B) const { return A.Cost < B.Cost; }
+    };
+}
+
+void FGridLayers::Init(int32 NumLayers, int32 InWidth, int32 InHeight, EGridConnectivity InConnectivity)
+{
+    Width = InWidth;
+    Height = InHeight;
+    Layers.Reset();
+    Layers.SetNum(FMath::Max(0, NumLayers));
+    for (FGridPathfinder& Layer : Layers)
+    {
+        Layer.Init(Width, Height, InConnectivity);
+    }
+
+    Portals.Reset();
+    Nodes.Reset();
+    Edges.Reset();
+    LayerNodes.Reset();
+    LayerNodes.SetNum(Layers.Num());
+    ReachCost.Reset();
+}
+
+int32 FGridLayers::AddPortal(const FGridPortal& Portal)
+{
+    return Portals.Add(Portal);
+}
+
+void FGridLayers::BuildPortalGraph()
+{
+    Nodes.Reset();
+    Edges.Reset();
+    LayerNodes.Reset();
+    LayerNodes.SetNum(Layers.Num());
+
+    // One node per distinct portal end
+    TMap<TPair<int32, int32>, int32> NodeOfTile;
+    auto FindOrAddNode = [this, &NodeOfTile](const FGridLayerTile& Tile)
+    {
+        if (const int32* Existing = NodeOfTile.Find(TPair<int32, int32>(Tile.Layer, Tile.TileIndex)))
+        {
+            return *Existing;
+        }
+        const int32 Node = Nodes.AddDefaulted();
+        Nodes[Node].Tile = Tile;
+        NodeOfTile.Add(TPair<int32, int32>(Tile.Layer, Tile.TileIndex), Node);
+        LayerNodes[Tile.Layer].Add(Node);
+        return Node;
+    };
+
+    const int32 Scale = GetCostScale();
+    TArray<FEdge> PortalEdges;
+    for (const FGridPortal& Portal : Portals)
+    {
+        if (!IsValidTile(Portal.From) || !IsValidTile(Portal.To)) continue;
+        if (Layers[Portal.From.Layer].GetTileCost(Portal.From.TileIndex) < 0 || Layers[Portal.To.Layer].GetTileCost(Portal.To.TileIndex) < 0) continue;
+
+        const int32 From = FindOrAddNode(Portal.From);
+        const int32 To = FindOrAddNode(Portal.To);
+        const int32 Cost = FMath::Max(0, Portal.Cost) * Scale;
+        PortalEdges.Add({ From, To, Cost, true });
+        if (Portal.bTwoWay)
+        {
+            PortalEdges.Add({ To, From, Cost, true });
+        }
+    }
+
+    for (FNode& Node : Nodes)
+    {
+        const FGridPathfinder& Layer = Layers[Node.Tile.Layer];
+        Layer.ComputeCostField(Node.Tile.TileIndex, false, Node.CostFrom);
+        Layer.ComputeCostField(Node.Tile.TileIndex, true, Node.CostTo);
+    }
+
+    // Edges grouped by source: walking to the other nodes of the layer, then the node's portals
+    PortalEdges.Sort([](const FEdge& A, const FEdge& B) { return A.From < B.From; });
+    int32 NextPortalEdge = 0;
+    for (int32 Node = 0; Node < Nodes.Num(); ++Node)
+    {
+        FNode& Source = Nodes[Node];
+        Source.FirstEdge = Edges.Num();
+        for (int32 Other : LayerNodes[Source.Tile.Layer])
+        {
+            const int32 Cost = Source.CostFrom[Nodes[Other].Tile.TileIndex];
+            if (Other != Node && Cost != MAX_int32)
+            {
+                Edges.Add({ Node, Other, Cost, false });
+            }
+        }
+        for (; NextPortalEdge < PortalEdges.Num() && PortalEdges[NextPortalEdge].From == Node; ++NextPortalEdge)
+        {
+            Edges.Add(PortalEdges[NextPortalEdge]);
+        }
+        Source.NumEdges = Edges.Num() - Source.FirstEdge;
+    }
+}
+
+void FGridLayers::SearchNodes(const FGridLayerTile& Start, const FGridLayerTile& Goal, int32 Limit, TArray<int32>& OutCost, TArray<int32>& OutParentEdge,
+    int32& InOutBestCost, int32& OutBestNode, FGridLayerPathStats* OutStats) const
+{
+    OutCost.Init(MAX_int32, Nodes.Num());
+    OutParentEdge.Init(INDEX_NONE, Nodes.Num());
+    OutBestNode = INDEX_NONE;
+    const bool bHasGoal = IsValidTile(Goal);
+
+    TArray<FNodeEntry, TInlineAllocator<64>> Heap;
+    for (int32 Node : LayerNodes[Start.Layer])
+    {
+        const int32 Cost = Nodes[Node].CostTo[Start.TileIndex];
+        if (Cost != MAX_int32 && Cost <= Limit)
+        {
+            OutCost[Node] = Cost;
+            Heap.HeapPush({ Cost, Node }, FNodeLess());
+        }
+    }
+
+    while (Heap.Num() > 0)
+    {
+        FNodeEntry Entry;
+        Heap.HeapPop(Entry, FNodeLess(), false);
+        if (Entry.Cost != OutCost[Entry.Node]) continue;
+        if (bHasGoal && Entry.Cost >= InOutBestCost) break;
+        if (OutStats) ++OutStats->NodesExpanded;
+
+        const FNode& Node = Nodes[Entry.Node];
+        if (bHasGoal && Node.Tile.Layer == Goal.Layer)
+        {
+            const int32 ToGoal = Node.CostFrom[Goal.TileIndex];
+            if (ToGoal != MAX_int32 && Entry.Cost + ToGoal < InOutBestCost)
+            {
+                InOutBestCost = Entry.Cost + ToGoal;
+                OutBestNode = Entry.Node;
+            }
+        }
+
+        for (int32 EdgeIndex = Node.FirstEdge; EdgeIndex < Node.FirstEdge + Node.NumEdges; ++EdgeIndex)
+        {
+            const FEdge& Edge = Edges[EdgeIndex];
+            if (Edge.Cost > Limit - Entry.Cost) continue;
+
+            const int32 Cost = Entry.Cost + Edge.Cost;
+            if (Cost < OutCost[Edge.To])
+            {
+                OutCost[Edge.To] = Cost;
+                OutParentEdge[Edge.To] = EdgeIndex;
+                Heap.HeapPush({ Cost, Edge.To }, FNodeLess());
+            }
+        }
+    }
+}
+
+bool FGridLayers::AppendLeg(int32 Layer, int32 From, int32 To, FGridLayerPath& OutPath, FGridLayerPathStats* OutStats) const
+{
+    if (From == To) return true;
+
+    if (OutStats) ++OutStats->LayerSearches;
+    if (!Layers[Layer].FindPath(From, To, nullptr, LegPath, Scratch)) return false;
+
+    const int32 BaseCost = OutPath.GetTotalCost();
+    for (int32 Step = 1; Step < LegPath.Num(); ++Step)
+    {
+        OutPath.Steps.Add({ FGridLayerTile(Layer, LegPath.Steps[Step].TileIndex), BaseCost + LegPath.Steps[Step].CumulativeCost });
+    }
+    return true;
+}
+
+bool FGridLayers::FindPath(const FGridLayerTile& Start, const FGridLayerTile& Goal, FGridLayerPath& OutPath, FGridLayerPathStats* OutStats) const
+{
+    OutPath.Reset();
+    if (OutStats) *OutStats = FGridLayerPathStats();
+    if (!IsValidTile(Start) || !IsValidTile(Goal) || Start == Goal) return false;
+
+    // Staying on one layer is the bound any route through portals has to beat
+    int32 BestCost = MAX_int32;
+    bool bDirect = false;
+    if (Start.Layer == Goal.Layer)
+    {
+        if (OutStats) ++OutStats->LayerSearches;
+        bDirect = Layers[Start.Layer].FindPath(Start.TileIndex, Goal.TileIndex, nullptr, LegPath, Scratch);
+        if (bDirect) BestCost = LegPath.GetTotalCost();
+    }
+
+    int32 LastNode = INDEX_NONE;
+    SearchNodes(Start, Goal, MAX_int32, NodeCost, NodeParentEdge, BestCost, LastNode, OutStats);
+
+    OutPath.CostScale = GetCostScale();
+    if (LastNode == INDEX_NONE)
+    {
+        if (!bDirect) return false;
+        for (const FGridPathStep& Step : LegPath.Steps)
+        {
+            OutPath.Steps.Add({ FGridLayerTile(Start.Layer, Step.TileIndex), Step.CumulativeCost });
+        }
+        return true;
+    }
+
+    // Edges from the first node to the last, then one A* per walked leg
+    TArray<int32, TInlineAllocator<16>> Chain;
+    int32 FirstNode = LastNode;
+    for (int32 Edge = NodeParentEdge[LastNode]; Edge != INDEX_NONE; Edge = NodeParentEdge[Edges[Edge].From])
+    {
+        Chain.Add(Edge);
+        FirstNode = Edges[Edge].From;
+    }
+    Algo::Reverse(Chain);
+
+    OutPath.Steps.Add({ Start, 0 });
+    bool bFound = AppendLeg(Start.Layer, Start.TileIndex, Nodes[FirstNode].Tile.TileIndex, OutPath, OutStats);
+    FGridLayerTile Current = Nodes[FirstNode].Tile;
+    for (int32 Index = 0; bFound && Index < Chain.Num(); ++Index)
+    {
+        const FEdge& Edge = Edges[Chain[Index]];
+        const FGridLayerTile& Next = Nodes[Edge.To].Tile;
+        if (Edge.bPortal)
+        {
+            OutPath.Steps.Add({ Next, OutPath.GetTotalCost() + Edge.Cost });
+        }
+        else
+        {
+            bFound = AppendLeg(Current.Layer, Current.TileIndex, Next.TileIndex, OutPath, OutStats);
+        }
+        Current = Next;
+    }
+    bFound = bFound && AppendLeg(Goal.Layer, Current.TileIndex, Goal.TileIndex, OutPath, OutStats);
+
+    // The cost fields and the legs search the same terrain, so a leg only fails if layers were edited without a rebuild
+    if (!bFound)
+    {
+        OutPath.Reset();
+        return false;
+    }
+    return true;
+}
+
+void FGridLayers::GetReachableTiles(const FGridLayerTile& Start, int32 MaxCost, TArray<FGridLayerTile>& OutTiles, TArray<int32>* OutCosts) const
+{
+    OutTiles.Reset();
+    if (OutCosts) OutCosts->Reset();
+    if (!IsValidTile(Start) || MaxCost < 0) return;
+
+    const int32 Scale = GetCostScale();
+    // Kept below MAX_int32, which marks unreached tiles and nodes
+    const int32 Budget = (int32)FMath::Min<int64>((int64)MaxCost * Scale, MAX_int32 - 1);
+    const int32 NumTiles = Width * Height;
+    if (ReachCost.Num() != Layers.Num() * NumTiles)
+    {
+        ReachCost.Init(MAX_int32, Layers.Num() * NumTiles);
+    }
+
+    int32 NoBest = MAX_int32;
+    int32 NoBestNode = INDEX_NONE;
+    SearchNodes(Start, FGridLayerTile(), Budget, NodeCost, NodeParentEdge, NoBest, NoBestNode, nullptr);
+
+    // The last layer change of any path is a portal crossing, so flooding each layer from the start and from every
+    // portal exit reached within budget (with what is left of it) and keeping the cheapest cost per tile covers it
+    ReachTouched.Reset();
+    auto Flood = [&](const FGridLayerTile& Source, int32 SourceCost)
+    {
+        const int32 Offset = Source.Layer * NumTiles;
+        if (SourceCost < ReachCost[Offset + Source.TileIndex])
+        {
+            if (ReachCost[Offset + Source.TileIndex] == MAX_int32) ReachTouched.Add(Offset + Source.TileIndex);
+            ReachCost[Offset + Source.TileIndex] = SourceCost;
+        }
+
+        Layers[Source.Layer].GetReachableTiles(Source.TileIndex, FMath::DivideAndRoundUp(Budget - SourceCost, Scale), nullptr, LayerTiles, Scratch, &LayerCosts);
+        for (int32 Index = 0; Index < LayerTiles.Num(); ++Index)
+        {
+            const int32 Cost = SourceCost + LayerCosts[Index];
+            int32& Best = ReachCost[Offset + LayerTiles[Index]];
+            if (Cost <= Budget && Cost < Best)
+            {
+                if (Best == MAX_int32) ReachTouched.Add(Offset + LayerTiles[Index]);
+                Best = Cost;
+            }
+        }
+    };
+
+    Flood(Start, 0);
+    for (int32 Node = 0; Node < Nodes.Num(); ++Node)
+    {
+        const int32 ParentEdge = NodeParentEdge[Node];
+        if (NodeCost[Node] <= Budget && ParentEdge != INDEX_NONE && Edges[ParentEdge].bPortal)
+        {
+            Flood(Nodes[Node].Tile, NodeCost[Node]);
+        }
+    }
+
+    const int32 StartIndex = Start.Layer * NumTiles + Start.TileIndex;
+    for (int32 Index : ReachTouched)
+    {
+        if (Index != StartIndex)
+        {
+            OutTiles.Add(FGridLayerTile(Index / NumTiles, Index % NumTiles));
+            if (OutCosts) OutCosts->Add(ReachCost[Index]);
+        }
+        ReachCost[Index] = MAX_int32;
+    }
+}
+
+SIZE_T FGridLayers::GetAllocatedSize() const
+{
+    SIZE_T Size = Layers.GetAllocatedSize() + Portals.GetAllocatedSize() + Nodes.GetAllocatedSize() + Edges.GetAllocatedSize()
+        + LayerNodes.GetAllocatedSize() + Scratch.GetAllocatedSize() + LegPath.Steps.GetAllocatedSize()
+        + NodeCost.GetAllocatedSize() + NodeParentEdge.GetAllocatedSize() + ReachCost.GetAllocatedSize() + ReachTouched.GetAllocatedSize()
+        + LayerTiles.GetAllocatedSize() + LayerCosts.GetAllocatedSize();
+    for (const FGridPathfinder& Layer : Layers)
+    {
+        Size += Layer.GetAllocatedSize() + Layer.GetScratchAllocatedSize();
+    }
+    for (const FNode& Node : Nodes)
+    {
+        Size += Node.CostFrom.GetAllocatedSize() + Node.CostTo.GetAllocatedSize();
+    }
+    for (const TArray<int32>& Layer : LayerNodes)
+    {
+        Size += Layer.GetAllocatedSize();
+    }
+    return Size;
+}
+
+namespace
+{
+    constexpr int32 BenchLayers = 4;
+    constexpr int32 BenchSize = 128;
+    constexpr int32 StairsPerFloor = 8;
+
+    // Four floors of mixed terrain joined by stairs at matching positions, each floor to the next
+    void BuildBenchLayers(FGridLayers& Grid, FRandomStream& Random)
+    {
+        Grid.Init(BenchLayers, BenchSize, BenchSize);
+        for (int32 Layer = 0; Layer < BenchLayers; ++Layer)
+        {
+            FGridPathfinder& Nav = Grid.GetLayer(Layer);
+            for (int32 Index = 0; Index < Nav.NumTiles(); ++Index)
+            {
+                Nav.SetTileCost(Index, Random.FRand() < 0.1f ? FGridPathfinder::Blocked : 1 + Random.RandHelper(3));
+            }
+            // A wall splits every floor in two, so many routes have to go up or down and back
+            const int32 WallX = BenchSize / 2 + Random.RandRange(-BenchSize / 4, BenchSize / 4);
+            for (int32 Y = 0; Y < BenchSize; ++Y)
+            {
+                Nav.SetTileCost(Y * BenchSize + WallX, FGridPathfinder::Blocked);
+            }
+        }
+
+        for (int32 Layer = 0; Layer + 1 < BenchLayers; ++Layer)
+        {
+            for (int32 Stair = 0; Stair < StairsPerFloor; ++Stair)
+            {
+                int32 Tile;
+                do
+                {
+                    Tile = Random.RandHelper(BenchSize * BenchSize);
+                } while (Grid.GetLayer(Layer).GetTileCost(Tile) < 0 || Grid.GetLayer(Layer + 1).GetTileCost(Tile) < 0);
+
+                FGridPortal Portal;
+                Portal.From = FGridLayerTile(Layer, Tile);
+                Portal.To = FGridLayerTile(Layer + 1, Tile);
+                Portal.Cost = 2;
+                Grid.AddPortal(Portal);
+            }
+        }
+        for (int32 Layer = 0; Layer < BenchLayers; ++Layer)
+        {
+            Grid.GetLayer(Layer).BuildLandmarks(8);
+        }
+    }
+
+    // The search the portal graph replaces: A* over every tile of every layer at once, portals as extra edges, with
+    // the grid distance as heuristic (admissible here: stairs keep their position and tiles cost at least 1). Without
+    // a goal it is a Dijkstra bounded by Budget. Returns the goal's cost (or the number of tiles reached).
+    int32 SearchAllLayers(const FGridLayers& Grid, const TMultiMap<int32, TPair<int32, int32>>& Links, int32 Start, int32 Goal, int32 Budget)
+    {
+        const int32 NumTiles = BenchSize * BenchSize;
+        TArray<int32> Cost;
+        Cost.Init(MAX_int32, BenchLayers * NumTiles);
+        TArray<FNodeEntry> Open;
+
+        auto Estimate = [Goal, NumTiles](int32 Index)
+        {
+            if (Goal == INDEX_NONE) return 0;
+            const int32 Tile = Index % NumTiles;
+            const int32 GoalTile = Goal % NumTiles;
+            return FMath::Abs(Tile % BenchSize - GoalTile % BenchSize) + FMath::Abs(Tile / BenchSize - GoalTile / BenchSize);
+        };
+        auto Relax = [&](int32 Next, int32 NextCost)
+        {
+            if (NextCost <= Budget && NextCost < Cost[Next])
+            {
+                Cost[Next] = NextCost;
+                Open.HeapPush({ NextCost + Estimate(Next), Next }, FNodeLess());
+            }
+        };
+
+        int32 Reached = 0;
+        Cost[Start] = 0;
+        Open.HeapPush({ Estimate(Start), Start }, FNodeLess());
+        while (Open.Num() > 0)
+        {
+            FNodeEntry Entry;
+            Open.HeapPop(Entry, FNodeLess(), false);
+            const int32 Current = Entry.Node;
+            if (Entry.Cost != Cost[Current] + Estimate(Current)) continue;
+            if (Current == Goal) return Cost[Current];
+            ++Reached;
+
+            const int32 Layer = Current / NumTiles;
+            Grid.GetLayer(Layer).ForEachWalkableEdge(Current % NumTiles, [&](int32 Neighbor, int32 Weight)
+            {
+                Relax(Layer * NumTiles + Neighbor, Cost[Current] + Weight);
+            });
+            for (auto It = Links.CreateConstKeyIterator(Current); It; ++It)
+            {
+                Relax(It.Value().Key, Cost[Current] + It.Value().Value);
+            }
+        }
+        return Goal == INDEX_NONE ? Reached - 1 : MAX_int32;
+    }
+
+    void RunLayeredPathBenchmark()
+    {
+        constexpr int32 NumQueries = 200;
+        constexpr int32 ReachCost = 25;
+
+        FRandomStream Random(2024);
+        FGridLayers Grid;
+        BuildBenchLayers(Grid, Random);
+
+        double StartTime = FPlatformTime::Seconds();
+        Grid.BuildPortalGraph();
+        const double BuildMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+        // Portals as edges between global indices (Layer * tiles + tile) for the all-layers search
+        const int32 NumTiles = BenchSize * BenchSize;
+        TMultiMap<int32, TPair<int32, int32>> Links;
+        for (const FGridPortal& Portal : Grid.GetPortals())
+        {
+            const int32 From = Portal.From.Layer * NumTiles + Portal.From.TileIndex;
+            const int32 To = Portal.To.Layer * NumTiles + Portal.To.TileIndex;
+            Links.Add(From, TPair<int32, int32>(To, Portal.Cost * Grid.GetCostScale()));
+            if (Portal.bTwoWay) Links.Add(To, TPair<int32, int32>(From, Portal.Cost * Grid.GetCostScale()));
+        }
+
+        TArray<FGridLayerTile> Walkable;
+        for (int32 Layer = 0; Layer < BenchLayers; ++Layer)
+        {
+            for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+            {
+                if (Grid.GetLayer(Layer).GetTileCost(Tile) >= 0) Walkable.Add(FGridLayerTile(Layer, Tile));
+            }
+        }
+
+        FGridLayerPath Path;
+        FGridLayerPathStats Stats;
+        TArray<FGridLayerTile> Reachable;
+        double LayeredMs = 0.0;
+        double AllLayersMs = 0.0;
+        double ReachMs = 0.0;
+        double AllLayersReachMs = 0.0;
+        int32 Found = 0;
+        int32 CrossLayer = 0;
+        int32 Mismatches = 0;
+        int64 NodesExpanded = 0;
+        int64 LayerSearches = 0;
+        for (int32 Query = 0; Query < NumQueries; ++Query)
+        {
+            const FGridLayerTile Start = Walkable[Random.RandHelper(Walkable.Num())];
+            const FGridLayerTile Goal = Walkable[Random.RandHelper(Walkable.Num())];
+
+            StartTime = FPlatformTime::Seconds();
+            const bool bFound = Grid.FindPath(Start, Goal, Path, &Stats);
+            LayeredMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+            StartTime = FPlatformTime::Seconds();
+            const int32 AllLayersCost = SearchAllLayers(Grid, Links, Start.Layer * NumTiles + Start.TileIndex, Goal.Layer * NumTiles + Goal.TileIndex, MAX_int32);
+            AllLayersMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+            Found += bFound ? 1 : 0;
+            CrossLayer += Start.Layer != Goal.Layer ? 1 : 0;
+            Mismatches += (bFound ? Path.GetTotalCost() : MAX_int32) != AllLayersCost ? 1 : 0;
+            NodesExpanded += Stats.NodesExpanded;
+            LayerSearches += Stats.LayerSearches;
+
+            StartTime = FPlatformTime::Seconds();
+            Grid.GetReachableTiles(Start, ReachCost, Reachable);
+            ReachMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+            StartTime = FPlatformTime::Seconds();
+            const int32 AllLayersReached = SearchAllLayers(Grid, Links, Start.Layer * NumTiles + Start.TileIndex, INDEX_NONE, ReachCost * Grid.GetCostScale());
+            AllLayersReachMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+            Mismatches += Reachable.Num() != AllLayersReached ? 1 : 0;
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("LayeredPaths %d layers of %dx%d, %d portals: graph of %d nodes built in %.2f ms, %llu bytes"),
+            BenchLayers, BenchSize, BenchSize, Grid.GetPortals().Num(), Grid.NumPortalNodes(), BuildMs, (uint64)Grid.GetAllocatedSize());
+        UE_LOG(LogTemp, Display, TEXT("LayeredPaths FindPath: portal graph %.3f ms vs all-layers A* %.3f ms per query (%d of %d found, %d across layers, %.1f nodes and %.1f layer searches each)"),
+            LayeredMs / NumQueries, AllLayersMs / NumQueries, Found, NumQueries, CrossLayer, (double)NodesExpanded / NumQueries, (double)LayerSearches / NumQueries);
+        UE_LOG(LogTemp, Display, TEXT("LayeredPaths reachable within %d: portal graph %.3f ms vs all-layers Dijkstra %.3f ms per query, mismatches %d"),
+            ReachCost, ReachMs / NumQueries, AllLayersReachMs / NumQueries, Mismatches);
+    }
+
+    FAutoConsoleCommand LayeredPathBenchmarkCommand(
+        TEXT("tb.Bench.LayeredPaths"),
+        TEXT("Paths and reachability on 4 stacked 128x128 layers joined by stairs: portal graph against one search over every layer"),
+        FConsoleCommandDelegate::CreateStatic(&RunLayeredPathBenchmark));
+}
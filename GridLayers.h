@@ -0,0 +1,162 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+
+// A tile on one layer
+struct FGridLayerTile
+{
+    int32 Layer = INDEX_NONE;
+    int32 TileIndex = INDEX_NONE;
+
+    FGridLayerTile() = default;
+    FGridLayerTile(int32 InLayer, int32 InTileIndex) : Layer(InLayer), TileIndex(InTileIndex) {}
+
+    bool operator==(const FGridLayerTile& Other) const { return Layer == Other.Layer && TileIndex == Other.TileIndex; }
+};
+
+// Stairs, ladder or ramp: stepping onto From moves on to To for Cost movement points
+struct FGridPortal
+{
+    FGridLayerTile From;
+    FGridLayerTile To;
+    int32 Cost = 1;
+    bool bTwoWay = true;
+};
+
+struct FGridLayerPathStep
+{
+    FGridLayerTile Tile;
+    int32 CumulativeCost = 0;
+};
+
+// Path across layers, start (cost 0) to goal; a portal crossing is two consecutive steps on different layers
+struct FGridLayerPath
+{
+    TArray<FGridLayerPathStep> Steps;
+
+    // Search cost units per movement point
+    int32 CostScale = 1;
+
+    void Reset()
+    {
+        Steps.Reset();
+        CostScale = 1;
+    }
+
+    int32 Num() const { return Steps.Num(); }
+    int32 GetTotalCost() const { return Steps.Num() ? Steps.Last().CumulativeCost : 0; }
+    int32 GetMovementCost() const { return FMath::DivideAndRoundUp(GetTotalCost(), FMath::Max(1, CostScale)); }
+};
+
+// Counters from one layered search
+struct FGridLayerPathStats
+{
+    // Portal graph nodes settled
+    int32 NodesExpanded = 0;
+
+    // Single-layer A* searches run to build the path
+    int32 LayerSearches = 0;
+};
+
+// Stacked grid layers (ground, bridges, upper floors) of the same size, each a dense FGridPathfinder of its own,
+// joined by portals. The portal graph is precomputed: every portal end knows its cost to and from every tile of its
+// layer, so a query seeds the graph from the start tile, runs Dijkstra over the few portal ends only, and then walks
+// the chosen legs with one A* per layer. Nothing ever searches all layers' tiles at once.
+// The price is memory that grows with portals x layer tiles: every portal end keeps two int32 cost fields over its
+// layer (8 bytes per tile per node), so a 128x128 layer costs 128 KB for each portal end on it.
+class DENEME_API FGridLayers
+{
+public:
+    void Init(int32 NumLayers, int32 InWidth, int32 InHeight, EGridConnectivity InConnectivity = EGridConnectivity::Square4);
+
+    int32 NumLayers() const { return Layers.Num(); }
+    int32 GetWidth() const { return Width; }
+    int32 GetHeight() const { return Height; }
+    int32 GetCostScale() const { return Layers.Num() ? Layers[0].GetCostScale() : 1; }
+
+    // Terrain of one layer. Call BuildPortalGraph after editing costs.
+    FGridPathfinder& GetLayer(int32 Layer) { return Layers[Layer]; }
+    const FGridPathfinder& GetLayer(int32 Layer) const { return Layers[Layer]; }
+
+    // Returns the portal's index. Call BuildPortalGraph after adding portals.
+    int32 AddPortal(const FGridPortal& Portal);
+    const TArray<FGridPortal>& GetPortals() const { return Portals; }
+
+    // Cost fields of every portal end and the edges between them. Portals with a blocked end are left out.
+    void BuildPortalGraph();
+
+    // Cheapest path from Start to Goal on any layers; false if there is none (or Start == Goal)
+    bool FindPath(const FGridLayerTile& Start, const FGridLayerTile& Goal, FGridLayerPath& OutPath, FGridLayerPathStats* OutStats = nullptr) const;
+
+    // Every tile reachable from Start for at most MaxCost movement points, not counting Start. OutCosts, if given,
+    // receives the search cost to reach each tile.
+    void GetReachableTiles(const FGridLayerTile& Start, int32 MaxCost, TArray<FGridLayerTile>& OutTiles, TArray<int32>* OutCosts = nullptr) const;
+
+    // Portal graph nodes (distinct portal ends)
+    int32 NumPortalNodes() const { return Nodes.Num(); }
+
+    // Bytes held by the layers and the portal graph
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    struct FNode
+    {
+        FGridLayerTile Tile;
+
+        // Search cost from this node to each tile of its layer, and from each tile to it
+        TArray<int32> CostFrom;
+        TArray<int32> CostTo;
+
+        // Range in Edges
+        int32 FirstEdge = 0;
+        int32 NumEdges = 0;
+    };
+
+    struct FEdge
+    {
+        int32 From;
+        int32 To;
+        int32 Cost;
+        // Crossing a portal, as opposed to walking within the layer
+        bool bPortal;
+    };
+
+    bool IsValidTile(const FGridLayerTile& Tile) const
+    {
+        return Layers.IsValidIndex(Tile.Layer) && Tile.TileIndex >= 0 && Tile.TileIndex < Width * Height;
+    }
+
+    // Dijkstra over the portal graph seeded from Start: cheapest cost to each node (MAX_int32 where unreachable or
+    // past Limit) and the edge it was reached by (INDEX_NONE straight from Start). With a valid Goal, also finds the cheapest way on to Goal below
+    // InOutBestCost (OutBestNode is the last node of it) and stops once no node can improve on it.
+    void SearchNodes(const FGridLayerTile& Start, const FGridLayerTile& Goal, int32 Limit, TArray<int32>& OutCost, TArray<int32>& OutParentEdge,
+        int32& InOutBestCost, int32& OutBestNode, FGridLayerPathStats* OutStats) const;
+
+    // Append the single-layer leg From -> To to OutPath (From is already its last step)
+    bool AppendLeg(int32 Layer, int32 From, int32 To, FGridLayerPath& OutPath, FGridLayerPathStats* OutStats) const;
+
+    int32 Width = 0;
+    int32 Height = 0;
+
+    TArray<FGridPathfinder> Layers;
+    TArray<FGridPortal> Portals;
+
+    TArray<FNode> Nodes;
+    TArray<FEdge> Edges;
+
+    // Nodes of each layer
+    TArray<TArray<int32>> LayerNodes;
+
+    // Query scratch (not thread-safe, like FGridPathfinder's own)
+    mutable FGridPathScratch Scratch;
+    mutable FGridPath LegPath;
+    mutable TArray<int32> NodeCost;
+    mutable TArray<int32> NodeParentEdge;
+
+    // Reachability: best cost per layer tile (MAX_int32 between queries) and the tiles it was set for
+    mutable TArray<int32> ReachCost;
+    mutable TArray<int32> ReachTouched;
+    mutable TArray<int32> LayerTiles;
+    mutable TArray<int32> LayerCosts;
+};
@@ -0,0 +1,77 @@
+#include "GridOccupancy.h"
+
+void FGridOccupancy::Init(int32 InWidth, int32 InHeight)
+{
+    Width = FMath::Max(0, InWidth);
+    Height = FMath::Max(0, InHeight);
+    WordsPerRow = (Width + 63) / 64;
+
+    AnyBoard.Init(0, WordsPerRow * Height);
+    UnitBoard.Init(0, WordsPerRow * Height);
+    TeamBoards.Empty();
+    ++Version;
+}
+
+void FGridOccupancy::SetOccupied(int32 X, int32 Y, int32 TeamId, bool bIsUnit)
+{
+    if (X < 0 || X >= Width || Y < 0 || Y >= Height) return;
+    ClearTile(X, Y);
+
+    const int32 Word = Y * WordsPerRow + (X >> 6);
+    const uint64 Bit = 1ull << (X & 63);
+    AnyBoard.Set(Word, AnyBoard[Word] | Bit);
+    if (!bIsUnit) return;
+
+    UnitBoard.Set(Word, UnitBoard[Word] | Bit);
+    FBoard& Team = TeamBoards.FindOrAdd(TeamId);
+    if (Team.Num() == 0)
+    {
+        Team.Init(0, WordsPerRow * Height);
+    }
+    Team.Set(Word, Team[Word] | Bit);
+}
+
+void FGridOccupancy::ClearTile(int32 X, int32 Y)
+{
+    if (X < 0 || X >= Width || Y < 0 || Y >= Height) return;
+
+    const int32 Word = Y * WordsPerRow + (X >> 6);
+    const uint64 Mask = ~(1ull << (X & 63));
+    ++Version;
+    AnyBoard.Set(Word, AnyBoard[Word] & Mask);
+    UnitBoard.Set(Word, UnitBoard[Word] & Mask);
+    for (auto& Pair : TeamBoards)
+    {
+        Pair.Value.Set(Word, Pair.Value[Word] & Mask);
+    }
+}
+
+bool FGridOccupancy::IsTeamAt(int32 TeamId, int32 X, int32 Y) const
+{
+    const FBoard* Team = TeamBoards.Find(TeamId);
+    return Team && TestBit(*Team, X, Y);
+}
+
+bool FGridOccupancy::IsUnitInRange(int32 X, int32 Y, int32 Range, int32 TX, int32 TY) const
+{
+    // Compared in int64 so Blueprint-sized ranges cannot overflow
+    if ((int64)FMath::Abs(TX - X) + FMath::Abs(TY - Y) > (int64)Range) return false;
+    return IsUnitAt(TX, TY);
+}
+
+int32 FGridOccupancy::CountUnitsInRange(int32 X, int32 Y, int32 Range, int32 TeamId, bool bEnemiesOf, bool bAlliesOf) const
+{
+    int32 Count = 0;
+    ForEachUnitInRange(X, Y, Range, TeamId, bEnemiesOf, bAlliesOf, [&Count](int32, int32) { ++Count; });
+    return Count;
+}
+
+SIZE_T FGridOccupancy::GetAllocatedSize() const
+{
+    SIZE_T Size = AnyBoard.GetAllocatedSize() + UnitBoard.GetAllocatedSize() + TeamBoards.GetAllocatedSize();
+    for (const auto& Pair : TeamBoards)
+    {
+        Size += Pair.Value.GetAllocatedSize();
+    }
+    return Size;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPagedArray.h"
+
+// Per-team occupancy bitboards for range queries.
+// Boards are row-padded (each grid row starts on a fresh 64-bit word) so a Manhattan
+// diamond becomes, per row, one contiguous bit run covering one or two words. Words are paged, so stretches of
+// empty rows (most of a streamed world map) take no memory.
+class DENEME_API FGridOccupancy
+{
+public:
+    void Init(int32 InWidth, int32 InHeight);
+
+    int32 GetWidth() const { return Width; }
+    int32 GetHeight() const { return Height; }
+
+    // Bumped on every change, so callers can cache results derived from the boards
+    uint32 GetVersion() const { return Version; }
+
+    // Mark a tile as occupied by a unit of TeamId (or by a non-unit actor when bIsUnit is false)
+    void SetOccupied(int32 X, int32 Y, int32 TeamId, bool bIsUnit);
+    void ClearTile(int32 X, int32 Y);
+
+    bool IsOccupied(int32 X, int32 Y) const { return TestBit(AnyBoard, X, Y); }
+    bool IsUnitAt(int32 X, int32 Y) const { return TestBit(UnitBoard, X, Y); }
+    bool IsTeamAt(int32 TeamId, int32 X, int32 Y) const;
+
+    // True if (TX, TY) is within Manhattan Range of (X, Y) and holds a unit
+    bool IsUnitInRange(int32 X, int32 Y, int32 Range, int32 TX, int32 TY) const;
+
+    // Calls Fn(TileX, TileY) for each unit within Manhattan Range of (X, Y).
+    // bEnemiesOf / bAlliesOf filter on TeamId; both false returns every unit.
+    template <typename FuncType>
+    void ForEachUnitInRange(int32 X, int32 Y, int32 Range, int32 TeamId, bool bEnemiesOf, bool bAlliesOf, FuncType&& Fn) const;
+
+    int32 CountUnitsInRange(int32 X, int32 Y, int32 Range, int32 TeamId, bool bEnemiesOf, bool bAlliesOf) const;
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    using FBoard = TGridPagedArray<uint64>;
+
+    bool TestBit(const FBoard& Board, int32 X, int32 Y) const
+    {
+        if (X < 0 || X >= Width || Y < 0 || Y >= Height || Board.Num() == 0) return false;
+        return (Board[Y * WordsPerRow + (X >> 6)] & (1ull << (X & 63))) != 0;
+    }
+
+    // Mask with bits Lo..Hi set (inclusive, both within one 64-bit word)
+    static uint64 RunMask(int32 Lo, int32 Hi)
+    {
+        return (~0ull >> (63 - (Hi - Lo))) << Lo;
+    }
+
+    int32 Width = 0;
+    int32 Height = 0;
+    int32 WordsPerRow = 0;
+    uint32 Version = 0;
+
+    FBoard AnyBoard;
+    FBoard UnitBoard;
+    TMap<int32, FBoard> TeamBoards;
+};
+
+template <typename FuncType>
+void FGridOccupancy::ForEachUnitInRange(int32 X, int32 Y, int32 Range, int32 TeamId, bool bEnemiesOf, bool bAlliesOf, FuncType&& Fn) const
+{
+    if (Range < 0 || UnitBoard.Num() == 0) return;
+
+    const FBoard* Team = TeamBoards.Find(TeamId);
+    if (bAlliesOf && !Team) return;
+
+    // No diamond reaches further than the grid's own extent
+    Range = FMath::Min(Range, Width + Height);
+    const int32 MinY = FMath::Max(0, Y - Range);
+    const int32 MaxY = FMath::Min(Height - 1, Y + Range);
+
+    for (int32 RowY = MinY; RowY <= MaxY; ++RowY)
+    {
+        const int32 HalfWidth = Range - FMath::Abs(RowY - Y);
+        const int32 Lo = FMath::Max(0, X - HalfWidth);
+        const int32 Hi = FMath::Min(Width - 1, X + HalfWidth);
+        if (Lo > Hi) continue;
+
+        const int32 RowBase = RowY * WordsPerRow;
+        for (int32 Word = Lo >> 6; Word <= (Hi >> 6); ++Word)
+        {
+            const int32 WordLo = FMath::Max(Lo, Word * 64) - Word * 64;
+            const int32 WordHi = FMath::Min(Hi, Word * 64 + 63) - Word * 64;
+
+            uint64 Bits = UnitBoard[RowBase + Word] & RunMask(WordLo, WordHi);
+            if (bAlliesOf)
+            {
+                Bits &= (*Team)[RowBase + Word];
+            }
+            else if (bEnemiesOf && Team)
+            {
+                Bits &= ~(*Team)[RowBase + Word];
+            }
+
+            while (Bits)
+            {
+                const int32 Bit = (int32)FMath::CountTrailingZeros64(Bits);
+                Bits &= Bits - 1;
+                Fn(Word * 64 + Bit, RowY);
+            }
+        }
+    }
+}
@@ -0,0 +1,230 @@
+#include "GridOverlayComponent.h"
+#include "AGridTile.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Components/PrimitiveComponent.h"
+
+namespace
+{
+    // Channel each layer is written to
+    uint8 FColor::* const LayerChannels[(int32)EGridOverlayLayer::Count] = { &FColor::R, &FColor::G, &FColor::B, &FColor::A };
+
+    const FName MaskParameterName(TEXT("OverlayMask"));
+    const FName GridOriginParameterName(TEXT("GridOrigin"));
+    const FName GridSizeParameterName(TEXT("GridSize"));
+    const FName TileSizeParameterName(TEXT("TileSize"));
+}
+
+UGridOverlayComponent::UGridOverlayComponent()
+{
+    // Only ticks on frames with pending layer changes
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = false;
+    PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+}
+
+void UGridOverlayComponent::Init(int32 InGridWidth, int32 InGridHeight, const FVector& InGridOrigin, float InTileSize, int32 WindowSize)
+{
+    GridWidth = FMath::Max(1, InGridWidth);
+    GridHeight = FMath::Max(1, InGridHeight);
+    GridOrigin = InGridOrigin;
+    TileSize = InTileSize;
+    WindowWidth = WindowSize > 0 ? FMath::Min(WindowSize, GridWidth) : GridWidth;
+    WindowHeight = WindowSize > 0 ? FMath::Min(WindowSize, GridHeight) : GridHeight;
+
+    const int32 NumTiles = WindowWidth * WindowHeight;
+    for (FGridBitset& Layer : Layers)
+    {
+        Layer.Init(NumTiles);
+    }
+    Texels.Init(FColor(0, 0, 0, 0), NumTiles);
+
+    if (!MaskTexture || MaskTexture->GetSizeX() != WindowWidth || MaskTexture->GetSizeY() != WindowHeight)
+    {
+        MaskTexture = UTexture2D::CreateTransient(WindowWidth, WindowHeight, PF_B8G8R8A8, TEXT("GridOverlayMask"));
+        if (MaskTexture)
+        {
+            // One texel per tile: no filtering, no sRGB curve, no mips
+            MaskTexture->Filter = TF_Nearest;
+            MaskTexture->SRGB = false;
+            MaskTexture->CompressionSettings = TC_VectorDisplacementmap;
+            MaskTexture->AddressX = TA_Clamp;
+            MaskTexture->AddressY = TA_Clamp;
+            MaskTexture->UpdateResource();
+        }
+    }
+
+    SetWindow(0, 0, GridOrigin);
+}
+
+void UGridOverlayComponent::SetWindow(int32 MinX, int32 MinY, const FVector& InWindowOrigin)
+{
+    WindowMinX = FMath::Clamp(MinX, 0, GridWidth - WindowWidth);
+    WindowMinY = FMath::Clamp(MinY, 0, GridHeight - WindowHeight);
+    WindowOrigin = InWindowOrigin;
+    for (FGridBitset& Layer : Layers)
+    {
+        Layer.Reset();
+    }
+    CreateMaterialInstance();
+
+    // Upload the cleared mask on the next tick
+    DirtyLayers = (1 << (int32)EGridOverlayLayer::Count) - 1;
+    SetComponentTickEnabled(true);
+}
+
+void UGridOverlayComponent::CreateMaterialInstance()
+{
+    if (!OverlayMaterial) return;
+
+    if (!MaterialInstance || MaterialInstance->Parent != OverlayMaterial)
+    {
+        MaterialInstance = UMaterialInstanceDynamic::Create(OverlayMaterial, this);
+    }
+    MaterialInstance->SetTextureParameterValue(MaskParameterName, MaskTexture);
+    MaterialInstance->SetVectorParameterValue(GridOriginParameterName, FLinearColor(WindowOrigin));
+    MaterialInstance->SetVectorParameterValue(GridSizeParameterName, FLinearColor((float)WindowWidth, (float)WindowHeight, 0.0f, 0.0f));
+    MaterialInstance->SetScalarParameterValue(TileSizeParameterName, TileSize);
+}
+
+void UGridOverlayComponent::SetOverlaySurface(UPrimitiveComponent* Surface, int32 MaterialIndex)
+{
+    CreateMaterialInstance();
+    if (Surface && MaterialInstance)
+    {
+        Surface->SetMaterial(MaterialIndex, MaterialInstance);
+    }
+}
+
+void UGridOverlayComponent::MarkLayerDirty(EGridOverlayLayer Layer)
+{
+    DirtyLayers |= 1 << (int32)Layer;
+    SetComponentTickEnabled(true);
+}
+
+void UGridOverlayComponent::SetLayerTiles(EGridOverlayLayer Layer, const TArray<AGridTile*>& InTiles)
+{
+    FGridBitset& Bits = Layers[(int32)Layer];
+    Bits.Reset();
+    for (const AGridTile* Tile : InTiles)
+    {
+        if (Tile)
+        {
+            Bits.Set(ToWindowIndex(Tile->X, Tile->Y));
+        }
+    }
+    MarkLayerDirty(Layer);
+}
+
+void UGridOverlayComponent::SetLayerIndices(EGridOverlayLayer Layer, TArrayView<const int32> TileIndices)
+{
+    FGridBitset& Bits = Layers[(int32)Layer];
+    Bits.Reset();
+    for (int32 Index : TileIndices)
+    {
+        Bits.Set(ToWindowIndex(Index));
+    }
+    MarkLayerDirty(Layer);
+}
+
+void UGridOverlayComponent::SetLayerPath(EGridOverlayLayer Layer, const FGridPath& Path)
+{
+    FGridBitset& Bits = Layers[(int32)Layer];
+    Bits.Reset();
+    Path.ForEachTile([this, &Bits](int32 Index) { Bits.Set(ToWindowIndex(Index)); });
+    MarkLayerDirty(Layer);
+}
+
+void UGridOverlayComponent::SetLayerBits(EGridOverlayLayer Layer, const FGridBitset& Bits)
+{
+    FGridBitset& Target = Layers[(int32)Layer];
+    if (Bits.NumBits != GridWidth * GridHeight) return;
+    if (Bits.NumBits == Target.NumBits)
+    {
+        Target.Words = Bits.Words;
+    }
+    else
+    {
+        Target.Reset();
+        Bits.ForEachSetBit([this, &Target](int32 Index) { Target.Set(ToWindowIndex(Index)); });
+    }
+    MarkLayerDirty(Layer);
+}
+
+void UGridOverlayComponent::ClearLayer(EGridOverlayLayer Layer)
+{
+    Layers[(int32)Layer].Reset();
+    MarkLayerDirty(Layer);
+}
+
+void UGridOverlayComponent::ClearAllLayers()
+{
+    for (int32 Layer = 0; Layer < (int32)EGridOverlayLayer::Count; ++Layer)
+    {
+        ClearLayer((EGridOverlayLayer)Layer);
+    }
+}
+
+bool UGridOverlayComponent::IsTileHighlighted(EGridOverlayLayer Layer, AGridTile* Tile) const
+{
+    if (!Tile) return false;
+    return Layers[(int32)Layer].Test(ToWindowIndex(Tile->X, Tile->Y));
+}
+
+void UGridOverlayComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+    FlushOverlay();
+}
+
+SIZE_T UGridOverlayComponent::GetAllocatedSize() const
+{
+    SIZE_T Size = Texels.GetAllocatedSize();
+    for (const FGridBitset& Layer : Layers)
+    {
+        Size += Layer.Words.GetAllocatedSize();
+    }
+    if (MaskTexture)
+    {
+        Size += (SIZE_T)WindowWidth * WindowHeight * sizeof(FColor);
+    }
+    return Size;
+}
+
+void UGridOverlayComponent::FlushOverlay()
+{
+    SetComponentTickEnabled(false);
+    if (!DirtyLayers || Texels.Num() == 0) return;
+
+    // Rewrite only the channels of layers that changed
+    for (int32 Layer = 0; Layer < (int32)EGridOverlayLayer::Count; ++Layer)
+    {
+        if (!(DirtyLayers & (1 << Layer))) continue;
+
+        uint8 FColor::* Channel = LayerChannels[Layer];
+        for (FColor& Texel : Texels)
+        {
+            Texel.*Channel = 0;
+        }
+        Layers[Layer].ForEachSetBit([this, Channel](int32 Index)
+        {
+            Texels[Index].*Channel = 255;
+        });
+    }
+    DirtyLayers = 0;
+
+    if (!MaskTexture) return;
+
+    // One region covering the whole window; the render thread owns the copy until the upload is done
+    const int32 NumBytes = Texels.Num() * sizeof(FColor);
+    uint8* UploadData = (uint8*)FMemory::Malloc(NumBytes);
+    FMemory::Memcpy(UploadData, Texels.GetData(), NumBytes);
+    FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, WindowWidth, WindowHeight);
+
+    MaskTexture->UpdateTextureRegions(0, 1, Region, WindowWidth * sizeof(FColor), sizeof(FColor), UploadData,
+        [](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+        {
+            FMemory::Free(SrcData);
+            delete Regions;
+        });
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GridBitset.h"
+#include "GridOverlayComponent.generated.h"
+
+class AGridTile;
+struct FGridPath;
+class UTexture2D;
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+class UPrimitiveComponent;
+
+// Highlight layers, one texture channel each (R, G, B, A)
+UENUM(BlueprintType)
+enum class EGridOverlayLayer : uint8
+{
+    Reachable,
+    Path,
+    Targetable,
+    Threat,
+
+    Count UMETA(Hidden)
+};
+
+// Tile highlight overlay drawn by a single grid material.
+// Every layer is a bitset over tile indices; changes are packed into a GridWidth x GridHeight BGRA8 mask
+// texture (one texel per tile, one channel per layer) and uploaded once per frame, whatever the number of tiles touched.
+// On world-scale grids the mask covers a window of the grid instead (see SetWindow); tiles outside it are not drawn.
+UCLASS(ClassGroup = (Grid), meta = (BlueprintSpawnableComponent))
+class DENEME_API UGridOverlayComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UGridOverlayComponent();
+
+    // Material sampling the mask; receives OverlayMask (texture), GridOrigin (center of tile 0,0), GridSize and TileSize parameters
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Overlay")
+    UMaterialInterface* OverlayMaterial = nullptr;
+
+    // Size the mask for a grid (called by AGridManager after generation); clears every layer. WindowSize 0 covers the
+    // whole grid, otherwise the mask is a WindowSize square starting at tile (0, 0) and moved with SetWindow.
+    void Init(int32 InGridWidth, int32 InGridHeight, const FVector& InGridOrigin, float InTileSize, int32 WindowSize = 0);
+
+    // Move the mask window so it starts at tile (MinX, MinY), whose center is at WindowOrigin; clears every layer
+    void SetWindow(int32 MinX, int32 MinY, const FVector& WindowOrigin);
+
+    FIntPoint GetWindowMin() const { return FIntPoint(WindowMinX, WindowMinY); }
+    FIntPoint GetWindowSize() const { return FIntPoint(WindowWidth, WindowHeight); }
+
+    // Replace a layer's contents
+    UFUNCTION(BlueprintCallable, Category = "Overlay")
+    void SetLayerTiles(EGridOverlayLayer Layer, const TArray<AGridTile*>& InTiles);
+
+    void SetLayerIndices(EGridOverlayLayer Layer, TArrayView<const int32> TileIndices);
+
+    // Every tile of a path result
+    void SetLayerPath(EGridOverlayLayer Layer, const FGridPath& Path);
+
+    // Replace a layer from an existing grid-sized bitset (e.g. team visibility) without going through tiles
+    void SetLayerBits(EGridOverlayLayer Layer, const FGridBitset& Bits);
+
+    UFUNCTION(BlueprintCallable, Category = "Overlay")
+    void ClearLayer(EGridOverlayLayer Layer);
+
+    UFUNCTION(BlueprintCallable, Category = "Overlay")
+    void ClearAllLayers();
+
+    UFUNCTION(BlueprintCallable, Category = "Overlay")
+    bool IsTileHighlighted(EGridOverlayLayer Layer, AGridTile* Tile) const;
+
+    // Apply the overlay material to a surface covering the grid (e.g. a plane mesh on the grid manager)
+    UFUNCTION(BlueprintCallable, Category = "Overlay")
+    void SetOverlaySurface(UPrimitiveComponent* Surface, int32 MaterialIndex = 0);
+
+    UFUNCTION(BlueprintCallable, Category = "Overlay")
+    UMaterialInstanceDynamic* GetOverlayMaterialInstance() const { return MaterialInstance; }
+
+    UFUNCTION(BlueprintCallable, Category = "Overlay")
+    UTexture2D* GetMaskTexture() const { return MaskTexture; }
+
+    // CPU-side layers and mask copy plus the mask texture's texels
+    SIZE_T GetAllocatedSize() const;
+
+    // Upload pending layer changes now instead of at the end of the frame
+    void FlushOverlay();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+    void MarkLayerDirty(EGridOverlayLayer Layer);
+    void CreateMaterialInstance();
+
+    // Layer bit of a grid tile, or INDEX_NONE outside the window
+    int32 ToWindowIndex(int32 X, int32 Y) const
+    {
+        const int32 LocalX = X - WindowMinX;
+        const int32 LocalY = Y - WindowMinY;
+        if (LocalX < 0 || LocalX >= WindowWidth || LocalY < 0 || LocalY >= WindowHeight) return INDEX_NONE;
+        return LocalY * WindowWidth + LocalX;
+    }
+    int32 ToWindowIndex(int32 TileIndex) const
+    {
+        return TileIndex >= 0 ? ToWindowIndex(TileIndex % GridWidth, TileIndex / GridWidth) : INDEX_NONE;
+    }
+
+    UPROPERTY(Transient)
+    UTexture2D* MaskTexture = nullptr;
+
+    UPROPERTY(Transient)
+    UMaterialInstanceDynamic* MaterialInstance = nullptr;
+
+    int32 GridWidth = 0;
+    int32 GridHeight = 0;
+    FVector GridOrigin = FVector::ZeroVector;
+    float TileSize = 100.0f;
+
+    // Tiles covered by the mask (the whole grid unless windowed)
+    int32 WindowMinX = 0;
+    int32 WindowMinY = 0;
+    int32 WindowWidth = 0;
+    int32 WindowHeight = 0;
+    FVector WindowOrigin = FVector::ZeroVector;
+
+    // Per window tile
+    FGridBitset Layers[(int32)EGridOverlayLayer::Count];
+
+    // Bit per layer whose channel needs rewriting
+    uint8 DirtyLayers = 0;
+
+    // CPU copy of the mask, one texel per window tile
+    TArray<FColor> Texels;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Per-tile array for world-scale grids, indexed like a flat TArray but kept in pages of PageSize entries. A page whose
+// entries all hold one value stores just that value and only gets storage on the first write of a different one, so
+// memory follows the varied or visited part of the grid instead of its bounding box (the same idea as FGridChunkStore,
+// over flat indices). Reads cost one more load than a TArray; writes go through Set.
+template <typename ElementType, int32 PageShift = 8>
+class TGridPagedArray
+{
+public:
+    static constexpr int32 PageSize = 1 << PageShift;
+
+    // InNum entries, all Value; frees every page
+    void Init(const ElementType& Value, int32 InNum)
+    {
+        NumEntries = FMath::Max(0, InNum);
+        FPage Uniform;
+        Uniform.Uniform = Value;
+        Pages.Init(Uniform, (NumEntries + PageSize - 1) >> PageShift);
+    }
+
+    void Empty()
+    {
+        NumEntries = 0;
+        Pages.Empty();
+    }
+
+    int32 Num() const { return NumEntries; }
+    bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumEntries; }
+
+    ElementType operator[](int32 Index) const
+    {
+        const FPage& Page = Pages[Index >> PageShift];
+        return Page.Entries.Num() ? Page.Entries.GetData()[Index & (PageSize - 1)] : Page.Uniform;
+    }
+
+    void Set(int32 Index, const ElementType& Value)
+    {
+        FPage& Page = Pages[Index >> PageShift];
+        if (Page.Entries.Num() == 0)
+        {
+            if (Page.Uniform == Value) return;
+            Page.Entries.Init(Page.Uniform, PageSize);
+        }
+        Page.Entries.GetData()[Index & (PageSize - 1)] = Value;
+    }
+
+    // Give the entries of a page one value again and free its storage (e.g. after clearing a region)
+    void FillPage(int32 Page, const ElementType& Value)
+    {
+        Pages[Page].Uniform = Value;
+        Pages[Page].Entries.Empty();
+    }
+
+    int32 NumPages() const { return Pages.Num(); }
+    int32 GetNumDetailedPages() const
+    {
+        int32 Count = 0;
+        for (const FPage& Page : Pages)
+        {
+            Count += Page.Entries.Num() ? 1 : 0;
+        }
+        return Count;
+    }
+
+    SIZE_T GetAllocatedSize() const
+    {
+        SIZE_T Size = Pages.GetAllocatedSize();
+        for (const FPage& Page : Pages)
+        {
+            Size += Page.Entries.GetAllocatedSize();
+        }
+        return Size;
+    }
+
+private:
+    struct FPage
+    {
+        // Value of every entry while Entries is empty
+        ElementType Uniform = ElementType();
+
+        // PageSize entries, or empty when uniform
+        TArray<ElementType> Entries;
+    };
+
+    int32 NumEntries = 0;
+    TArray<FPage> Pages;
+};
@@ -0,0 +1,961 @@
+#include "GridPathfinding.h"
+#include "GridOccupancy.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    struct FDistEntry
+    {
+        int32 Dist;
+        int32 Index;
+    };
+
+    struct FDistLess
+    {
+        bool operator()(const FDistEntry& A, const FDistEntry& B) const { return A.Dist < B.Dist; }
+    };
+
+    // Sum of two non-negative search costs, pinned at MAX_int32 instead of wrapping on huge grids
+    FORCEINLINE int32 AddCost(int32 A, int32 B)
+    {
+        return A > MAX_int32 - B ? MAX_int32 : A + B;
+    }
+
+    struct FOpenLess
+    {
+        template <typename EntryType>
+        bool operator()(const EntryType& A, const EntryType& B) const
+        {
+            return A.F < B.F || (A.F == B.F && A.H < B.H);
+        }
+    };
+}
+
+void FGridPathfinder::Init(int32 InWidth, int32 InHeight, EGridConnectivity InConnectivity)
+{
+    Width = FMath::Max(0, InWidth);
+    Height = FMath::Max(0, InHeight);
+    PaddedWidth = Width + 2;
+    Connectivity = InConnectivity;
+    const int32 NumPadded = Width > 0 && Height > 0 ? PaddedWidth * (Height + 2) : 0;
+
+    // Every tile is blocked until its cost is set; the border stays blocked
+    Costs.Init(Blocked, NumPadded);
+    MinCost = 1;
+    ClearLandmarks();
+
+    const int32 W = PaddedWidth;
+    if (Connectivity == EGridConnectivity::Hex6)
+    {
+        // W, E, NW, NE, SW, SE; odd rows sit half a tile to the right
+        const int32 EvenRow[6] = { -1, 1, -W - 1, -W, W - 1, W };
+        const int32 OddRow[6] = { -1, 1, -W, -W + 1, W, W + 1 };
+        FMemory::Memcpy(NeighborOffsets[0], EvenRow, sizeof(EvenRow));
+        FMemory::Memcpy(NeighborOffsets[1], OddRow, sizeof(OddRow));
+    }
+    else
+    {
+        // W, E, N, S, NW, NE, SW, SE
+        const int32 Square[8] = { -1, 1, -W, W, -W - 1, -W + 1, W - 1, W + 1 };
+        FMemory::Memcpy(NeighborOffsets[0], Square, sizeof(Square));
+        FMemory::Memcpy(NeighborOffsets[1], Square, sizeof(Square));
+    }
+}
+
+int32 FGridPathfinder::GetCostScale() const
+{
+    return Dispatch([](auto Traits) { return decltype(Traits)::CostScale; });
+}
+
+int32 FGridPathfinder::GetTileCost(int32 TileIndex) const
+{
+    return IsValidTile(TileIndex) ? Costs[ToPadded(TileIndex)] : Blocked;
+}
+
+void FGridPathfinder::SetTileCost(int32 TileIndex, int32 Cost)
+{
+    if (!IsValidTile(TileIndex)) return;
+
+    const int32 Padded = ToPadded(TileIndex);
+    Cost = Cost < 0 ? Blocked : FMath::Min(Cost, MaxTileCost);
+    const int32 OldCost = Costs[Padded];
+    if (OldCost == Cost) return;
+
+    Costs.Set(Padded, Cost);
+    if (Cost >= 0 && Cost < MinCost)
+    {
+        MinCost = Cost;
+    }
+
+    if (Landmarks.Num() == 0) return;
+
+    // A landmark that became a wall has no distances left to give; choose a new set
+    if (Cost == Blocked && Landmarks.Contains(Padded))
+    {
+        BuildLandmarks(Landmarks.Num());
+        return;
+    }
+
+    Dispatch([&](auto Traits)
+    {
+        using TraitsType = decltype(Traits);
+        for (int32 Slot = 0; Slot < Landmarks.Num(); ++Slot)
+        {
+            RepairTable<TraitsType>(Slot, false, Padded, OldCost);
+            RepairTable<TraitsType>(Slot, true, Padded, OldCost);
+        }
+    });
+}
+
+void FGridPathfinder::SetTileCostDeferred(int32 TileIndex, int32 Cost)
+{
+    if (!IsValidTile(TileIndex)) return;
+
+    const int32 Padded = ToPadded(TileIndex);
+    Cost = Cost < 0 ? Blocked : FMath::Min(Cost, MaxTileCost);
+    const int32 OldCost = Costs[Padded];
+    if (OldCost == Cost) return;
+
+    if (Landmarks.Num())
+    {
+        DeferredOldCosts.FindOrAdd(Padded, OldCost);
+    }
+    Costs.Set(Padded, Cost);
+    if (Cost >= 0 && Cost < MinCost)
+    {
+        MinCost = Cost;
+    }
+}
+
+void FGridPathfinder::FlushTileCosts()
+{
+    if (DeferredOldCosts.Num() == 0) return;
+
+    // Tiles edited back to their old cost need nothing
+    struct FChange
+    {
+        int32 Padded;
+        int32 OldCost;
+        int32 NewCost;
+    };
+    TArray<FChange, TInlineAllocator<MaxRepairedTiles>> Changes;
+    bool bLandmarkBlocked = false;
+    for (const TPair<int32, int32>& Pair : DeferredOldCosts)
+    {
+        const int32 NewCost = Costs[Pair.Key];
+        if (NewCost == Pair.Value) continue;
+        Changes.Add({ Pair.Key, Pair.Value, NewCost });
+        bLandmarkBlocked |= NewCost == Blocked && Landmarks.Contains(Pair.Key);
+    }
+    DeferredOldCosts.Reset();
+    if (Changes.Num() == 0) return;
+
+    if (Changes.Num() <= MaxRepairedTiles)
+    {
+        // Replay the edits one at a time so every repair sees a single changed tile
+        for (const FChange& Change : Changes)
+        {
+            Costs.Set(Change.Padded, Change.OldCost);
+        }
+        for (const FChange& Change : Changes)
+        {
+            SetTileCost(FromPadded(Change.Padded), Change.NewCost);
+        }
+        return;
+    }
+
+    if (bLandmarkBlocked)
+    {
+        BuildLandmarks(Landmarks.Num());
+        return;
+    }
+    for (int32 Slot = 0; Slot < Landmarks.Num(); ++Slot)
+    {
+        ComputeTable(Slot, false);
+        ComputeTable(Slot, true);
+    }
+}
+
+void FGridPathfinder::ClearLandmarks()
+{
+    Landmarks.Reset();
+    Forward.Empty();
+    Backward.Empty();
+    DeferredOldCosts.Reset();
+    Build = FLandmarkBuild();
+}
+
+template <typename Traits>
+void FGridPathfinder::ComputeDistances(int32 Root, bool bBackward, TArray<int32>& OutDist) const
+{
+    OutDist.Init(MAX_int32, Costs.Num());
+    if (!Costs.IsValidIndex(Root) || Costs[Root] < 0) return;
+
+    TArray<FDistEntry> Heap;
+    OutDist[Root] = 0;
+    Heap.HeapPush({ 0, Root }, FDistLess());
+    while (Heap.Num() > 0)
+    {
+        FDistEntry Entry;
+        Heap.HeapPop(Entry, FDistLess(), false);
+        if (Entry.Dist != OutDist[Entry.Index]) continue;
+
+        const int32* Offsets = GetOffsets<Traits>(Entry.Index);
+        for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+        {
+            const int32 Weight = EdgeWeight<Traits>(Entry.Index, Dir, bBackward);
+            if (Weight < 0) continue;
+
+            const int32 Next = Entry.Index + Offsets[Dir];
+            const int32 Dist = AddCost(Entry.Dist, Weight);
+            if (Dist < OutDist[Next])
+            {
+                OutDist[Next] = Dist;
+                Heap.HeapPush({ Dist, Next }, FDistLess());
+            }
+        }
+    }
+}
+
+void FGridPathfinder::ComputeTable(int32 Slot, bool bBackward)
+{
+    TArray<int32> Dist;
+    Dispatch([&](auto Traits) { ComputeDistances<decltype(Traits)>(Landmarks[Slot], bBackward, Dist); });
+    for (int32 Index = 0; Index < Dist.Num(); ++Index)
+    {
+        TableAt(bBackward, Index, Slot) = Dist[Index] == MAX_int32 ? Unreachable : (uint16)FMath::Min(Dist[Index], MaxStoredDistance);
+    }
+}
+
+void FGridPathfinder::ComputeCostField(int32 Root, bool bBackward, TArray<int32>& OutCosts) const
+{
+    OutCosts.Init(MAX_int32, NumTiles());
+    if (!IsValidTile(Root)) return;
+
+    TArray<int32> Dist;
+    Dispatch([&](auto Traits) { ComputeDistances<decltype(Traits)>(ToPadded(Root), bBackward, Dist); });
+    for (int32 Index = 0; Index < OutCosts.Num(); ++Index)
+    {
+        OutCosts[Index] = Dist[ToPadded(Index)];
+    }
+}
+
+void FGridPathfinder::BuildLandmarks(int32 NumLandmarks)
+{
+    BeginBuildLandmarks(NumLandmarks);
+    bool bDone = false;
+    while (!bDone)
+    {
+        bDone = StepBuildLandmarks();
+    }
+}
+
+void FGridPathfinder::BeginBuildLandmarks(int32 NumLandmarks)
+{
+    ClearLandmarks();
+    Build.NumLandmarks = Costs.Num() ? FMath::Clamp(NumLandmarks, 0, MaxLandmarks) : 0;
+}
+
+bool FGridPathfinder::StepBuildLandmarks()
+{
+    if (Build.NumLandmarks == 0) return true;
+
+    if (Build.NextTable != INDEX_NONE)
+    {
+        ComputeTable(Build.NextTable / 2, (Build.NextTable & 1) != 0);
+        if (++Build.NextTable < Landmarks.Num() * 2) return false;
+
+        Build = FLandmarkBuild();
+        return true;
+    }
+
+    if (Build.MinDist.Num() == 0)
+    {
+        // Seed with the walkable tile nearest the center; the first landmark is the tile farthest from it
+        int32 Seed = INDEX_NONE;
+        int32 SeedDistance = MAX_int32;
+        for (int32 Y = 0; Y < Height; ++Y)
+        {
+            for (int32 X = 0; X < Width; ++X)
+            {
+                const int32 Padded = (Y + 1) * PaddedWidth + X + 1;
+                const int32 Distance = FMath::Abs(X - Width / 2) + FMath::Abs(Y - Height / 2);
+                if (Costs[Padded] >= 0 && Distance < SeedDistance)
+                {
+                    Seed = Padded;
+                    SeedDistance = Distance;
+                }
+            }
+        }
+        if (Seed == INDEX_NONE)
+        {
+            Build = FLandmarkBuild();
+            return true;
+        }
+        Dispatch([&](auto Traits) { ComputeDistances<decltype(Traits)>(Seed, false, Build.MinDist); });
+        return false;
+    }
+
+    // Farthest-point selection: each new landmark maximizes its distance to the ones already chosen
+    int32 Best = INDEX_NONE;
+    int32 BestDist = 0;
+    for (int32 Index = 0; Index < Build.MinDist.Num(); ++Index)
+    {
+        if (Build.MinDist[Index] != MAX_int32 && Build.MinDist[Index] > BestDist)
+        {
+            Best = Index;
+            BestDist = Build.MinDist[Index];
+        }
+    }
+
+    if (Best != INDEX_NONE)
+    {
+        TArray<int32> Dist;
+        Dispatch([&](auto Traits) { ComputeDistances<decltype(Traits)>(Best, false, Dist); });
+        for (int32 Index = 0; Index < Build.MinDist.Num(); ++Index)
+        {
+            Build.MinDist[Index] = Build.Picks.Num() == 0 ? Dist[Index] : FMath::Min(Build.MinDist[Index], Dist[Index]);
+        }
+        Build.Picks.Add(Best);
+        if (Build.Picks.Num() < Build.NumLandmarks) return false;
+    }
+
+    if (Build.Picks.Num() == 0)
+    {
+        Build = FLandmarkBuild();
+        return true;
+    }
+
+    // Selection done: publish the landmarks with empty tables
+    Landmarks = MoveTemp(Build.Picks);
+    Forward.Init(Unreachable, Costs.Num() * Landmarks.Num());
+    Backward.Init(Unreachable, Costs.Num() * Landmarks.Num());
+    Build.MinDist.Empty();
+    Build.NextTable = 0;
+    return false;
+}
+
+int32 FGridPathfinder::CountStaleLandmarkEntries() const
+{
+    int32 Stale = 0;
+    TArray<int32> Dist;
+    const int32 NumLandmarks = Landmarks.Num();
+    for (int32 Slot = 0; Slot < NumLandmarks; ++Slot)
+    {
+        for (int32 Direction = 0; Direction < 2; ++Direction)
+        {
+            const TArray<uint16>& Table = Direction ? Backward : Forward;
+            Dispatch([&](auto Traits) { ComputeDistances<decltype(Traits)>(Landmarks[Slot], Direction != 0, Dist); });
+            for (int32 Index = 0; Index < Dist.Num(); ++Index)
+            {
+                const uint16 Expected = Dist[Index] == MAX_int32 ? Unreachable : (uint16)FMath::Min(Dist[Index], MaxStoredDistance);
+                Stale += Table[Index * NumLandmarks + Slot] != Expected ? 1 : 0;
+            }
+        }
+    }
+    return Stale;
+}
+
+template <typename Traits>
+void FGridPathfinder::RepairTable(int32 Slot, bool bBackward, int32 V, int32 OldCost)
+{
+    const int32 Root = Landmarks[Slot];
+
+    auto Dist = [this, bBackward, Slot](int32 Index) -> int32
+    {
+        const uint16 Stored = TableAt(bBackward, Index, Slot);
+        return Stored == Unreachable ? MAX_int32 : Stored;
+    };
+    auto OldCostOf = [this, V, OldCost](int32 Index)
+    {
+        return Index == V ? OldCost : Costs[Index];
+    };
+    auto Increased = [&](int32 From, int32 Dir)
+    {
+        const int32 Old = EdgeWeight<Traits>(From, Dir, bBackward, OldCostOf);
+        const int32 New = EdgeWeight<Traits>(From, Dir, bBackward);
+        return Old >= 0 && (New < 0 || New > Old);
+    };
+    auto WasSupported = [&](int32 From, int32 Dir)
+    {
+        const int32 Weight = EdgeWeight<Traits>(From, Dir, bBackward, OldCostOf);
+        if (Weight < 0) return false;
+        const int32 FromDist = Dist(From);
+        const int32 ToDist = Dist(From + GetOffsets<Traits>(From)[Dir]);
+        return FromDist != MAX_int32 && ToDist != MAX_int32 && ToDist == FMath::Min(FromDist + Weight, MaxStoredDistance);
+    };
+
+    // Every edge whose weight can change has both ends in V's neighborhood (diagonals also depend on corners)
+    TArray<int32, TInlineAllocator<9>> Neighborhood;
+    Neighborhood.Add(V);
+    const int32* VOffsets = GetOffsets<Traits>(V);
+    for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+    {
+        Neighborhood.Add(V + VOffsets[Dir]);
+    }
+
+    // 1. Invalidate tiles that lost every shortest-path parent. Candidates are decided in order of their old
+    // distance, so a tile only keeps its distance through a strictly closer parent that is already known to be intact.
+    TArray<int32> Affected;
+    TBitArray<> IsAffected(false, Costs.Num());
+    TBitArray<> IsQueued(false, Costs.Num());
+    TArray<FDistEntry> Candidates;
+    auto Enqueue = [&](int32 Index)
+    {
+        if (Index != Root && !IsQueued[Index] && Dist(Index) != MAX_int32)
+        {
+            IsQueued[Index] = true;
+            Candidates.HeapPush({ Dist(Index), Index }, FDistLess());
+        }
+    };
+
+    for (int32 From : Neighborhood)
+    {
+        const int32* Offsets = GetOffsets<Traits>(From);
+        for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+        {
+            if (Increased(From, Dir) && WasSupported(From, Dir)) Enqueue(From + Offsets[Dir]);
+        }
+    }
+    if (Costs[V] < 0)
+    {
+        Enqueue(V);
+    }
+
+    while (Candidates.Num() > 0)
+    {
+        FDistEntry Candidate;
+        Candidates.HeapPop(Candidate, FDistLess(), false);
+        const int32 Current = Candidate.Index;
+        const int32* Offsets = GetOffsets<Traits>(Current);
+
+        // Edge Prev -> Current weighs the same as Current -> Prev with the cost roles swapped
+        bool bStillSupported = false;
+        for (int32 Dir = 0; Dir < Traits::NumDirections && !bStillSupported; ++Dir)
+        {
+            const int32 Prev = Current + Offsets[Dir];
+            const int32 Weight = EdgeWeight<Traits>(Current, Dir, !bBackward);
+            const int32 PrevDist = Weight >= 0 ? Dist(Prev) : MAX_int32;
+            bStillSupported = PrevDist < Candidate.Dist && !IsAffected[Prev] && FMath::Min(PrevDist + Weight, MaxStoredDistance) == Candidate.Dist;
+        }
+        if (bStillSupported) continue;
+
+        IsAffected[Current] = true;
+        Affected.Add(Current);
+        for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+        {
+            if (WasSupported(Current, Dir)) Enqueue(Current + Offsets[Dir]);
+        }
+    }
+
+    for (int32 Index : Affected)
+    {
+        TableAt(bBackward, Index, Slot) = Unreachable;
+    }
+
+    // 2. Offer new distances: invalidated tiles from their neighbors, and every edge around V (covers cheaper costs)
+    TArray<FDistEntry> Heap;
+    auto Offer = [&](int32 Index, int32 NewDist)
+    {
+        if (NewDist < Dist(Index))
+        {
+            TableAt(bBackward, Index, Slot) = (uint16)FMath::Min(NewDist, MaxStoredDistance);
+            Heap.HeapPush({ NewDist, Index }, FDistLess());
+        }
+    };
+    auto OfferEdges = [&](int32 From)
+    {
+        const int32 FromDist = Dist(From);
+        if (FromDist == MAX_int32) return;
+        const int32* Offsets = GetOffsets<Traits>(From);
+        for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+        {
+            const int32 Weight = EdgeWeight<Traits>(From, Dir, bBackward);
+            if (Weight >= 0) Offer(From + Offsets[Dir], FromDist + Weight);
+        }
+    };
+
+    for (int32 Index : Affected)
+    {
+        const int32* Offsets = GetOffsets<Traits>(Index);
+        for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+        {
+            const int32 Weight = EdgeWeight<Traits>(Index, Dir, !bBackward);
+            const int32 PrevDist = Weight >= 0 ? Dist(Index + Offsets[Dir]) : MAX_int32;
+            if (PrevDist != MAX_int32) Offer(Index, PrevDist + Weight);
+        }
+    }
+    for (int32 From : Neighborhood)
+    {
+        OfferEdges(From);
+    }
+
+    // 3. Dijkstra outward from everything offered
+    while (Heap.Num() > 0)
+    {
+        FDistEntry Entry;
+        Heap.HeapPop(Entry, FDistLess(), false);
+        if (FMath::Min(Entry.Dist, MaxStoredDistance) != Dist(Entry.Index)) continue;
+        OfferEdges(Entry.Index);
+    }
+}
+
+void FGridPathfinder::LoadGoal(int32 Goal, FGridPathScratch& S) const
+{
+    S.GoalForward.Reset();
+    S.GoalBackward.Reset();
+    if (!bUseLandmarks || Landmarks.Num() == 0) return;
+
+    const int32 NumLandmarks = Landmarks.Num();
+    for (int32 Slot = 0; Slot < NumLandmarks; ++Slot)
+    {
+        const uint16 ToGoal = Forward[Goal * NumLandmarks + Slot];
+        const uint16 FromGoal = Backward[Goal * NumLandmarks + Slot];
+        S.GoalForward.Add(ToGoal == Unreachable ? INDEX_NONE : ToGoal);
+        S.GoalBackward.Add(FromGoal == Unreachable ? INDEX_NONE : FromGoal);
+    }
+}
+
+template <typename Traits>
+int32 FGridPathfinder::EstimateToLoadedGoal(int32 Padded, int32 Goal, const FGridPathScratch& S) const
+{
+    const int32 X = Padded % PaddedWidth - 1;
+    const int32 Y = Padded / PaddedWidth - 1;
+    const int32 GoalX = Goal % PaddedWidth - 1;
+    const int32 GoalY = Goal / PaddedWidth - 1;
+    int32 Estimate = Traits::Distance(X, Y, GoalX, GoalY) * MinCost;
+
+    // d(n, g) >= d(L, g) - d(L, n) and d(n, g) >= d(n, L) - d(g, L)
+    const TArray<int32>& GoalForward = S.GoalForward;
+    const TArray<int32>& GoalBackward = S.GoalBackward;
+    const int32 NumLandmarks = GoalForward.Num();
+    if (NumLandmarks > 0)
+    {
+        const uint16* NodeForward = Forward.GetData() + Padded * NumLandmarks;
+        const uint16* NodeBackward = Backward.GetData() + Padded * NumLandmarks;
+        for (int32 Slot = 0; Slot < NumLandmarks; ++Slot)
+        {
+            if (GoalForward[Slot] >= 0 && NodeForward[Slot] != Unreachable)
+            {
+                Estimate = FMath::Max(Estimate, GoalForward[Slot] - (int32)NodeForward[Slot]);
+            }
+            if (GoalBackward[Slot] >= 0 && NodeBackward[Slot] != Unreachable)
+            {
+                Estimate = FMath::Max(Estimate, (int32)NodeBackward[Slot] - GoalBackward[Slot]);
+            }
+        }
+    }
+    return Estimate;
+}
+
+int32 FGridPathfinder::EstimateCost(int32 Index, int32 Goal) const
+{
+    if (!IsValidTile(Index) || !IsValidTile(Goal)) return 0;
+    const int32 PaddedGoal = ToPadded(Goal);
+    LoadGoal(PaddedGoal, Scratch);
+    return Dispatch([&](auto Traits) { return EstimateToLoadedGoal<decltype(Traits)>(ToPadded(Index), PaddedGoal, Scratch); });
+}
+
+void FGridPathfinder::BeginSearch(FGridPathScratch& S) const
+{
+    if (S.VisitStamp.Num() != Costs.Num())
+    {
+        S.GScore.Init(0, Costs.Num());
+        S.Parent.Init(INDEX_NONE, Costs.Num());
+        S.VisitStamp.Init(0, Costs.Num());
+        S.ClosedStamp.Init(0, Costs.Num());
+        S.SearchStamp = 0;
+    }
+
+    // Stamps stand in for clearing per-tile state between queries
+    if (++S.SearchStamp == 0)
+    {
+        S.VisitStamp.Init(0, Costs.Num());
+        S.ClosedStamp.Init(0, Costs.Num());
+        S.SearchStamp = 1;
+    }
+}
+
+bool FGridPathfinder::FindPath(int32 Start, int32 Goal, const FGridOccupancy* Occupancy, FGridPath& OutPath, FGridPathScratch& InScratch, FGridPathStats* OutStats, int32 MaxExpanded) const
+{
+    OutPath.Reset();
+    if (OutStats) *OutStats = FGridPathStats();
+    if (!IsValidTile(Start) || !IsValidTile(Goal) || Start == Goal) return false;
+
+    return Dispatch([&](auto Traits)
+    {
+        return FindPathImpl<decltype(Traits)>(ToPadded(Start), ToPadded(Goal), Occupancy, OutPath, InScratch, OutStats, MaxExpanded);
+    });
+}
+
+template <typename Traits>
+bool FGridPathfinder::FindPathImpl(int32 Start, int32 Goal, const FGridOccupancy* Occupancy, FGridPath& OutPath, FGridPathScratch& S, FGridPathStats* OutStats, int32 MaxExpanded) const
+{
+    if (Costs[Goal] < 0) return false;
+
+    BeginSearch(S);
+    LoadGoal(Goal, S);
+
+    TGridPagedArray<int32>& GScore = S.GScore;
+    TGridPagedArray<int32>& Parent = S.Parent;
+    TGridPagedArray<uint32>& VisitStamp = S.VisitStamp;
+    TGridPagedArray<uint32>& ClosedStamp = S.ClosedStamp;
+    TArray<FOpenEntry>& OpenHeap = S.OpenHeap;
+    const uint32 SearchStamp = S.SearchStamp;
+
+    OpenHeap.Reset();
+    GScore.Set(Start, 0);
+    Parent.Set(Start, INDEX_NONE);
+    VisitStamp.Set(Start, SearchStamp);
+    const int32 StartEstimate = EstimateToLoadedGoal<Traits>(Start, Goal, S);
+    OpenHeap.HeapPush({ StartEstimate, StartEstimate, Start }, FOpenLess());
+
+    int32 Expanded = 0;
+    bool bFound = false;
+    bool bOutOfBudget = false;
+    while (OpenHeap.Num() > 0)
+    {
+        FOpenEntry Current;
+        OpenHeap.HeapPop(Current, FOpenLess(), false);
+        if (ClosedStamp[Current.Index] == SearchStamp) continue;
+        ClosedStamp.Set(Current.Index, SearchStamp);
+        ++Expanded;
+
+        if (Current.Index == Goal)
+        {
+            bFound = true;
+            break;
+        }
+        if (Expanded >= MaxExpanded)
+        {
+            bOutOfBudget = true;
+            break;
+        }
+
+        const int32 CurrentG = GScore[Current.Index];
+        const int32* Offsets = GetOffsets<Traits>(Current.Index);
+        for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+        {
+            const int32 Next = Current.Index + Offsets[Dir];
+            const int32 Weight = EdgeWeight<Traits>(Current.Index, Dir, false);
+            if (Weight < 0 || ClosedStamp[Next] == SearchStamp) continue;
+
+            // Skip if occupied (unless it's the destination)
+            if (Next != Goal && Occupancy && Occupancy->IsOccupied(Next % PaddedWidth - 1, Next / PaddedWidth - 1)) continue;
+
+            // A path too long to count in int32 is treated as no path
+            const int32 NewG = AddCost(CurrentG, Weight);
+            if (NewG == MAX_int32) continue;
+            if (VisitStamp[Next] == SearchStamp && NewG >= GScore[Next]) continue;
+
+            VisitStamp.Set(Next, SearchStamp);
+            GScore.Set(Next, NewG);
+            Parent.Set(Next, Current.Index);
+            const int32 Estimate = EstimateToLoadedGoal<Traits>(Next, Goal, S);
+            OpenHeap.HeapPush({ AddCost(NewG, Estimate), Estimate, Next }, FOpenLess());
+        }
+    }
+
+    if (OutStats)
+    {
+        OutStats->NodesExpanded = Expanded;
+        OutStats->PathCost = bFound ? GScore[Goal] : 0;
+        OutStats->bOutOfBudget = bOutOfBudget;
+    }
+    if (!bFound) return false;
+
+    // Measure the parent chain, then fill it back to front (no inserts or reversal)
+    int32 Length = 0;
+    for (int32 Index = Goal; Index != INDEX_NONE; Index = Parent[Index])
+    {
+        ++Length;
+    }
+    OutPath.Steps.SetNumUninitialized(Length);
+    OutPath.CostScale = Traits::CostScale;
+    for (int32 Index = Goal; Index != INDEX_NONE; Index = Parent[Index])
+    {
+        OutPath.Steps[--Length] = { FromPadded(Index), GScore[Index] };
+    }
+    return true;
+}
+
+void FGridPathfinder::GetReachableTiles(int32 Start, int32 MaxCost, const FGridOccupancy* Occupancy, TArray<int32>& OutTiles, FGridPathScratch& InScratch, TArray<int32>* OutCosts) const
+{
+    OutTiles.Reset();
+    if (OutCosts) OutCosts->Reset();
+    if (!IsValidTile(Start) || MaxCost < 0) return;
+
+    Dispatch([&](auto Traits)
+    {
+        GetReachableImpl<decltype(Traits)>(ToPadded(Start), MaxCost, Occupancy, OutTiles, InScratch, OutCosts);
+    });
+}
+
+template <typename Traits>
+void FGridPathfinder::GetReachableImpl(int32 Start, int32 MaxCost, const FGridOccupancy* Occupancy, TArray<int32>& OutTiles, FGridPathScratch& S, TArray<int32>* OutCosts) const
+{
+    BeginSearch(S);
+
+    TGridPagedArray<int32>& GScore = S.GScore;
+    TGridPagedArray<uint32>& VisitStamp = S.VisitStamp;
+    TGridPagedArray<uint32>& ClosedStamp = S.ClosedStamp;
+    TArray<FOpenEntry>& OpenHeap = S.OpenHeap;
+    const uint32 SearchStamp = S.SearchStamp;
+
+    // Kept below MAX_int32, which the saturating sums reserve for "too far"
+    const int32 Budget = (int32)FMath::Min<int64>((int64)MaxCost * Traits::CostScale, MAX_int32 - 1);
+    OpenHeap.Reset();
+    GScore.Set(Start, 0);
+    VisitStamp.Set(Start, SearchStamp);
+    OpenHeap.HeapPush({ 0, 0, Start }, FOpenLess());
+
+    // Dijkstra bounded by the budget
+    while (OpenHeap.Num() > 0)
+    {
+        FOpenEntry Current;
+        OpenHeap.HeapPop(Current, FOpenLess(), false);
+        if (ClosedStamp[Current.Index] == SearchStamp) continue;
+        ClosedStamp.Set(Current.Index, SearchStamp);
+
+        if (Current.Index != Start)
+        {
+            OutTiles.Add(FromPadded(Current.Index));
+            if (OutCosts) OutCosts->Add(Current.F);
+        }
+
+        const int32* Offsets = GetOffsets<Traits>(Current.Index);
+        for (int32 Dir = 0; Dir < Traits::NumDirections; ++Dir)
+        {
+            const int32 Next = Current.Index + Offsets[Dir];
+            const int32 Weight = EdgeWeight<Traits>(Current.Index, Dir, false);
+            if (Weight < 0 || ClosedStamp[Next] == SearchStamp) continue;
+
+            const int32 NewG = AddCost(Current.F, Weight);
+            if (NewG > Budget) continue;
+            if (VisitStamp[Next] == SearchStamp && NewG >= GScore[Next]) continue;
+            if (Occupancy && Occupancy->IsOccupied(Next % PaddedWidth - 1, Next / PaddedWidth - 1)) continue;
+
+            VisitStamp.Set(Next, SearchStamp);
+            GScore.Set(Next, NewG);
+            OpenHeap.HeapPush({ NewG, 0, Next }, FOpenLess());
+        }
+    }
+}
+
+SIZE_T FGridPathfinder::GetAllocatedSize() const
+{
+    return Costs.GetAllocatedSize() + Landmarks.GetAllocatedSize() + Forward.GetAllocatedSize() + Backward.GetAllocatedSize()
+        + DeferredOldCosts.GetAllocatedSize() + Build.Picks.GetAllocatedSize() + Build.MinDist.GetAllocatedSize();
+}
+
+namespace
+{
+    constexpr int32 BenchSize = 128;
+
+    void BuildOpenMap(FGridPathfinder& Nav, FRandomStream& Random, EGridConnectivity Connectivity = EGridConnectivity::Square4)
+    {
+        Nav.Init(BenchSize, BenchSize, Connectivity);
+        for (int32 Index = 0; Index < BenchSize * BenchSize; ++Index)
+        {
+            Nav.SetTileCost(Index, Random.FRand() < 0.05f ? FGridPathfinder::Blocked : 1);
+        }
+    }
+
+    // Perfect maze on odd coordinates, carved by iterative depth-first search
+    void BuildMazeMap(FGridPathfinder& Nav, FRandomStream& Random)
+    {
+        Nav.Init(BenchSize, BenchSize);
+        const int32 Cells = (BenchSize - 1) / 2;
+        TArray<int32> Stack;
+        TBitArray<> Visited(false, Cells * Cells);
+        Stack.Add(0);
+        Visited[0] = true;
+        Nav.SetTileCost(BenchSize + 1, 1);
+        while (Stack.Num() > 0)
+        {
+            const int32 Cell = Stack.Last();
+            const int32 CX = Cell % Cells;
+            const int32 CY = Cell / Cells;
+
+            int32 Options[4];
+            int32 NumOptions = 0;
+            if (CX > 0 && !Visited[Cell - 1]) Options[NumOptions++] = Cell - 1;
+            if (CX < Cells - 1 && !Visited[Cell + 1]) Options[NumOptions++] = Cell + 1;
+            if (CY > 0 && !Visited[Cell - Cells]) Options[NumOptions++] = Cell - Cells;
+            if (CY < Cells - 1 && !Visited[Cell + Cells]) Options[NumOptions++] = Cell + Cells;
+            if (NumOptions == 0)
+            {
+                Stack.Pop(false);
+                continue;
+            }
+
+            const int32 Next = Options[Random.RandHelper(NumOptions)];
+            const int32 NX = Next % Cells;
+            const int32 NY = Next / Cells;
+            Visited[Next] = true;
+            Stack.Add(Next);
+
+            // Open the target cell and the wall between
+            Nav.SetTileCost((2 * NY + 1) * BenchSize + 2 * NX + 1, 1);
+            Nav.SetTileCost((CY + NY + 1) * BenchSize + CX + NX + 1, 1);
+        }
+    }
+
+    // Open field split by a wide river with a single bridge near one end
+    void BuildRiverMap(FGridPathfinder& Nav, FRandomStream& Random)
+    {
+        BuildOpenMap(Nav, Random);
+        for (int32 Y = 0; Y < BenchSize; ++Y)
+        {
+            const int32 Bend = FMath::RoundToInt(6.0f * FMath::Sin(Y * 0.1f));
+            for (int32 X = BenchSize / 2 - 2 + Bend; X <= BenchSize / 2 + 2 + Bend; ++X)
+            {
+                Nav.SetTileCost(Y * BenchSize + X, Y >= 4 && Y <= 6 ? 2 : FGridPathfinder::Blocked);
+            }
+        }
+    }
+
+    void RunLandmarkBenchmark()
+    {
+        constexpr int32 NumQueries = 200;
+        constexpr int32 NumLandmarks = 8;
+        constexpr int32 NumEdits = 100;
+
+        struct FMapCase
+        {
+            const TCHAR* Name;
+            void (*Build)(FGridPathfinder&, FRandomStream&);
+        };
+        const FMapCase Maps[] = {
+            { TEXT("open"), [](FGridPathfinder& Nav, FRandomStream& Random) { BuildOpenMap(Nav, Random); } },
+            { TEXT("maze"), &BuildMazeMap },
+            { TEXT("river"), &BuildRiverMap } };
+
+        for (const FMapCase& Map : Maps)
+        {
+            FRandomStream Random(1234);
+            FGridPathfinder Nav;
+            Map.Build(Nav, Random);
+
+            double StartTime = FPlatformTime::Seconds();
+            Nav.BuildLandmarks(NumLandmarks);
+            const double BuildMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+            TArray<int32> Walkable;
+            for (int32 Index = 0; Index < Nav.NumTiles(); ++Index)
+            {
+                if (Nav.GetTileCost(Index) >= 0) Walkable.Add(Index);
+            }
+
+            FGridPath Path;
+            FGridPathStats Stats;
+            int64 ExpandedManhattan = 0;
+            int64 ExpandedLandmarks = 0;
+            double ManhattanMs = 0.0;
+            double LandmarkMs = 0.0;
+            int32 CostMismatches = 0;
+            for (int32 Query = 0; Query < NumQueries; ++Query)
+            {
+                const int32 Start = Walkable[Random.RandHelper(Walkable.Num())];
+                const int32 Goal = Walkable[Random.RandHelper(Walkable.Num())];
+
+                Nav.bUseLandmarks = false;
+                StartTime = FPlatformTime::Seconds();
+                Nav.FindPath(Start, Goal, nullptr, Path, &Stats);
+                ManhattanMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+                ExpandedManhattan += Stats.NodesExpanded;
+                const int32 ManhattanCost = Stats.PathCost;
+
+                Nav.bUseLandmarks = true;
+                StartTime = FPlatformTime::Seconds();
+                Nav.FindPath(Start, Goal, nullptr, Path, &Stats);
+                LandmarkMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+                ExpandedLandmarks += Stats.NodesExpanded;
+                CostMismatches += Stats.PathCost != ManhattanCost ? 1 : 0;
+            }
+
+            // Incremental repair after single-tile edits, checked against a rebuild from scratch
+            StartTime = FPlatformTime::Seconds();
+            for (int32 Edit = 0; Edit < NumEdits; ++Edit)
+            {
+                const int32 Index = Walkable[Random.RandHelper(Walkable.Num())];
+                Nav.SetTileCost(Index, Nav.GetTileCost(Index) < 0 ? 1 : FGridPathfinder::Blocked);
+            }
+            const double RepairMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumEdits;
+
+            const int32 RepairErrors = Nav.CountStaleLandmarkEntries();
+
+            UE_LOG(LogTemp, Display, TEXT("Landmarks %-5s %dx%d: nodes expanded Manhattan %lld vs ALT %lld (%.1fx), search %.2f ms vs %.2f ms, build %.2f ms, repair %.3f ms/edit, cost mismatches %d, repair errors %d"),
+                Map.Name, BenchSize, BenchSize, ExpandedManhattan / NumQueries, ExpandedLandmarks / NumQueries,
+                ExpandedLandmarks > 0 ? (double)ExpandedManhattan / ExpandedLandmarks : 0.0,
+                ManhattanMs / NumQueries, LandmarkMs / NumQueries, BuildMs, RepairMs, CostMismatches, RepairErrors);
+        }
+    }
+
+    // Search and reachability cost of each connectivity on the same open map
+    void RunConnectivityBenchmark()
+    {
+        constexpr int32 NumQueries = 500;
+        constexpr int32 MoveBudget = 8;
+
+        struct FConnectivityCase
+        {
+            const TCHAR* Name;
+            EGridConnectivity Connectivity;
+        };
+        const FConnectivityCase Cases[] = {
+            { TEXT("square4"), EGridConnectivity::Square4 },
+            { TEXT("square8"), EGridConnectivity::Square8 },
+            { TEXT("hex6"), EGridConnectivity::Hex6 } };
+
+        for (const FConnectivityCase& Case : Cases)
+        {
+            FRandomStream Random(1234);
+            FGridPathfinder Nav;
+            BuildOpenMap(Nav, Random, Case.Connectivity);
+            Nav.bUseLandmarks = false;
+
+            TArray<int32> Walkable;
+            for (int32 Index = 0; Index < Nav.NumTiles(); ++Index)
+            {
+                if (Nav.GetTileCost(Index) >= 0) Walkable.Add(Index);
+            }
+
+            FGridPath Path;
+            TArray<int32> ReachableTiles;
+            FGridPathStats Stats;
+            int64 Expanded = 0;
+            int64 Reachable = 0;
+            double SearchMs = 0.0;
+            double ReachMs = 0.0;
+            for (int32 Query = 0; Query < NumQueries; ++Query)
+            {
+                const int32 Start = Walkable[Random.RandHelper(Walkable.Num())];
+                const int32 Goal = Walkable[Random.RandHelper(Walkable.Num())];
+
+                double StartTime = FPlatformTime::Seconds();
+                Nav.FindPath(Start, Goal, nullptr, Path, &Stats);
+                SearchMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+                Expanded += Stats.NodesExpanded;
+
+                StartTime = FPlatformTime::Seconds();
+                Nav.GetReachableTiles(Start, MoveBudget, nullptr, ReachableTiles);
+                ReachMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+                Reachable += ReachableTiles.Num();
+            }
+
+            UE_LOG(LogTemp, Display, TEXT("Connectivity %-7s %dx%d: FindPath %.3f ms (%lld nodes), reachable within %d: %.3f ms (%lld tiles)"),
+                Case.Name, BenchSize, BenchSize, SearchMs / NumQueries, Expanded / NumQueries, MoveBudget, ReachMs / NumQueries, Reachable / NumQueries);
+        }
+    }
+
+    FAutoConsoleCommand ConnectivityBenchmarkCommand(
+        TEXT("tb.Bench.Connectivity"),
+        TEXT("Time FindPath and reachability queries on 4-, 8- and 6-connected 128x128 maps"),
+        FConsoleCommandDelegate::CreateStatic(&RunConnectivityBenchmark));
+
+    FAutoConsoleCommand LandmarkBenchmarkCommand(
+        TEXT("tb.Bench.Landmarks"),
+        TEXT("Compare nodes expanded by A* with Manhattan vs landmark (ALT) heuristics on open, maze and river maps"),
+        FConsoleCommandDelegate::CreateStatic(&RunLandmarkBenchmark));
+}
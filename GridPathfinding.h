@@ -0,0 +1,427 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPagedArray.h"
+#include "GridPathfinding.generated.h"
+
+class FGridOccupancy;
+
+// How tiles connect to their neighbors
+UENUM(BlueprintType)
+enum class EGridConnectivity : uint8
+{
+    // Orthogonal moves only
+    Square4,
+    // Orthogonal and diagonal moves (octile costs, no cutting past blocked corners)
+    Square8,
+    // Hex grid in odd-r offset layout (odd rows shifted right by half a tile)
+    Hex6
+};
+
+// Compile-time description of a connectivity. Square directions are W, E, N, S, then NW, NE, SW, SE for Square8;
+// hex directions are W, E, NW, NE, SW, SE. Search costs are tile entry cost times Weight(Dir).
+struct FSquare4Connectivity
+{
+    static constexpr int32 NumDirections = 4;
+    static constexpr bool bDiagonals = false;
+    static constexpr bool bRowParity = false;
+    static constexpr int32 CostScale = 1;
+
+    static constexpr int32 Weight(int32 Dir) { return 1; }
+
+    static int32 Distance(int32 X0, int32 Y0, int32 X1, int32 Y1)
+    {
+        return FMath::Abs(X1 - X0) + FMath::Abs(Y1 - Y0);
+    }
+};
+
+struct FSquare8Connectivity
+{
+    static constexpr int32 NumDirections = 8;
+    static constexpr bool bDiagonals = true;
+    static constexpr bool bRowParity = false;
+
+    // Straight 5, diagonal 7 (7 / 5 = 1.4, close to sqrt(2))
+    static constexpr int32 CostScale = 5;
+
+    static constexpr int32 Weight(int32 Dir) { return Dir < 4 ? 5 : 7; }
+
+    static int32 Distance(int32 X0, int32 Y0, int32 X1, int32 Y1)
+    {
+        const int32 DX = FMath::Abs(X1 - X0);
+        const int32 DY = FMath::Abs(Y1 - Y0);
+        return 5 * FMath::Abs(DX - DY) + 7 * FMath::Min(DX, DY);
+    }
+};
+
+struct FHex6Connectivity
+{
+    static constexpr int32 NumDirections = 6;
+    static constexpr bool bDiagonals = false;
+    static constexpr bool bRowParity = true;
+    static constexpr int32 CostScale = 1;
+
+    static constexpr int32 Weight(int32 Dir) { return 1; }
+
+    static int32 Distance(int32 X0, int32 Y0, int32 X1, int32 Y1)
+    {
+        // Odd-r offset to axial
+        const int32 Q0 = X0 - (Y0 - (Y0 & 1)) / 2;
+        const int32 Q1 = X1 - (Y1 - (Y1 & 1)) / 2;
+        const int32 DQ = Q1 - Q0;
+        const int32 DR = Y1 - Y0;
+        return (FMath::Abs(DQ) + FMath::Abs(DR) + FMath::Abs(DQ + DR)) / 2;
+    }
+};
+
+// Counters from one search, for benchmarks and tuning
+struct FGridPathStats
+{
+    int32 NodesExpanded = 0;
+    int32 PathCost = 0;
+
+    // The search hit its MaxExpanded budget before reaching the goal or running out of tiles
+    bool bOutOfBudget = false;
+};
+
+// One path step: a tile index and the search cost of reaching it from the start
+struct FGridPathStep
+{
+    int32 TileIndex = INDEX_NONE;
+    int32 CumulativeCost = 0;
+};
+
+// Compact path result, start (cost 0) to goal. FindPath overwrites it in place and Reset keeps the
+// allocation, so one instance can serve as the output buffer for every query.
+struct FGridPath
+{
+    TArray<FGridPathStep> Steps;
+
+    // Search cost units per movement point (FGridPathfinder::GetCostScale of the search that wrote it)
+    int32 CostScale = 1;
+
+    void Reset()
+    {
+        Steps.Reset();
+        CostScale = 1;
+    }
+
+    int32 Num() const { return Steps.Num(); }
+
+    // Start plus at least one step
+    bool IsMove() const { return Steps.Num() >= 2; }
+
+    int32 GetStart() const { return Steps.Num() ? Steps[0].TileIndex : INDEX_NONE; }
+    int32 GetGoal() const { return Steps.Num() ? Steps.Last().TileIndex : INDEX_NONE; }
+    int32 GetTotalCost() const { return Steps.Num() ? Steps.Last().CumulativeCost : 0; }
+
+    // Movement points needed to walk the path (search cost rounded up to whole points)
+    int32 GetMovementCost() const { return FMath::DivideAndRoundUp(GetTotalCost(), FMath::Max(1, CostScale)); }
+
+    // Calls Fn(TileIndex) for every step, start first
+    template <typename FuncType>
+    void ForEachTile(FuncType&& Fn) const
+    {
+        for (const FGridPathStep& Step : Steps) Fn(Step.TileIndex);
+    }
+};
+
+// Working memory of one search. FGridPathfinder keeps one for its own queries; code that shares a pathfinder
+// between threads passes its own (one per thread or per match), which makes the const queries safe to run concurrently.
+struct FGridPathScratch
+{
+    struct FOpenEntry
+    {
+        int32 F;
+        int32 H;
+        int32 Index;
+    };
+
+    // Per padded tile, paged: only the pages searches have touched hold memory
+    TGridPagedArray<int32> GScore;
+    TGridPagedArray<int32> Parent;
+    TGridPagedArray<uint32> VisitStamp;
+    TGridPagedArray<uint32> ClosedStamp;
+    TArray<FOpenEntry> OpenHeap;
+    uint32 SearchStamp = 0;
+
+    // Landmark distances of the current goal
+    TArray<int32> GoalForward;
+    TArray<int32> GoalBackward;
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return GScore.GetAllocatedSize() + Parent.GetAllocatedSize() + VisitStamp.GetAllocatedSize() + ClosedStamp.GetAllocatedSize()
+            + OpenHeap.GetAllocatedSize() + GoalForward.GetAllocatedSize() + GoalBackward.GetAllocatedSize();
+    }
+};
+
+// Index-based A* over a snapshot of the grid's terrain: it sees only the costs written through SetTileCost(Deferred),
+// so edits made straight to tile actors stay invisible until the owner re-reads them (AGridManager::RebuildNavigation).
+// Path sums saturate at MAX_int32 rather than wrapping; a path too long to count is reported as none. The public API takes tile indices (Y * Width + X);
+// internally the grid carries a one-tile blocked border so neighbor offsets never need bounds checks, and
+// every search loop is instantiated per connectivity so the direction loop is fixed-length and unrolled.
+// Each tile stores the cost to enter it, or Blocked. Optionally keeps ALT landmark tables
+// (exact distances from and to a few landmarks, uint16 per tile) whose triangle-inequality bound
+// is a far better heuristic than plain grid distance on mazes and maps with long detours.
+class DENEME_API FGridPathfinder
+{
+public:
+    static constexpr int32 Blocked = -1;
+
+    // Tile costs are clamped to this, so one edge (cost times the largest octile weight) always fits in int32
+    static constexpr int32 MaxTileCost = 1 << 20;
+
+    void Init(int32 InWidth, int32 InHeight, EGridConnectivity InConnectivity = EGridConnectivity::Square4);
+
+    int32 GetWidth() const { return Width; }
+    int32 GetHeight() const { return Height; }
+    int32 NumTiles() const { return Width * Height; }
+    EGridConnectivity GetConnectivity() const { return Connectivity; }
+
+    // Search costs are tile costs times this (octile weights); divide path costs by it for movement points
+    int32 GetCostScale() const;
+
+    // Change one tile's entry cost (Blocked for unwalkable, at most MaxTileCost); landmark tables are repaired locally
+    void SetTileCost(int32 TileIndex, int32 Cost);
+    int32 GetTileCost(int32 TileIndex) const;
+
+    // Batched edits: change the cost now and leave the landmark tables to FlushTileCosts, which repairs them tile by
+    // tile for a few changed tiles and recomputes them once for many. Searches in between may return longer paths.
+    void SetTileCostDeferred(int32 TileIndex, int32 Cost);
+    void FlushTileCosts();
+
+    static constexpr int32 MaxLandmarks = 32;
+
+    // Pick NumLandmarks landmarks by farthest-point selection and compute their distance tables
+    void BuildLandmarks(int32 NumLandmarks);
+    void ClearLandmarks();
+    int32 GetNumLandmarks() const { return Landmarks.Num(); }
+
+    // Time-sliced BuildLandmarks: BeginBuildLandmarks, then StepBuildLandmarks (one full-grid Dijkstra per call) until
+    // it returns true. Landmarks appear once all are chosen and their tables fill in one per step; a table not computed
+    // yet holds only Unreachable, which the estimate skips, so searches in between stay correct.
+    void BeginBuildLandmarks(int32 NumLandmarks);
+    bool StepBuildLandmarks();
+    bool IsBuildingLandmarks() const { return Build.NumLandmarks > 0; }
+
+    // Upper bound on the StepBuildLandmarks calls of a build
+    static int32 GetLandmarkBuildSteps(int32 NumLandmarks) { return 1 + 3 * FMath::Clamp(NumLandmarks, 0, MaxLandmarks); }
+
+    // Use the landmark bound when tables exist (otherwise grid distance times the cheapest tile cost)
+    bool bUseLandmarks = true;
+
+    // A* from Start to Goal. Tiles occupied in Occupancy are impassable except Goal.
+    // OutPath receives the steps from Start to Goal inclusive (reusing its allocation); returns false if there is no path,
+    // or if MaxExpanded tiles were expanded without reaching Goal (OutStats->bOutOfBudget tells the two apart).
+    bool FindPath(int32 Start, int32 Goal, const FGridOccupancy* Occupancy, FGridPath& OutPath, FGridPathStats* OutStats = nullptr, int32 MaxExpanded = MAX_int32) const
+    {
+        return FindPath(Start, Goal, Occupancy, OutPath, Scratch, OutStats, MaxExpanded);
+    }
+
+    // Same, searching in caller-owned scratch instead of the pathfinder's own
+    bool FindPath(int32 Start, int32 Goal, const FGridOccupancy* Occupancy, FGridPath& OutPath, FGridPathScratch& InScratch, FGridPathStats* OutStats = nullptr, int32 MaxExpanded = MAX_int32) const;
+
+    // Every tile reachable from Start for at most MaxCost (in tile cost units), not counting Start.
+    // Occupied tiles are impassable. OutCosts, if given, receives the search cost to reach each tile.
+    void GetReachableTiles(int32 Start, int32 MaxCost, const FGridOccupancy* Occupancy, TArray<int32>& OutTiles, TArray<int32>* OutCosts = nullptr) const
+    {
+        GetReachableTiles(Start, MaxCost, Occupancy, OutTiles, Scratch, OutCosts);
+    }
+
+    void GetReachableTiles(int32 Start, int32 MaxCost, const FGridOccupancy* Occupancy, TArray<int32>& OutTiles, FGridPathScratch& InScratch, TArray<int32>* OutCosts = nullptr) const;
+
+    // Search cost from Root to every tile, or with bBackward from every tile to Root, ignoring units. OutCosts is per
+    // tile index, MAX_int32 where there is no path. For precomputing costs between fixed points such as portals.
+    void ComputeCostField(int32 Root, bool bBackward, TArray<int32>& OutCosts) const;
+
+    // Calls Fn(NeighborTileIndex) for each walkable neighbor a unit on TileIndex could step to
+    template <typename FuncType>
+    void ForEachWalkableNeighbor(int32 TileIndex, FuncType&& Fn) const
+    {
+        ForEachWalkableEdge(TileIndex, [&Fn](int32 Neighbor, int32 Weight) { Fn(Neighbor); });
+    }
+
+    // Same with the search cost of the step (entry cost times the direction weight), for searches built on top
+    template <typename FuncType>
+    void ForEachWalkableEdge(int32 TileIndex, FuncType&& Fn) const;
+
+    // Debug check: number of landmark table entries that differ from a recomputation from scratch
+    int32 CountStaleLandmarkEntries() const;
+
+    // Admissible estimate of the cost from Index to Goal (uses the pathfinder's own scratch)
+    int32 EstimateCost(int32 Index, int32 Goal) const;
+
+    // Bytes held by cost and landmark tables
+    SIZE_T GetAllocatedSize() const;
+
+    // Bytes held by the pathfinder's own search scratch (grows to the largest search so far)
+    SIZE_T GetScratchAllocatedSize() const { return Scratch.GetAllocatedSize(); }
+
+private:
+    static constexpr uint16 Unreachable = 0xFFFF;
+    static constexpr int32 MaxStoredDistance = 0xFFFE;
+
+    // Above this many deferred tiles FlushTileCosts recomputes the tables instead of repairing them tile by tile
+    static constexpr int32 MaxRepairedTiles = 32;
+
+    // Tile index <-> bordered index
+    int32 ToPadded(int32 TileIndex) const { return (TileIndex / Width + 1) * PaddedWidth + TileIndex % Width + 1; }
+    int32 FromPadded(int32 Padded) const { return (Padded / PaddedWidth - 1) * Width + Padded % PaddedWidth - 1; }
+    bool IsValidTile(int32 TileIndex) const { return TileIndex >= 0 && TileIndex < Width * Height; }
+
+    // Runs Fn(ConnectivityTraits()) for the active connectivity
+    template <typename FuncType>
+    decltype(auto) Dispatch(FuncType&& Fn) const;
+
+    // Offsets of the active connectivity for the row holding Padded (hex offsets alternate by row)
+    template <typename Traits>
+    const int32* GetOffsets(int32 Padded) const
+    {
+        return NeighborOffsets[Traits::bRowParity ? ((Padded / PaddedWidth - 1) & 1) : 0];
+    }
+
+    // Weight of the search-graph edge leaving From in direction Dir, or Blocked. Forward edges cost entering the
+    // target; the backward graph is reversed, so it costs entering the source. CostOf(PaddedIndex) supplies tile
+    // costs, which lets landmark repair evaluate edges with a tile's previous cost.
+    template <typename Traits, typename CostFuncType>
+    int32 EdgeWeight(int32 From, int32 Dir, bool bBackward, CostFuncType&& CostOf) const;
+
+    template <typename Traits>
+    int32 EdgeWeight(int32 From, int32 Dir, bool bBackward) const
+    {
+        return EdgeWeight<Traits>(From, Dir, bBackward, [this](int32 Index) { return Costs[Index]; });
+    }
+
+    template <typename Traits>
+    bool FindPathImpl(int32 Start, int32 Goal, const FGridOccupancy* Occupancy, FGridPath& OutPath, FGridPathScratch& S, FGridPathStats* OutStats, int32 MaxExpanded) const;
+
+    template <typename Traits>
+    void GetReachableImpl(int32 Start, int32 MaxCost, const FGridOccupancy* Occupancy, TArray<int32>& OutTiles, FGridPathScratch& S, TArray<int32>* OutCosts) const;
+
+    // Size S for this grid if needed and start a new search stamp
+    void BeginSearch(FGridPathScratch& S) const;
+
+    // Dijkstra from Root over the forward graph, or over the reversed graph (cost to reach Root)
+    template <typename Traits>
+    void ComputeDistances(int32 Root, bool bBackward, TArray<int32>& OutDist) const;
+
+    // Bring one table up to date after tile V changed from OldCost to its current cost
+    template <typename Traits>
+    void RepairTable(int32 Slot, bool bBackward, int32 V, int32 OldCost);
+
+    // Distance table for one landmark: forward = cost from the landmark, backward = cost to it
+    void ComputeTable(int32 Slot, bool bBackward);
+
+    uint16& TableAt(bool bBackward, int32 Padded, int32 Slot)
+    {
+        return (bBackward ? Backward : Forward)[Padded * Landmarks.Num() + Slot];
+    }
+
+    // Cache the goal's landmark distances for the estimates of one search
+    void LoadGoal(int32 Goal, FGridPathScratch& S) const;
+
+    // Estimate using the distances cached by LoadGoal (padded indices)
+    template <typename Traits>
+    int32 EstimateToLoadedGoal(int32 Padded, int32 Goal, const FGridPathScratch& S) const;
+
+    int32 Width = 0;
+    int32 Height = 0;
+    int32 PaddedWidth = 0;
+    EGridConnectivity Connectivity = EGridConnectivity::Square4;
+
+    // Bordered, row-major: (Y + 1) * PaddedWidth + X + 1. Border tiles stay Blocked. Paged, so blocked stretches
+    // (the ocean of a streamed world map) take no per-tile memory.
+    TGridPagedArray<int32> Costs;
+
+    // Padded index offsets per direction, [row parity][direction]
+    int32 NeighborOffsets[2][8] = {};
+
+    // Lower bound on any walkable tile's cost, scales the grid-distance fallback
+    int32 MinCost = 1;
+
+    // Padded indices
+    TArray<int32> Landmarks;
+
+    // Interleaved per tile: [Padded * NumLandmarks + Slot], so one estimate reads one cache line
+    TArray<uint16> Forward;
+    TArray<uint16> Backward;
+
+    // Cost before the first deferred change, by padded index, for tiles changed since the last flush
+    TMap<int32, int32> DeferredOldCosts;
+
+    // Time-sliced landmark build in progress
+    struct FLandmarkBuild
+    {
+        // Landmarks wanted; 0 when no build is running
+        int32 NumLandmarks = 0;
+
+        // Farthest-point selection: landmarks chosen so far and each tile's distance to the nearest (empty until the
+        // seed step ran)
+        TArray<int32> Picks;
+        TArray<int32> MinDist;
+
+        // Next table to compute once selection is done (slot * 2 + backward), INDEX_NONE while selecting
+        int32 NextTable = INDEX_NONE;
+    };
+    FLandmarkBuild Build;
+
+    // Search scratch for queries that don't bring their own (not thread-safe)
+    using FOpenEntry = FGridPathScratch::FOpenEntry;
+    mutable FGridPathScratch Scratch;
+};
+
+template <typename FuncType>
+decltype(auto) FGridPathfinder::Dispatch(FuncType&& Fn) const
+{
+    switch (Connectivity)
+    {
+    case EGridConnectivity::Square8:
+        return Fn(FSquare8Connectivity());
+    case EGridConnectivity::Hex6:
+        return Fn(FHex6Connectivity());
+    default:
+        return Fn(FSquare4Connectivity());
+    }
+}
+
+template <typename Traits, typename CostFuncType>
+int32 FGridPathfinder::EdgeWeight(int32 From, int32 Dir, bool bBackward, CostFuncType&& CostOf) const
+{
+    // Border tiles are Blocked, so nothing past them is ever read
+    const int32 FromCost = CostOf(From);
+    if (FromCost < 0) return Blocked;
+
+    const int32* Offsets = GetOffsets<Traits>(From);
+    const int32 ToCost = CostOf(From + Offsets[Dir]);
+    if (ToCost < 0) return Blocked;
+
+    if (Traits::bDiagonals && Dir >= 4)
+    {
+        // Diagonal steps need both orthogonal corners open: NW = W+N, NE = E+N, SW = W+S, SE = E+S
+        const int32 SideX = (Dir & 1) ? 1 : 0;
+        const int32 SideY = (Dir & 2) ? 3 : 2;
+        if (CostOf(From + Offsets[SideX]) < 0 || CostOf(From + Offsets[SideY]) < 0) return Blocked;
+    }
+    return Traits::Weight(Dir) * (bBackward ? FromCost : ToCost);
+}
+
+template <typename FuncType>
+void FGridPathfinder::ForEachWalkableEdge(int32 TileIndex, FuncType&& Fn) const
+{
+    if (!IsValidTile(TileIndex)) return;
+    const int32 Padded = ToPadded(TileIndex);
+    Dispatch([&](auto Traits)
+    {
+        using TraitsType = decltype(Traits);
+        const int32* Offsets = GetOffsets<TraitsType>(Padded);
+        for (int32 Dir = 0; Dir < TraitsType::NumDirections; ++Dir)
+        {
+            const int32 Weight = EdgeWeight<TraitsType>(Padded, Dir, false);
+            if (Weight >= 0)
+            {
+                Fn(FromPadded(Padded + Offsets[Dir]), Weight);
+            }
+        }
+    });
+}
@@ -0,0 +1,295 @@
+#include "GridRegions.h"
+#include "GridPathfinding.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+void FGridRegions::Build(const FGridPathfinder& Pathfinder)
+{
+    Width = Pathfinder.GetWidth();
+    Height = Pathfinder.GetHeight();
+    const int32 NumTiles = Width * Height;
+    Labels.Init(INDEX_NONE, NumTiles);
+    RegionSizes.Reset();
+    FreeRegions.Reset();
+    VisitStamp.Init(0, NumTiles);
+    Stamp = 1;
+
+    TArray<int32> Freed;
+    for (int32 Index = 0; Index < NumTiles; ++Index)
+    {
+        if (Labels[Index] == INDEX_NONE && Pathfinder.GetTileCost(Index) >= 0)
+        {
+            Flood(Pathfinder, Index, Freed);
+        }
+    }
+}
+
+void FGridRegions::Reset()
+{
+    Width = 0;
+    Height = 0;
+    Labels.Empty();
+    RegionSizes.Empty();
+    FreeRegions.Empty();
+    VisitStamp.Empty();
+    Stack.Empty();
+    Stamp = 0;
+}
+
+void FGridRegions::Update(const FGridPathfinder& Pathfinder, TArrayView<const int32> ChangedTiles)
+{
+    if (Pathfinder.GetWidth() != Width || Pathfinder.GetHeight() != Height)
+    {
+        Build(Pathfinder);
+        return;
+    }
+    if (++Stamp == 0)
+    {
+        FMemory::Memzero(VisitStamp.GetData(), VisitStamp.Num() * sizeof(uint32));
+        Stamp = 1;
+    }
+
+    // Every edge that can appear or disappear joins two tiles of the 3x3 block around a changed tile (diagonals depend
+    // on their corners, and hex neighbors fit in the block too), so seeding floods from the walkable tiles of those
+    // blocks reaches every tile of every region that may have split or merged
+    TArray<int32> Seeds;
+    TArray<int32> Freed;
+    for (int32 Tile : ChangedTiles)
+    {
+        if (!Labels.IsValidIndex(Tile)) continue;
+
+        // Cost-only changes never connect or cut anything
+        const bool bWalkable = Pathfinder.GetTileCost(Tile) >= 0;
+        if (bWalkable == (Labels[Tile] != INDEX_NONE)) continue;
+
+        if (!bWalkable)
+        {
+            const int32 OldRegion = Labels[Tile];
+            Labels[Tile] = INDEX_NONE;
+            if (--RegionSizes[OldRegion] == 0)
+            {
+                Freed.Add(OldRegion);
+            }
+        }
+
+        const int32 X = Tile % Width;
+        const int32 Y = Tile / Width;
+        for (int32 NY = FMath::Max(0, Y - 1); NY <= FMath::Min(Height - 1, Y + 1); ++NY)
+        {
+            for (int32 NX = FMath::Max(0, X - 1); NX <= FMath::Min(Width - 1, X + 1); ++NX)
+            {
+                const int32 Neighbor = NY * Width + NX;
+                if (Pathfinder.GetTileCost(Neighbor) >= 0)
+                {
+                    Seeds.Add(Neighbor);
+                }
+            }
+        }
+    }
+
+    for (int32 Seed : Seeds)
+    {
+        if (VisitStamp[Seed] != Stamp)
+        {
+            Flood(Pathfinder, Seed, Freed);
+        }
+    }
+
+    // Ids emptied by this update are only reused by the next one, so no flood above hands out an id still on a tile
+    FreeRegions.Append(Freed);
+}
+
+void FGridRegions::Flood(const FGridPathfinder& Pathfinder, int32 Seed, TArray<int32>& OutFreed)
+{
+    const int32 Region = AllocateRegion();
+    int32 Size = 0;
+
+    Stack.Reset();
+    Stack.Add(Seed);
+    VisitStamp[Seed] = Stamp;
+    while (Stack.Num() > 0)
+    {
+        const int32 Tile = Stack.Pop(false);
+        const int32 OldRegion = Labels[Tile];
+        if (OldRegion != INDEX_NONE && --RegionSizes[OldRegion] == 0)
+        {
+            OutFreed.Add(OldRegion);
+        }
+        Labels[Tile] = Region;
+        ++Size;
+
+        Pathfinder.ForEachWalkableNeighbor(Tile, [this](int32 Neighbor)
+        {
+            if (VisitStamp[Neighbor] != Stamp)
+            {
+                VisitStamp[Neighbor] = Stamp;
+                Stack.Add(Neighbor);
+            }
+        });
+    }
+    RegionSizes[Region] = Size;
+}
+
+int32 FGridRegions::AllocateRegion()
+{
+    return FreeRegions.Num() ? FreeRegions.Pop(false) : RegionSizes.Add(0);
+}
+
+int32 FGridRegions::CountMislabeledTiles(const FGridPathfinder& Pathfinder) const
+{
+    FGridRegions Fresh;
+    Fresh.Build(Pathfinder);
+    if (Fresh.Labels.Num() != Labels.Num()) return Fresh.Labels.Num();
+
+    // Ids differ between the two labelings; the partitions must match one to one
+    TMap<int32, int32> FreshToOurs;
+    TMap<int32, int32> OursToFresh;
+    int32 Mislabeled = 0;
+    for (int32 Index = 0; Index < Labels.Num(); ++Index)
+    {
+        const int32 Ours = Labels[Index];
+        const int32 Theirs = Fresh.Labels[Index];
+        if ((Ours == INDEX_NONE) != (Theirs == INDEX_NONE))
+        {
+            ++Mislabeled;
+            continue;
+        }
+        if (Ours == INDEX_NONE) continue;
+
+        const int32 MappedOurs = FreshToOurs.FindOrAdd(Theirs, Ours);
+        const int32 MappedFresh = OursToFresh.FindOrAdd(Ours, Theirs);
+        Mislabeled += MappedOurs != Ours || MappedFresh != Theirs ? 1 : 0;
+    }
+    return Mislabeled;
+}
+
+SIZE_T FGridRegions::GetAllocatedSize() const
+{
+    return Labels.GetAllocatedSize() + RegionSizes.GetAllocatedSize() + FreeRegions.GetAllocatedSize()
+        + VisitStamp.GetAllocatedSize() + Stack.GetAllocatedSize();
+}
+
+namespace
+{
+    constexpr int32 BenchSize = 128;
+
+    // Mixed-cost field with scattered rocks
+    void BuildBenchMap(FGridPathfinder& Nav, FRandomStream& Random)
+    {
+        Nav.Init(BenchSize, BenchSize);
+        for (int32 Index = 0; Index < Nav.NumTiles(); ++Index)
+        {
+            Nav.SetTileCost(Index, Random.FRand() < 0.1f ? FGridPathfinder::Blocked : 1 + Random.RandHelper(3));
+        }
+    }
+
+    void RunTerrainEditBenchmark()
+    {
+        constexpr int32 NumEdits = 40;
+        constexpr int32 WallLength = 48;
+        constexpr int32 NumLandmarks = 8;
+        constexpr int32 NumQueries = 500;
+
+        // Walls raised across random rows, each one flooded (reopened at a higher cost) by the next edit,
+        // applied tile by tile and then as one batch per edit
+        for (int32 Pass = 0; Pass < 2; ++Pass)
+        {
+            const bool bBatched = Pass == 1;
+            FRandomStream Random(4321);
+            FGridPathfinder Nav;
+            BuildBenchMap(Nav, Random);
+            Nav.BuildLandmarks(NumLandmarks);
+            FGridRegions Regions;
+            Regions.Build(Nav);
+
+            TArray<int32> Wall;
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 Edit = 0; Edit < NumEdits; ++Edit)
+            {
+                const int32 Cost = (Edit & 1) ? 3 : FGridPathfinder::Blocked;
+                if (Cost == FGridPathfinder::Blocked)
+                {
+                    const int32 Y = Random.RandRange(0, BenchSize - 1);
+                    const int32 X0 = Random.RandRange(0, BenchSize - WallLength);
+                    Wall.Reset();
+                    for (int32 X = X0; X < X0 + WallLength; ++X)
+                    {
+                        Wall.Add(Y * BenchSize + X);
+                    }
+                }
+
+                if (bBatched)
+                {
+                    for (int32 Tile : Wall)
+                    {
+                        Nav.SetTileCostDeferred(Tile, Cost);
+                    }
+                    Nav.FlushTileCosts();
+                    Regions.Update(Nav, Wall);
+                }
+                else
+                {
+                    for (int32 Tile : Wall)
+                    {
+                        Nav.SetTileCost(Tile, Cost);
+                        Regions.Update(Nav, MakeArrayView(&Tile, 1));
+                    }
+                }
+            }
+            const double EditMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumEdits;
+
+            UE_LOG(LogTemp, Display, TEXT("TerrainEdit %s %dx%d, %d-tile edits: %.3f ms per edit, %d regions, stale landmark entries %d, mislabeled tiles %d"),
+                bBatched ? TEXT("batched   ") : TEXT("tile by tile"), BenchSize, BenchSize, WallLength, EditMs,
+                Regions.NumRegions(), Nav.CountStaleLandmarkEntries(), Regions.CountMislabeledTiles(Nav));
+        }
+
+        // Any-path queries on a map cut into three bands by two full walls: region lookup against a failing A*
+        FRandomStream Random(4321);
+        FGridPathfinder Nav;
+        BuildBenchMap(Nav, Random);
+        for (int32 X = 0; X < BenchSize; ++X)
+        {
+            Nav.SetTileCost(BenchSize / 3 * BenchSize + X, FGridPathfinder::Blocked);
+            Nav.SetTileCost(2 * BenchSize / 3 * BenchSize + X, FGridPathfinder::Blocked);
+        }
+        Nav.BuildLandmarks(NumLandmarks);
+        FGridRegions Regions;
+        Regions.Build(Nav);
+
+        TArray<int32> Walkable;
+        for (int32 Index = 0; Index < Nav.NumTiles(); ++Index)
+        {
+            if (Nav.GetTileCost(Index) >= 0) Walkable.Add(Index);
+        }
+
+        FGridPath Path;
+        int32 Disconnected = 0;
+        int32 Mismatches = 0;
+        double RegionMs = 0.0;
+        double SearchMs = 0.0;
+        for (int32 Query = 0; Query < NumQueries; ++Query)
+        {
+            const int32 Start = Walkable[Random.RandHelper(Walkable.Num())];
+            const int32 Goal = Walkable[Random.RandHelper(Walkable.Num())];
+
+            double QueryStart = FPlatformTime::Seconds();
+            const bool bConnected = Regions.AreConnected(Start, Goal);
+            RegionMs += (FPlatformTime::Seconds() - QueryStart) * 1000.0;
+
+            QueryStart = FPlatformTime::Seconds();
+            const bool bFound = Nav.FindPath(Start, Goal, nullptr, Path);
+            SearchMs += (FPlatformTime::Seconds() - QueryStart) * 1000.0;
+
+            Disconnected += bConnected ? 0 : 1;
+            Mismatches += bConnected != bFound ? 1 : 0;
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("TerrainEdit any-path: %d of %d pairs disconnected, region lookup %.5f ms vs FindPath %.3f ms per query, mismatches %d"),
+            Disconnected, NumQueries, RegionMs / NumQueries, SearchMs / NumQueries, Mismatches);
+    }
+
+    FAutoConsoleCommand TerrainEditBenchmarkCommand(
+        TEXT("tb.Bench.TerrainEdit"),
+        TEXT("Batched against tile-by-tile terrain edits on 128x128 (landmark repair and region labels), and region lookups against FindPath"),
+        FConsoleCommandDelegate::CreateStatic(&RunTerrainEditBenchmark));
+}
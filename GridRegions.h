@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FGridPathfinder;
+
+// Connected regions of walkable terrain: two tiles share a region exactly when a path joins them with no units in the
+// way, so "is there any path at all" is one comparison. Labels follow the pathfinder's costs and connectivity
+// (diagonals included); after terrain edits only the regions around the changed tiles are relabeled, which is cheap
+// on maps cut into many regions and close to a full Build on open maps where one region covers most of the grid.
+class DENEME_API FGridRegions
+{
+public:
+    // Label every tile from scratch
+    void Build(const FGridPathfinder& Pathfinder);
+
+    // Free the labels (grids too large to keep 8 bytes per tile for them)
+    void Reset();
+
+    bool IsBuilt() const { return Labels.Num() > 0; }
+
+    // Relabel after the given tiles changed cost in the pathfinder (duplicates are fine). Only walkability matters:
+    // cost-only edits are free, otherwise every region touching a changed tile is flooded again in full (the whole
+    // grid when one open region spans it). Bounded by the size of those regions, not by the edit.
+    void Update(const FGridPathfinder& Pathfinder, TArrayView<const int32> ChangedTiles);
+
+    // Region of a tile, or INDEX_NONE for blocked and out-of-range tiles
+    int32 GetRegion(int32 TileIndex) const { return Labels.IsValidIndex(TileIndex) ? Labels[TileIndex] : INDEX_NONE; }
+
+    // Both walkable and in the same region
+    bool AreConnected(int32 A, int32 B) const
+    {
+        const int32 Region = GetRegion(A);
+        return Region != INDEX_NONE && Region == GetRegion(B);
+    }
+
+    // Tiles in a region
+    int32 GetRegionSize(int32 Region) const { return RegionSizes.IsValidIndex(Region) ? RegionSizes[Region] : 0; }
+
+    int32 NumRegions() const { return RegionSizes.Num() - FreeRegions.Num(); }
+
+    // Debug check: tiles whose region disagrees with a labeling from scratch (0 when Update kept up)
+    int32 CountMislabeledTiles(const FGridPathfinder& Pathfinder) const;
+
+    // Bytes held by labels and flood fill scratch
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    // Give every unvisited walkable tile reachable from Seed the next free region
+    void Flood(const FGridPathfinder& Pathfinder, int32 Seed, TArray<int32>& OutFreed);
+
+    int32 AllocateRegion();
+
+    int32 Width = 0;
+    int32 Height = 0;
+
+    // Per tile
+    TArray<int32> Labels;
+
+    // Per region; zero for ids on the free list
+    TArray<int32> RegionSizes;
+    TArray<int32> FreeRegions;
+
+    // Flood fill scratch
+    TArray<uint32> VisitStamp;
+    TArray<int32> Stack;
+    uint32 Stamp = 0;
+};
@@ -0,0 +1,418 @@
+#include "GridVisibility.h"
+
+namespace
+{
+    // Upper bound on cached origin views before the cache is dropped wholesale
+    constexpr int32 MaxCachedWindows = 8192;
+
+    // Slope of a shadowcasting row boundary as an exact fraction (Den > 0)
+    struct FSlope
+    {
+        int32 Num;
+        int32 Den;
+    };
+
+    struct FRow
+    {
+        int32 Depth;
+        FSlope Start;
+        FSlope End;
+    };
+
+    int32 FloorDiv(int32 A, int32 B)
+    {
+        return A >= 0 ? A / B : -((-A + B - 1) / B);
+    }
+
+    int32 CeilDiv(int32 A, int32 B)
+    {
+        return -FloorDiv(-A, B);
+    }
+
+    // floor(Depth * Slope + 0.5)
+    int32 RoundTiesUp(int32 Depth, const FSlope& Slope)
+    {
+        return FloorDiv(2 * Depth * Slope.Num + Slope.Den, 2 * Slope.Den);
+    }
+
+    // ceil(Depth * Slope - 0.5)
+    int32 RoundTiesDown(int32 Depth, const FSlope& Slope)
+    {
+        return CeilDiv(2 * Depth * Slope.Num - Slope.Den, 2 * Slope.Den);
+    }
+
+    FSlope TileSlope(int32 Col, int32 Depth)
+    {
+        return FSlope{ 2 * Col - 1, 2 * Depth };
+    }
+
+    // Floor tiles are only revealed when the origin would also be visible from them
+    bool IsSymmetric(const FRow& Row, int32 Col)
+    {
+        return (int64)Col * Row.Start.Den >= (int64)Row.Depth * Row.Start.Num
+            && (int64)Col * Row.End.Den <= (int64)Row.Depth * Row.End.Num;
+    }
+
+    // Quadrant-local (Depth, Col) to grid offset. 0 = north, 1 = east, 2 = south, 3 = west.
+    void TransformQuadrant(int32 Quadrant, int32 Depth, int32 Col, int32& OutDX, int32& OutDY)
+    {
+        switch (Quadrant)
+        {
+        case 0: OutDX = Col; OutDY = -Depth; break;
+        case 1: OutDX = Depth; OutDY = Col; break;
+        case 2: OutDX = Col; OutDY = Depth; break;
+        default: OutDX = -Depth; OutDY = Col; break;
+        }
+    }
+}
+
+void FGridVisibility::Init(int32 InWidth, int32 InHeight)
+{
+    Width = FMath::Max(0, InWidth);
+    Height = FMath::Max(0, InHeight);
+    Blockers.Init(0, (Width * Height + 63) / 64);
+    WindowCache.Empty();
+    Viewers.Empty();
+    Teams.Empty();
+    DeferredBlockers.Reset();
+    NumDirtyViewers = 0;
+}
+
+bool FGridVisibility::BlocksSight(int32 X, int32 Y) const
+{
+    // Out of bounds behaves like a wall
+    if (!IsInBounds(X, Y)) return true;
+    return TestBlocker(Y * Width + X);
+}
+
+void FGridVisibility::SetBlocker(int32 Index, bool bBlocks)
+{
+    const uint64 Bit = 1ull << (Index & 63);
+    const uint64 Word = Blockers[Index >> 6];
+    Blockers.Set(Index >> 6, bBlocks ? (Word | Bit) : (Word & ~Bit));
+}
+
+void FGridVisibility::SetBlocksSight(int32 X, int32 Y, bool bBlocks)
+{
+    if (!IsInBounds(X, Y)) return;
+    const int32 Index = Y * Width + X;
+    if (TestBlocker(Index) == bBlocks) return;
+    SetBlocker(Index, bBlocks);
+
+    const FIntPoint Tile(X, Y);
+    InvalidateAround(MakeArrayView(&Tile, 1));
+}
+
+void FGridVisibility::SetBlocksSightDeferred(int32 X, int32 Y, bool bBlocks)
+{
+    if (!IsInBounds(X, Y)) return;
+    const int32 Index = Y * Width + X;
+    if (TestBlocker(Index) == bBlocks) return;
+    SetBlocker(Index, bBlocks);
+    DeferredBlockers.Add(FIntPoint(X, Y));
+}
+
+bool FGridVisibility::FlushBlockers()
+{
+    if (DeferredBlockers.Num() == 0) return false;
+    InvalidateAround(DeferredBlockers);
+    DeferredBlockers.Reset();
+    return true;
+}
+
+void FGridVisibility::InvalidateAround(TArrayView<const FIntPoint> ChangedTiles)
+{
+    FIntRect Bounds(ChangedTiles[0], ChangedTiles[0]);
+    for (const FIntPoint& Tile : ChangedTiles)
+    {
+        Bounds.Include(Tile);
+    }
+
+    // Bounds first, so windows far from the edit cost one test however many tiles changed
+    auto Covers = [&Bounds, ChangedTiles](int32 OriginX, int32 OriginY, int32 Radius)
+    {
+        if (OriginX + Radius < Bounds.Min.X || OriginX - Radius > Bounds.Max.X || OriginY + Radius < Bounds.Min.Y || OriginY - Radius > Bounds.Max.Y)
+        {
+            return false;
+        }
+        for (const FIntPoint& Tile : ChangedTiles)
+        {
+            if (FMath::Abs(OriginX - Tile.X) <= Radius && FMath::Abs(OriginY - Tile.Y) <= Radius) return true;
+        }
+        return false;
+    };
+
+    // Drop cached views whose window covers a changed tile
+    for (auto It = WindowCache.CreateIterator(); It; ++It)
+    {
+        const FFovWindow& Window = It.Value();
+        if (Covers(Window.OriginX, Window.OriginY, Window.Radius))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    // Only viewers that can see that far need a recompute
+    for (auto& Pair : Viewers)
+    {
+        FViewer& Viewer = Pair.Value;
+        if (!Viewer.bDirty && Covers(Viewer.X, Viewer.Y, Viewer.Radius))
+        {
+            Viewer.bDirty = true;
+            ++NumDirtyViewers;
+        }
+    }
+}
+
+void FGridVisibility::UpdateViewer(uint32 ViewerId, int32 TeamId, int32 X, int32 Y, int32 Radius)
+{
+    FViewer* Viewer = Viewers.Find(ViewerId);
+    if (!Viewer)
+    {
+        Viewer = &Viewers.Add(ViewerId);
+        Viewer->bDirty = false;
+    }
+    else if (Viewer->TeamId == TeamId && Viewer->X == X && Viewer->Y == Y && Viewer->Radius == Radius)
+    {
+        return;
+    }
+
+    Viewer->TeamId = TeamId;
+    Viewer->X = X;
+    Viewer->Y = Y;
+    Viewer->Radius = FMath::Max(0, Radius);
+    if (!Viewer->bDirty)
+    {
+        Viewer->bDirty = true;
+        ++NumDirtyViewers;
+    }
+}
+
+void FGridVisibility::RemoveViewer(uint32 ViewerId)
+{
+    FViewer Removed;
+    if (!Viewers.RemoveAndCopyValue(ViewerId, Removed)) return;
+    if (Removed.bDirty) --NumDirtyViewers;
+    if (Removed.Applied.Radius >= 0)
+    {
+        ApplyWindowToTeam(Removed.AppliedTeamId, Removed.Applied, -1);
+    }
+}
+
+void FGridVisibility::Flush()
+{
+    if (NumDirtyViewers <= 0) return;
+
+    for (auto& Pair : Viewers)
+    {
+        FViewer& Viewer = Pair.Value;
+        if (!Viewer.bDirty) continue;
+
+        if (Viewer.Applied.Radius >= 0)
+        {
+            ApplyWindowToTeam(Viewer.AppliedTeamId, Viewer.Applied, -1);
+        }
+
+        Viewer.Applied = GetOrComputeWindow(Viewer.X, Viewer.Y, Viewer.Radius);
+        Viewer.AppliedTeamId = Viewer.TeamId;
+        ApplyWindowToTeam(Viewer.AppliedTeamId, Viewer.Applied, 1);
+        Viewer.bDirty = false;
+    }
+    NumDirtyViewers = 0;
+}
+
+bool FGridVisibility::HasLineOfSight(int32 FromX, int32 FromY, int32 ToX, int32 ToY, int32 Radius)
+{
+    if (!IsInBounds(FromX, FromY) || !IsInBounds(ToX, ToY)) return false;
+    if (FMath::Abs(FromX - ToX) + FMath::Abs(FromY - ToY) > Radius) return false;
+    return GetOrComputeWindow(FromX, FromY, Radius).Test(ToX, ToY);
+}
+
+void FGridVisibility::GetTilesInSight(int32 X, int32 Y, int32 Radius, FGridBitset& OutTiles)
+{
+    OutTiles.Init(Width * Height);
+    if (!IsInBounds(X, Y) || Radius < 0) return;
+
+    const FFovWindow& Window = GetOrComputeWindow(X, Y, Radius);
+    const int32 Side = Window.Side();
+    for (int32 WordIndex = 0; WordIndex < Window.Bits.Num(); ++WordIndex)
+    {
+        uint64 Word = Window.Bits[WordIndex];
+        while (Word)
+        {
+            const int32 Bit = WordIndex * 64 + (int32)FMath::CountTrailingZeros64(Word);
+            Word &= Word - 1;
+
+            const int32 TileX = X + (Bit % Side) - Radius;
+            const int32 TileY = Y + (Bit / Side) - Radius;
+            if (IsInBounds(TileX, TileY))
+            {
+                OutTiles.Set(TileY * Width + TileX);
+            }
+        }
+    }
+}
+
+bool FGridVisibility::IsVisibleToTeam(int32 TeamId, int32 X, int32 Y)
+{
+    if (!IsInBounds(X, Y)) return false;
+    const FGridBitset* Visible = GetTeamVisibility(TeamId);
+    return Visible && Visible->Test(Y * Width + X);
+}
+
+const FGridBitset* FGridVisibility::GetTeamVisibility(int32 TeamId)
+{
+    Flush();
+    const FTeamVisibility* Team = Teams.Find(TeamId);
+    return Team ? &Team->Visible : nullptr;
+}
+
+SIZE_T FGridVisibility::GetAllocatedSize() const
+{
+    SIZE_T Size = Blockers.GetAllocatedSize() + DeferredBlockers.GetAllocatedSize() + Viewers.GetAllocatedSize() + Teams.GetAllocatedSize();
+    for (const auto& Pair : Viewers)
+    {
+        Size += Pair.Value.Applied.Bits.GetAllocatedSize();
+    }
+    for (const auto& Pair : Teams)
+    {
+        Size += Pair.Value.Counts.GetAllocatedSize() + Pair.Value.Visible.Words.GetAllocatedSize();
+    }
+    return Size;
+}
+
+SIZE_T FGridVisibility::GetCacheAllocatedSize() const
+{
+    SIZE_T Size = WindowCache.GetAllocatedSize();
+    for (const auto& Pair : WindowCache)
+    {
+        Size += Pair.Value.Bits.GetAllocatedSize();
+    }
+    return Size;
+}
+
+const FFovWindow& FGridVisibility::GetOrComputeWindow(int32 X, int32 Y, int32 Radius)
+{
+    const uint64 Key = MakeCacheKey(Y * Width + X, Radius);
+    if (const FFovWindow* Cached = WindowCache.Find(Key))
+    {
+        return *Cached;
+    }
+
+    if (WindowCache.Num() >= MaxCachedWindows)
+    {
+        WindowCache.Reset();
+    }
+
+    FFovWindow& Window = WindowCache.Add(Key);
+    Window.OriginX = X;
+    Window.OriginY = Y;
+    Window.Radius = Radius;
+    ComputeWindow(Window);
+    return Window;
+}
+
+void FGridVisibility::ComputeWindow(FFovWindow& Window) const
+{
+    const int32 Radius = Window.Radius;
+    const int32 Side = Window.Side();
+    Window.Bits.Init(0, (Side * Side + 63) / 64);
+
+    auto Reveal = [&Window, Radius, Side](int32 DX, int32 DY)
+    {
+        if (FMath::Abs(DX) + FMath::Abs(DY) > Radius) return;
+        const int32 Bit = (DY + Radius) * Side + (DX + Radius);
+        Window.Bits[Bit >> 6] |= (1ull << (Bit & 63));
+    };
+
+    // The origin always sees itself
+    Reveal(0, 0);
+
+    // Symmetric shadowcasting, one quadrant at a time, with an explicit row stack
+    TArray<FRow, TInlineAllocator<64>> Stack;
+    for (int32 Quadrant = 0; Quadrant < 4; ++Quadrant)
+    {
+        Stack.Reset();
+        Stack.Add(FRow{ 1, FSlope{ -1, 1 }, FSlope{ 1, 1 } });
+
+        while (Stack.Num() > 0)
+        {
+            FRow Row = Stack.Pop(false);
+            if (Row.Depth > Radius) continue;
+
+            const int32 MinCol = RoundTiesUp(Row.Depth, Row.Start);
+            const int32 MaxCol = RoundTiesDown(Row.Depth, Row.End);
+
+            // -1 = no previous tile, 0 = floor, 1 = wall
+            int32 PrevState = -1;
+            for (int32 Col = MinCol; Col <= MaxCol; ++Col)
+            {
+                int32 DX, DY;
+                TransformQuadrant(Quadrant, Row.Depth, Col, DX, DY);
+                const bool bWall = BlocksSight(Window.OriginX + DX, Window.OriginY + DY);
+
+                if (bWall || IsSymmetric(Row, Col))
+                {
+                    if (IsInBounds(Window.OriginX + DX, Window.OriginY + DY))
+                    {
+                        Reveal(DX, DY);
+                    }
+                }
+
+                if (PrevState == 1 && !bWall)
+                {
+                    Row.Start = TileSlope(Col, Row.Depth);
+                }
+                if (PrevState == 0 && bWall)
+                {
+                    Stack.Add(FRow{ Row.Depth + 1, Row.Start, TileSlope(Col, Row.Depth) });
+                }
+                PrevState = bWall ? 1 : 0;
+            }
+
+            if (PrevState == 0)
+            {
+                Stack.Add(FRow{ Row.Depth + 1, Row.Start, Row.End });
+            }
+        }
+    }
+}
+
+void FGridVisibility::ApplyWindowToTeam(int32 TeamId, const FFovWindow& Window, int32 Delta)
+{
+    FTeamVisibility& Team = Teams.FindOrAdd(TeamId);
+    if (Team.Counts.Num() != Width * Height)
+    {
+        Team.Counts.Init(0, Width * Height);
+        Team.Visible.Init(Width * Height);
+    }
+
+    const int32 Radius = Window.Radius;
+    const int32 Side = Window.Side();
+    for (int32 WordIndex = 0; WordIndex < Window.Bits.Num(); ++WordIndex)
+    {
+        uint64 Word = Window.Bits[WordIndex];
+        while (Word)
+        {
+            const int32 Bit = WordIndex * 64 + (int32)FMath::CountTrailingZeros64(Word);
+            Word &= Word - 1;
+
+            const int32 X = Window.OriginX + (Bit % Side) - Radius;
+            const int32 Y = Window.OriginY + (Bit / Side) - Radius;
+            if (!IsInBounds(X, Y)) continue;
+
+            const int32 Index = Y * Width + X;
+            const uint16 Count = Team.Counts[Index];
+            if (Delta > 0)
+            {
+                Team.Counts.Set(Index, Count + 1);
+                if (Count == 0) Team.Visible.Set(Index);
+            }
+            else if (Count > 0)
+            {
+                Team.Counts.Set(Index, Count - 1);
+                if (Count == 1) Team.Visible.Clear(Index);
+            }
+        }
+    }
+}
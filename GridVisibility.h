@@ -0,0 +1,122 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridBitset.h"
+#include "GridPagedArray.h"
+
+// Field of view of a single origin tile, stored as a (2R+1)x(2R+1) bit window centered on the origin.
+// A tile is set when it is within Manhattan distance R and visible under symmetric shadowcasting.
+struct FFovWindow
+{
+    int32 OriginX = 0;
+    int32 OriginY = 0;
+    int32 Radius = -1;
+    TArray<uint64> Bits;
+
+    int32 Side() const { return 2 * Radius + 1; }
+
+    bool Test(int32 X, int32 Y) const
+    {
+        const int32 DX = X - OriginX;
+        const int32 DY = Y - OriginY;
+        if (Radius < 0 || FMath::Abs(DX) > Radius || FMath::Abs(DY) > Radius) return false;
+        const int32 Bit = (DY + Radius) * Side() + (DX + Radius);
+        return (Bits[Bit >> 6] & (1ull << (Bit & 63))) != 0;
+    }
+};
+
+// Line of sight and per-team fog of war over a grid of sight-blocking tiles.
+// Pure data (no actors), so it can be driven by AGridManager or by headless simulations.
+class DENEME_API FGridVisibility
+{
+public:
+    void Init(int32 InWidth, int32 InHeight);
+
+    int32 GetWidth() const { return Width; }
+    int32 GetHeight() const { return Height; }
+
+    // Blockers. Changing one only invalidates cached views and viewers whose radius covers it.
+    void SetBlocksSight(int32 X, int32 Y, bool bBlocks);
+    bool BlocksSight(int32 X, int32 Y) const;
+
+    // Batched blocker edits: the blocker changes now, and FlushBlockers invalidates what covers any of the changed
+    // tiles in one pass over the cache and viewers. Sight queries in between may see the old blockers.
+    void SetBlocksSightDeferred(int32 X, int32 Y, bool bBlocks);
+
+    // Returns whether any blocker changed since the last flush
+    bool FlushBlockers();
+
+    // Viewers (units) contribute their field of view to their team's visible set.
+    // Cheap to call every move; the view is only recomputed when origin, radius or team changed.
+    void UpdateViewer(uint32 ViewerId, int32 TeamId, int32 X, int32 Y, int32 Radius);
+    void RemoveViewer(uint32 ViewerId);
+
+    // Recompute views for dirty viewers and fold them into the team visibility sets
+    void Flush();
+
+    // True if To is within Manhattan Radius of From and not hidden behind blockers
+    bool HasLineOfSight(int32 FromX, int32 FromY, int32 ToX, int32 ToY, int32 Radius);
+
+    // Every tile HasLineOfSight(X, Y, ...) accepts, as a grid-sized bitset (one cached window lookup)
+    void GetTilesInSight(int32 X, int32 Y, int32 Radius, FGridBitset& OutTiles);
+
+    bool IsVisibleToTeam(int32 TeamId, int32 X, int32 Y);
+
+    // Visible tiles of a team as a grid-sized bitset (nullptr if the team has no viewers)
+    const FGridBitset* GetTeamVisibility(int32 TeamId);
+
+    // Bytes held by blockers, viewers and team sets, and separately by the per-origin LOS cache
+    SIZE_T GetAllocatedSize() const;
+    SIZE_T GetCacheAllocatedSize() const;
+
+private:
+    struct FViewer
+    {
+        int32 TeamId = 0;
+        int32 X = 0;
+        int32 Y = 0;
+        int32 Radius = 0;
+        bool bDirty = true;
+
+        // What is currently folded into the team counts (so it can be removed later)
+        int32 AppliedTeamId = 0;
+        FFovWindow Applied;
+    };
+
+    struct FTeamVisibility
+    {
+        // Number of viewers seeing each tile, paged so unseen stretches take no memory; the bitset mirrors Counts > 0
+        TGridPagedArray<uint16> Counts;
+        FGridBitset Visible;
+    };
+
+    const FFovWindow& GetOrComputeWindow(int32 X, int32 Y, int32 Radius);
+    void ComputeWindow(FFovWindow& Window) const;
+    void ApplyWindowToTeam(int32 TeamId, const FFovWindow& Window, int32 Delta);
+
+    // Drop cached views and dirty viewers whose window covers any of the tiles
+    void InvalidateAround(TArrayView<const FIntPoint> ChangedTiles);
+
+    bool IsInBounds(int32 X, int32 Y) const { return X >= 0 && X < Width && Y >= 0 && Y < Height; }
+
+    bool TestBlocker(int32 Index) const { return (Blockers[Index >> 6] & (1ull << (Index & 63))) != 0; }
+    void SetBlocker(int32 Index, bool bBlocks);
+
+    static uint64 MakeCacheKey(int32 TileIndex, int32 Radius) { return ((uint64)(uint32)TileIndex << 16) | (uint16)Radius; }
+
+    int32 Width = 0;
+    int32 Height = 0;
+    int32 NumDirtyViewers = 0;
+
+    // Blocker bits by tile index, 64 per word; paged, so open terrain and ocean take no memory
+    TGridPagedArray<uint64> Blockers;
+
+    // Blockers changed by SetBlocksSightDeferred since the last FlushBlockers
+    TArray<FIntPoint> DeferredBlockers;
+
+    // LOS results per origin tile and radius
+    TMap<uint64, FFovWindow> WindowCache;
+
+    TMap<uint32, FViewer> Viewers;
+    TMap<int32, FTeamVisibility> Teams;
+};
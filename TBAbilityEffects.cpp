@@ -0,0 +1,567 @@
+#include "TBAbilityEffects.h"
+#include "TBAbilityEffectsBenchmark.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "UObject/Package.h"
+
+namespace
+{
+    const TCHAR* const OpNames[] = { TEXT("End"), TEXT("Area"), TEXT("Filter"), TEXT("If"), TEXT("Damage"), TEXT("AbilityDamage"), TEXT("Heal"), TEXT("Push") };
+    const int32 OperandCounts[] = { 0, 2, 1, 3, 2, 0, 1, 1 };
+    static_assert(UE_ARRAY_COUNT(OpNames) == (int32)ETBEffectOp::Count && UE_ARRAY_COUNT(OperandCounts) == (int32)ETBEffectOp::Count, "One entry per op");
+
+    // Largest area radius and push distance a script may ask for
+    constexpr int32 MaxEffectRadius = 16;
+
+    // Whole number in [Min, Max]
+    bool ParseValue(const FString& Token, int32 Min, int32 Max, int32& OutValue, FString& OutError)
+    {
+        if (!Token.IsNumeric() || Token.Contains(TEXT(".")))
+        {
+            OutError = FString::Printf(TEXT("'%s' is not a whole number"), *Token);
+            return false;
+        }
+        OutValue = FCString::Atoi(*Token);
+        if (OutValue < Min || OutValue > Max)
+        {
+            OutError = FString::Printf(TEXT("%d is outside %d..%d"), OutValue, Min, Max);
+            return false;
+        }
+        return true;
+    }
+
+    // One of Names (case-insensitive), as its index
+    template <int32 NumNames>
+    bool ParseName(const FString& Token, const TCHAR* const (&Names)[NumNames], int32& OutIndex, FString& OutError)
+    {
+        for (int32 Index = 0; Index < NumNames; ++Index)
+        {
+            if (Token.Equals(Names[Index], ESearchCase::IgnoreCase))
+            {
+                OutIndex = Index;
+                return true;
+            }
+        }
+        OutError = FString::Printf(TEXT("unknown word '%s'"), *Token);
+        return false;
+    }
+
+    void Emit(TArray<int16>& Code, ETBEffectOp Op, int32 A = 0, int32 B = 0, int32 C = 0)
+    {
+        const int32 Operands[] = { A, B, C };
+        Code.Add((int16)Op);
+        for (int32 Index = 0; Index < OperandCounts[(int32)Op]; ++Index)
+        {
+            Code.Add((int16)Operands[Index]);
+        }
+    }
+
+    // damage / heal / push
+    bool CompileEffectStatement(const TArray<FString>& Tokens, TArray<int16>& Code, FString& OutError)
+    {
+        const FString& Keyword = Tokens[0];
+        if (Keyword.Equals(TEXT("damage"), ESearchCase::IgnoreCase))
+        {
+            if (Tokens.Num() == 1)
+            {
+                Emit(Code, ETBEffectOp::AbilityDamage);
+                return true;
+            }
+            FString MinText = Tokens[1];
+            FString MaxText = Tokens[1];
+            Tokens[1].Split(TEXT(".."), &MinText, &MaxText);
+
+            int32 Min = 0;
+            int32 Max = 0;
+            if (Tokens.Num() != 2 || !ParseValue(MinText, 0, MAX_int16, Min, OutError) || !ParseValue(MaxText, Min, MAX_int16, Max, OutError))
+            {
+                if (OutError.IsEmpty()) OutError = TEXT("expected 'damage', 'damage N' or 'damage Min..Max'");
+                return false;
+            }
+            Emit(Code, ETBEffectOp::Damage, Min, Max);
+            return true;
+        }
+
+        const bool bHeal = Keyword.Equals(TEXT("heal"), ESearchCase::IgnoreCase);
+        if (bHeal || Keyword.Equals(TEXT("push"), ESearchCase::IgnoreCase))
+        {
+            int32 Amount = 0;
+            if (Tokens.Num() != 2)
+            {
+                OutError = FString::Printf(TEXT("expected '%s N'"), *Keyword.ToLower());
+                return false;
+            }
+            if (!ParseValue(Tokens[1], 1, bHeal ? MAX_int16 : MaxEffectRadius, Amount, OutError)) return false;
+            Emit(Code, bHeal ? ETBEffectOp::Heal : ETBEffectOp::Push, Amount);
+            return true;
+        }
+
+        OutError = FString::Printf(TEXT("unknown statement '%s'"), *Keyword);
+        return false;
+    }
+
+    bool CompileStatement(const FString& Statement, TArray<int16>& Code, bool& bTargetTileOnly, FString& OutError)
+    {
+        if (Statement.StartsWith(TEXT("if "), ESearchCase::IgnoreCase))
+        {
+            int32 Colon = INDEX_NONE;
+            if (!Statement.FindChar(TEXT(':'), Colon))
+            {
+                OutError = TEXT("expected ':' after the condition");
+                return false;
+            }
+            TArray<FString> Condition;
+            Statement.Mid(3, Colon - 3).ParseIntoArrayWS(Condition);
+            TArray<FString> Effect;
+            Statement.Mid(Colon + 1).ParseIntoArrayWS(Effect);
+            if (Condition.Num() != 3 || Effect.Num() == 0)
+            {
+                OutError = TEXT("expected 'if <stat> <op> <value>: <statement>'");
+                return false;
+            }
+
+            static const TCHAR* const Stats[] = { TEXT("hp"), TEXT("hp%"), TEXT("ap"), TEXT("mp"), TEXT("distance") };
+            static const TCHAR* const Compares[] = { TEXT("<"), TEXT("<="), TEXT(">"), TEXT(">="), TEXT("=="), TEXT("!=") };
+            int32 Stat = 0;
+            int32 Compare = 0;
+            int32 Value = 0;
+            if (!ParseName(Condition[0], Stats, Stat, OutError) || !ParseName(Condition[1], Compares, Compare, OutError)
+                || !ParseValue(Condition[2], MIN_int16, MAX_int16, Value, OutError))
+            {
+                return false;
+            }
+            Emit(Code, ETBEffectOp::If, Stat, Compare, Value);
+            return CompileEffectStatement(Effect, Code, OutError);
+        }
+
+        TArray<FString> Tokens;
+        Statement.ParseIntoArrayWS(Tokens);
+        const FString& Keyword = Tokens[0];
+        if (Keyword.Equals(TEXT("area"), ESearchCase::IgnoreCase))
+        {
+            static const TCHAR* const Shapes[] = { TEXT("tile"), TEXT("diamond"), TEXT("square"), TEXT("line") };
+            int32 Shape = 0;
+            int32 Radius = 0;
+            if (Tokens.Num() < 2 || !ParseName(Tokens[1], Shapes, Shape, OutError))
+            {
+                if (OutError.IsEmpty()) OutError = TEXT("expected 'area tile', or 'area diamond|square|line R'");
+                return false;
+            }
+            if (Tokens.Num() != ((ETBEffectShape)Shape == ETBEffectShape::Tile ? 2 : 3))
+            {
+                OutError = TEXT("expected 'area tile', or 'area diamond|square|line R'");
+                return false;
+            }
+            if (Tokens.Num() == 3 && !ParseValue(Tokens[2], 1, MaxEffectRadius, Radius, OutError)) return false;
+            Emit(Code, ETBEffectOp::Area, Shape, Radius);
+            bTargetTileOnly &= (ETBEffectShape)Shape == ETBEffectShape::Tile;
+            return true;
+        }
+        if (Keyword.Equals(TEXT("filter"), ESearchCase::IgnoreCase))
+        {
+            static const TCHAR* const Filters[] = { TEXT("any"), TEXT("enemies"), TEXT("allies") };
+            int32 Filter = 0;
+            if (Tokens.Num() != 2 || !ParseName(Tokens[1], Filters, Filter, OutError))
+            {
+                if (OutError.IsEmpty()) OutError = TEXT("expected 'filter any|enemies|allies'");
+                return false;
+            }
+            Emit(Code, ETBEffectOp::Filter, Filter);
+            return true;
+        }
+        return CompileEffectStatement(Tokens, Code, OutError);
+    }
+}
+
+TSharedPtr<const FTBEffectProgram, ESPMode::ThreadSafe> FTBEffectProgram::Compile(const FString& Source, FString* OutError)
+{
+    TSharedRef<FTBEffectProgram, ESPMode::ThreadSafe> Program = MakeShared<FTBEffectProgram, ESPMode::ThreadSafe>();
+
+    TArray<FString> Lines;
+    Source.Replace(TEXT("\r"), TEXT("\n")).ParseIntoArray(Lines, TEXT("\n"));
+    int32 StatementNumber = 0;
+    for (FString& Line : Lines)
+    {
+        int32 Comment = INDEX_NONE;
+        if (Line.FindChar(TEXT('#'), Comment))
+        {
+            Line.LeftInline(Comment);
+        }
+
+        TArray<FString> Statements;
+        Line.ParseIntoArray(Statements, TEXT(";"));
+        for (FString& Statement : Statements)
+        {
+            Statement.TrimStartAndEndInline();
+            if (Statement.IsEmpty()) continue;
+
+            ++StatementNumber;
+            FString Error;
+            if (!CompileStatement(Statement, Program->Code, Program->bTargetTileOnly, Error))
+            {
+                if (OutError) *OutError = FString::Printf(TEXT("statement %d ('%s'): %s"), StatementNumber, *Statement, *Error);
+                return nullptr;
+            }
+        }
+    }
+
+    if (StatementNumber == 0)
+    {
+        Emit(Program->Code, ETBEffectOp::AbilityDamage);
+    }
+    Emit(Program->Code, ETBEffectOp::End);
+    Program->Code.Shrink();
+    return Program;
+}
+
+const FTBEffectProgram& FTBEffectProgram::GetDefault()
+{
+    static const TSharedPtr<const FTBEffectProgram, ESPMode::ThreadSafe> Default = Compile(FString());
+    return *Default;
+}
+
+int32 FTBEffectProgram::GetNumOperands(ETBEffectOp Op)
+{
+    return (uint8)Op < (uint8)ETBEffectOp::Count ? OperandCounts[(int32)Op] : 0;
+}
+
+FString FTBEffectProgram::Disassemble() const
+{
+    FString Listing;
+    for (int32 Index = 0; Index < Code.Num(); Index += 1 + GetNumOperands((ETBEffectOp)Code[Index]))
+    {
+        const int32 Op = Code[Index];
+        Listing += FString::Printf(TEXT("%3d %s"), Index, Op < (int32)ETBEffectOp::Count ? OpNames[Op] : TEXT("?"));
+        for (int32 Operand = 1; Operand <= GetNumOperands((ETBEffectOp)Op) && Code.IsValidIndex(Index + Operand); ++Operand)
+        {
+            Listing += FString::Printf(TEXT(" %d"), Code[Index + Operand]);
+        }
+        Listing += TEXT("\n");
+    }
+    return Listing;
+}
+
+void TBAbilityEffects::GetShapeTiles(ETBEffectShape Shape, int32 Radius, int32 Width, int32 Height, int32 CasterTile, int32 TargetTile, TArray<int32, TInlineAllocator<32>>& OutTiles)
+{
+    OutTiles.Reset();
+    if (TargetTile < 0 || TargetTile >= Width * Height) return;
+
+    const int32 TX = TargetTile % Width;
+    const int32 TY = TargetTile / Width;
+    switch (Shape)
+    {
+    case ETBEffectShape::Diamond:
+    case ETBEffectShape::Square:
+        for (int32 Y = FMath::Max(0, TY - Radius); Y <= FMath::Min(Height - 1, TY + Radius); ++Y)
+        {
+            for (int32 X = FMath::Max(0, TX - Radius); X <= FMath::Min(Width - 1, TX + Radius); ++X)
+            {
+                if (Shape == ETBEffectShape::Square || FMath::Abs(X - TX) + FMath::Abs(Y - TY) <= Radius)
+                {
+                    OutTiles.Add(Y * Width + X);
+                }
+            }
+        }
+        break;
+    case ETBEffectShape::Line:
+    {
+        int32 Tile = TargetTile;
+        OutTiles.Add(Tile);
+        for (int32 Step = 1; Step < Radius && CasterTile >= 0; ++Step)
+        {
+            Tile = StepAway(CasterTile, Tile, Width, Height);
+            if (Tile == INDEX_NONE) break;
+            OutTiles.Add(Tile);
+        }
+        break;
+    }
+    default:
+        OutTiles.Add(TargetTile);
+        break;
+    }
+}
+
+// Headless board for tb.Bench.AbilityEffects: units on an open grid. A unit brought to 0 HP is put back at full HP
+// so the benchmark can run millions of casts without the board emptying.
+struct FTBEffectBenchmarkBoard
+{
+    static constexpr int32 Size = 64;
+    static constexpr int32 MaxHP = 1000;
+
+    TArray<int32> UnitAtTile;
+    TArray<int32> HP;
+    TArray<int32> Team;
+    TArray<int32> Tile;
+    FTBEffectContext Context;
+
+    void Init(int32 NumUnits, int32 RandomSeed)
+    {
+        FRandomStream Random(RandomSeed);
+        UnitAtTile.Init(INDEX_NONE, Size * Size);
+        HP.Init(MaxHP, NumUnits);
+        Team.SetNum(NumUnits);
+        Tile.SetNum(NumUnits);
+        for (int32 Unit = 0; Unit < NumUnits; ++Unit)
+        {
+            int32 Free;
+            do
+            {
+                Free = Random.RandHelper(Size * Size);
+            } while (UnitAtTile[Free] != INDEX_NONE);
+            UnitAtTile[Free] = Unit;
+            Tile[Unit] = Free;
+            Team[Unit] = Unit & 1;
+        }
+    }
+
+    uint32 Checksum() const
+    {
+        uint32 Hash = 0;
+        for (int32 Unit = 0; Unit < HP.Num(); ++Unit)
+        {
+            Hash = HashCombine(Hash, HashCombine(GetTypeHash(HP[Unit]), GetTypeHash(Tile[Unit])));
+        }
+        return Hash;
+    }
+
+    // ExecuteEffect state interface
+    int32 GetWidth() const { return Size; }
+    int32 GetHeight() const { return Size; }
+    int32 GetUnitAt(int32 TileIndex) const { return UnitAtTile[TileIndex]; }
+    bool IsAlive(int32 Unit) const { return true; }
+    int32 GetTeam(int32 Unit) const { return Team[Unit]; }
+    int32 GetTile(int32 Unit) const { return Tile[Unit]; }
+    int32 GetStat(int32 Unit, ETBEffectStat Stat) const { return Stat == ETBEffectStat::HPPercent ? HP[Unit] * 100 / MaxHP : HP[Unit]; }
+    int32 GetRollId(int32 Unit) const { return Unit; }
+
+    void ApplyDamage(int32 Unit, int32 Amount, bool bMagical)
+    {
+        HP[Unit] -= Amount;
+        if (HP[Unit] <= 0) HP[Unit] += MaxHP;
+    }
+
+    int32 ApplyHeal(int32 Unit, int32 Amount)
+    {
+        const int32 Healed = FMath::Min(Amount, MaxHP - HP[Unit]);
+        HP[Unit] += Healed;
+        return Healed;
+    }
+
+    bool CanPushInto(int32 TileIndex) const { return UnitAtTile[TileIndex] == INDEX_NONE; }
+
+    void MoveUnit(int32 Unit, int32 TileIndex)
+    {
+        UnitAtTile[Tile[Unit]] = INDEX_NONE;
+        UnitAtTile[TileIndex] = Unit;
+        Tile[Unit] = TileIndex;
+    }
+
+    int32 Roll(int32 Unit, int32 Ordinal, int32 MinDamage, int32 MaxDamage) const
+    {
+        const uint64 Counter = DeterministicRandom::MakeCounter(Context.Turn, Context.CasterId, Context.AbilityId, Unit, Context.Sequence + (Ordinal << 16));
+        return DeterministicRandom::ToRange(DeterministicRandom::Squares32(Counter, DeterministicRandom::MakeKey(Context.MatchSeed)), MinDamage, MaxDamage);
+    }
+
+    int32 Push(int32 Unit, int32 Tiles)
+    {
+        int32 Current = Tile[Unit];
+        int32 Moved = 0;
+        for (; Moved < Tiles; ++Moved)
+        {
+            const int32 Next = TBAbilityEffects::StepAway(Context.CasterTile, Current, Size, Size);
+            if (Next == INDEX_NONE || !CanPushInto(Next)) break;
+            Current = Next;
+        }
+        if (Moved > 0) MoveUnit(Unit, Current);
+        return Moved;
+    }
+};
+
+int32 UTBEffectBenchmarkNodes::GetUnitAt(int32 TileIndex) const { return Board->GetUnitAt(TileIndex); }
+int32 UTBEffectBenchmarkNodes::GetTeam(int32 Unit) const { return Board->GetTeam(Unit); }
+int32 UTBEffectBenchmarkNodes::GetHPPercent(int32 Unit) const { return Board->GetStat(Unit, ETBEffectStat::HPPercent); }
+int32 UTBEffectBenchmarkNodes::RollDamage(int32 Unit, int32 Ordinal, int32 MinDamage, int32 MaxDamage) const { return Board->Roll(Unit, Ordinal, MinDamage, MaxDamage); }
+void UTBEffectBenchmarkNodes::ApplyDamage(int32 Unit, int32 Amount) { Board->ApplyDamage(Unit, Amount, false); }
+int32 UTBEffectBenchmarkNodes::PushAway(int32 Unit, int32 Tiles) { return Board->Push(Unit, Tiles); }
+
+namespace
+{
+    const TCHAR* const BenchmarkEffect = TEXT("area diamond 1; filter enemies; damage 4..8; if hp% < 50: damage 6; push 1");
+
+    // BenchmarkEffect written out by hand: the ceiling for any data-driven version
+    void RunNativeEffect(FTBEffectBenchmarkBoard& Board)
+    {
+        const FTBEffectContext& Context = Board.Context;
+        TArray<int32, TInlineAllocator<32>> Tiles;
+        TArray<int32, TInlineAllocator<32>> Targets;
+        TBAbilityEffects::GetShapeTiles(ETBEffectShape::Diamond, 1, Board.Size, Board.Size, Context.CasterTile, Context.TargetTile, Tiles);
+        for (int32 Tile : Tiles)
+        {
+            const int32 Unit = Board.GetUnitAt(Tile);
+            if (Unit != INDEX_NONE && Board.GetTeam(Unit) != Context.CasterTeam) Targets.Add(Unit);
+        }
+        for (int32 Unit : Targets)
+        {
+            Board.ApplyDamage(Unit, Board.Roll(Unit, 0, 4, 8), false);
+        }
+        for (int32 Unit : Targets)
+        {
+            if (Board.GetStat(Unit, ETBEffectStat::HPPercent) < 50) Board.ApplyDamage(Unit, 6, false);
+        }
+        for (int32 Unit : Targets)
+        {
+            Board.Push(Unit, 1);
+        }
+    }
+
+    // The same graph with every node a reflected call
+    struct FReflectedEffect
+    {
+        UTBEffectBenchmarkNodes* Nodes;
+        UFunction* GetUnitAt;
+        UFunction* GetTeam;
+        UFunction* GetHPPercent;
+        UFunction* RollDamage;
+        UFunction* ApplyDamage;
+        UFunction* PushAway;
+
+        explicit FReflectedEffect(UTBEffectBenchmarkNodes* InNodes)
+            : Nodes(InNodes)
+            , GetUnitAt(InNodes->FindFunctionChecked(GET_FUNCTION_NAME_CHECKED(UTBEffectBenchmarkNodes, GetUnitAt)))
+            , GetTeam(InNodes->FindFunctionChecked(GET_FUNCTION_NAME_CHECKED(UTBEffectBenchmarkNodes, GetTeam)))
+            , GetHPPercent(InNodes->FindFunctionChecked(GET_FUNCTION_NAME_CHECKED(UTBEffectBenchmarkNodes, GetHPPercent)))
+            , RollDamage(InNodes->FindFunctionChecked(GET_FUNCTION_NAME_CHECKED(UTBEffectBenchmarkNodes, RollDamage)))
+            , ApplyDamage(InNodes->FindFunctionChecked(GET_FUNCTION_NAME_CHECKED(UTBEffectBenchmarkNodes, ApplyDamage)))
+            , PushAway(InNodes->FindFunctionChecked(GET_FUNCTION_NAME_CHECKED(UTBEffectBenchmarkNodes, PushAway)))
+        {
+        }
+
+        int32 CallUnit(UFunction* Function, int32 Argument) const
+        {
+            struct { int32 Argument; int32 ReturnValue; } Params = { Argument, 0 };
+            Nodes->ProcessEvent(Function, &Params);
+            return Params.ReturnValue;
+        }
+
+        void Damage(int32 Unit, int32 Amount) const
+        {
+            struct { int32 Unit; int32 Amount; } Params = { Unit, Amount };
+            Nodes->ProcessEvent(ApplyDamage, &Params);
+        }
+
+        void Run(const FTBEffectContext& Context) const
+        {
+            TArray<int32, TInlineAllocator<32>> Tiles;
+            TArray<int32, TInlineAllocator<32>> Targets;
+            TBAbilityEffects::GetShapeTiles(ETBEffectShape::Diamond, 1, FTBEffectBenchmarkBoard::Size, FTBEffectBenchmarkBoard::Size, Context.CasterTile, Context.TargetTile, Tiles);
+            for (int32 Tile : Tiles)
+            {
+                const int32 Unit = CallUnit(GetUnitAt, Tile);
+                if (Unit != INDEX_NONE && CallUnit(GetTeam, Unit) != Context.CasterTeam) Targets.Add(Unit);
+            }
+            for (int32 Unit : Targets)
+            {
+                struct { int32 Unit; int32 Ordinal; int32 MinDamage; int32 MaxDamage; int32 ReturnValue; } Roll = { Unit, 0, 4, 8, 0 };
+                Nodes->ProcessEvent(RollDamage, &Roll);
+                Damage(Unit, Roll.ReturnValue);
+            }
+            for (int32 Unit : Targets)
+            {
+                if (CallUnit(GetHPPercent, Unit) < 50) Damage(Unit, 6);
+            }
+            for (int32 Unit : Targets)
+            {
+                struct { int32 Unit; int32 Tiles; int32 ReturnValue; } Push = { Unit, 1, 0 };
+                Nodes->ProcessEvent(PushAway, &Push);
+            }
+        }
+    };
+
+    void RunAbilityEffectBenchmark()
+    {
+        constexpr int32 NumUnits = 1024;
+        constexpr int32 NumCasts = 1 << 20;
+
+        FString Error;
+        const TSharedPtr<const FTBEffectProgram, ESPMode::ThreadSafe> Program = FTBEffectProgram::Compile(BenchmarkEffect, &Error);
+        if (!Program)
+        {
+            UE_LOG(LogTemp, Error, TEXT("AbilityEffects: benchmark effect does not compile: %s"), *Error);
+            return;
+        }
+        UE_LOG(LogTemp, Display, TEXT("AbilityEffects: '%s' compiles to %d bytes:\n%s"), BenchmarkEffect, Program->GetCode().Num() * (int32)sizeof(int16), *Program->Disassemble());
+
+        UTBEffectBenchmarkNodes* Nodes = NewObject<UTBEffectBenchmarkNodes>(GetTransientPackage());
+        Nodes->AddToRoot();
+
+        // Same casts on the same board three ways: bytecode, hand-written C++, reflected node calls
+        const TCHAR* const Names[] = { TEXT("bytecode"), TEXT("native"), TEXT("reflected") };
+        uint32 Checksums[3] = {};
+        for (int32 Variant = 0; Variant < 3; ++Variant)
+        {
+            FTBEffectBenchmarkBoard Board;
+            Board.Init(NumUnits, 77);
+            Nodes->Board = &Board;
+            const FReflectedEffect Reflected(Nodes);
+
+            // Reflected calls are slow enough that a fraction of the casts gives a stable rate
+            const int32 Casts = Variant == 2 ? NumCasts / 16 : NumCasts;
+            FRandomStream Random(5);
+            int64 Hits = 0;
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 Cast = 0; Cast < Casts; ++Cast)
+            {
+                // A random caster aims at a random unit's tile
+                const int32 Caster = Random.RandHelper(NumUnits);
+                FTBEffectContext& Context = Board.Context;
+                Context.CasterId = Caster;
+                Context.CasterTeam = Board.Team[Caster];
+                Context.CasterTile = Board.Tile[Caster];
+                Context.TargetTile = Board.Tile[Random.RandHelper(NumUnits)];
+                Context.Sequence = Cast;
+
+                if (Variant == 0)
+                {
+                    Hits += ExecuteEffect(*Program, Board, Context).NumHits;
+                }
+                else if (Variant == 1)
+                {
+                    RunNativeEffect(Board);
+                }
+                else
+                {
+                    Reflected.Run(Context);
+                }
+            }
+            const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+            // The reflected run stops early; replay the rest natively so all three end on the same board
+            for (int32 Cast = Casts; Cast < NumCasts; ++Cast)
+            {
+                const int32 Caster = Random.RandHelper(NumUnits);
+                FTBEffectContext& Context = Board.Context;
+                Context.CasterId = Caster;
+                Context.CasterTeam = Board.Team[Caster];
+                Context.CasterTile = Board.Tile[Caster];
+                Context.TargetTile = Board.Tile[Random.RandHelper(NumUnits)];
+                Context.Sequence = Cast;
+                RunNativeEffect(Board);
+            }
+            Checksums[Variant] = Board.Checksum();
+
+            UE_LOG(LogTemp, Display, TEXT("AbilityEffects %-9s %8.2f M executions/s (%.0f ns each)%s"),
+                Names[Variant], Casts / Seconds / 1.0e6, Seconds * 1.0e9 / Casts,
+                Variant == 0 ? *FString::Printf(TEXT(", %.2f units affected per cast"), (double)Hits / Casts) : TEXT(""));
+        }
+        Nodes->Board = nullptr;
+        Nodes->RemoveFromRoot();
+
+        UE_LOG(LogTemp, Display, TEXT("AbilityEffects: final boards %s"),
+            Checksums[0] == Checksums[1] && Checksums[1] == Checksums[2] ? TEXT("match") : TEXT("DO NOT MATCH"));
+    }
+
+    FAutoConsoleCommand AbilityEffectBenchmarkCommand(
+        TEXT("tb.Bench.AbilityEffects"),
+        TEXT("Executions per second of a compiled area/condition/push effect against hand-written C++ and reflected (Blueprint-style) node calls"),
+        FConsoleCommandDelegate::CreateStatic(&RunAbilityEffectBenchmark));
+}
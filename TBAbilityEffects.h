@@ -0,0 +1,313 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DeterministicRandom.h"
+
+// Ability effects as data. An ability's Effect text is compiled once into a few int16 words of bytecode and run by
+// ExecuteEffect against any battle state: the live actors (AUnitCharacter::CastAbilityAtTile) or the entities of a
+// headless match (FTBMatch).
+//
+// Statements are separated by ';' or new lines; '#' starts a comment.
+//   damage                  the ability's MinDamage..MaxDamage (what an empty Effect does)
+//   damage 4 | damage 4..8  fixed or rolled damage, magical when the ability is
+//   heal 5                  up to max HP
+//   push 2                  move targets up to 2 tiles away from the caster, stopping at walls and units
+//   area tile | diamond R | square R | line R
+//                           units the following statements affect, around the target tile (line: the target tile
+//                           and the R - 1 tiles beyond it, away from the caster)
+//   filter any | enemies | allies
+//   if <stat> <op> <value>: <statement>
+//                           the statement only affects targets passing the test. Stats: hp, hp%, ap, mp, distance
+//                           (Manhattan, from the caster); ops: < <= > >= == !=
+// Targets are picked when the first statement after an area or filter change runs, so a push does not change who
+// later statements hit. Defaults: area tile, filter any.
+
+enum class ETBEffectOp : uint8
+{
+    End,
+    // Shape, radius
+    Area,
+    // ETBEffectFilter
+    Filter,
+    // Stat, compare, value; applies to the next effect op
+    If,
+    // Min, max
+    Damage,
+    // Ability's own damage range
+    AbilityDamage,
+    // Amount
+    Heal,
+    // Tiles
+    Push,
+
+    Count
+};
+
+enum class ETBEffectShape : uint8
+{
+    Tile,
+    Diamond,
+    Square,
+    Line
+};
+
+enum class ETBEffectFilter : uint8
+{
+    Any,
+    Enemies,
+    Allies
+};
+
+enum class ETBEffectStat : uint8
+{
+    HP,
+    HPPercent,
+    ActionPoints,
+    MovementPoints,
+    Distance
+};
+
+enum class ETBEffectCompare : uint8
+{
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
+};
+
+// Compiled effect: op words each followed by their operands, ending with End
+class DENEME_API FTBEffectProgram
+{
+public:
+    // Compile Source; returns nullptr and fills OutError (with the statement number) on a syntax error
+    static TSharedPtr<const FTBEffectProgram, ESPMode::ThreadSafe> Compile(const FString& Source, FString* OutError = nullptr);
+
+    // The program of an empty Effect: "damage"
+    static const FTBEffectProgram& GetDefault();
+
+    // Operand words following an op
+    static int32 GetNumOperands(ETBEffectOp Op);
+
+    const TArray<int16>& GetCode() const { return Code; }
+
+    // Only ever affects the unit on the target tile (no area statement), so a cast at an empty tile does nothing
+    bool AffectsTargetTileOnly() const { return bTargetTileOnly; }
+
+    // Readable listing, one op per line
+    FString Disassemble() const;
+
+    SIZE_T GetAllocatedSize() const { return Code.GetAllocatedSize(); }
+
+private:
+    TArray<int16> Code;
+    bool bTargetTileOnly = true;
+};
+
+// Who casts what at which tile, and what the rolls are keyed on (see DeterministicRandom)
+struct FTBEffectContext
+{
+    uint64 MatchSeed = 0;
+    int32 Turn = 0;
+    int32 CasterId = 0;
+    int32 AbilityId = 0;
+    int32 Sequence = 0;
+
+    int32 CasterTeam = 0;
+    int32 CasterTile = INDEX_NONE;
+    int32 TargetTile = INDEX_NONE;
+
+    int32 MinDamage = 0;
+    int32 MaxDamage = 0;
+    bool bMagical = false;
+};
+
+struct FTBEffectResult
+{
+    // Effect ops that changed a unit
+    int32 NumHits = 0;
+    int32 TotalDamage = 0;
+    int32 TotalHealing = 0;
+    int32 TilesPushed = 0;
+};
+
+namespace TBAbilityEffects
+{
+    // Tile indices of Shape around the target (clipped to the grid)
+    DENEME_API void GetShapeTiles(ETBEffectShape Shape, int32 Radius, int32 Width, int32 Height, int32 CasterTile, int32 TargetTile, TArray<int32, TInlineAllocator<32>>& OutTiles);
+
+    FORCEINLINE bool Compare(int32 Value, ETBEffectCompare Op, int32 Operand)
+    {
+        switch (Op)
+        {
+        case ETBEffectCompare::Less: return Value < Operand;
+        case ETBEffectCompare::LessEqual: return Value <= Operand;
+        case ETBEffectCompare::Greater: return Value > Operand;
+        case ETBEffectCompare::GreaterEqual: return Value >= Operand;
+        case ETBEffectCompare::Equal: return Value == Operand;
+        default: return Value != Operand;
+        }
+    }
+
+    // One step from From away from Origin along the dominant axis (X on ties), or INDEX_NONE at the grid edge
+    FORCEINLINE int32 StepAway(int32 Origin, int32 From, int32 Width, int32 Height)
+    {
+        const int32 DX = From % Width - Origin % Width;
+        const int32 DY = From / Width - Origin / Width;
+        if (DX == 0 && DY == 0) return INDEX_NONE;
+
+        const bool bAlongX = FMath::Abs(DX) >= FMath::Abs(DY);
+        const int32 X = From % Width + (bAlongX ? FMath::Sign(DX) : 0);
+        const int32 Y = From / Width + (bAlongX ? 0 : FMath::Sign(DY));
+        return X >= 0 && X < Width && Y >= 0 && Y < Height ? Y * Width + X : INDEX_NONE;
+    }
+}
+
+// Run a program. StateType provides, for unit handles of its choosing:
+//   int32 GetWidth() const, GetHeight() const
+//   int32 GetUnitAt(int32 TileIndex)                  handle, or INDEX_NONE
+//   bool IsAlive(int32 Unit) const
+//   int32 GetTeam(int32 Unit) const, GetTile(int32 Unit) const
+//   int32 GetStat(int32 Unit, ETBEffectStat Stat) const  (never asked for Distance)
+//   int32 GetRollId(int32 Unit) const                 target id of damage rolls
+//   void ApplyDamage(int32 Unit, int32 Amount, bool bMagical)
+//   int32 ApplyHeal(int32 Unit, int32 Amount)         HP actually restored
+//   bool CanPushInto(int32 TileIndex) const
+//   void MoveUnit(int32 Unit, int32 TileIndex)
+// The n-th damage op of a program rolls with Sequence + (n << 16), so the first one rolls exactly like a plain cast.
+template <typename StateType>
+FTBEffectResult ExecuteEffect(const FTBEffectProgram& Program, StateType& State, const FTBEffectContext& Context)
+{
+    FTBEffectResult Result;
+    const int32 Width = State.GetWidth();
+    const int32 Height = State.GetHeight();
+    const uint64 Key = DeterministicRandom::MakeKey(Context.MatchSeed);
+
+    ETBEffectShape Shape = ETBEffectShape::Tile;
+    int32 Radius = 0;
+    ETBEffectFilter Filter = ETBEffectFilter::Any;
+    bool bSelect = true;
+    TArray<int32, TInlineAllocator<32>> Tiles;
+    TArray<int32, TInlineAllocator<32>> Targets;
+
+    bool bHasCondition = false;
+    ETBEffectStat ConditionStat = ETBEffectStat::HP;
+    ETBEffectCompare ConditionCompare = ETBEffectCompare::Less;
+    int32 ConditionValue = 0;
+    int32 DamageOrdinal = 0;
+
+    const int16* Code = Program.GetCode().GetData();
+    for (;;)
+    {
+        const ETBEffectOp Op = (ETBEffectOp)*Code;
+        switch (Op)
+        {
+        case ETBEffectOp::End:
+            return Result;
+        case ETBEffectOp::Area:
+            Shape = (ETBEffectShape)Code[1];
+            Radius = Code[2];
+            bSelect = true;
+            Code += 3;
+            continue;
+        case ETBEffectOp::Filter:
+            Filter = (ETBEffectFilter)Code[1];
+            bSelect = true;
+            Code += 2;
+            continue;
+        case ETBEffectOp::If:
+            bHasCondition = true;
+            ConditionStat = (ETBEffectStat)Code[1];
+            ConditionCompare = (ETBEffectCompare)Code[2];
+            ConditionValue = Code[3];
+            Code += 4;
+            continue;
+        default:
+            break;
+        }
+
+        if (bSelect)
+        {
+            bSelect = false;
+            Targets.Reset();
+            TBAbilityEffects::GetShapeTiles(Shape, Radius, Width, Height, Context.CasterTile, Context.TargetTile, Tiles);
+            for (int32 Tile : Tiles)
+            {
+                const int32 Unit = State.GetUnitAt(Tile);
+                if (Unit == INDEX_NONE) continue;
+                const bool bAlly = State.GetTeam(Unit) == Context.CasterTeam;
+                if (Filter == ETBEffectFilter::Any || bAlly == (Filter == ETBEffectFilter::Allies))
+                {
+                    Targets.Add(Unit);
+                }
+            }
+        }
+
+        for (int32 Unit : Targets)
+        {
+            if (!State.IsAlive(Unit)) continue;
+            if (bHasCondition)
+            {
+                int32 Value;
+                if (ConditionStat == ETBEffectStat::Distance)
+                {
+                    const int32 Tile = State.GetTile(Unit);
+                    Value = FMath::Abs(Tile % Width - Context.CasterTile % Width) + FMath::Abs(Tile / Width - Context.CasterTile / Width);
+                }
+                else
+                {
+                    Value = State.GetStat(Unit, ConditionStat);
+                }
+                if (!TBAbilityEffects::Compare(Value, ConditionCompare, ConditionValue)) continue;
+            }
+
+            switch (Op)
+            {
+            case ETBEffectOp::Damage:
+            case ETBEffectOp::AbilityDamage:
+            {
+                const bool bOwnRange = Op == ETBEffectOp::AbilityDamage;
+                const uint64 Counter = DeterministicRandom::MakeCounter(Context.Turn, Context.CasterId, Context.AbilityId, State.GetRollId(Unit), Context.Sequence + (DamageOrdinal << 16));
+                const int32 Damage = DeterministicRandom::ToRange(DeterministicRandom::Squares32(Counter, Key),
+                    bOwnRange ? Context.MinDamage : Code[1], bOwnRange ? Context.MaxDamage : Code[2]);
+                State.ApplyDamage(Unit, Damage, Context.bMagical);
+                Result.TotalDamage += Damage;
+                ++Result.NumHits;
+                break;
+            }
+            case ETBEffectOp::Heal:
+                Result.TotalHealing += State.ApplyHeal(Unit, Code[1]);
+                ++Result.NumHits;
+                break;
+            case ETBEffectOp::Push:
+            {
+                int32 Tile = State.GetTile(Unit);
+                int32 Moved = 0;
+                for (; Moved < Code[1]; ++Moved)
+                {
+                    const int32 Next = TBAbilityEffects::StepAway(Context.CasterTile, Tile, Width, Height);
+                    if (Next == INDEX_NONE || !State.CanPushInto(Next)) break;
+                    Tile = Next;
+                }
+                if (Moved > 0)
+                {
+                    State.MoveUnit(Unit, Tile);
+                    Result.TilesPushed += Moved;
+                    ++Result.NumHits;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        if (Op == ETBEffectOp::Damage || Op == ETBEffectOp::AbilityDamage)
+        {
+            ++DamageOrdinal;
+        }
+        bHasCondition = false;
+        Code += 1 + FTBEffectProgram::GetNumOperands(Op);
+    }
+}
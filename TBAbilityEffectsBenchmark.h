@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "TBAbilityEffectsBenchmark.generated.h"
+
+struct FTBEffectBenchmarkBoard;
+
+// Reflective version of the tb.Bench.AbilityEffects effect (TBAbilityEffects.cpp only): one UFUNCTION per graph node,
+// called through ProcessEvent the way the Blueprint VM calls native nodes
+UCLASS()
+class UTBEffectBenchmarkNodes : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    UFUNCTION()
+    int32 GetUnitAt(int32 TileIndex) const;
+
+    UFUNCTION()
+    int32 GetTeam(int32 Unit) const;
+
+    UFUNCTION()
+    int32 GetHPPercent(int32 Unit) const;
+
+    UFUNCTION()
+    int32 RollDamage(int32 Unit, int32 Ordinal, int32 MinDamage, int32 MaxDamage) const;
+
+    UFUNCTION()
+    void ApplyDamage(int32 Unit, int32 Amount);
+
+    UFUNCTION()
+    int32 PushAway(int32 Unit, int32 Tiles);
+
+    FTBEffectBenchmarkBoard* Board = nullptr;
+};
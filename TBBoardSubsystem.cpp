@@ -0,0 +1,176 @@
+#include "TBBoardSubsystem.h"
+#include "AGridManager.h"
+#include "AGridTile.h"
+#include "UnitCharacter.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+UTBBoardSubsystem* UTBBoardSubsystem::Get(const UObject* WorldContextObject)
+{
+    UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+    return World ? World->GetSubsystem<UTBBoardSubsystem>() : nullptr;
+}
+
+AUnitCharacter* UTBBoardSubsystem::GetUnitAt(int32 TileIndex) const
+{
+    AUnitCharacter* const* Unit = UnitsByTile.Find(TileIndex);
+    return Unit ? *Unit : nullptr;
+}
+
+AUnitCharacter* UTBBoardSubsystem::GetUnitOnTile(const AGridTile* Tile) const
+{
+    const AGridManager* Grid = GetGrid();
+    if (!Tile || !Grid || Tile->GetGridManager() != Grid) return nullptr;
+    return GetUnitAt(Tile->Y * Grid->GridWidth + Tile->X);
+}
+
+const TArray<AUnitCharacter*>& UTBBoardSubsystem::GetTeamUnits(int32 TeamId) const
+{
+    static const TArray<AUnitCharacter*> NoUnits;
+    const FTBTeamUnits* Team = Teams.Find(TeamId);
+    return Team ? Team->Units : NoUnits;
+}
+
+void UTBBoardSubsystem::GetTeamIds(TArray<int32>& OutTeamIds) const
+{
+    OutTeamIds.Reset();
+    for (const TPair<int32, FTBTeamUnits>& Team : Teams)
+    {
+        if (Team.Value.Units.Num()) OutTeamIds.Add(Team.Key);
+    }
+    OutTeamIds.Sort();
+}
+
+void UTBBoardSubsystem::RegisterGrid(AGridManager* Grid)
+{
+    if (!Grid) return;
+    Grids.Remove(Grid);
+    Grids.Add(Grid);
+    RebuildTileMap();
+}
+
+void UTBBoardSubsystem::NotifyBoardGenerated(AGridManager* Grid)
+{
+    // A grid generated before its BeginPlay (editor tools, commandlets) becomes active here
+    if (Grid && !Grids.Contains(Grid))
+    {
+        Grids.Add(Grid);
+    }
+    RebuildTileMap();
+}
+
+void UTBBoardSubsystem::UnregisterGrid(AGridManager* Grid)
+{
+    if (Grids.Remove(Grid) > 0)
+    {
+        RebuildTileMap();
+    }
+}
+
+void UTBBoardSubsystem::RegisterUnit(AUnitCharacter* Unit)
+{
+    if (!Unit || Registered.Contains(Unit)) return;
+
+    FRegisteredUnit& Entry = Registered.Add(Unit);
+    Entry.TeamId = Unit->TeamId;
+    Teams.FindOrAdd(Unit->TeamId).Units.Add(Unit);
+    SetUnitTile(Unit, Entry, GetTileIndexOf(Unit));
+    ++BoardGeneration;
+}
+
+void UTBBoardSubsystem::UpdateUnitTile(AUnitCharacter* Unit)
+{
+    if (!Unit) return;
+
+    FRegisteredUnit* Entry = Registered.Find(Unit);
+    if (!Entry)
+    {
+        RegisterUnit(Unit);
+        return;
+    }
+    SyncUnitTeam(Unit, *Entry);
+    SetUnitTile(Unit, *Entry, GetTileIndexOf(Unit));
+    ++BoardGeneration;
+}
+
+void UTBBoardSubsystem::UpdateUnitTeam(AUnitCharacter* Unit)
+{
+    if (FRegisteredUnit* Entry = Unit ? Registered.Find(Unit) : nullptr)
+    {
+        SyncUnitTeam(Unit, *Entry);
+    }
+}
+
+void UTBBoardSubsystem::UnregisterUnit(AUnitCharacter* Unit)
+{
+    FRegisteredUnit Entry;
+    if (!Unit || !Registered.RemoveAndCopyValue(Unit, Entry)) return;
+
+    if (Entry.TileIndex != INDEX_NONE && GetUnitAt(Entry.TileIndex) == Unit)
+    {
+        UnitsByTile.Remove(Entry.TileIndex);
+    }
+    if (FTBTeamUnits* Team = Teams.Find(Entry.TeamId))
+    {
+        Team->Units.RemoveSingle(Unit);
+    }
+    ++BoardGeneration;
+}
+
+int32 UTBBoardSubsystem::GetTileIndexOf(const AUnitCharacter* Unit) const
+{
+    const AGridManager* Grid = GetGrid();
+    const AGridTile* Tile = Unit->CurrentTile;
+    if (!Grid || !Tile || Tile->GetGridManager() != Grid) return INDEX_NONE;
+    return Tile->Y * Grid->GridWidth + Tile->X;
+}
+
+void UTBBoardSubsystem::SetUnitTile(AUnitCharacter* Unit, FRegisteredUnit& Entry, int32 TileIndex)
+{
+    if (Entry.TileIndex != INDEX_NONE && GetUnitAt(Entry.TileIndex) == Unit)
+    {
+        UnitsByTile.Remove(Entry.TileIndex);
+    }
+    Entry.TileIndex = TileIndex;
+    if (TileIndex != INDEX_NONE)
+    {
+        UnitsByTile.Add(TileIndex, Unit);
+    }
+}
+
+void UTBBoardSubsystem::SyncUnitTeam(AUnitCharacter* Unit, FRegisteredUnit& Entry)
+{
+    if (Entry.TeamId == Unit->TeamId) return;
+
+    if (FTBTeamUnits* OldTeam = Teams.Find(Entry.TeamId))
+    {
+        OldTeam->Units.RemoveSingle(Unit);
+    }
+    Entry.TeamId = Unit->TeamId;
+    Teams.FindOrAdd(Entry.TeamId).Units.Add(Unit);
+    ++BoardGeneration;
+}
+
+void UTBBoardSubsystem::RebuildTileMap()
+{
+    UnitsByTile.Reset();
+    for (TPair<AUnitCharacter*, FRegisteredUnit>& Pair : Registered)
+    {
+        Pair.Value.TileIndex = INDEX_NONE;
+    }
+    for (TPair<AUnitCharacter*, FRegisteredUnit>& Pair : Registered)
+    {
+        SetUnitTile(Pair.Key, Pair.Value, GetTileIndexOf(Pair.Key));
+    }
+    ++BoardGeneration;
+}
+
+SIZE_T UTBBoardSubsystem::GetAllocatedSize() const
+{
+    SIZE_T Size = Grids.GetAllocatedSize() + Teams.GetAllocatedSize() + UnitsByTile.GetAllocatedSize() + Registered.GetAllocatedSize();
+    for (const TPair<int32, FTBTeamUnits>& Team : Teams)
+    {
+        Size += Team.Value.Units.GetAllocatedSize();
+    }
+    return Size;
+}
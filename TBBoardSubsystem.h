@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TBBoardSubsystem.generated.h"
+
+class AGridManager;
+class AGridTile;
+class AUnitCharacter;
+
+USTRUCT()
+struct FTBTeamUnits
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<AUnitCharacter*> Units;
+};
+
+// Registry of the board in one world: the active grid, the live units of each team and which unit stands on which
+// tile. Grids and units register themselves and report moves and deaths (BeginPlay, CommitToTile, OnDeath, EndPlay),
+// so controllers, the HUD and AI look things up in O(1) instead of iterating actors or tracing.
+UCLASS()
+class DENEME_API UTBBoardSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UTBBoardSubsystem* Get(const UObject* WorldContextObject);
+
+    // Grid units play on: the most recently registered one
+    UFUNCTION(BlueprintCallable, Category = "Board")
+    AGridManager* GetGrid() const { return Grids.Num() ? Grids.Last() : nullptr; }
+
+    // Unit standing on a tile of the active grid (Y * GridWidth + X), or nullptr
+    UFUNCTION(BlueprintCallable, Category = "Board")
+    AUnitCharacter* GetUnitAt(int32 TileIndex) const;
+
+    UFUNCTION(BlueprintCallable, Category = "Board")
+    AUnitCharacter* GetUnitOnTile(const AGridTile* Tile) const;
+
+    // Live units of a team, in registration order
+    UFUNCTION(BlueprintCallable, Category = "Board")
+    TArray<AUnitCharacter*> GetUnitsOfTeam(int32 TeamId) const { return GetTeamUnits(TeamId); }
+
+    // Same without a copy
+    const TArray<AUnitCharacter*>& GetTeamUnits(int32 TeamId) const;
+
+    // Teams with at least one live unit
+    void GetTeamIds(TArray<int32>& OutTeamIds) const;
+
+    int32 GetNumUnits() const { return Registered.Num(); }
+
+    // Calls Fn(AUnitCharacter*) for every live unit, team by team
+    template <typename FuncType>
+    void ForEachUnit(FuncType&& Fn) const
+    {
+        for (const TPair<int32, FTBTeamUnits>& Team : Teams)
+        {
+            for (AUnitCharacter* Unit : Team.Value.Units)
+            {
+                Fn(Unit);
+            }
+        }
+    }
+
+    // Bumped when the board is regenerated, a unit registers, moves, changes team or leaves, and whenever the grid
+    // reports an occupancy or sight-blocker change; targeting results are cached against it (AGridManager::GetTargetingVersion)
+    uint32 GetBoardGeneration() const { return BoardGeneration; }
+    void BumpBoardGeneration() { ++BoardGeneration; }
+
+    // Called by AGridManager (BeginPlay, end of generation, EndPlay)
+    void RegisterGrid(AGridManager* Grid);
+    void NotifyBoardGenerated(AGridManager* Grid);
+    void UnregisterGrid(AGridManager* Grid);
+
+    // Called by AUnitCharacter. UpdateUnitTile re-reads the unit's CurrentTile and TeamId (registering it if needed),
+    // UpdateUnitTeam only its TeamId (SetTeam); UnregisterUnit is for death, going dormant as a pooled proxy and EndPlay.
+    void RegisterUnit(AUnitCharacter* Unit);
+    void UpdateUnitTile(AUnitCharacter* Unit);
+    void UpdateUnitTeam(AUnitCharacter* Unit);
+    void UnregisterUnit(AUnitCharacter* Unit);
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    struct FRegisteredUnit
+    {
+        int32 TeamId = 0;
+
+        // Key in UnitsByTile, or INDEX_NONE when not on a tile of the active grid
+        int32 TileIndex = INDEX_NONE;
+    };
+
+    // Tile index of the unit's CurrentTile on the active grid, or INDEX_NONE
+    int32 GetTileIndexOf(const AUnitCharacter* Unit) const;
+
+    void SetUnitTile(AUnitCharacter* Unit, FRegisteredUnit& Entry, int32 TileIndex);
+
+    // Move the unit to the team list of its current TeamId
+    void SyncUnitTeam(AUnitCharacter* Unit, FRegisteredUnit& Entry);
+
+    // Re-key every unit after the active grid changed
+    void RebuildTileMap();
+
+    UPROPERTY()
+    TArray<AGridManager*> Grids;
+
+    UPROPERTY()
+    TMap<int32, FTBTeamUnits> Teams;
+
+    UPROPERTY()
+    TMap<int32, AUnitCharacter*> UnitsByTile;
+
+    TMap<AUnitCharacter*, FRegisteredUnit> Registered;
+
+    uint32 BoardGeneration = 0;
+};
@@ -0,0 +1,432 @@
+#include "TBMatchServer.h"
+#include "DeterministicRandom.h"
+#include "TBAbilityEffects.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Math/RandomStream.h"
+
+TSharedRef<const FTBSharedMap, ESPMode::ThreadSafe> FTBSharedMap::Build(const FBuildParams& Params)
+{
+    TSharedRef<FTBSharedMap, ESPMode::ThreadSafe> Map = MakeShared<FTBSharedMap, ESPMode::ThreadSafe>();
+    FGridPathfinder& Pathfinder = Map->Pathfinder;
+    Pathfinder.Init(FMath::Max(8, Params.Width), FMath::Max(8, Params.Height), Params.Connectivity);
+
+    FRandomStream Random((int32)Params.Seed);
+    for (int32 Index = 0; Index < Pathfinder.NumTiles(); ++Index)
+    {
+        const float Roll = Random.GetFraction();
+        if (Roll < Params.WallFraction)
+        {
+            Pathfinder.SetTileCost(Index, FGridPathfinder::Blocked);
+        }
+        else
+        {
+            Pathfinder.SetTileCost(Index, Roll < Params.WallFraction + Params.RoughFraction ? 2 : 1);
+        }
+    }
+    Pathfinder.BuildLandmarks(Params.NumLandmarks);
+    return Map;
+}
+
+FTBMatch::FTBMatch(int32 InMatchId, const FTBSharedMapRef& InMap, const FUnitArchetype& Archetype, const FTBMatchSettings& Settings)
+    : MatchId(InMatchId)
+    , Map(InMap)
+    , Seed(Settings.Seed)
+    , MaxTurns(FMath::Max(1, Settings.MaxTurns))
+{
+    const int32 Width = Map->GetWidth();
+    const int32 Height = Map->GetHeight();
+    Occupancy.Init(Width, Height);
+
+    const int32 ArchetypeIndex = Units.AddArchetype(Archetype);
+    Units.Reserve(Settings.UnitsPerTeam * 2);
+    EntityAtTile.Reserve(Settings.UnitsPerTeam * 2);
+
+    // Teams start in the outer thirds of the map
+    FRandomStream Random((int32)DeterministicRandom::Mix64((uint64)Seed));
+    for (int32 Index = 0; Index < Settings.UnitsPerTeam * 2; ++Index)
+    {
+        const int32 TeamId = Index & 1;
+        for (int32 Attempt = 0; Attempt < 64; ++Attempt)
+        {
+            const int32 X = Random.RandRange(0, Width / 3 - 1) + TeamId * (Width - Width / 3);
+            const int32 Y = Random.RandRange(0, Height - 1);
+            const int32 Tile = Y * Width + X;
+            if (!Map->IsWalkable(Tile) || EntityAtTile.Contains(Tile)) continue;
+
+            const int32 EntityId = Units.Create(ArchetypeIndex, TeamId, Tile);
+            Occupancy.SetOccupied(X, Y, TeamId, true);
+            EntityAtTile.Add(Tile, EntityId);
+            break;
+        }
+    }
+}
+
+void FTBMatch::StepTurn(FTBMatchScratch& Scratch)
+{
+    if (bFinished) return;
+
+    ++TurnNumber;
+    Units.ResetAllForNewTurn();
+    for (int32 EntityId = 0; EntityId < Units.Num(); ++EntityId)
+    {
+        if (Units.IsAlive(EntityId))
+        {
+            ActUnit(EntityId, Scratch);
+        }
+    }
+
+    const int32 Alive0 = GetNumAlive(0);
+    const int32 Alive1 = GetNumAlive(1);
+    if (Alive0 == 0 || Alive1 == 0)
+    {
+        bFinished = true;
+        WinningTeam = Alive0 > 0 ? 0 : (Alive1 > 0 ? 1 : INDEX_NONE);
+    }
+    else if (TurnNumber >= MaxTurns)
+    {
+        bFinished = true;
+    }
+}
+
+int32 FTBMatch::GetNumAlive(int32 TeamId) const
+{
+    int32 Count = 0;
+    for (int32 EntityId = 0; EntityId < Units.Num(); ++EntityId)
+    {
+        Count += Units.IsAlive(EntityId) && Units.TeamId[EntityId] == TeamId;
+    }
+    return Count;
+}
+
+SIZE_T FTBMatch::GetAllocatedSize() const
+{
+    return sizeof(*this) + Units.GetAllocatedSize() + Occupancy.GetAllocatedSize() + EntityAtTile.GetAllocatedSize();
+}
+
+struct FTBMatch::FEffectState
+{
+    FTBMatch& Match;
+
+    explicit FEffectState(FTBMatch& InMatch) : Match(InMatch) {}
+
+    int32 GetWidth() const { return Match.Map->GetWidth(); }
+    int32 GetHeight() const { return Match.Map->GetHeight(); }
+
+    int32 GetUnitAt(int32 TileIndex) const
+    {
+        const int32* Entity = Match.EntityAtTile.Find(TileIndex);
+        return Entity ? *Entity : INDEX_NONE;
+    }
+
+    bool IsAlive(int32 Entity) const { return Match.Units.IsAlive(Entity); }
+    int32 GetTeam(int32 Entity) const { return Match.Units.TeamId[Entity]; }
+    int32 GetTile(int32 Entity) const { return Match.Units.TileIndex[Entity]; }
+
+    int32 GetStat(int32 Entity, ETBEffectStat Stat) const
+    {
+        const FUnitEntityStore& Units = Match.Units;
+        switch (Stat)
+        {
+        case ETBEffectStat::HPPercent:
+        {
+            const int32 MaxHP = Units.GetArchetype(Entity).MaxHP;
+            return MaxHP > 0 ? Units.HP[Entity] * 100 / MaxHP : 0;
+        }
+        case ETBEffectStat::ActionPoints: return Units.ActionPoints[Entity];
+        case ETBEffectStat::MovementPoints: return Units.MovementPoints[Entity];
+        default: return Units.HP[Entity];
+        }
+    }
+
+    int32 GetRollId(int32 Entity) const { return Entity; }
+
+    void ApplyDamage(int32 Entity, int32 Amount, bool bMagical)
+    {
+        if (Match.Units.ApplyDamage(Entity, Amount))
+        {
+            Match.KillUnit(Entity);
+        }
+    }
+
+    int32 ApplyHeal(int32 Entity, int32 Amount)
+    {
+        int32& HP = Match.Units.HP[Entity];
+        const int32 Healed = FMath::Clamp(Match.Units.GetArchetype(Entity).MaxHP - HP, 0, Amount);
+        HP += Healed;
+        return Healed;
+    }
+
+    bool CanPushInto(int32 TileIndex) const { return Match.Map->IsWalkable(TileIndex) && !Match.EntityAtTile.Contains(TileIndex); }
+
+    void MoveUnit(int32 Entity, int32 TileIndex) { Match.PlaceUnit(Entity, TileIndex); }
+};
+
+void FTBMatch::ActUnit(int32 EntityId, FTBMatchScratch& Scratch)
+{
+    const int32 Enemy = FindNearestEnemy(EntityId);
+    if (Enemy == INDEX_NONE) return;
+
+    // Close in until the longest-ranged ability reaches
+    const FUnitArchetype& Archetype = Units.GetArchetype(EntityId);
+    int32 Range = 1;
+    for (const FAbilityData& Ability : Archetype.Abilities)
+    {
+        Range = FMath::Max(Range, Ability.Range);
+    }
+    MoveTowards(EntityId, Units.TileIndex[Enemy], Range, Scratch);
+
+    // Cast every ability at the first enemy in range while casts and AP last
+    const int32 Width = Map->GetWidth();
+    const int32 TeamId = Units.TeamId[EntityId];
+    for (int32 Slot = 0; Slot < FUnitEntityStore::NumAbilitySlots; ++Slot)
+    {
+        const FAbilityData& Ability = Archetype.Abilities[Slot];
+        while (Units.CastsRemaining(EntityId, Slot) > 0 && Units.ActionPoints[EntityId] >= Ability.APCost)
+        {
+            const int32 Tile = Units.TileIndex[EntityId];
+            int32 TargetTile = INDEX_NONE;
+            Occupancy.ForEachUnitInRange(Tile % Width, Tile / Width, Ability.Range, TeamId, true, false, [&TargetTile, Width](int32 X, int32 Y)
+            {
+                if (TargetTile == INDEX_NONE) TargetTile = Y * Width + X;
+            });
+            const int32* Target = EntityAtTile.Find(TargetTile);
+            if (!Target) break;
+
+            Units.SpendAction(EntityId, Ability.APCost);
+            --Units.CastsRemaining(EntityId, Slot);
+
+            FTBEffectContext Context;
+            Context.MatchSeed = (uint64)Seed;
+            Context.Turn = TurnNumber;
+            Context.CasterId = EntityId;
+            Context.AbilityId = Slot;
+            // Casts of this ability made this turn before this one, as AUnitCharacter::ApplyAbilityToTile keys them
+            Context.Sequence = FMath::Max(0, Ability.MaxCastsPerTurn - Units.CastsRemaining(EntityId, Slot) - 1);
+            Context.CasterTeam = TeamId;
+            Context.CasterTile = Tile;
+            Context.TargetTile = TargetTile;
+            Context.MinDamage = Ability.MinDamage;
+            Context.MaxDamage = Ability.MaxDamage;
+            Context.bMagical = Ability.bIsMagical;
+
+            FEffectState State(*this);
+            ExecuteEffect(Ability.GetEffectProgram(), State, Context);
+
+            // Effects that hit everything in an area can take the caster down too
+            if (!Units.IsAlive(EntityId)) return;
+        }
+    }
+}
+
+int32 FTBMatch::FindNearestEnemy(int32 EntityId) const
+{
+    const int32 Width = Map->GetWidth();
+    const int32 Tile = Units.TileIndex[EntityId];
+    const int32 X = Tile % Width;
+    const int32 Y = Tile / Width;
+
+    int32 Nearest = INDEX_NONE;
+    int32 NearestDistance = MAX_int32;
+    for (int32 Other = 0; Other < Units.Num(); ++Other)
+    {
+        if (!Units.IsAlive(Other) || Units.TeamId[Other] == Units.TeamId[EntityId]) continue;
+
+        const int32 OtherTile = Units.TileIndex[Other];
+        const int32 Distance = FMath::Abs(OtherTile % Width - X) + FMath::Abs(OtherTile / Width - Y);
+        if (Distance < NearestDistance)
+        {
+            Nearest = Other;
+            NearestDistance = Distance;
+        }
+    }
+    return Nearest;
+}
+
+void FTBMatch::MoveTowards(int32 EntityId, int32 TargetTile, int32 Range, FTBMatchScratch& Scratch)
+{
+    const int32 Width = Map->GetWidth();
+    const int32 Start = Units.TileIndex[EntityId];
+    const int32 TargetX = TargetTile % Width;
+    const int32 TargetY = TargetTile / Width;
+    if (FMath::Abs(Start % Width - TargetX) + FMath::Abs(Start / Width - TargetY) <= Range) return;
+    if (!Map->FindPath(Start, TargetTile, &Occupancy, Scratch.Path, Scratch.Search)) return;
+
+    // The last step is the target's own tile
+    const FGridPath& Path = Scratch.Path;
+    const int32 Budget = Units.MovementPoints[EntityId] * Path.CostScale;
+    int32 Stop = 0;
+    for (int32 Step = 1; Step < Path.Num() - 1; ++Step)
+    {
+        const FGridPathStep& PathStep = Path.Steps[Step];
+        if (PathStep.CumulativeCost > Budget) break;
+
+        Stop = Step;
+        if (FMath::Abs(PathStep.TileIndex % Width - TargetX) + FMath::Abs(PathStep.TileIndex / Width - TargetY) <= Range) break;
+    }
+    if (Stop == 0) return;
+
+    if (Units.SpendMovement(EntityId, FMath::DivideAndRoundUp(Path.Steps[Stop].CumulativeCost, Path.CostScale)))
+    {
+        PlaceUnit(EntityId, Path.Steps[Stop].TileIndex);
+    }
+}
+
+void FTBMatch::PlaceUnit(int32 EntityId, int32 TileIndex)
+{
+    const int32 Width = Map->GetWidth();
+    const int32 OldTile = Units.TileIndex[EntityId];
+    Occupancy.ClearTile(OldTile % Width, OldTile / Width);
+    EntityAtTile.Remove(OldTile);
+
+    Units.CommitMove(EntityId, TileIndex);
+    Occupancy.SetOccupied(TileIndex % Width, TileIndex / Width, Units.TeamId[EntityId], true);
+    EntityAtTile.Add(TileIndex, EntityId);
+}
+
+void FTBMatch::KillUnit(int32 EntityId)
+{
+    const int32 Width = Map->GetWidth();
+    const int32 Tile = Units.TileIndex[EntityId];
+    Occupancy.ClearTile(Tile % Width, Tile / Width);
+    EntityAtTile.Remove(Tile);
+    Units.Destroy(EntityId);
+}
+
+// One pool thread; sleeps until StepAll wakes it
+class FTBMatchServer::FWorker : public FRunnable
+{
+public:
+    explicit FWorker(FTBMatchServer& InServer)
+        : Server(InServer)
+        , WakeEvent(FPlatformProcess::GetSynchEventFromPool())
+    {
+    }
+
+    virtual ~FWorker() override
+    {
+        FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    }
+
+    virtual uint32 Run() override
+    {
+        Server.RunWorker(*this);
+        return 0;
+    }
+
+    virtual void Stop() override
+    {
+        Server.bStopping.store(true, std::memory_order_relaxed);
+        WakeEvent->Trigger();
+    }
+
+    FTBMatchServer& Server;
+    FEvent* WakeEvent;
+    FRunnableThread* Thread = nullptr;
+    FTBMatchScratch Scratch;
+};
+
+FTBMatchServer::FTBMatchServer(int32 NumWorkers)
+    : StepDoneEvent(FPlatformProcess::GetSynchEventFromPool())
+{
+    NumWorkers = FMath::Max(1, NumWorkers);
+    for (int32 Index = 0; Index < NumWorkers; ++Index)
+    {
+        TUniquePtr<FWorker> Worker = MakeUnique<FWorker>(*this);
+        Worker->Thread = FRunnableThread::Create(Worker.Get(), *FString::Printf(TEXT("TBMatchWorker%d"), Index), 0, TPri_Normal);
+        if (!Worker->Thread) break;
+        Workers.Add(MoveTemp(Worker));
+    }
+    UE_CLOG(Workers.Num() < NumWorkers, LogTemp, Warning, TEXT("MatchServer: started %d of %d workers"), Workers.Num(), NumWorkers);
+}
+
+FTBMatchServer::~FTBMatchServer()
+{
+    // Kill(true) stops each worker and joins it
+    for (TUniquePtr<FWorker>& Worker : Workers)
+    {
+        Worker->Thread->Kill(true);
+        delete Worker->Thread;
+    }
+    Workers.Empty();
+    FPlatformProcess::ReturnSynchEventToPool(StepDoneEvent);
+}
+
+int32 FTBMatchServer::AddMatch(const FTBSharedMapRef& Map, const FUnitArchetype& Archetype, const FTBMatchSettings& Settings)
+{
+    const int32 MatchId = Matches.Num();
+    Matches.Add(MakeUnique<FTBMatch>(MatchId, Map, Archetype, Settings));
+    return MatchId;
+}
+
+void FTBMatchServer::StepAll()
+{
+    if (Matches.Num() == 0 || Workers.Num() == 0) return;
+
+    NextMatch.store(0, std::memory_order_relaxed);
+    NumBusyWorkers.store(Workers.Num(), std::memory_order_release);
+    for (TUniquePtr<FWorker>& Worker : Workers)
+    {
+        Worker->WakeEvent->Trigger();
+    }
+    StepDoneEvent->Wait();
+}
+
+void FTBMatchServer::RunWorker(FWorker& Worker)
+{
+    while (true)
+    {
+        Worker.WakeEvent->Wait();
+        if (bStopping.load(std::memory_order_relaxed)) break;
+
+        const uint64 StartCycles = FPlatformTime::Cycles64();
+        int64 NumStepped = 0;
+        for (int32 Index = NextMatch.fetch_add(1, std::memory_order_relaxed); Index < Matches.Num(); Index = NextMatch.fetch_add(1, std::memory_order_relaxed))
+        {
+            FTBMatch& Match = *Matches[Index];
+            if (Match.IsFinished()) continue;
+            Match.StepTurn(Worker.Scratch);
+            ++NumStepped;
+        }
+        BusyCycles.fetch_add(FPlatformTime::Cycles64() - StartCycles, std::memory_order_relaxed);
+        NumTurnsStepped.fetch_add(NumStepped, std::memory_order_relaxed);
+
+        // The last worker out releases StepAll; acq_rel publishes every worker's match writes to it
+        if (NumBusyWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            StepDoneEvent->Trigger();
+        }
+    }
+}
+
+int32 FTBMatchServer::RemoveFinishedMatches()
+{
+    return Matches.RemoveAll([](const TUniquePtr<FTBMatch>& Match) { return Match->IsFinished(); });
+}
+
+double FTBMatchServer::GetBusySeconds() const
+{
+    return FPlatformTime::ToSeconds64(BusyCycles.load(std::memory_order_relaxed));
+}
+
+SIZE_T FTBMatchServer::GetMatchesAllocatedSize() const
+{
+    SIZE_T Size = Matches.GetAllocatedSize();
+    for (const TUniquePtr<FTBMatch>& Match : Matches)
+    {
+        Size += Match->GetAllocatedSize();
+    }
+    return Size;
+}
+
+SIZE_T FTBMatchServer::GetWorkerScratchAllocatedSize() const
+{
+    SIZE_T Size = 0;
+    for (const TUniquePtr<FWorker>& Worker : Workers)
+    {
+        Size += Worker->Scratch.Search.GetAllocatedSize() + Worker->Scratch.Path.Steps.GetAllocatedSize();
+    }
+    return Size;
+}
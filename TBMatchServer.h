@@ -0,0 +1,173 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+#include "GridOccupancy.h"
+#include "UnitEntityStore.h"
+#include <atomic>
+
+class FEvent;
+class FRunnableThread;
+
+// Map data every match on one map shares: walkability, movement costs and the landmark tables, held in one
+// FGridPathfinder. Built once and never changed afterwards, so queries are only offered with caller-owned scratch
+// and any number of matches on any number of workers can run them at the same time.
+class DENEME_API FTBSharedMap
+{
+public:
+    struct FBuildParams
+    {
+        int32 Width = 32;
+        int32 Height = 32;
+        EGridConnectivity Connectivity = EGridConnectivity::Square4;
+        int32 NumLandmarks = 4;
+        int64 Seed = 1;
+
+        // Share of tiles made walls or rough ground (movement cost 2)
+        float WallFraction = 0.08f;
+        float RoughFraction = 0.12f;
+    };
+
+    static TSharedRef<const FTBSharedMap, ESPMode::ThreadSafe> Build(const FBuildParams& Params);
+
+    int32 GetWidth() const { return Pathfinder.GetWidth(); }
+    int32 GetHeight() const { return Pathfinder.GetHeight(); }
+    int32 NumTiles() const { return Pathfinder.NumTiles(); }
+    int32 GetCostScale() const { return Pathfinder.GetCostScale(); }
+    bool IsWalkable(int32 TileIndex) const { return Pathfinder.GetTileCost(TileIndex) != FGridPathfinder::Blocked; }
+
+    bool FindPath(int32 Start, int32 Goal, const FGridOccupancy* Occupancy, FGridPath& OutPath, FGridPathScratch& Scratch) const
+    {
+        return Pathfinder.FindPath(Start, Goal, Occupancy, OutPath, Scratch);
+    }
+
+    void GetReachableTiles(int32 Start, int32 MaxCost, const FGridOccupancy* Occupancy, TArray<int32>& OutTiles, FGridPathScratch& Scratch) const
+    {
+        Pathfinder.GetReachableTiles(Start, MaxCost, Occupancy, OutTiles, Scratch);
+    }
+
+    SIZE_T GetAllocatedSize() const { return Pathfinder.GetAllocatedSize(); }
+
+private:
+    FGridPathfinder Pathfinder;
+};
+
+using FTBSharedMapRef = TSharedRef<const FTBSharedMap, ESPMode::ThreadSafe>;
+
+struct FTBMatchSettings
+{
+    int64 Seed = 1;
+    int32 UnitsPerTeam = 8;
+
+    // The match ends in a draw after this many turns
+    int32 MaxTurns = 60;
+};
+
+// Search buffers for stepping matches. Owned by a worker thread and reused by every match it steps,
+// so their size is paid per core rather than per match.
+struct FTBMatchScratch
+{
+    FGridPathScratch Search;
+    FGridPath Path;
+};
+
+// One battle without a world or actors: only the state that changes during play (units with their turn stats,
+// occupancy) on top of a shared map. Both teams are driven by a simple AI that closes in on the
+// nearest enemy and casts at whatever is in range. A match is stepped by one thread at a time.
+class DENEME_API FTBMatch
+{
+public:
+    FTBMatch(int32 InMatchId, const FTBSharedMapRef& InMap, const FUnitArchetype& Archetype, const FTBMatchSettings& Settings);
+
+    // Play one full turn: reset turn stats, then every live unit moves and casts
+    void StepTurn(FTBMatchScratch& Scratch);
+
+    int32 GetMatchId() const { return MatchId; }
+    int32 GetTurnNumber() const { return TurnNumber; }
+    bool IsFinished() const { return bFinished; }
+
+    // INDEX_NONE while running or after a draw
+    int32 GetWinningTeam() const { return WinningTeam; }
+
+    int32 GetNumAlive(int32 TeamId) const;
+
+    // Bytes owned by this match (the shared map is not included)
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    void ActUnit(int32 EntityId, FTBMatchScratch& Scratch);
+
+    // Live enemy with the smallest Manhattan distance, or INDEX_NONE
+    int32 FindNearestEnemy(int32 EntityId) const;
+
+    // Walk the path prefix the unit can pay for, stopping once Target is within Range
+    void MoveTowards(int32 EntityId, int32 TargetTile, int32 Range, FTBMatchScratch& Scratch);
+
+    void PlaceUnit(int32 EntityId, int32 TileIndex);
+    void KillUnit(int32 EntityId);
+
+    // ExecuteEffect state over this match's entities
+    struct FEffectState;
+
+    int32 MatchId;
+    FTBSharedMapRef Map;
+    int64 Seed;
+    int32 MaxTurns;
+    int32 TurnNumber = 0;
+    int32 WinningTeam = INDEX_NONE;
+    bool bFinished = false;
+
+    FUnitEntityStore Units;
+    FGridOccupancy Occupancy;
+
+    // Tile index -> entity standing on it
+    TMap<int32, int32> EntityAtTile;
+};
+
+// Hosts many matches in one process and steps them on a pool of worker threads. Matches share nothing mutable,
+// so a step hands out matches to workers through one atomic counter; each match is stepped by exactly one worker.
+class DENEME_API FTBMatchServer
+{
+public:
+    explicit FTBMatchServer(int32 NumWorkers);
+    ~FTBMatchServer();
+
+    int32 AddMatch(const FTBSharedMapRef& Map, const FUnitArchetype& Archetype, const FTBMatchSettings& Settings);
+
+    // Step every unfinished match by one turn; returns once all workers are done
+    void StepAll();
+
+    // Drop finished matches; returns how many were removed
+    int32 RemoveFinishedMatches();
+
+    int32 GetNumMatches() const { return Matches.Num(); }
+    int32 GetNumWorkers() const { return Workers.Num(); }
+    const FTBMatch& GetMatch(int32 Index) const { return *Matches[Index]; }
+
+    // Turns stepped and worker time spent stepping them (CPU seconds summed over workers, excluding idle waits)
+    int64 GetNumTurnsStepped() const { return NumTurnsStepped.load(std::memory_order_relaxed); }
+    double GetBusySeconds() const;
+
+    // Bytes owned by all matches, and by the workers' search buffers
+    SIZE_T GetMatchesAllocatedSize() const;
+    SIZE_T GetWorkerScratchAllocatedSize() const;
+
+private:
+    class FWorker;
+    friend class FWorker;
+
+    // Worker loop: wait for a step, take matches until none are left, report done
+    void RunWorker(FWorker& Worker);
+
+    TArray<TUniquePtr<FTBMatch>> Matches;
+    TArray<TUniquePtr<FWorker>> Workers;
+
+    std::atomic<int32> NextMatch{ 0 };
+    std::atomic<int32> NumBusyWorkers{ 0 };
+    std::atomic<int64> NumTurnsStepped{ 0 };
+    std::atomic<uint64> BusyCycles{ 0 };
+    std::atomic<bool> bStopping{ false };
+
+    // Signalled by the last worker to finish a step
+    FEvent* StepDoneEvent = nullptr;
+};
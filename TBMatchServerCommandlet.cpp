@@ -0,0 +1,152 @@
+#include "TBMatchServerCommandlet.h"
+#include "TBMatchServer.h"
+#include "UnitCharacter.h"
+#include "HAL/PlatformMemory.h"
+
+namespace
+{
+    struct FLoadTestSettings
+    {
+        int32 NumMatches = 1000;
+        int32 NumWorkers = 0;
+        bool bSweep = false;
+        int32 Width = 32;
+        int32 Height = 32;
+        int32 UnitsPerTeam = 8;
+        int32 NumTurns = 30;
+        int64 Seed = 1;
+
+        // Game time a match gets per turn; sets how many matches a core can carry
+        double TurnSeconds = 2.0;
+    };
+
+    FLoadTestSettings ParseSettings(const FString& Params)
+    {
+        FLoadTestSettings Settings;
+        FParse::Value(*Params, TEXT("Matches="), Settings.NumMatches);
+        FParse::Value(*Params, TEXT("Workers="), Settings.NumWorkers);
+        FParse::Value(*Params, TEXT("Width="), Settings.Width);
+        FParse::Value(*Params, TEXT("Height="), Settings.Height);
+        FParse::Value(*Params, TEXT("UnitsPerTeam="), Settings.UnitsPerTeam);
+        FParse::Value(*Params, TEXT("Turns="), Settings.NumTurns);
+        FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+        FParse::Value(*Params, TEXT("TurnSeconds="), Settings.TurnSeconds);
+        Settings.bSweep = FParse::Param(*Params, TEXT("Sweep"));
+
+        Settings.NumMatches = FMath::Max(1, Settings.NumMatches);
+        Settings.NumWorkers = Settings.NumWorkers > 0 ? Settings.NumWorkers : FPlatformMisc::NumberOfCores();
+        Settings.Width = FMath::Max(8, Settings.Width);
+        Settings.Height = FMath::Max(8, Settings.Height);
+        Settings.UnitsPerTeam = FMath::Clamp(Settings.UnitsPerTeam, 1, Settings.Width * Settings.Height / 8);
+        Settings.NumTurns = FMath::Max(1, Settings.NumTurns);
+        Settings.TurnSeconds = FMath::Max(0.001, Settings.TurnSeconds);
+        return Settings;
+    }
+
+    double GetUsedMemoryMB()
+    {
+        return FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+    }
+
+    // Nearest-rank percentile, P in [0, 100]
+    double Percentile(TArray<double> Samples, double P)
+    {
+        if (Samples.Num() == 0) return 0.0;
+        Samples.Sort();
+        const int32 Rank = FMath::Clamp(FMath::CeilToInt(P / 100.0 * Samples.Num()) - 1, 0, Samples.Num() - 1);
+        return Samples[Rank];
+    }
+
+    void RunLoadTest(const FLoadTestSettings& Settings, const FTBSharedMapRef& Map, const FUnitArchetype& Archetype, int32 NumWorkers)
+    {
+        FTBMatchServer Server(NumWorkers);
+
+        const double MemoryStartMB = GetUsedMemoryMB();
+        for (int32 Index = 0; Index < Settings.NumMatches; ++Index)
+        {
+            FTBMatchSettings MatchSettings;
+            MatchSettings.Seed = Settings.Seed * 1000003 + Index;
+            MatchSettings.UnitsPerTeam = Settings.UnitsPerTeam;
+            MatchSettings.MaxTurns = Settings.NumTurns;
+            Server.AddMatch(Map, Archetype, MatchSettings);
+        }
+
+        TArray<double> StepMs;
+        StepMs.Reserve(Settings.NumTurns);
+        double MemoryPeakMB = GetUsedMemoryMB();
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 Turn = 0; Turn < Settings.NumTurns; ++Turn)
+        {
+            const double StepStart = FPlatformTime::Seconds();
+            Server.StepAll();
+            StepMs.Add((FPlatformTime::Seconds() - StepStart) * 1000.0);
+            MemoryPeakMB = FMath::Max(MemoryPeakMB, GetUsedMemoryMB());
+        }
+        const double WallSeconds = FPlatformTime::Seconds() - StartTime;
+
+        int32 NumFinished = 0;
+        int32 Wins[2] = {};
+        for (int32 Index = 0; Index < Server.GetNumMatches(); ++Index)
+        {
+            const FTBMatch& Match = Server.GetMatch(Index);
+            NumFinished += Match.IsFinished();
+            if (Match.GetWinningTeam() == 0 || Match.GetWinningTeam() == 1)
+            {
+                ++Wins[Match.GetWinningTeam()];
+            }
+        }
+
+        const int64 NumTurns = Server.GetNumTurnsStepped();
+        const double BusySeconds = FMath::Max(Server.GetBusySeconds(), 1.0e-9);
+        const double TurnsPerCoreSecond = NumTurns / BusySeconds;
+        const double MatchBytes = (double)Server.GetMatchesAllocatedSize() / Settings.NumMatches;
+
+        UE_LOG(LogTemp, Display, TEXT("MatchServer %2d workers, %d matches x %d turns: %.0f turns/s wall, %.0f turns per core-second, %.0f matches per core at one turn per %.1f s"),
+            Server.GetNumWorkers(), Settings.NumMatches, Settings.NumTurns, NumTurns / WallSeconds, TurnsPerCoreSecond, TurnsPerCoreSecond * Settings.TurnSeconds, Settings.TurnSeconds);
+        UE_LOG(LogTemp, Display, TEXT("    step p50 %.2f ms, p99 %.2f ms, max %.2f ms; %d finished (team 0: %d, team 1: %d), %lld turns stepped"),
+            Percentile(StepMs, 50.0), Percentile(StepMs, 99.0), Percentile(StepMs, 100.0), NumFinished, Wins[0], Wins[1], NumTurns);
+        UE_LOG(LogTemp, Display, TEXT("    memory per match: %.2f KB accounted, %.2f KB process growth; worker scratch %.1f KB total; shared map %.1f KB once"),
+            MatchBytes / 1024.0, (MemoryPeakMB - MemoryStartMB) * 1024.0 / Settings.NumMatches,
+            Server.GetWorkerScratchAllocatedSize() / 1024.0, Map->GetAllocatedSize() / 1024.0);
+    }
+}
+
+UTBMatchServerCommandlet::UTBMatchServerCommandlet()
+{
+    IsClient = false;
+    IsServer = true;
+    IsEditor = false;
+    LogToConsole = true;
+    ShowErrorCount = true;
+}
+
+int32 UTBMatchServerCommandlet::Main(const FString& Params)
+{
+    const FLoadTestSettings Settings = ParseSettings(Params);
+
+    FTBSharedMap::FBuildParams MapParams;
+    MapParams.Width = Settings.Width;
+    MapParams.Height = Settings.Height;
+    MapParams.Seed = Settings.Seed;
+    const FTBSharedMapRef Map = FTBSharedMap::Build(MapParams);
+    const FUnitArchetype Archetype = FUnitArchetype::FromUnit(GetDefault<AUnitCharacter>());
+
+    UE_LOG(LogTemp, Display, TEXT("MatchServer: %dx%d shared map, %.1f KB, %d units per team"),
+        Map->GetWidth(), Map->GetHeight(), Map->GetAllocatedSize() / 1024.0, Settings.UnitsPerTeam);
+
+    TArray<int32> WorkerCounts;
+    if (Settings.bSweep)
+    {
+        for (int32 Count = 1; Count < Settings.NumWorkers; Count *= 2)
+        {
+            WorkerCounts.Add(Count);
+        }
+    }
+    WorkerCounts.Add(Settings.NumWorkers);
+
+    for (int32 NumWorkers : WorkerCounts)
+    {
+        RunLoadTest(Settings, Map, Archetype, NumWorkers);
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TBMatchServerCommandlet.generated.h"
+
+// Load test for the multi-match server (FTBMatchServer):
+//
+//   UnrealEditor-Cmd <Project>.uproject -run=TBMatchServer -nullrhi -unattended -nosplash
+//       [-Matches=1000] [-Workers=<cores>] [-Sweep] [-Width=32] [-Height=32] [-UnitsPerTeam=8]
+//       [-Turns=30] [-Seed=1] [-TurnSeconds=2]
+//
+// Hosts Matches battles on one shared map in a single process and steps all of them for Turns turns on the worker
+// pool. Reports turns per core-second, how many matches one core sustains at one turn every TurnSeconds, step latency,
+// and memory per match (accounted bytes and process growth) next to the shared map each match no longer copies.
+// With -Sweep the run repeats for 1, 2, 4, ... workers up to the number of cores.
+UCLASS()
+class DENEME_API UTBMatchServerCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTBMatchServerCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
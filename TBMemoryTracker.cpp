@@ -0,0 +1,262 @@
+#include "TBMemoryTracker.h"
+#include "AGridManager.h"
+#include "AGridTile.h"
+#include "UnitCharacter.h"
+#include "UnitEntityManager.h"
+#include "UnitMovementSubsystem.h"
+#include "TBBoardSubsystem.h"
+#include "GridOverlayComponent.h"
+#include "TurnHudWidget.h"
+#include "Components/ActorComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+LLM_DEFINE_TAG(TB_Grid);
+LLM_DEFINE_TAG(TB_Units);
+
+SIZE_T FTBMemorySnapshot::Total() const
+{
+    SIZE_T Sum = 0;
+    for (SIZE_T Value : Bytes) Sum += Value;
+    return Sum;
+}
+
+void FTBMemorySnapshot::MaxWith(const FTBMemorySnapshot& Other)
+{
+    for (int32 Index = 0; Index < (int32)ETBMemoryCategory::Count; ++Index)
+    {
+        Bytes[Index] = FMath::Max(Bytes[Index], Other.Bytes[Index]);
+    }
+    NumTiles = FMath::Max(NumTiles, Other.NumTiles);
+    NumUnits = FMath::Max(NumUnits, Other.NumUnits);
+}
+
+UTBMemoryTracker* UTBMemoryTracker::Get(const UObject* WorldContextObject)
+{
+    UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+    return World ? World->GetSubsystem<UTBMemoryTracker>() : nullptr;
+}
+
+TStatId UTBMemoryTracker::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UTBMemoryTracker, STATGROUP_Tickables);
+}
+
+const TCHAR* UTBMemoryTracker::GetCategoryName(ETBMemoryCategory Category)
+{
+    switch (Category)
+    {
+    case ETBMemoryCategory::TileActors: return TEXT("TileActors");
+    case ETBMemoryCategory::GridData: return TEXT("GridData");
+    case ETBMemoryCategory::PathScratch: return TEXT("PathScratch");
+    case ETBMemoryCategory::Caches: return TEXT("Caches");
+    case ETBMemoryCategory::UnitActors: return TEXT("UnitActors");
+    case ETBMemoryCategory::AbilityData: return TEXT("AbilityData");
+    case ETBMemoryCategory::HUD: return TEXT("HUD");
+    default: return TEXT("?");
+    }
+}
+
+void UTBMemoryTracker::SetTracking(bool bEnable)
+{
+    bTracking = bEnable;
+    FramesUntilSample = 0;
+    FootprintCache.Reset();
+}
+
+void UTBMemoryTracker::Tick(float DeltaTime)
+{
+    if (!bTracking) return;
+    if (--FramesUntilSample > 0) return;
+    FramesUntilSample = FMath::Max(1, SampleIntervalFrames);
+    Sample();
+}
+
+int32 UTBMemoryTracker::GetCurrentTurn() const
+{
+    int32 Turn = 0;
+    for (TActorIterator<AGridManager> It(GetWorld()); It; ++It)
+    {
+        Turn = FMath::Max(Turn, It->TurnNumber);
+    }
+    return Turn;
+}
+
+SIZE_T UTBMemoryTracker::GetActorFootprint(const AActor* Actor) const
+{
+    const UClass* Class = Actor->GetClass();
+    if (const SIZE_T* Cached = FootprintCache.Find(Class))
+    {
+        return *Cached;
+    }
+
+    SIZE_T Size = Class->GetStructureSize();
+    for (const UActorComponent* Component : Actor->GetComponents())
+    {
+        if (Component) Size += Component->GetClass()->GetStructureSize();
+    }
+    FootprintCache.Add(Class, Size);
+    return Size;
+}
+
+FTBMemorySnapshot UTBMemoryTracker::Measure() const
+{
+    FTBMemorySnapshot Snapshot;
+    UWorld* World = GetWorld();
+    if (!World) return Snapshot;
+
+    auto Add = [&Snapshot](ETBMemoryCategory Category, SIZE_T Bytes)
+    {
+        Snapshot.Bytes[(int32)Category] += Bytes;
+    };
+
+    for (TActorIterator<AGridManager> It(World); It; ++It)
+    {
+        AGridManager* Grid = *It;
+        Add(ETBMemoryCategory::TileActors, Grid->Tiles.GetAllocatedSize() + Grid->GetTilePool().GetAllocatedSize());
+        Grid->ForEachLoadedTile([this, &Snapshot, &Add](const AGridTile* Tile)
+        {
+            Add(ETBMemoryCategory::TileActors, GetActorFootprint(Tile));
+            ++Snapshot.NumTiles;
+        });
+        for (const AGridTile* Tile : Grid->GetTilePool())
+        {
+            if (Tile) Add(ETBMemoryCategory::TileActors, GetActorFootprint(Tile));
+        }
+
+        const FGridPathfinder& Pathfinder = Grid->GetPathfinder();
+        Add(ETBMemoryCategory::GridData, Pathfinder.GetAllocatedSize() + Grid->GetRegions().GetAllocatedSize() + Grid->GetOccupancy().GetAllocatedSize() + Grid->GetVisibility().GetAllocatedSize() + Grid->GetChunkStore().GetAllocatedSize());
+        Add(ETBMemoryCategory::PathScratch, Pathfinder.GetScratchAllocatedSize() + Grid->GetMovePlanner().GetAllocatedSize());
+        Add(ETBMemoryCategory::Caches, Grid->GetVisibility().GetCacheAllocatedSize());
+        if (Grid->Overlay)
+        {
+            Add(ETBMemoryCategory::HUD, Grid->Overlay->GetAllocatedSize());
+        }
+    }
+
+    for (TActorIterator<AUnitCharacter> It(World); It; ++It)
+    {
+        SIZE_T InlineAbilityBytes = 0;
+        Add(ETBMemoryCategory::AbilityData, It->GetAbilityAllocatedSize(&InlineAbilityBytes));
+        Add(ETBMemoryCategory::UnitActors, GetActorFootprint(*It) - InlineAbilityBytes);
+        ++Snapshot.NumUnits;
+    }
+    for (TActorIterator<AUnitEntityManager> It(World); It; ++It)
+    {
+        Add(ETBMemoryCategory::UnitActors, It->GetStore().GetAllocatedSize());
+    }
+    if (const UUnitMovementSubsystem* Movement = World->GetSubsystem<UUnitMovementSubsystem>())
+    {
+        Add(ETBMemoryCategory::UnitActors, Movement->GetAllocatedSize());
+    }
+    if (const UTBBoardSubsystem* Board = World->GetSubsystem<UTBBoardSubsystem>())
+    {
+        Add(ETBMemoryCategory::UnitActors, Board->GetAllocatedSize());
+    }
+
+    // Widget trees are owned by Slate; this counts the HUD objects themselves
+    for (TObjectIterator<UTurnHudWidget> It; It; ++It)
+    {
+        if (It->GetWorld() == World)
+        {
+            Add(ETBMemoryCategory::HUD, It->GetClass()->GetStructureSize());
+        }
+    }
+    return Snapshot;
+}
+
+FTBMemorySnapshot UTBMemoryTracker::Sample()
+{
+    const FTBMemorySnapshot Snapshot = Measure();
+    const int32 Turn = GetCurrentTurn();
+
+    if (TurnRecords.Num() == 0 || TurnRecords.Last().Turn != Turn)
+    {
+        if (TurnRecords.Num() >= MaxTurnRecords)
+        {
+            TurnRecords.RemoveAt(0);
+        }
+        TurnRecords.AddDefaulted_GetRef().Turn = Turn;
+    }
+
+    FTBTurnMemoryRecord& Record = TurnRecords.Last();
+    Record.Peak.MaxWith(Snapshot);
+    Record.PeakTotal = FMath::Max(Record.PeakTotal, Snapshot.Total());
+    ++Record.NumSamples;
+    return Snapshot;
+}
+
+void UTBMemoryTracker::LogReport()
+{
+    const FTBMemorySnapshot Now = Measure();
+    const double ToKB = 1.0 / 1024.0;
+
+    UE_LOG(LogTemp, Display, TEXT("Memory: %d tiles, %d units, %.1f KB total (%.1f bytes per tile)"),
+        Now.NumTiles, Now.NumUnits, Now.Total() * ToKB, Now.NumTiles ? (double)Now.Total() / Now.NumTiles : 0.0);
+    for (int32 Index = 0; Index < (int32)ETBMemoryCategory::Count; ++Index)
+    {
+        UE_LOG(LogTemp, Display, TEXT("  %-12s %12.1f KB"), GetCategoryName((ETBMemoryCategory)Index), Now.Bytes[Index] * ToKB);
+    }
+
+    if (TurnRecords.Num() == 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("No per-turn high-water marks yet (tb.Mem.Track 1 to start sampling)"));
+        return;
+    }
+
+    FString Header = TEXT("  Turn Samples    Total KB");
+    for (int32 Index = 0; Index < (int32)ETBMemoryCategory::Count; ++Index)
+    {
+        Header += FString::Printf(TEXT(" %12s"), GetCategoryName((ETBMemoryCategory)Index));
+    }
+    UE_LOG(LogTemp, Display, TEXT("High-water marks per turn (KB):"));
+    UE_LOG(LogTemp, Display, TEXT("%s"), *Header);
+    for (const FTBTurnMemoryRecord& Record : TurnRecords)
+    {
+        FString Line = FString::Printf(TEXT("  %4d %7d %11.1f"), Record.Turn, Record.NumSamples, Record.PeakTotal * ToKB);
+        for (int32 Index = 0; Index < (int32)ETBMemoryCategory::Count; ++Index)
+        {
+            Line += FString::Printf(TEXT(" %12.1f"), Record.Peak.Bytes[Index] * ToKB);
+        }
+        UE_LOG(LogTemp, Display, TEXT("%s"), *Line);
+    }
+}
+
+namespace
+{
+    void RunMemoryReport(const TArray<FString>& Args, UWorld* World)
+    {
+        if (UTBMemoryTracker* Tracker = World ? World->GetSubsystem<UTBMemoryTracker>() : nullptr)
+        {
+            Tracker->LogReport();
+        }
+    }
+
+    // tb.Mem.Track [0|1] [IntervalFrames]
+    void RunMemoryTrack(const TArray<FString>& Args, UWorld* World)
+    {
+        UTBMemoryTracker* Tracker = World ? World->GetSubsystem<UTBMemoryTracker>() : nullptr;
+        if (!Tracker) return;
+
+        const bool bEnable = Args.Num() > 0 ? FCString::Atoi(*Args[0]) != 0 : !Tracker->IsTracking();
+        if (Args.Num() > 1)
+        {
+            Tracker->SampleIntervalFrames = FMath::Max(1, FCString::Atoi(*Args[1]));
+        }
+        Tracker->SetTracking(bEnable);
+        UE_LOG(LogTemp, Display, TEXT("Memory tracking %s (every %d frames)"), bEnable ? TEXT("on") : TEXT("off"), Tracker->SampleIntervalFrames);
+    }
+
+    FAutoConsoleCommandWithWorldAndArgs MemoryReportCommand(
+        TEXT("tb.Mem.Report"),
+        TEXT("Print memory per subsystem (tiles, grid data, path scratch, caches, units, abilities, HUD) and per-turn high-water marks"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunMemoryReport));
+
+    FAutoConsoleCommandWithWorldAndArgs MemoryTrackCommand(
+        TEXT("tb.Mem.Track"),
+        TEXT("tb.Mem.Track [0|1] [IntervalFrames]: sample memory every N frames (default 30) and keep per-turn high-water marks"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunMemoryTrack));
+}
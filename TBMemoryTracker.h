@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TBMemoryTracker.generated.h"
+
+// LLM tags for allocations made by the board and by units (visible with -llm / stat LLM)
+LLM_DECLARE_TAG_API(TB_Grid, DENEME_API);
+LLM_DECLARE_TAG_API(TB_Units, DENEME_API);
+
+// Buckets of the memory report
+UENUM(BlueprintType)
+enum class ETBMemoryCategory : uint8
+{
+    // AGridTile instances (with their components) and the Tiles arrays
+    TileActors,
+    // Terrain costs, landmark tables, occupancy boards, blockers and team visibility
+    GridData,
+    // Reusable pathfinder search buffers
+    PathScratch,
+    // Line of sight windows cached per origin
+    Caches,
+    // AUnitCharacter instances, movement playback buffers, the unit entity store and the board registry
+    UnitActors,
+    // Ability structs and EvaluateAbilities results
+    AbilityData,
+    // HUD widgets and the overlay highlight mask
+    HUD,
+
+    Count UMETA(Hidden)
+};
+
+// Bytes per category at one moment. Actor figures are instance sizes (class and component layouts),
+// not engine-side allocations such as render proxies; LLM tags cover those.
+struct DENEME_API FTBMemorySnapshot
+{
+    SIZE_T Bytes[(int32)ETBMemoryCategory::Count] = {};
+    int32 NumTiles = 0;
+    int32 NumUnits = 0;
+
+    SIZE_T Total() const;
+
+    // Per-category maximum of this and Other
+    void MaxWith(const FTBMemorySnapshot& Other);
+};
+
+// Highest usage seen while one turn was in progress
+struct FTBTurnMemoryRecord
+{
+    int32 Turn = 0;
+    int32 NumSamples = 0;
+
+    // Each category's own high-water mark (they need not peak at the same moment)
+    FTBMemorySnapshot Peak;
+
+    // Highest sampled total
+    SIZE_T PeakTotal = 0;
+};
+
+// Breaks the game's memory down by subsystem and keeps per-turn high-water marks.
+// Sampling walks the grid managers and units, so it only runs while tracking is on (tb.Mem.Track),
+// every SampleIntervalFrames frames and whenever Sample() is called. tb.Mem.Report prints the breakdown.
+UCLASS()
+class DENEME_API UTBMemoryTracker : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UTBMemoryTracker* Get(const UObject* WorldContextObject);
+
+    UFUNCTION(BlueprintCallable, Category = "Memory")
+    void SetTracking(bool bEnable);
+
+    UFUNCTION(BlueprintPure, Category = "Memory")
+    bool IsTracking() const { return bTracking; }
+
+    // Frames between automatic samples while tracking
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Memory", meta = (ClampMin = "1"))
+    int32 SampleIntervalFrames = 30;
+
+    // Measure now and fold the result into the current turn's high-water marks
+    FTBMemorySnapshot Sample();
+
+    // Measure without recording
+    FTBMemorySnapshot Measure() const;
+
+    const TArray<FTBTurnMemoryRecord>& GetTurnRecords() const { return TurnRecords; }
+
+    void ResetRecords() { TurnRecords.Reset(); }
+
+    // Current breakdown and the per-turn table, to the log
+    UFUNCTION(BlueprintCallable, Category = "Memory")
+    void LogReport();
+
+    static const TCHAR* GetCategoryName(ETBMemoryCategory Category);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+private:
+    // Shallow size of an actor of this class and its components; tiles and units share layouts per class, so it is cached
+    SIZE_T GetActorFootprint(const AActor* Actor) const;
+
+    // Turn number of the board (largest over grid managers)
+    int32 GetCurrentTurn() const;
+
+    static constexpr int32 MaxTurnRecords = 256;
+
+    bool bTracking = false;
+    int32 FramesUntilSample = 0;
+
+    TArray<FTBTurnMemoryRecord> TurnRecords;
+
+    mutable TMap<const UClass*, SIZE_T> FootprintCache;
+};
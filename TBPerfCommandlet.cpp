@@ -0,0 +1,538 @@
+#include "TBPerfCommandlet.h"
+#include "AGridManager.h"
+#include "AGridTile.h"
+#include "UnitCharacter.h"
+#include "TurnStatsComponent.h"
+#include "TBBoardSubsystem.h"
+#include "UnitMovementSubsystem.h"
+#include "TBMemoryTracker.h"
+#include "TBTelemetry.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Tickable.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+    struct FPerfSettings
+    {
+        int32 Width = 128;
+        int32 Height = 128;
+        int32 NumUnits = 300;
+        int32 NumTurns = 20;
+        int64 Seed = 1;
+
+        // Units issuing their commands in the same frame, and frames allowed for moves to finish after the last one
+        int32 UnitsPerFrame = 32;
+        int32 MaxSettleFrames = 60;
+        float FrameTime = 1.0f / 60.0f;
+
+        // Share of tiles made walls (block movement and sight) or rough ground (movement cost 2)
+        float WallFraction = 0.08f;
+        float RoughFraction = 0.12f;
+
+        FString OutputPath;
+        FString BaselinePath;
+
+        // Record match telemetry for the run to this file, so its overhead shows in the timings
+        FString TelemetryPath;
+        float ThresholdPercent = 10.0f;
+        double NoiseFloorMs = 0.05;
+    };
+
+    // Samples of one timed section, in milliseconds
+    struct FTimingSeries
+    {
+        TArray<double> Samples;
+        double Total = 0.0;
+
+        void Add(double Ms)
+        {
+            Samples.Add(Ms);
+            Total += Ms;
+        }
+
+        double Average() const { return Samples.Num() ? Total / Samples.Num() : 0.0; }
+
+        // Nearest-rank percentile, P in [0, 100]
+        double Percentile(double P) const
+        {
+            if (Samples.Num() == 0) return 0.0;
+            TArray<double> Sorted = Samples;
+            Sorted.Sort();
+            const int32 Rank = FMath::Clamp(FMath::CeilToInt(P / 100.0 * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+            return Sorted[Rank];
+        }
+    };
+
+    struct FScopedTiming
+    {
+        explicit FScopedTiming(FTimingSeries& InSeries) : Series(InSeries), StartTime(FPlatformTime::Seconds()) {}
+        ~FScopedTiming() { Series.Add((FPlatformTime::Seconds() - StartTime) * 1000.0); }
+
+        FTimingSeries& Series;
+        double StartTime;
+    };
+
+    double GetUsedMemoryMB()
+    {
+        return FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+    }
+
+    // Metric name -> value, kept in insertion order so reports diff cleanly
+    using FMetricList = TArray<TPair<FString, double>>;
+
+    FPerfSettings ParseSettings(const FString& Params)
+    {
+        FPerfSettings Settings;
+        FParse::Value(*Params, TEXT("Width="), Settings.Width);
+        FParse::Value(*Params, TEXT("Height="), Settings.Height);
+        FParse::Value(*Params, TEXT("Units="), Settings.NumUnits);
+        FParse::Value(*Params, TEXT("Turns="), Settings.NumTurns);
+        FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+        FParse::Value(*Params, TEXT("UnitsPerFrame="), Settings.UnitsPerFrame);
+        FParse::Value(*Params, TEXT("Threshold="), Settings.ThresholdPercent);
+        FParse::Value(*Params, TEXT("NoiseFloorMs="), Settings.NoiseFloorMs);
+        FParse::Value(*Params, TEXT("Output="), Settings.OutputPath);
+        FParse::Value(*Params, TEXT("Baseline="), Settings.BaselinePath);
+        FParse::Value(*Params, TEXT("Telemetry="), Settings.TelemetryPath);
+
+        Settings.Width = FMath::Max(8, Settings.Width);
+        Settings.Height = FMath::Max(8, Settings.Height);
+        Settings.NumUnits = FMath::Clamp(Settings.NumUnits, 2, Settings.Width * Settings.Height / 4);
+        Settings.NumTurns = FMath::Max(1, Settings.NumTurns);
+        Settings.UnitsPerFrame = FMath::Max(1, Settings.UnitsPerFrame);
+        if (Settings.OutputPath.IsEmpty())
+        {
+            Settings.OutputPath = FPaths::ProjectSavedDir() / TEXT("Perf") / TEXT("TBPerf.json");
+        }
+        return Settings;
+    }
+
+    // The scenario itself: everything between world creation and teardown
+    class FPerfScenario
+    {
+    public:
+        FPerfScenario(const FPerfSettings& InSettings, UWorld* InWorld)
+            : Settings(InSettings), World(InWorld), Random((int32)InSettings.Seed)
+        {
+        }
+
+        bool Setup();
+        void Run();
+        void CollectMetrics(FMetricList& OutMetrics) const;
+
+    private:
+        // Path, preview, confirm and cast for one unit, as TBPlayerController would issue them
+        void IssueCommands(AUnitCharacter* Unit);
+
+        // Tick the world (actors, timers, tickable subsystems) by one fixed step
+        void TickWorld();
+
+        // Cast MagicArrow, else Boulder, at some enemy in a legal target tile
+        void CastAtEnemy(AUnitCharacter* Unit);
+
+        const FPerfSettings& Settings;
+        UWorld* World;
+        FRandomStream Random;
+
+        AGridManager* Grid = nullptr;
+        TArray<TWeakObjectPtr<AUnitCharacter>> Units;
+        FGridPath PathBuffer;
+
+        FTimingSeries FrameTimes;
+        FTimingSeries WorldTickTimes;
+        FTimingSeries PathfindingTimes;
+        FTimingSeries MovementTimes;
+        FTimingSeries AbilityTimes;
+        FTimingSeries EndTurnTimes;
+        double GenerationMs = 0.0;
+
+        int32 NumMoves = 0;
+        int32 NumCasts = 0;
+        double MemoryStartMB = 0.0;
+        double MemoryPeakMB = 0.0;
+    };
+
+    bool FPerfScenario::Setup()
+    {
+        MemoryStartMB = GetUsedMemoryMB();
+        MemoryPeakMB = MemoryStartMB;
+
+        Grid = World->SpawnActor<AGridManager>();
+        if (!Grid) return false;
+
+        Grid->GridWidth = Settings.Width;
+        Grid->GridHeight = Settings.Height;
+        Grid->TileClass = AGridTile::StaticClass();
+        Grid->MatchSeed = Settings.Seed;
+        Grid->bTimeSlicedGeneration = false;
+        {
+            const double StartTime = FPlatformTime::Seconds();
+            Grid->GenerateGrid();
+
+            // Walls and rough ground, so paths detour and sight lines break
+            for (AGridTile* Tile : Grid->Tiles)
+            {
+                if (!Tile) continue;
+                const float Roll = Random.GetFraction();
+                if (Roll < Settings.WallFraction)
+                {
+                    Tile->bIsWalkable = false;
+                    Tile->bBlocksSight = true;
+                }
+                else if (Roll < Settings.WallFraction + Settings.RoughFraction)
+                {
+                    Tile->MovementCost = 2;
+                }
+            }
+            Grid->RebuildNavigation();
+            Grid->RebuildVisibility();
+            GenerationMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+        }
+        if (!Grid->IsGridReady()) return false;
+
+        // Teams start in opposite halves so they have to close in before they can trade casts
+        Units.Reserve(Settings.NumUnits);
+        for (int32 Index = 0; Index < Settings.NumUnits; ++Index)
+        {
+            const int32 TeamId = Index & 1;
+            AGridTile* Tile = nullptr;
+            for (int32 Attempt = 0; Attempt < 64 && !Tile; ++Attempt)
+            {
+                const int32 X = Random.RandRange(0, Settings.Width / 2 - 1) + TeamId * (Settings.Width / 2);
+                const int32 Y = Random.RandRange(0, Settings.Height - 1);
+                AGridTile* Candidate = Grid->GetTileAt(X, Y);
+                if (Candidate && Candidate->IsAvailable() && !Grid->IsTileOccupied(Candidate)) Tile = Candidate;
+            }
+            if (!Tile) continue;
+
+            AUnitCharacter* Unit = World->SpawnActorDeferred<AUnitCharacter>(AUnitCharacter::StaticClass(), FTransform(Tile->GetTileCenter()),
+                nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+            if (!Unit) continue;
+            Unit->UnitId = Index;
+            Unit->TeamId = TeamId;
+            Unit->CurrentTile = Tile;
+            Unit->FinishSpawning(FTransform(Tile->GetTileCenter()));
+            Units.Add(Unit);
+        }
+
+        MemoryPeakMB = FMath::Max(MemoryPeakMB, GetUsedMemoryMB());
+        return Units.Num() > 1;
+    }
+
+    void FPerfScenario::Run()
+    {
+        UUnitMovementSubsystem* Movement = World->GetSubsystem<UUnitMovementSubsystem>();
+
+        for (int32 Turn = 0; Turn < Settings.NumTurns; ++Turn)
+        {
+            {
+                FScopedTiming Timing(EndTurnTimes);
+                Grid->BeginNewTurn();
+                for (const TWeakObjectPtr<AUnitCharacter>& Unit : Units)
+                {
+                    if (Unit.IsValid()) Unit->ResetForNewTurn();
+                }
+            }
+
+            // Units act in batches, one batch per frame
+            for (int32 First = 0; First < Units.Num(); First += Settings.UnitsPerFrame)
+            {
+                const double FrameStart = FPlatformTime::Seconds();
+                const int32 Last = FMath::Min(First + Settings.UnitsPerFrame, Units.Num());
+                for (int32 Index = First; Index < Last; ++Index)
+                {
+                    if (AUnitCharacter* Unit = Units[Index].Get())
+                    {
+                        IssueCommands(Unit);
+                    }
+                }
+                TickWorld();
+                FrameTimes.Add((FPlatformTime::Seconds() - FrameStart) * 1000.0);
+            }
+
+            // Let the last moves play out before the turn ends
+            for (int32 Frame = 0; Frame < Settings.MaxSettleFrames && Movement && Movement->GetNumMoving() > 0; ++Frame)
+            {
+                const double FrameStart = FPlatformTime::Seconds();
+                TickWorld();
+                FrameTimes.Add((FPlatformTime::Seconds() - FrameStart) * 1000.0);
+            }
+            if (Movement) Movement->SkipAll();
+
+            if (UTBMemoryTracker* Tracker = World->GetSubsystem<UTBMemoryTracker>())
+            {
+                Tracker->Sample();
+            }
+            MemoryPeakMB = FMath::Max(MemoryPeakMB, GetUsedMemoryMB());
+        }
+    }
+
+    void FPerfScenario::IssueCommands(AUnitCharacter* Unit)
+    {
+        AGridTile* Start = Unit->CurrentTile;
+        if (!Start || !Unit->TurnStats) return;
+
+        {
+            FScopedTiming Timing(PathfindingTimes);
+            const TArray<AGridTile*> Reachable = Grid->GetReachableTiles(Start, Unit->TurnStats->MovementPoints);
+            if (Reachable.Num())
+            {
+                Grid->FindGridPath(Start, Reachable[Random.RandRange(0, Reachable.Num() - 1)], PathBuffer);
+            }
+            else
+            {
+                PathBuffer.Reset();
+            }
+        }
+
+        if (PathBuffer.IsMove())
+        {
+            FScopedTiming Timing(MovementTimes);
+            if (Unit->RequestPreviewMove(MoveTemp(PathBuffer)))
+            {
+                Unit->ConfirmPlacement();
+                NumMoves += Unit->CurrentTile != Start;
+            }
+        }
+
+        FScopedTiming Timing(AbilityTimes);
+        CastAtEnemy(Unit);
+    }
+
+    void FPerfScenario::CastAtEnemy(AUnitCharacter* Unit)
+    {
+        const UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(Unit);
+        if (!Board) return;
+
+        const TArray<FAbilityEvaluation>& Abilities = Unit->EvaluateAbilities();
+        for (const FAbilityEvaluation& Ability : Abilities)
+        {
+            if (!Ability.CanCast() || Ability.NumUnitTargets == 0) continue;
+
+            for (AGridTile* Tile : Unit->GetAbilityTargetTiles(Ability.AbilityName, true))
+            {
+                const AUnitCharacter* Target = Board->GetUnitOnTile(Tile);
+                if (Target && Target->TeamId != Unit->TeamId)
+                {
+                    // The target may die and be destroyed inside the cast
+                    Unit->CastAbilityAtTile(Ability.AbilityName, Tile);
+                    ++NumCasts;
+                    return;
+                }
+            }
+        }
+    }
+
+    void FPerfScenario::TickWorld()
+    {
+        FScopedTiming Timing(WorldTickTimes);
+        World->Tick(LEVELTICK_All, Settings.FrameTime);
+
+        // Tickable world subsystems (movement, event bus) are ticked by the engine loop, which a commandlet does not run
+        FTickableGameObject::TickObjects(World, LEVELTICK_All, false, Settings.FrameTime);
+    }
+
+    void FPerfScenario::CollectMetrics(FMetricList& OutMetrics) const
+    {
+        int32 NumAlive = 0;
+        for (const TWeakObjectPtr<AUnitCharacter>& Unit : Units)
+        {
+            NumAlive += Unit.IsValid();
+        }
+
+        OutMetrics.Emplace(TEXT("frame_avg_ms"), FrameTimes.Average());
+        OutMetrics.Emplace(TEXT("frame_p50_ms"), FrameTimes.Percentile(50.0));
+        OutMetrics.Emplace(TEXT("frame_p95_ms"), FrameTimes.Percentile(95.0));
+        OutMetrics.Emplace(TEXT("frame_p99_ms"), FrameTimes.Percentile(99.0));
+        OutMetrics.Emplace(TEXT("frame_max_ms"), FrameTimes.Percentile(100.0));
+        OutMetrics.Emplace(TEXT("world_tick_avg_ms"), WorldTickTimes.Average());
+        OutMetrics.Emplace(TEXT("pathfinding_avg_ms"), PathfindingTimes.Average());
+        OutMetrics.Emplace(TEXT("pathfinding_total_ms"), PathfindingTimes.Total);
+        OutMetrics.Emplace(TEXT("movement_avg_ms"), MovementTimes.Average());
+        OutMetrics.Emplace(TEXT("movement_total_ms"), MovementTimes.Total);
+        OutMetrics.Emplace(TEXT("abilities_avg_ms"), AbilityTimes.Average());
+        OutMetrics.Emplace(TEXT("abilities_total_ms"), AbilityTimes.Total);
+        OutMetrics.Emplace(TEXT("end_turn_avg_ms"), EndTurnTimes.Average());
+        OutMetrics.Emplace(TEXT("grid_generation_ms"), GenerationMs);
+        OutMetrics.Emplace(TEXT("memory_peak_mb"), MemoryPeakMB);
+        OutMetrics.Emplace(TEXT("memory_growth_mb"), MemoryPeakMB - MemoryStartMB);
+        OutMetrics.Emplace(TEXT("pathfinder_bytes"), (double)Grid->GetPathfinder().GetAllocatedSize());
+
+        // Per-subsystem high-water marks over all turns
+        if (const UTBMemoryTracker* Tracker = World->GetSubsystem<UTBMemoryTracker>())
+        {
+            FTBMemorySnapshot Peak;
+            for (const FTBTurnMemoryRecord& Record : Tracker->GetTurnRecords())
+            {
+                Peak.MaxWith(Record.Peak);
+            }
+            for (int32 Index = 0; Index < (int32)ETBMemoryCategory::Count; ++Index)
+            {
+                const FString Name = FString(UTBMemoryTracker::GetCategoryName((ETBMemoryCategory)Index)).ToLower();
+                OutMetrics.Emplace(FString::Printf(TEXT("mem_%s_peak_kb"), *Name), Peak.Bytes[Index] / 1024.0);
+            }
+        }
+
+        // Counts, reported for context; a different count means the scenario changed, not that it got slower
+        OutMetrics.Emplace(TEXT("frames"), FrameTimes.Samples.Num());
+        OutMetrics.Emplace(TEXT("moves"), NumMoves);
+        OutMetrics.Emplace(TEXT("casts"), NumCasts);
+        OutMetrics.Emplace(TEXT("units_alive"), NumAlive);
+    }
+
+    // Counts are not performance: they only change with the scenario, and are checked for equality instead
+    bool IsCountMetric(const FString& Name)
+    {
+        return Name == TEXT("frames") || Name == TEXT("moves") || Name == TEXT("casts") || Name == TEXT("units_alive");
+    }
+
+    // Compare against a baseline report; returns false and fills OutRegressions when any metric got too much worse
+    bool CompareToBaseline(const FPerfSettings& Settings, const FMetricList& Metrics, TArray<TSharedPtr<FJsonValue>>& OutRegressions)
+    {
+        FString BaselineText;
+        if (!FFileHelper::LoadFileToString(BaselineText, *Settings.BaselinePath))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TBPerf: cannot read baseline %s"), *Settings.BaselinePath);
+            return false;
+        }
+
+        TSharedPtr<FJsonObject> Baseline;
+        const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(BaselineText);
+        const TSharedPtr<FJsonObject>* BaselineMetrics = nullptr;
+        if (!FJsonSerializer::Deserialize(Reader, Baseline) || !Baseline.IsValid() || !Baseline->TryGetObjectField(TEXT("metrics"), BaselineMetrics))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TBPerf: baseline %s has no metrics object"), *Settings.BaselinePath);
+            return false;
+        }
+
+        bool bPassed = true;
+        for (const TPair<FString, double>& Metric : Metrics)
+        {
+            double Expected = 0.0;
+            if (!(*BaselineMetrics)->TryGetNumberField(Metric.Key, Expected)) continue;
+
+            if (IsCountMetric(Metric.Key))
+            {
+                if (Metric.Value != Expected)
+                {
+                    UE_LOG(LogTemp, Warning, TEXT("TBPerf: %s is %.0f, baseline %.0f; the scenario differs from the baseline run"),
+                        *Metric.Key, Metric.Value, Expected);
+                }
+                continue;
+            }
+            if (Expected <= 0.0) continue;
+
+            // Time metrics also have to exceed the noise floor, so sub-microsecond jitter does not fail the run
+            const double Percent = (Metric.Value - Expected) / Expected * 100.0;
+            const bool bTimeMetric = Metric.Key.EndsWith(TEXT("_ms"));
+            if (Percent <= Settings.ThresholdPercent) continue;
+            if (bTimeMetric && Metric.Value - Expected <= Settings.NoiseFloorMs) continue;
+
+            bPassed = false;
+            UE_LOG(LogTemp, Error, TEXT("TBPerf: %s regressed %.1f%% (%.4f -> %.4f, threshold %.1f%%)"),
+                *Metric.Key, Percent, Expected, Metric.Value, Settings.ThresholdPercent);
+
+            TSharedRef<FJsonObject> Regression = MakeShared<FJsonObject>();
+            Regression->SetStringField(TEXT("metric"), Metric.Key);
+            Regression->SetNumberField(TEXT("baseline"), Expected);
+            Regression->SetNumberField(TEXT("value"), Metric.Value);
+            Regression->SetNumberField(TEXT("percent"), Percent);
+            OutRegressions.Add(MakeShared<FJsonValueObject>(Regression));
+        }
+        return bPassed;
+    }
+}
+
+UTBPerfCommandlet::UTBPerfCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+    ShowErrorCount = true;
+}
+
+int32 UTBPerfCommandlet::Main(const FString& Params)
+{
+    const FPerfSettings Settings = ParseSettings(Params);
+    UE_LOG(LogTemp, Display, TEXT("TBPerf: %dx%d grid, %d units, %d turns, seed %lld"),
+        Settings.Width, Settings.Height, Settings.NumUnits, Settings.NumTurns, Settings.Seed);
+
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("TBPerfWorld"));
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+    World->InitializeActorsForPlay(FURL());
+    World->BeginPlay();
+
+    FMetricList Metrics;
+    bool bScenarioOk = false;
+    {
+        FPerfScenario Scenario(Settings, World);
+        bScenarioOk = Scenario.Setup();
+        if (bScenarioOk)
+        {
+            const bool bTelemetry = !Settings.TelemetryPath.IsEmpty() && FTBTelemetry::Start(Settings.TelemetryPath);
+            Scenario.Run();
+            if (bTelemetry) FTBTelemetry::Stop();
+            Scenario.CollectMetrics(Metrics);
+        }
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+
+    if (!bScenarioOk)
+    {
+        UE_LOG(LogTemp, Error, TEXT("TBPerf: scenario setup failed (grid not generated or no units placed)"));
+        return 2;
+    }
+
+    TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+    TSharedRef<FJsonObject> Scenario = MakeShared<FJsonObject>();
+    Scenario->SetNumberField(TEXT("width"), Settings.Width);
+    Scenario->SetNumberField(TEXT("height"), Settings.Height);
+    Scenario->SetNumberField(TEXT("units"), Settings.NumUnits);
+    Scenario->SetNumberField(TEXT("turns"), Settings.NumTurns);
+    Scenario->SetNumberField(TEXT("seed"), (double)Settings.Seed);
+    Scenario->SetNumberField(TEXT("units_per_frame"), Settings.UnitsPerFrame);
+    Report->SetObjectField(TEXT("scenario"), Scenario);
+
+    TSharedRef<FJsonObject> MetricsObject = MakeShared<FJsonObject>();
+    for (const TPair<FString, double>& Metric : Metrics)
+    {
+        MetricsObject->SetNumberField(Metric.Key, Metric.Value);
+        UE_LOG(LogTemp, Display, TEXT("TBPerf: %-22s %12.4f"), *Metric.Key, Metric.Value);
+    }
+    Report->SetObjectField(TEXT("metrics"), MetricsObject);
+
+    bool bPassed = true;
+    if (!Settings.BaselinePath.IsEmpty())
+    {
+        TArray<TSharedPtr<FJsonValue>> Regressions;
+        bPassed = CompareToBaseline(Settings, Metrics, Regressions);
+        Report->SetStringField(TEXT("baseline"), Settings.BaselinePath);
+        Report->SetNumberField(TEXT("threshold_percent"), Settings.ThresholdPercent);
+        Report->SetArrayField(TEXT("regressions"), Regressions);
+    }
+    Report->SetBoolField(TEXT("passed"), bPassed);
+
+    FString ReportText;
+    const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportText);
+    FJsonSerializer::Serialize(Report, Writer);
+    if (!FFileHelper::SaveStringToFile(ReportText, *Settings.OutputPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TBPerf: cannot write report to %s"), *Settings.OutputPath);
+        return 2;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("TBPerf: report written to %s (%s)"), *Settings.OutputPath, bPassed ? TEXT("passed") : TEXT("REGRESSED"));
+    return bPassed ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TBPerfCommandlet.generated.h"
+
+// Headless performance regression scenario, for CI machines without a GPU:
+//
+//   UnrealEditor-Cmd <Project>.uproject -run=TBPerf -nullrhi -unattended -nosplash
+//       [-Width=128] [-Height=128] [-Units=300] [-Turns=20] [-Seed=1]
+//       [-Output=<path>.json] [-Baseline=<path>.json] [-Threshold=10] [-NoiseFloorMs=0.05]
+//       [-Telemetry=<path>.tbt]
+//
+// Builds a grid in a fresh game world, spawns units on both teams and drives them for N turns with the same calls
+// ATBPlayerController makes (path, preview, confirm, cast), then ends the turn. The world is ticked at a fixed step.
+// Writes frame times, per-subsystem timings and memory as JSON. Given a baseline report from an earlier run,
+// any metric more than Threshold percent worse (and worse by more than the noise floor) fails the run with exit code 1.
+UCLASS()
+class DENEME_API UTBPerfCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTBPerfCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -5,8 +5,9 @@
 #include "AGridTile.h"
 #include "AGridManager.h"
 #include "Engine/World.h"
-#include "EngineUtils.h"
+#include "TBBoardSubsystem.h"
 #include "TurnHudWidget.h"
+#include "GridOverlayComponent.h"
 
 ATBPlayerController::ATBPlayerController()
 {
@@ -48,7 +49,14 @@ AUnitCharacter* ATBPlayerController::GetUnitUnderCursor() const
 {
     FHitResult Hit;
     if (!TraceClick(Hit)) return nullptr;
-    return Cast<AUnitCharacter>(Hit.GetActor());
+    if (AUnitCharacter* Unit = Cast<AUnitCharacter>(Hit.GetActor()))
+    {
+        return Unit;
+    }
+
+    // Clicking the tile a unit stands on selects the unit too
+    const UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this);
+    return Board ? Board->GetUnitOnTile(Cast<AGridTile>(Hit.GetActor())) : nullptr;
 }
 
 AGridTile* ATBPlayerController::GetTileUnderCursor() const
@@ -89,18 +97,24 @@ void ATBPlayerController::OnRightClick()
     AGridTile* Tile = GetTileUnderCursor();
     if (!Tile) return;
 
-    // Ask GridManager to find a path
-    for (TActorIterator<AGridManager> It(GetWorld()); It; ++It)
+    // Ask the active GridManager to find a path
+    const UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this);
+    AGridManager* GM = Board ? Board->GetGrid() : nullptr;
+    if (GM && GM->FindGridPath(SelectedUnit->CurrentTile, Tile, PathBuffer))
     {
-        AGridManager* GM = *It;
-        if (!GM) continue;
-        TArray<AGridTile*> Path = GM->FindPath(SelectedUnit->CurrentTile, Tile);
-        if (Path.Num())
+        GM->OnTerrainChanged.AddUniqueDynamic(this, &ATBPlayerController::HandleTerrainChanged);
+
+        // Highlight before the path is handed to the unit
+        if (GM->Overlay)
+        {
+            GM->Overlay->SetLayerPath(EGridOverlayLayer::Path, PathBuffer);
+        }
+
+        // Request preview move (visual only); confirmation happens via Confirm input/UI
+        if (!SelectedUnit->RequestPreviewMove(MoveTemp(PathBuffer)))
         {
-            // Request preview move (visual only); confirmation happens via Confirm input/UI
-            SelectedUnit->RequestPreviewMove(Path);
+            ClearPathOverlay();
         }
-        break;
     }
 }
 
@@ -108,28 +122,36 @@ void ATBPlayerController::OnConfirmPlacement()
 {
     if (!SelectedUnit) return;
     SelectedUnit->ConfirmPlacement();
+    ClearPathOverlay();
+}
 
-    // After confirm, update HUD stats
-    if (TurnHudWidget)
+void ATBPlayerController::OnCancelPreview()
+{
+    if (!SelectedUnit) return;
+    SelectedUnit->CancelPreviewMove();
+    ClearPathOverlay();
+}
+
+void ATBPlayerController::ClearPathOverlay()
+{
+    AGridManager* GM = SelectedUnit && SelectedUnit->CurrentTile ? SelectedUnit->CurrentTile->GetGridManager() : nullptr;
+    if (GM && GM->Overlay)
     {
-        UTurnHudWidget* Hud = Cast<UTurnHudWidget>(TurnHudWidget);
-        if (Hud)
-        {
-            Hud->RefreshAllStats();
-        }
+        GM->Overlay->ClearLayer(EGridOverlayLayer::Path);
     }
 }
 
-void ATBPlayerController::OnCancelPreview()
+void ATBPlayerController::HandleTerrainChanged(FIntPoint DirtyMin, FIntPoint DirtyMax)
 {
     if (!SelectedUnit) return;
-    SelectedUnit->CancelPreviewMove();
 
-    if (TurnHudWidget)
+    AGridManager* GM = SelectedUnit->GetPreviewGrid();
+    if (!GM || !GM->Overlay || !SelectedUnit->GetPreviewPath().IsMove())
     {
-        UTurnHudWidget* Hud = Cast<UTurnHudWidget>(TurnHudWidget);
-        if (Hud) Hud->RefreshAllStats();
+        ClearPathOverlay();
+        return;
     }
+    GM->Overlay->SetLayerPath(EGridOverlayLayer::Path, SelectedUnit->GetPreviewPath());
 }
 
 void ATBPlayerController::OnCastMagicArrow()
@@ -138,12 +160,6 @@ void ATBPlayerController::OnCastMagicArrow()
     AGridTile* Tile = GetTileUnderCursor();
     if (!Tile) return;
     SelectedUnit->CastAbilityAtTile(FName("MagicArrow"), Tile);
-
-    if (TurnHudWidget)
-    {
-        UTurnHudWidget* Hud = Cast<UTurnHudWidget>(TurnHudWidget);
-        if (Hud) Hud->RefreshAllStats();
-    }
 }
 
 void ATBPlayerController::OnCastBoulder()
@@ -152,10 +168,4 @@ void ATBPlayerController::OnCastBoulder()
     AGridTile* Tile = GetTileUnderCursor();
     if (!Tile) return;
     SelectedUnit->CastAbilityAtTile(FName("Boulder"), Tile);
-
-    if (TurnHudWidget)
-    {
-        UTurnHudWidget* Hud = Cast<UTurnHudWidget>(TurnHudWidget);
-        if (Hud) Hud->RefreshAllStats();
-    }
 }
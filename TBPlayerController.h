@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "GridPathfinding.h"
 #include "TBPlayerController.generated.h"
 
 class AGridManager;
@@ -55,5 +56,13 @@ protected:
     bool TraceClick(FHitResult& OutHit) const;
     AGridTile* GetTileUnderCursor() const;
     AUnitCharacter* GetUnitUnderCursor() const;
+    void ClearPathOverlay();
+
+    // Redraw the path highlight from the selected unit's preview, which the grid re-searched or cancelled
+    UFUNCTION()
+    void HandleTerrainChanged(FIntPoint DirtyMin, FIntPoint DirtyMax);
+
+    // Reused by every path query so right-click previews do not allocate
+    FGridPath PathBuffer;
 };
 
@@ -0,0 +1,222 @@
+#include "TBStatModifiers.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+    // Lowest effective value of each stat
+    const int32 StatMinimums[] = { 1, 0, 0, 0, 0, 0 };
+    static_assert(UE_ARRAY_COUNT(StatMinimums) == (int32)ETBStat::Count, "One minimum per stat");
+
+    bool IsAbilityStat(ETBStat Stat)
+    {
+        return Stat >= ETBStat::AbilityRange;
+    }
+}
+
+int32 FTBStatModifierStack::GetCacheIndex(ETBStat Stat, int32 AbilitySlot)
+{
+    if (!IsAbilityStat(Stat)) return (int32)Stat;
+    return NumUnitStats + ((int32)Stat - NumUnitStats) * NumAbilitySlots + AbilitySlot;
+}
+
+void FTBStatModifierStack::MarkDirty(const FTBStatModifier& Modifier)
+{
+    if (!IsAbilityStat(Modifier.Stat))
+    {
+        DirtySums |= 1u << GetCacheIndex(Modifier.Stat, 0);
+        return;
+    }
+    for (int32 Slot = 0; Slot < NumAbilitySlots; ++Slot)
+    {
+        if (Modifier.AbilitySlot == INDEX_NONE || Modifier.AbilitySlot == Slot)
+        {
+            DirtySums |= 1u << GetCacheIndex(Modifier.Stat, Slot);
+        }
+    }
+}
+
+int32 FTBStatModifierStack::Add(const FTBStatModifier& Modifier)
+{
+    if (Modifier.Stat >= ETBStat::Count || Modifier.AbilitySlot < INDEX_NONE || Modifier.AbilitySlot >= NumAbilitySlots || Modifier.Turns < 0)
+    {
+        return INDEX_NONE;
+    }
+
+    FTBStatModifier& Added = Modifiers.Add_GetRef(Modifier);
+    Added.Handle = NextHandle++;
+    MarkDirty(Added);
+    return Added.Handle;
+}
+
+bool FTBStatModifierStack::Remove(int32 Handle)
+{
+    const int32 Index = Modifiers.IndexOfByPredicate([Handle](const FTBStatModifier& Modifier) { return Modifier.Handle == Handle; });
+    if (Index == INDEX_NONE) return false;
+
+    MarkDirty(Modifiers[Index]);
+    Modifiers.RemoveAtSwap(Index, 1, false);
+    return true;
+}
+
+int32 FTBStatModifierStack::RemoveBySource(FName Source)
+{
+    return Modifiers.RemoveAllSwap([this, Source](const FTBStatModifier& Modifier)
+    {
+        if (Modifier.Source != Source) return false;
+        MarkDirty(Modifier);
+        return true;
+    }, false);
+}
+
+uint32 FTBStatModifierStack::ExpireTurn()
+{
+    uint32 ChangedStats = 0;
+    Modifiers.RemoveAllSwap([this, &ChangedStats](FTBStatModifier& Modifier)
+    {
+        if (Modifier.Turns <= 0 || --Modifier.Turns > 0) return false;
+        MarkDirty(Modifier);
+        ChangedStats |= 1u << (uint32)Modifier.Stat;
+        return true;
+    }, false);
+    return ChangedStats;
+}
+
+void FTBStatModifierStack::Refresh() const
+{
+    const uint32 Dirty = DirtySums;
+    for (int32 Index = 0; Index < NumCacheSlots; ++Index)
+    {
+        if (Dirty & (1u << Index))
+        {
+            FlatSum[Index] = 0;
+            PercentSum[Index] = 0;
+        }
+    }
+
+    for (const FTBStatModifier& Modifier : Modifiers)
+    {
+        const bool bAbilityStat = IsAbilityStat(Modifier.Stat);
+        const int32 FirstSlot = bAbilityStat && Modifier.AbilitySlot != INDEX_NONE ? Modifier.AbilitySlot : 0;
+        const int32 LastSlot = bAbilityStat && Modifier.AbilitySlot == INDEX_NONE ? NumAbilitySlots - 1 : FirstSlot;
+        for (int32 Slot = FirstSlot; Slot <= LastSlot && Slot < NumAbilitySlots; ++Slot)
+        {
+            const int32 Index = GetCacheIndex(Modifier.Stat, Slot);
+            if (Dirty & (1u << Index))
+            {
+                FlatSum[Index] += Modifier.Flat;
+                PercentSum[Index] += Modifier.Percent;
+            }
+        }
+    }
+
+    DirtySums = 0;
+}
+
+int32 FTBStatModifierStack::GetEffective(ETBStat Stat, int32 Base, int32 AbilitySlot) const
+{
+    if (IsAbilityStat(Stat) && (AbilitySlot < 0 || AbilitySlot >= NumAbilitySlots)) return Base;
+    if (DirtySums) Refresh();
+
+    const int32 Index = GetCacheIndex(Stat, AbilitySlot);
+    const int64 Value = ((int64)Base + FlatSum[Index]) * (100 + PercentSum[Index]) / 100;
+    return (int32)FMath::Clamp<int64>(Value, StatMinimums[(int32)Stat], MAX_int32);
+}
+
+namespace
+{
+    // Stack of the buffs a busy unit might carry, as equipment, a few timed effects and per-ability bonuses
+    void AddBenchModifiers(FTBStatModifierStack& Stack, FRandomStream& Random, int32 Count)
+    {
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            FTBStatModifier Modifier;
+            Modifier.Stat = (ETBStat)Random.RandHelper((int32)ETBStat::Count);
+            Modifier.AbilitySlot = Random.RandRange(-1, FTBStatModifierStack::NumAbilitySlots - 1);
+            Modifier.Flat = Random.RandRange(-2, 3);
+            Modifier.Percent = Random.RandRange(-10, 25);
+            Modifier.Turns = Random.RandRange(0, 3);
+            Stack.Add(Modifier);
+        }
+    }
+
+    // Effective value summed from scratch, as every read would without the cache
+    int32 SumModifiers(const FTBStatModifierStack& Stack, ETBStat Stat, int32 Base, int32 AbilitySlot)
+    {
+        int32 Flat = 0;
+        int32 Percent = 0;
+        for (const FTBStatModifier& Modifier : Stack.GetModifiers())
+        {
+            if (Modifier.Stat != Stat) continue;
+            if (Stat >= ETBStat::AbilityRange && Modifier.AbilitySlot != INDEX_NONE && Modifier.AbilitySlot != AbilitySlot) continue;
+            Flat += Modifier.Flat;
+            Percent += Modifier.Percent;
+        }
+        const int64 Value = ((int64)Base + Flat) * (100 + Percent) / 100;
+        return (int32)FMath::Clamp<int64>(Value, Stat == ETBStat::MaxHP ? 1 : 0, MAX_int32);
+    }
+
+    void RunStatModifierBenchmark()
+    {
+        constexpr int32 NumUnits = 256;
+        constexpr int32 ModifiersPerUnit = 24;
+        constexpr int32 NumTurns = 20;
+        // Reads per unit per turn: HUD refreshes, cast validation and AI scoring
+        constexpr int32 ReadsPerTurn = 400;
+        const int32 Bases[] = { 100, 10, 5, 12, 8, 3 };
+
+        FRandomStream Random(99);
+        TArray<FTBStatModifierStack> Stacks;
+        Stacks.SetNum(NumUnits);
+        for (FTBStatModifierStack& Stack : Stacks)
+        {
+            AddBenchModifiers(Stack, Random, ModifiersPerUnit);
+        }
+
+        double CachedSeconds = 0.0;
+        double SummedSeconds = 0.0;
+        int64 CachedTotal = 0;
+        int64 SummedTotal = 0;
+        for (int32 Turn = 0; Turn < NumTurns; ++Turn)
+        {
+            double StartTime = FPlatformTime::Seconds();
+            for (const FTBStatModifierStack& Stack : Stacks)
+            {
+                for (int32 Read = 0; Read < ReadsPerTurn; ++Read)
+                {
+                    const ETBStat Stat = (ETBStat)(Read % (int32)ETBStat::Count);
+                    CachedTotal += Stack.GetEffective(Stat, Bases[(int32)Stat], Read & 1);
+                }
+            }
+            CachedSeconds += FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (const FTBStatModifierStack& Stack : Stacks)
+            {
+                for (int32 Read = 0; Read < ReadsPerTurn; ++Read)
+                {
+                    const ETBStat Stat = (ETBStat)(Read % (int32)ETBStat::Count);
+                    SummedTotal += SumModifiers(Stack, Stat, Bases[(int32)Stat], Read & 1);
+                }
+            }
+            SummedSeconds += FPlatformTime::Seconds() - StartTime;
+
+            // Turn reset: timed modifiers expire in bulk and new ones arrive
+            for (FTBStatModifierStack& Stack : Stacks)
+            {
+                Stack.ExpireTurn();
+                AddBenchModifiers(Stack, Random, FMath::Max(0, ModifiersPerUnit - Stack.GetModifiers().Num()));
+            }
+        }
+
+        const double NumReads = (double)NumUnits * ReadsPerTurn * NumTurns;
+        UE_LOG(LogTemp, Display, TEXT("StatModifiers %d units x %d modifiers: cached %.2f ns per read, summed %.2f ns per read, results %s"),
+            NumUnits, ModifiersPerUnit, CachedSeconds * 1.0e9 / NumReads, SummedSeconds * 1.0e9 / NumReads,
+            CachedTotal == SummedTotal ? TEXT("match") : TEXT("DO NOT MATCH"));
+    }
+
+    FAutoConsoleCommand StatModifierBenchmarkCommand(
+        TEXT("tb.Bench.StatModifiers"),
+        TEXT("Cached effective stat reads against summing every modifier on each read, with turn-reset expiry"),
+        FConsoleCommandDelegate::CreateStatic(&RunStatModifierBenchmark));
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TBStatModifiers.generated.h"
+
+// Stats buffs, debuffs and equipment can modify. The ability stats apply per ability slot.
+UENUM(BlueprintType)
+enum class ETBStat : uint8
+{
+    MaxHP,
+    MaxMovementPoints,
+    MaxActionPoints,
+    AbilityRange,
+    // Scales the ability's own MinDamage..MaxDamage (fixed amounts in effect scripts are left alone)
+    AbilityDamage,
+    AbilityAPCost,
+
+    Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct FTBStatModifier
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+    ETBStat Stat = ETBStat::MaxHP;
+
+    // Ability stats only: the slot it applies to, or INDEX_NONE for every ability
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+    int32 AbilitySlot = INDEX_NONE;
+
+    // Added to the base value...
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+    int32 Flat = 0;
+
+    // ...then scaled by (100 + the sum of all Percents) / 100
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+    int32 Percent = 0;
+
+    // Turns the modifier lasts: each turn reset counts it down and the reset that takes it to 0 drops it, so 1 is gone
+    // at the next reset. 0 lasts until removed (equipment).
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier", meta = (ClampMin = "0"))
+    int32 Turns = 0;
+
+    // Who applied it, for removing everything one item or effect added
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Modifier")
+    FName Source = NAME_None;
+
+    // Assigned by FTBStatModifierStack::Add
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Modifier")
+    int32 Handle = INDEX_NONE;
+};
+
+// Modifiers of one unit with cached per-stat totals. Adding, removing or expiring modifiers only marks the affected
+// stats dirty; the next read re-sums the dirty stats in one pass over the modifiers, and every other read is a
+// couple of loads and a multiply, however many modifiers there are. Totals rather than final values are cached so
+// that the base can change freely (a damage modifier applies to both MinDamage and MaxDamage).
+USTRUCT()
+struct DENEME_API FTBStatModifierStack
+{
+    GENERATED_BODY()
+
+    // Ability slots tracked per ability stat (MagicArrow, Boulder)
+    static constexpr int32 NumAbilitySlots = 2;
+
+    // Returns the handle of the new modifier, or INDEX_NONE for an unknown stat, an ability slot outside
+    // [INDEX_NONE, NumAbilitySlots) or negative Turns
+    int32 Add(const FTBStatModifier& Modifier);
+
+    bool Remove(int32 Handle);
+
+    // Remove every modifier from Source; returns how many
+    int32 RemoveBySource(FName Source);
+
+    // Turn reset: count down timed modifiers and drop the ones that reach 0, in one pass. Returns a mask of
+    // (1 << ETBStat) for the stats that changed.
+    uint32 ExpireTurn();
+
+    // Base with the modifiers of Stat applied (ability stats need an AbilitySlot). Never below the stat's minimum.
+    int32 GetEffective(ETBStat Stat, int32 Base, int32 AbilitySlot = INDEX_NONE) const;
+
+    const TArray<FTBStatModifier>& GetModifiers() const { return Modifiers; }
+
+    SIZE_T GetAllocatedSize() const { return Modifiers.GetAllocatedSize(); }
+
+private:
+    // Cache slot of a stat: one per unit stat, one per (ability stat, slot)
+    static int32 GetCacheIndex(ETBStat Stat, int32 AbilitySlot);
+
+    void MarkDirty(const FTBStatModifier& Modifier);
+
+    // Re-sum every dirty cache slot
+    void Refresh() const;
+
+    static constexpr int32 NumUnitStats = (int32)ETBStat::AbilityRange;
+    static constexpr int32 NumCacheSlots = NumUnitStats + ((int32)ETBStat::Count - NumUnitStats) * NumAbilitySlots;
+
+    UPROPERTY(VisibleAnywhere, Category = "Modifier")
+    TArray<FTBStatModifier> Modifiers;
+
+    int32 NextHandle = 0;
+
+    // Per cache slot
+    mutable int32 FlatSum[NumCacheSlots] = {};
+    mutable int32 PercentSum[NumCacheSlots] = {};
+
+    // Bit per cache slot whose sums are out of date (all of them for a stack copied or loaded with modifiers)
+    mutable uint32 DirtySums = ~0u;
+    static_assert(NumCacheSlots <= 32, "Dirty masks are 32 bits");
+};
@@ -0,0 +1,152 @@
+#include "TBStateHash.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+    TAutoConsoleVariable<int32> CVarValidateStateHash(
+        TEXT("tb.StateHash.Validate"),
+        UE_BUILD_DEBUG ? 1 : 0,
+        TEXT("1: recompute the battle state hash from scratch after every incremental update and log mismatches"),
+        ECVF_Cheat);
+}
+
+bool TBStateHash::IsValidationEnabled()
+{
+    return CVarValidateStateHash.GetValueOnAnyThread() != 0;
+}
+
+namespace
+{
+    // Units of a synthetic battle, hashed the way AGridManager hashes actors
+    struct FBenchUnit
+    {
+        int32 Tile = 0;
+        int32 HP = 0;
+        int32 MovementPoints = 0;
+        int32 ActionPoints = 0;
+        int32 Casts[2] = {};
+    };
+
+    uint64 HashUnit(int32 UnitId, const FBenchUnit& Unit)
+    {
+        using namespace TBStateHash;
+        return Key(ETBStateField::Occupied, Unit.Tile, 0)
+            ^ Key(ETBStateField::UnitTile, UnitId, Unit.Tile)
+            ^ Key(ETBStateField::HP, UnitId, Unit.HP)
+            ^ Key(ETBStateField::MovementPoints, UnitId, Unit.MovementPoints)
+            ^ Key(ETBStateField::ActionPoints, UnitId, Unit.ActionPoints)
+            ^ Key(ETBStateField::CastsRemaining, UnitId, PackCasts(0, Unit.Casts[0]))
+            ^ Key(ETBStateField::CastsRemaining, UnitId, PackCasts(1, Unit.Casts[1]));
+    }
+
+    uint64 HashAll(const TArray<FBenchUnit>& Units)
+    {
+        uint64 Hash = 0;
+        for (int32 UnitId = 0; UnitId < Units.Num(); ++UnitId)
+        {
+            Hash ^= HashUnit(UnitId, Units[UnitId]);
+        }
+        return Hash;
+    }
+
+    void RunStateHashBenchmark()
+    {
+        constexpr int32 NumUpdates = 1 << 20;
+        const int32 UnitCounts[] = { 16, 64, 256 };
+
+        for (int32 NumUnits : UnitCounts)
+        {
+            FRandomStream Random(NumUnits);
+            TArray<FBenchUnit> Units;
+            Units.SetNum(NumUnits);
+            for (int32 UnitId = 0; UnitId < NumUnits; ++UnitId)
+            {
+                // One unit per row keeps tiles distinct while units move along their row
+                Units[UnitId].Tile = UnitId * 64;
+                Units[UnitId].HP = 100;
+                Units[UnitId].MovementPoints = 10;
+                Units[UnitId].ActionPoints = 5;
+            }
+
+            // Same mutations twice: once XORing the changed keys, once recomputing everything after each change
+            int32 NumMismatches = 0;
+            for (int32 Pass = 0; Pass < 2; ++Pass)
+            {
+                Random.Reset();
+                TArray<FBenchUnit> Work = Units;
+                uint64 Hash = HashAll(Units);
+                const int32 NumPassUpdates = Pass == 0 ? NumUpdates : NumUpdates / 64;
+
+                const double StartTime = FPlatformTime::Seconds();
+                for (int32 Update = 0; Update < NumPassUpdates; ++Update)
+                {
+                    const int32 UnitId = Random.RandRange(0, NumUnits - 1);
+                    FBenchUnit& Unit = Work[UnitId];
+                    const int32 NewHP = FMath::Max(0, Unit.HP - Random.RandRange(0, 3));
+                    const int32 NewTile = (Unit.Tile & ~63) | ((Unit.Tile + 1) & 63);
+                    if (Pass == 0)
+                    {
+                        using namespace TBStateHash;
+                        Hash ^= Delta(ETBStateField::HP, UnitId, Unit.HP, NewHP)
+                            ^ Key(ETBStateField::Occupied, Unit.Tile, 0) ^ Key(ETBStateField::Occupied, NewTile, 0)
+                            ^ Delta(ETBStateField::UnitTile, UnitId, Unit.Tile, NewTile);
+                    }
+                    Unit.HP = NewHP;
+                    Unit.Tile = NewTile;
+                    if (Pass == 1)
+                    {
+                        Hash = HashAll(Work);
+                    }
+                }
+                const double ElapsedNs = (FPlatformTime::Seconds() - StartTime) * 1.0e9 / NumPassUpdates;
+
+                if (Pass == 0)
+                {
+                    NumMismatches += Hash != HashAll(Work);
+                    UE_LOG(LogTemp, Display, TEXT("StateHash %3d units: incremental %6.1f ns per update"), NumUnits, ElapsedNs);
+                }
+                else
+                {
+                    UE_LOG(LogTemp, Display, TEXT("StateHash %3d units: full recompute %6.1f ns per update"), NumUnits, ElapsedNs);
+                }
+            }
+            UE_LOG(LogTemp, Display, TEXT("StateHash %3d units: incremental hash %s full recompute"), NumUnits, NumMismatches == 0 ? TEXT("matches") : TEXT("DOES NOT MATCH"));
+        }
+
+        // Transposition table: store a million states, then probe the most recent quarter
+        TTBTranspositionTable<int32> Table(18);
+        FRandomStream Random(7);
+        constexpr int32 NumStates = 1 << 20;
+        TArray<uint64> States;
+        States.SetNumUninitialized(NumStates);
+        for (int32 Index = 0; Index < NumStates; ++Index)
+        {
+            States[Index] = DeterministicRandom::Mix64((uint64)Index + 1);
+        }
+
+        const double StoreStart = FPlatformTime::Seconds();
+        for (int32 Index = 0; Index < NumStates; ++Index)
+        {
+            Table.Store(States[Index], Index, Index & 7);
+        }
+        const double StoreNs = (FPlatformTime::Seconds() - StoreStart) * 1.0e9 / NumStates;
+
+        int64 Found = 0;
+        const double ProbeStart = FPlatformTime::Seconds();
+        for (int32 Probe = 0; Probe < NumStates; ++Probe)
+        {
+            const int32* Value = Table.Find(States[Random.RandRange(NumStates * 3 / 4, NumStates - 1)]);
+            Found += Value ? 1 : 0;
+        }
+        const double ProbeNs = (FPlatformTime::Seconds() - ProbeStart) * 1.0e9 / NumStates;
+
+        UE_LOG(LogTemp, Display, TEXT("TranspositionTable %d entries, %.1f MB: %.1f ns per store, %.1f ns per probe, %.1f%% of recent states still cached"),
+            Table.Num(), Table.GetAllocatedSize() / (1024.0 * 1024.0), StoreNs, ProbeNs, 100.0 * Found / NumStates);
+    }
+
+    FAutoConsoleCommand StateHashBenchmarkCommand(
+        TEXT("tb.Bench.StateHash"),
+        TEXT("Incremental state hash updates against full recomputation, and transposition table store/probe cost"),
+        FConsoleCommandDelegate::CreateStatic(&RunStateHashBenchmark));
+}
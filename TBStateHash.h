@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DeterministicRandom.h"
+
+// Parts of battle state covered by the state hash
+enum class ETBStateField : uint8
+{
+    // Subject: tile index. Value: 0. Present while the occupancy bitboards mark the tile.
+    Occupied,
+    // Subject: UnitId. Value: tile index of the tile the unit occupies.
+    UnitTile,
+    HP,
+    MovementPoints,
+    ActionPoints,
+    // Value: (ability slot << 24) | casts remaining
+    CastsRemaining,
+};
+
+// Zobrist hashing of battle state. The hash is the XOR of one 64-bit key per (field, subject, value) present in the
+// state, so a change is undone and redone with two XORs: Hash ^= Key(old) ^ Key(new). Keys are derived with Mix64
+// instead of looked up in random tables, so fields with unbounded ranges (HP, tile index) need no table and every
+// machine derives the same keys, which is what replay verification and desync checks compare.
+namespace TBStateHash
+{
+    FORCEINLINE uint64 Key(ETBStateField Field, int32 Subject, int32 Value)
+    {
+        using namespace DeterministicRandom;
+        return Mix64(Mix64(((uint64)Field << 32) | (uint32)Subject) ^ (uint32)Value);
+    }
+
+    // XOR delta for a field changing from OldValue to NewValue (0 if unchanged)
+    FORCEINLINE uint64 Delta(ETBStateField Field, int32 Subject, int32 OldValue, int32 NewValue)
+    {
+        return OldValue == NewValue ? 0 : Key(Field, Subject, OldValue) ^ Key(Field, Subject, NewValue);
+    }
+
+    FORCEINLINE int32 PackCasts(int32 Slot, int32 CastsRemaining)
+    {
+        return (Slot << 24) | (CastsRemaining & 0xFFFFFF);
+    }
+
+    // tb.StateHash.Validate: recompute from scratch after every hashed change and report mismatches
+    DENEME_API bool IsValidationEnabled();
+}
+
+// Fixed-size cache of search results keyed on a state hash, for AI search and evaluation caching. Buckets hold two
+// entries: a probe reads one cache line pair, and a store replaces the empty, same-state, older or shallower entry.
+// The full 64-bit hash is stored, so a hit is a different state only on a true 64-bit collision.
+template <typename ValueType>
+class TTBTranspositionTable
+{
+public:
+    // 2^SizeLog2 entries
+    explicit TTBTranspositionTable(int32 SizeLog2 = 16)
+    {
+        Entries.SetNum(1 << FMath::Clamp(SizeLog2, 1, 28));
+        Mask = (uint64)Entries.Num() - 1;
+    }
+
+    void Clear()
+    {
+        for (FEntry& Entry : Entries) Entry = FEntry();
+        Generation = 0;
+        NumProbes = NumHits = 0;
+    }
+
+    // Age out earlier results without clearing (call at the start of each search)
+    void NewSearch() { ++Generation; }
+
+    // Result stored for Hash with at least MinDepth, or nullptr
+    const ValueType* Find(uint64 Hash, int32 MinDepth = 0) const
+    {
+        ++NumProbes;
+        const FEntry* Bucket = &Entries[Hash & Mask & ~1ull];
+        for (int32 Way = 0; Way < 2; ++Way)
+        {
+            if (Bucket[Way].Depth >= 0 && Bucket[Way].Hash == Hash && Bucket[Way].Depth >= MinDepth)
+            {
+                ++NumHits;
+                return &Bucket[Way].Value;
+            }
+        }
+        return nullptr;
+    }
+
+    void Store(uint64 Hash, const ValueType& Value, int32 Depth = 0)
+    {
+        FEntry* Bucket = &Entries[Hash & Mask & ~1ull];
+        FEntry* Victim = &Bucket[0];
+        for (int32 Way = 0; Way < 2; ++Way)
+        {
+            FEntry& Entry = Bucket[Way];
+            if (Entry.Depth < 0 || Entry.Hash == Hash)
+            {
+                Victim = &Entry;
+                break;
+            }
+            // Prefer evicting results from older searches, then shallower ones
+            const bool bOlder = Entry.Generation != Generation && Victim->Generation == Generation;
+            if (bOlder || (Entry.Generation == Victim->Generation && Entry.Depth < Victim->Depth))
+            {
+                Victim = &Entry;
+            }
+        }
+        if (Victim->Hash == Hash && Victim->Depth > Depth && Victim->Generation == Generation) return;
+
+        Victim->Hash = Hash;
+        Victim->Value = Value;
+        Victim->Depth = (int16)FMath::Clamp(Depth, 0, (int32)MAX_int16);
+        Victim->Generation = Generation;
+    }
+
+    int32 Num() const { return Entries.Num(); }
+    uint64 GetNumProbes() const { return NumProbes; }
+    uint64 GetNumHits() const { return NumHits; }
+    SIZE_T GetAllocatedSize() const { return Entries.GetAllocatedSize(); }
+
+private:
+    struct FEntry
+    {
+        uint64 Hash = 0;
+        ValueType Value = ValueType();
+
+        // -1 marks an empty entry
+        int16 Depth = -1;
+        uint8 Generation = 0;
+    };
+
+    TArray<FEntry> Entries;
+    uint64 Mask = 0;
+    uint8 Generation = 0;
+    mutable uint64 NumProbes = 0;
+    mutable uint64 NumHits = 0;
+};
@@ -0,0 +1,341 @@
+#include "TBTelemetry.h"
+#include "Async/ParallelFor.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+std::atomic<bool> FTBTelemetry::bRecording{ false };
+FTBTelemetryRing* FTBTelemetry::Ring = nullptr;
+
+FTBTelemetryRing::FTBTelemetryRing(int32 InCapacity)
+{
+    const uint64 Capacity = FMath::RoundUpToPowerOfTwo64((uint64)FMath::Max(2, InCapacity));
+    Mask = Capacity - 1;
+    Slots = MakeUnique<FSlot[]>(Capacity);
+    for (uint64 Index = 0; Index < Capacity; ++Index)
+    {
+        Slots[Index].Sequence.store(Index, std::memory_order_relaxed);
+    }
+}
+
+bool FTBTelemetryRing::Push(const FTBTelemetryRecord& Record)
+{
+    uint64 Pos = Head.load(std::memory_order_relaxed);
+    FSlot* Slot;
+    for (;;)
+    {
+        Slot = &Slots[Pos & Mask];
+        const int64 Diff = (int64)(Slot->Sequence.load(std::memory_order_acquire) - Pos);
+        if (Diff == 0)
+        {
+            // Slot is free for this lap: claim it
+            if (Head.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed)) break;
+        }
+        else if (Diff < 0)
+        {
+            // The consumer has not taken this slot's previous record yet: full
+            NumDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            // Another producer claimed it first
+            Pos = Head.load(std::memory_order_relaxed);
+        }
+    }
+
+    Slot->Record = Record;
+    Slot->Sequence.store(Pos + 1, std::memory_order_release);
+    return true;
+}
+
+int32 FTBTelemetryRing::Pop(FTBTelemetryRecord* OutRecords, int32 MaxRecords)
+{
+    int32 Count = 0;
+    while (Count < MaxRecords)
+    {
+        FSlot& Slot = Slots[Tail & Mask];
+        if (Slot.Sequence.load(std::memory_order_acquire) != Tail + 1) break; // not published yet
+
+        OutRecords[Count++] = Slot.Record;
+
+        // Hand the slot to the producers' next lap
+        Slot.Sequence.store(Tail + Mask + 1, std::memory_order_release);
+        ++Tail;
+    }
+    return Count;
+}
+
+namespace
+{
+    // Drains the ring into the file every FlushIntervalMs, in large sequential writes
+    class FTBTelemetryWriter : public FRunnable
+    {
+    public:
+        FTBTelemetryWriter(FTBTelemetryRing& InRing, IFileHandle* InFile)
+            : Ring(InRing)
+            , File(InFile)
+            , DroppedAtStart(InRing.GetNumDropped())
+            , WakeEvent(FPlatformProcess::GetSynchEventFromPool())
+        {
+            Batch.SetNumUninitialized(4096);
+        }
+
+        virtual ~FTBTelemetryWriter() override
+        {
+            FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+        }
+
+        virtual uint32 Run() override
+        {
+            while (!bStopRequested.load(std::memory_order_relaxed))
+            {
+                WakeEvent->Wait(FTBTelemetry::FlushIntervalMs);
+                Drain();
+            }
+            Drain();
+            return 0;
+        }
+
+        virtual void Stop() override
+        {
+            bStopRequested.store(true, std::memory_order_relaxed);
+            WakeEvent->Trigger();
+        }
+
+        // After the thread has exited: write the totals into the header and close the file
+        void Finish()
+        {
+            const uint64 NumDropped = Ring.GetNumDropped() - DroppedAtStart;
+            if (File->Seek(STRUCT_OFFSET(FTBTelemetryFileHeader, NumRecords)))
+            {
+                File->Write((const uint8*)&NumWritten, sizeof(NumWritten));
+                File->Write((const uint8*)&NumDropped, sizeof(NumDropped));
+            }
+            delete File;
+            File = nullptr;
+
+            UE_LOG(LogTemp, Display, TEXT("Telemetry: %llu records written, %llu dropped"), NumWritten, NumDropped);
+        }
+
+    private:
+        void Drain()
+        {
+            for (;;)
+            {
+                const int32 NumRecords = Ring.Pop(Batch.GetData(), Batch.Num());
+                if (NumRecords == 0) break;
+                File->Write((const uint8*)Batch.GetData(), NumRecords * sizeof(FTBTelemetryRecord));
+                NumWritten += NumRecords;
+            }
+        }
+
+        FTBTelemetryRing& Ring;
+        IFileHandle* File;
+        const uint64 DroppedAtStart;
+        uint64 NumWritten = 0;
+        FEvent* WakeEvent;
+        std::atomic<bool> bStopRequested{ false };
+        TArray<FTBTelemetryRecord> Batch;
+    };
+
+    // Game thread only
+    FTBTelemetryWriter* Writer = nullptr;
+    FRunnableThread* WriterThread = nullptr;
+    FString CurrentFilePath;
+}
+
+bool FTBTelemetry::Start(const FString& FilePath)
+{
+    Stop();
+
+    if (!Ring)
+    {
+        Ring = new FTBTelemetryRing(RingCapacity);
+
+        // Close the file properly if the game exits while recording
+        FCoreDelegates::OnPreExit.AddStatic(&FTBTelemetry::Stop);
+    }
+
+    // Records a late producer pushed after the last Stop belong to no file
+    FTBTelemetryRecord Discard[256];
+    while (Ring->Pop(Discard, UE_ARRAY_COUNT(Discard))) {}
+
+    const FString Path = FilePath.IsEmpty()
+        ? FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("Match_%s.tbt"), *FDateTime::Now().ToString())
+        : FilePath;
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+    IFileHandle* File = PlatformFile.OpenWrite(*Path);
+    if (!File)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Telemetry: could not open %s"), *Path);
+        return false;
+    }
+
+    FTBTelemetryFileHeader Header;
+    Header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+    Header.StartCycles = FPlatformTime::Cycles64();
+    File->Write((const uint8*)&Header, sizeof(Header));
+
+    Writer = new FTBTelemetryWriter(*Ring, File);
+    WriterThread = FRunnableThread::Create(Writer, TEXT("TBTelemetryWriter"), 0, TPri_BelowNormal);
+    if (!WriterThread)
+    {
+        Writer->Finish();
+        delete Writer;
+        Writer = nullptr;
+        UE_LOG(LogTemp, Warning, TEXT("Telemetry: could not start the writer thread"));
+        return false;
+    }
+
+    CurrentFilePath = Path;
+    bRecording.store(true, std::memory_order_release);
+    UE_LOG(LogTemp, Display, TEXT("Telemetry: recording to %s"), *Path);
+    return true;
+}
+
+void FTBTelemetry::Stop()
+{
+    if (!WriterThread) return;
+
+    bRecording.store(false, std::memory_order_release);
+
+    // Kill(true) asks the writer to stop and waits for its final drain
+    WriterThread->Kill(true);
+    delete WriterThread;
+    WriterThread = nullptr;
+
+    Writer->Finish();
+    delete Writer;
+    Writer = nullptr;
+}
+
+FString FTBTelemetry::GetFilePath()
+{
+    return IsRecording() ? CurrentFilePath : FString();
+}
+
+const TCHAR* FTBTelemetry::GetEventName(ETBTelemetryEvent Type)
+{
+    switch (Type)
+    {
+    case ETBTelemetryEvent::TurnStarted: return TEXT("TurnStarted");
+    case ETBTelemetryEvent::PathRequest: return TEXT("PathRequest");
+    case ETBTelemetryEvent::AbilityCast: return TEXT("AbilityCast");
+    case ETBTelemetryEvent::Damage: return TEXT("Damage");
+    case ETBTelemetryEvent::Death: return TEXT("Death");
+    case ETBTelemetryEvent::MovementSpent: return TEXT("MovementSpent");
+    case ETBTelemetryEvent::ActionSpent: return TEXT("ActionSpent");
+    default: return TEXT("?");
+    }
+}
+
+const TCHAR* FTBTelemetry::GetCastResultName(ETBCastResult Result)
+{
+    switch (Result)
+    {
+    case ETBCastResult::Hit: return TEXT("Hit");
+    case ETBCastResult::NoTarget: return TEXT("NoTarget");
+    case ETBCastResult::Blocked: return TEXT("Blocked");
+    case ETBCastResult::OutOfReach: return TEXT("OutOfReach");
+    default: return TEXT("?");
+    }
+}
+
+namespace
+{
+    void RunTelemetryStart(const TArray<FString>& Args)
+    {
+        FTBTelemetry::Start(Args.Num() > 0 ? Args[0] : FString());
+    }
+
+    void RunTelemetryStop()
+    {
+        FTBTelemetry::Stop();
+    }
+
+    // Recording cost at 10000 events per turn, against a 60 Hz frame: game thread alone and 4 producer threads
+    void RunTelemetryBenchmark()
+    {
+        if (FTBTelemetry::IsRecording())
+        {
+            UE_LOG(LogTemp, Warning, TEXT("tb.Bench.Telemetry: stop the current recording first"));
+            return;
+        }
+
+        constexpr int32 EventsPerTurn = 10000;
+        constexpr int32 NumTurns = 20;
+        constexpr int32 NumThreads = 4;
+        constexpr double FrameUs = 1.0e6 / 60.0;
+
+        // Disabled: the check every call site pays when nobody records
+        double StartTime = FPlatformTime::Seconds();
+        for (int32 Index = 0; Index < EventsPerTurn * NumTurns; ++Index)
+        {
+            FTBTelemetry::Record(ETBTelemetryEvent::Damage, Index, 10, 90, 0);
+        }
+        const double DisabledUs = (FPlatformTime::Seconds() - StartTime) * 1.0e6 / NumTurns;
+
+        const FString Path = FPaths::ProjectSavedDir() / TEXT("Telemetry") / TEXT("Bench.tbt");
+        if (!FTBTelemetry::Start(Path)) return;
+
+        double SingleUs = 0.0;
+        double ParallelUs = 0.0;
+        for (int32 Turn = 0; Turn < NumTurns; ++Turn)
+        {
+            StartTime = FPlatformTime::Seconds();
+            for (int32 Index = 0; Index < EventsPerTurn; ++Index)
+            {
+                FTBTelemetry::Record(ETBTelemetryEvent::Damage, Index, 10, 90, 0);
+            }
+            SingleUs += (FPlatformTime::Seconds() - StartTime) * 1.0e6;
+
+            // Let the writer catch up, as it would between turns
+            FPlatformProcess::Sleep(2.0f * FTBTelemetry::FlushIntervalMs / 1000.0f);
+
+            StartTime = FPlatformTime::Seconds();
+            ParallelFor(NumThreads, [](int32 Thread)
+            {
+                for (int32 Index = 0; Index < EventsPerTurn / NumThreads; ++Index)
+                {
+                    FTBTelemetry::Record(ETBTelemetryEvent::PathRequest, Thread, Index, 8, 1000, 1);
+                }
+            });
+            ParallelUs += (FPlatformTime::Seconds() - StartTime) * 1.0e6;
+
+            FPlatformProcess::Sleep(2.0f * FTBTelemetry::FlushIntervalMs / 1000.0f);
+        }
+        FTBTelemetry::Stop();
+        IFileManager::Get().Delete(*Path);
+
+        SingleUs /= NumTurns;
+        ParallelUs /= NumTurns;
+        UE_LOG(LogTemp, Display, TEXT("Telemetry %d events/turn: disabled %7.2f us, game thread %7.2f us (%5.1f ns/event, %.2f%% of a 60 Hz frame), %d threads %7.2f us (%.2f%%)"),
+            EventsPerTurn, DisabledUs, SingleUs, SingleUs * 1000.0 / EventsPerTurn, SingleUs * 100.0 / FrameUs,
+            NumThreads, ParallelUs, ParallelUs * 100.0 / FrameUs);
+    }
+
+    FAutoConsoleCommand TelemetryStartCommand(
+        TEXT("tb.Telemetry.Start"),
+        TEXT("tb.Telemetry.Start [Path]: record match telemetry to a binary file (default Saved/Telemetry/Match_<time>.tbt)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunTelemetryStart));
+
+    FAutoConsoleCommand TelemetryStopCommand(
+        TEXT("tb.Telemetry.Stop"),
+        TEXT("Flush and close the telemetry file"),
+        FConsoleCommandDelegate::CreateStatic(&RunTelemetryStop));
+
+    FAutoConsoleCommand TelemetryBenchmarkCommand(
+        TEXT("tb.Bench.Telemetry"),
+        TEXT("Measure telemetry recording cost at 10000 events per turn from the game thread and from 4 threads"),
+        FConsoleCommandDelegate::CreateStatic(&RunTelemetryBenchmark));
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreGlobals.h"
+#include "HAL/PlatformTime.h"
+#include <atomic>
+
+// Kinds of telemetry records; Subject and Values[] mean different things per kind
+enum class ETBTelemetryEvent : uint8
+{
+    // Subject: 0. Values: turn number, low and high 32 bits of the battle state hash (AGridManager::GetStateHash)
+    TurnStarted,
+    // Subject: start tile. Values: goal tile, path length in tiles (0 if none), search time in ns. Flags: 1 if found.
+    PathRequest,
+    // Subject: caster UnitId. Values: ability slot, target tile, damage dealt. Flags: ETBCastResult.
+    AbilityCast,
+    // Subject: UnitId. Values: amount, HP left, 1 if magical
+    Damage,
+    // Subject: UnitId. Values: tile the unit died on
+    Death,
+    // Subject: owning UnitId. Values: points requested, points left. Flags: 1 if spent.
+    MovementSpent,
+    ActionSpent,
+
+    Count
+};
+
+enum class ETBCastResult : uint8
+{
+    // Cast went off and damaged a unit
+    Hit,
+    // Cast went off at a tile without a unit
+    NoTarget,
+    // No casts left, not enough AP, no origin, unknown ability
+    Blocked,
+    // Out of range or line of sight; nothing spent
+    OutOfReach,
+};
+
+// One event. Fixed size and trivially copyable, so the writer dumps batches of them to disk as they are.
+struct FTBTelemetryRecord
+{
+    // FPlatformTime::Cycles64() when recorded
+    uint64 Cycles = 0;
+    uint32 Frame = 0;
+    ETBTelemetryEvent Type = ETBTelemetryEvent::TurnStarted;
+    uint8 Flags = 0;
+    uint16 Reserved = 0;
+    int32 Subject = 0;
+    int32 Values[3] = {};
+};
+static_assert(sizeof(FTBTelemetryRecord) == 32, "Telemetry records are written to disk as raw 32 byte blocks");
+
+// Start of a telemetry file, followed by the records
+struct FTBTelemetryFileHeader
+{
+    static constexpr uint32 ExpectedMagic = 0x4C544254; // "TBTL"
+    static constexpr uint16 CurrentVersion = 1;
+
+    uint32 Magic = ExpectedMagic;
+    uint16 Version = CurrentVersion;
+    uint16 RecordSize = sizeof(FTBTelemetryRecord);
+    double SecondsPerCycle = 0.0;
+    uint64 StartCycles = 0;
+    // Patched when the file is closed
+    uint64 NumRecords = 0;
+    uint64 NumDropped = 0;
+};
+
+// Bounded multi-producer, single-consumer queue of records. Each slot carries a sequence number:
+// producers claim a slot with one CAS on the head and publish it with a release store, the consumer
+// takes slots in order once they are published. Nobody takes a lock or waits; when the ring is full
+// the record is dropped and counted instead of stalling the game thread.
+class DENEME_API FTBTelemetryRing
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit FTBTelemetryRing(int32 InCapacity);
+
+    // Any thread
+    bool Push(const FTBTelemetryRecord& Record);
+
+    // Consumer thread only: copy up to MaxRecords published records to OutRecords, oldest first
+    int32 Pop(FTBTelemetryRecord* OutRecords, int32 MaxRecords);
+
+    int32 GetCapacity() const { return (int32)(Mask + 1); }
+    uint64 GetNumDropped() const { return NumDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct FSlot
+    {
+        std::atomic<uint64> Sequence;
+        FTBTelemetryRecord Record;
+    };
+
+    TUniquePtr<FSlot[]> Slots;
+    uint64 Mask = 0;
+
+    // Producers, consumer and the drop counter on separate cache lines
+    alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Head{ 0 };
+    alignas(PLATFORM_CACHE_LINE_SIZE) uint64 Tail = 0;
+    alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> NumDropped{ 0 };
+};
+
+// Match telemetry for balancing and performance work. Gameplay code calls Record() from any thread;
+// records go into a lock-free ring and a background thread appends them to a binary file in batches
+// (Saved/Telemetry/*.tbt). Convert files with -run=TBTelemetryCsv. When not recording, Record() is one acquire load (a plain load on x86).
+class DENEME_API FTBTelemetry
+{
+public:
+    // Begin writing to FilePath (default: a timestamped file under Saved/Telemetry). Stops any recording in progress.
+    static bool Start(const FString& FilePath = FString());
+
+    // Flush everything recorded so far, close the file and join the writer thread
+    static void Stop();
+
+    // Acquire pairs with the release store in Start(), so a producer that sees the flag also sees Ring
+    static bool IsRecording() { return bRecording.load(std::memory_order_acquire); }
+
+    static FString GetFilePath();
+
+    static void Record(ETBTelemetryEvent Type, int32 Subject, int32 Value0 = 0, int32 Value1 = 0, int32 Value2 = 0, uint8 Flags = 0)
+    {
+        if (!IsRecording()) return;
+
+        FTBTelemetryRecord Record;
+        Record.Cycles = FPlatformTime::Cycles64();
+        Record.Frame = (uint32)GFrameCounter;
+        Record.Type = Type;
+        Record.Flags = Flags;
+        Record.Subject = Subject;
+        Record.Values[0] = Value0;
+        Record.Values[1] = Value1;
+        Record.Values[2] = Value2;
+        Ring->Push(Record);
+    }
+
+    static const TCHAR* GetEventName(ETBTelemetryEvent Type);
+    static const TCHAR* GetCastResultName(ETBCastResult Result);
+
+    // Ring slots; at 10000 records per turn the writer has several turns of headroom
+    static constexpr int32 RingCapacity = 1 << 16;
+
+    // How often the writer wakes up to drain the ring
+    static constexpr uint32 FlushIntervalMs = 20;
+
+private:
+    static std::atomic<bool> bRecording;
+
+    // Allocated on the first Start and never freed, so a producer racing Stop() still pushes into valid memory
+    static FTBTelemetryRing* Ring;
+};
@@ -0,0 +1,99 @@
+#include "TBTelemetryCsvCommandlet.h"
+#include "TBTelemetry.h"
+#include "Algo/StableSort.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UTBTelemetryCsvCommandlet::UTBTelemetryCsvCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+    ShowErrorCount = true;
+}
+
+int32 UTBTelemetryCsvCommandlet::Main(const FString& Params)
+{
+    FString InputPath;
+    FString OutputPath;
+    if (!FParse::Value(*Params, TEXT("Input="), InputPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TBTelemetryCsv: -Input=<file>.tbt is required"));
+        return 1;
+    }
+    if (!FParse::Value(*Params, TEXT("Output="), OutputPath))
+    {
+        OutputPath = FPaths::ChangeExtension(InputPath, TEXT("csv"));
+    }
+
+    TArray<uint8> Data;
+    if (!FFileHelper::LoadFileToArray(Data, *InputPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TBTelemetryCsv: could not read %s"), *InputPath);
+        return 1;
+    }
+
+    FTBTelemetryFileHeader Header;
+    if (Data.Num() < (int32)sizeof(Header))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TBTelemetryCsv: %s is too short for a telemetry file"), *InputPath);
+        return 1;
+    }
+    FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+    if (Header.Magic != FTBTelemetryFileHeader::ExpectedMagic || Header.Version != FTBTelemetryFileHeader::CurrentVersion
+        || Header.RecordSize != sizeof(FTBTelemetryRecord))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TBTelemetryCsv: %s is not a version %d telemetry file"), *InputPath, FTBTelemetryFileHeader::CurrentVersion);
+        return 1;
+    }
+
+    // A file whose recording was cut short has no totals in the header; take whatever whole records are there
+    const int32 NumRecords = (Data.Num() - (int32)sizeof(Header)) / (int32)sizeof(FTBTelemetryRecord);
+    if (Header.NumRecords != 0 && Header.NumRecords != (uint64)NumRecords)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TBTelemetryCsv: header lists %llu records, file holds %d"), Header.NumRecords, NumRecords);
+    }
+    if (Header.NumDropped > 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TBTelemetryCsv: %llu records were dropped while recording (ring full)"), Header.NumDropped);
+    }
+
+    TArray<FTBTelemetryRecord> Records;
+    Records.SetNumUninitialized(NumRecords);
+    FMemory::Memcpy(Records.GetData(), Data.GetData() + sizeof(Header), NumRecords * sizeof(FTBTelemetryRecord));
+    Data.Empty();
+
+    // Producers on different threads interleave in the ring; restore time order
+    Algo::StableSortBy(Records, &FTBTelemetryRecord::Cycles);
+
+    FString Csv = TEXT("time_ms,frame,turn,event,subject,result,value0,value1,value2\n");
+    Csv.Reserve(Csv.Len() + NumRecords * 64);
+
+    int32 Turn = 0;
+    for (const FTBTelemetryRecord& Record : Records)
+    {
+        if (Record.Type == ETBTelemetryEvent::TurnStarted)
+        {
+            Turn = Record.Values[0];
+        }
+
+        const double TimeMs = (double)(int64)(Record.Cycles - Header.StartCycles) * Header.SecondsPerCycle * 1000.0;
+        const TCHAR* Result = Record.Type == ETBTelemetryEvent::AbilityCast
+            ? FTBTelemetry::GetCastResultName((ETBCastResult)Record.Flags)
+            : (Record.Flags ? TEXT("1") : TEXT("0"));
+
+        Csv += FString::Printf(TEXT("%.4f,%u,%d,%s,%d,%s,%d,%d,%d\n"),
+            TimeMs, Record.Frame, Turn, FTBTelemetry::GetEventName(Record.Type), Record.Subject, Result,
+            Record.Values[0], Record.Values[1], Record.Values[2]);
+    }
+
+    if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TBTelemetryCsv: could not write %s"), *OutputPath);
+        return 1;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("TBTelemetryCsv: %d records from %s to %s"), NumRecords, *InputPath, *OutputPath);
+    return 0;
+}
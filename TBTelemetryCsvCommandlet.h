@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TBTelemetryCsvCommandlet.generated.h"
+
+// Converts a binary telemetry file (FTBTelemetry) to CSV for spreadsheets and notebooks:
+//
+//   UnrealEditor-Cmd <Project>.uproject -run=TBTelemetryCsv -Input=<file>.tbt [-Output=<file>.csv]
+//
+// One row per record, ordered by time: time_ms,frame,turn,event,subject,result,value0,value1,value2.
+// The turn column is filled in from TurnStarted records; the value columns mean what ETBTelemetryEvent documents.
+UCLASS()
+class DENEME_API UTBTelemetryCsvCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTBTelemetryCsvCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -4,6 +4,8 @@
 #include "Kismet/GameplayStatics.h"
 #include "TBPlayerController.h"
 #include "UnitCharacter.h"
+#include "TurnStatsComponent.h"
+#include "TimerManager.h"
 
 void UTurnHudWidget::NativeConstruct()
 {
@@ -33,11 +35,7 @@ void UTurnHudWidget::NativeConstruct()
 void UTurnHudWidget::SetTargetUnit(AUnitCharacter* Unit)
 {
     // Unbind previous
-    if (BoundUnit)
-    {
-        BoundUnit->OnHPChanged.RemoveAll(this);
-        BoundUnit->OnDied.RemoveAll(this);
-    }
+    UnbindUnit();
 
     BoundUnit = Unit;
 
@@ -45,9 +43,32 @@ void UTurnHudWidget::SetTargetUnit(AUnitCharacter* Unit)
     {
         BoundUnit->OnHPChanged.AddDynamic(this, &UTurnHudWidget::OnUnitHPChanged);
         BoundUnit->OnDied.AddDynamic(this, &UTurnHudWidget::OnUnitDied);
+        if (BoundUnit->TurnStats)
+        {
+            BoundUnit->TurnStats->OnStatsChanged.AddDynamic(this, &UTurnHudWidget::OnUnitStatsChanged);
+        }
     }
 
-    RefreshAllStats();
+    MarkDirty(Field_All);
+}
+
+void UTurnHudWidget::UnbindUnit()
+{
+    if (!BoundUnit) return;
+
+    BoundUnit->OnHPChanged.RemoveAll(this);
+    BoundUnit->OnDied.RemoveAll(this);
+    if (BoundUnit->TurnStats)
+    {
+        BoundUnit->TurnStats->OnStatsChanged.RemoveAll(this);
+    }
+    BoundUnit = nullptr;
+}
+
+void UTurnHudWidget::NativeDestruct()
+{
+    UnbindUnit();
+    Super::NativeDestruct();
 }
 
 void UTurnHudWidget::HandleEndTurnClicked()
@@ -92,47 +113,96 @@ void UTurnHudWidget::HandleCastBoulderClicked()
 
 void UTurnHudWidget::OnUnitHPChanged(int32 NewHP)
 {
-    if (UnitHPText)
-    {
-        UnitHPText->SetText(FText::FromString(FString::Printf(TEXT("HP: %d/%d"), NewHP, BoundUnit ? BoundUnit->MaxHP : 0)));
-    }
+    MarkDirty(Field_HP);
 }
 
 void UTurnHudWidget::OnUnitDied()
 {
-    // Clear display for the dead unit
-    RefreshAllStats();
+    // Clear display for the dead unit (it is destroyed right after this broadcast)
+    UnbindUnit();
+    MarkDirty(Field_All);
 }
 
 void UTurnHudWidget::OnUnitStatsChanged()
 {
-    RefreshAllStats();
+    // AP and the committed tile (MP is spent on confirm) both feed ability availability
+    MarkDirty(Field_MP | Field_AP | Field_Abilities);
 }
 
 void UTurnHudWidget::RefreshAllStats()
 {
-    if (!BoundUnit)
+    MarkDirty(Field_All);
+}
+
+void UTurnHudWidget::MarkDirty(uint8 Fields)
+{
+    DirtyFields |= Fields;
+    if (bFlushScheduled) return;
+
+    UWorld* World = GetWorld();
+    if (!World)
     {
-        if (UnitHPText) UnitHPText->SetText(FText::FromString("HP: -"));
-        if (UnitMPText) UnitMPText->SetText(FText::FromString("MP: -"));
-        if (UnitAPText) UnitAPText->SetText(FText::FromString("AP: -"));
+        FlushDirtyFields();
         return;
     }
 
-    if (UnitHPText) UnitHPText->SetText(FText::FromString(FString::Printf(TEXT("HP: %d/%d"), BoundUnit->HP, BoundUnit->MaxHP)));
-    if (UnitMPText)
+    // Coalesce every change made this frame into one flush
+    bFlushScheduled = true;
+    World->GetTimerManager().SetTimerForNextTick(this, &UTurnHudWidget::FlushDirtyFields);
+}
+
+void UTurnHudWidget::FlushDirtyFields()
+{
+    bFlushScheduled = false;
+    const uint8 Fields = DirtyFields;
+    DirtyFields = 0;
+
+    const UTurnStatsComponent* Stats = BoundUnit ? BoundUnit->TurnStats : nullptr;
+    if (Fields & Field_HP)
     {
-        if (BoundUnit->TurnStats)
-            UnitMPText->SetText(FText::FromString(FString::Printf(TEXT("MP: %d/%d"), BoundUnit->TurnStats->MovementPoints, BoundUnit->TurnStats->MaxMovementPoints)));
-        else
-            UnitMPText->SetText(FText::FromString("MP: -"));
+        UpdateStatText(UnitHPText, TEXT("HP"), BoundUnit != nullptr, BoundUnit ? BoundUnit->HP : 0, BoundUnit ? BoundUnit->GetMaxHP() : 0, CachedHP);
     }
-    if (UnitAPText)
+    if (Fields & Field_MP)
     {
-        if (BoundUnit->TurnStats)
-            UnitAPText->SetText(FText::FromString(FString::Printf(TEXT("AP: %d/%d"), BoundUnit->TurnStats->ActionPoints, BoundUnit->TurnStats->MaxActionPoints)));
-        else
-            UnitAPText->SetText(FText::FromString("AP: -"));
+        UpdateStatText(UnitMPText, TEXT("MP"), Stats != nullptr, Stats ? Stats->MovementPoints : 0, Stats ? Stats->GetMaxMovementPoints() : 0, CachedMP);
+    }
+    if (Fields & Field_AP)
+    {
+        UpdateStatText(UnitAPText, TEXT("AP"), Stats != nullptr, Stats ? Stats->ActionPoints : 0, Stats ? Stats->GetMaxActionPoints() : 0, CachedAP);
+    }
+    if (Fields & Field_Abilities)
+    {
+        UpdateAbilityButtons();
+    }
+}
+
+void UTurnHudWidget::UpdateAbilityButtons()
+{
+    const TArray<FAbilityEvaluation>* Abilities = BoundUnit ? &BoundUnit->EvaluateAbilities() : nullptr;
+    if (CastMagicArrowButton)
+    {
+        CastMagicArrowButton->SetIsEnabled(Abilities && (*Abilities)[0].CanCast());
+    }
+    if (CastBoulderButton)
+    {
+        CastBoulderButton->SetIsEnabled(Abilities && (*Abilities)[1].CanCast());
     }
 }
 
+void UTurnHudWidget::UpdateStatText(UTextBlock* Text, const TCHAR* Label, bool bHasValue, int32 Value, int32 Max, FIntPoint& Cached)
+{
+    if (!Text) return;
+
+    const FIntPoint Shown = bHasValue ? FIntPoint(Value, Max) : FIntPoint(Placeholder, 0);
+    if (Shown == Cached) return;
+    Cached = Shown;
+
+    if (bHasValue)
+    {
+        Text->SetText(FText::FromString(FString::Printf(TEXT("%s: %d/%d"), Label, Value, Max)));
+    }
+    else
+    {
+        Text->SetText(FText::FromString(FString::Printf(TEXT("%s: -"), Label)));
+    }
+}
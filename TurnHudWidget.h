@@ -49,7 +49,7 @@ public:
     UFUNCTION(BlueprintCallable, Category = "UI")
     void SetTargetUnit(AUnitCharacter* Unit);
 
-    // Refresh (public helper)
+    // Mark every stat field dirty; the text is rebuilt at most once per frame and only for values that changed
     UFUNCTION(BlueprintCallable, Category = "UI")
     void RefreshAllStats();
 
@@ -77,5 +77,43 @@ protected:
 
     UFUNCTION()
     void OnUnitStatsChanged();
+
+    virtual void NativeDestruct() override;
+
+private:
+    // Stat fields that need their text rebuilt
+    enum EStatField : uint8
+    {
+        Field_HP = 1 << 0,
+        Field_MP = 1 << 1,
+        Field_AP = 1 << 2,
+        Field_Abilities = 1 << 3,
+        Field_All = Field_HP | Field_MP | Field_AP | Field_Abilities
+    };
+
+    void MarkDirty(uint8 Fields);
+
+    // Rebuild text for dirty fields (runs once, on the tick after the first change of a frame)
+    void FlushDirtyFields();
+
+    void UnbindUnit();
+
+    // Enable each cast button only when the bound unit's EvaluateAbilities says it can cast
+    void UpdateAbilityButtons();
+
+    // Sets "<Label>: Value/Max" (or "<Label>: -" when bHasValue is false) only if the shown numbers changed
+    static void UpdateStatText(UTextBlock* Text, const TCHAR* Label, bool bHasValue, int32 Value, int32 Max, FIntPoint& Cached);
+
+    // Cached value meaning "nothing written yet" / "showing the '-' placeholder"
+    static constexpr int32 NotWritten = MIN_int32;
+    static constexpr int32 Placeholder = MIN_int32 + 1;
+
+    uint8 DirtyFields = 0;
+    bool bFlushScheduled = false;
+
+    // Last (Value, Max) written to each text block
+    FIntPoint CachedHP = FIntPoint(NotWritten, 0);
+    FIntPoint CachedMP = FIntPoint(NotWritten, 0);
+    FIntPoint CachedAP = FIntPoint(NotWritten, 0);
 };
 
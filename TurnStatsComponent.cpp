@@ -1,33 +1,144 @@
 #include "TurnStatsComponent.h"
+#include "GameplayEventBus.h"
+#include "TBStateHash.h"
+#include "TBTelemetry.h"
+#include "UnitCharacter.h"
 
 UTurnStatsComponent::UTurnStatsComponent()
 {
     PrimaryComponentTick.bCanEverTick = false;
 }
 
+void UTurnStatsComponent::NotifyStatChanged(EGameplayEventType Type, int32 OldValue, int32 NewValue)
+{
+    // Coalesced by the event bus (which then fires OnStatsChanged once per frame); immediate if there is none
+    if (!UGameplayEventBus::Post(this, Type, this, OldValue, NewValue))
+    {
+        OnStatsChanged.Broadcast();
+    }
+}
+
+void UTurnStatsComponent::NotifyStateHashChanged(ETBStateField Field, int32 OldValue, int32 NewValue)
+{
+    if (AUnitCharacter* Unit = Cast<AUnitCharacter>(GetOwner()))
+    {
+        Unit->NotifyStateHashChanged(Field, OldValue, NewValue);
+    }
+}
+
+int32 UTurnStatsComponent::GetOwnerUnitId() const
+{
+    const AUnitCharacter* Unit = Cast<AUnitCharacter>(GetOwner());
+    return Unit ? Unit->UnitId : INDEX_NONE;
+}
+
 bool UTurnStatsComponent::SpendMovement(int32 Cost)
 {
-    if (Cost < 0) return false;
-    if (MovementPoints < Cost) return false;
+    if (Cost < 0 || MovementPoints < Cost)
+    {
+        FTBTelemetry::Record(ETBTelemetryEvent::MovementSpent, GetOwnerUnitId(), Cost, MovementPoints, 0, 0);
+        return false;
+    }
     
     MovementPoints -= Cost;
-    OnStatsChanged.Broadcast();
+    FTBTelemetry::Record(ETBTelemetryEvent::MovementSpent, GetOwnerUnitId(), Cost, MovementPoints, 0, 1);
+    NotifyStateHashChanged(ETBStateField::MovementPoints, MovementPoints + Cost, MovementPoints);
+    NotifyStatChanged(EGameplayEventType::MovementPointsChanged, MovementPoints + Cost, MovementPoints);
     return true;
 }
 
+void UTurnStatsComponent::RefundMovement(int32 Amount)
+{
+    if (Amount <= 0) return;
+    
+    MovementPoints += Amount;
+    // A negative spend, so a replay of the telemetry stream nets out
+    FTBTelemetry::Record(ETBTelemetryEvent::MovementSpent, GetOwnerUnitId(), -Amount, MovementPoints, 0, 1);
+    NotifyStateHashChanged(ETBStateField::MovementPoints, MovementPoints - Amount, MovementPoints);
+    NotifyStatChanged(EGameplayEventType::MovementPointsChanged, MovementPoints - Amount, MovementPoints);
+}
+
 bool UTurnStatsComponent::SpendAction(int32 Cost)
 {
-    if (Cost < 0) return false;
-    if (ActionPoints < Cost) return false;
+    if (Cost < 0 || ActionPoints < Cost)
+    {
+        FTBTelemetry::Record(ETBTelemetryEvent::ActionSpent, GetOwnerUnitId(), Cost, ActionPoints, 0, 0);
+        return false;
+    }
     
     ActionPoints -= Cost;
-    OnStatsChanged.Broadcast();
+    FTBTelemetry::Record(ETBTelemetryEvent::ActionSpent, GetOwnerUnitId(), Cost, ActionPoints, 0, 1);
+    NotifyStateHashChanged(ETBStateField::ActionPoints, ActionPoints + Cost, ActionPoints);
+    NotifyStatChanged(EGameplayEventType::ActionPointsChanged, ActionPoints + Cost, ActionPoints);
     return true;
 }
 
 void UTurnStatsComponent::ResetForNewTurn()
 {
-    MovementPoints = MaxMovementPoints;
-    ActionPoints = MaxActionPoints;
-    OnStatsChanged.Broadcast();
+    if (const uint32 ChangedStats = Modifiers.ExpireTurn())
+    {
+        NotifyModifiersChanged(ChangedStats);
+    }
+
+    const int32 OldMovementPoints = MovementPoints;
+    const int32 OldActionPoints = ActionPoints;
+    MovementPoints = GetMaxMovementPoints();
+    NotifyStateHashChanged(ETBStateField::MovementPoints, OldMovementPoints, MovementPoints);
+    ActionPoints = GetMaxActionPoints();
+    NotifyStateHashChanged(ETBStateField::ActionPoints, OldActionPoints, ActionPoints);
+    NotifyStatChanged(EGameplayEventType::MovementPointsChanged, OldMovementPoints, MovementPoints);
+    NotifyStatChanged(EGameplayEventType::ActionPointsChanged, OldActionPoints, ActionPoints);
+}
+
+int32 UTurnStatsComponent::AddModifier(const FTBStatModifier& Modifier)
+{
+    const int32 Handle = Modifiers.Add(Modifier);
+    if (Handle == INDEX_NONE) return INDEX_NONE;
+    NotifyModifiersChanged(1u << (uint32)Modifier.Stat);
+    return Handle;
+}
+
+bool UTurnStatsComponent::RemoveModifier(int32 Handle)
+{
+    const FTBStatModifier* Modifier = Modifiers.GetModifiers().FindByPredicate([Handle](const FTBStatModifier& Existing) { return Existing.Handle == Handle; });
+    if (!Modifier) return false;
+
+    const ETBStat Stat = Modifier->Stat;
+    Modifiers.Remove(Handle);
+    NotifyModifiersChanged(1u << (uint32)Stat);
+    return true;
+}
+
+int32 UTurnStatsComponent::RemoveModifiersFromSource(FName Source)
+{
+    uint32 ChangedStats = 0;
+    for (const FTBStatModifier& Modifier : Modifiers.GetModifiers())
+    {
+        if (Modifier.Source == Source) ChangedStats |= 1u << (uint32)Modifier.Stat;
+    }
+    const int32 Removed = Modifiers.RemoveBySource(Source);
+    if (Removed) NotifyModifiersChanged(ChangedStats);
+    return Removed;
+}
+
+FTBStatModifierStack UTurnStatsComponent::TakeModifiers()
+{
+    // Leaves an empty stack with clean sums behind
+    FTBStatModifierStack Taken;
+    Swap(Taken, Modifiers);
+    return Taken;
+}
+
+void UTurnStatsComponent::NotifyModifiersChanged(uint32 ChangedStats)
+{
+    // Current MP/AP stay as they are until the next reset, so only this event tells the HUD that maximums
+    // and ability stats moved (the bus refreshes the HP display too when MaxHP is in the mask)
+    if (!UGameplayEventBus::Post(this, EGameplayEventType::ModifiersChanged, this, 0, (int32)ChangedStats))
+    {
+        OnStatsChanged.Broadcast();
+    }
+    if (AUnitCharacter* Unit = Cast<AUnitCharacter>(GetOwner()))
+    {
+        Unit->HandleModifiersChanged(ChangedStats);
+    }
 }
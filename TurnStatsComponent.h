@@ -2,8 +2,12 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "TBStatModifiers.h"
 #include "TurnStatsComponent.generated.h"
 
+enum class EGameplayEventType : uint8;
+enum class ETBStateField : uint8;
+
 // Delegate for when MP/AP changes (for UI updates)
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnStatsChanged);
 
@@ -33,15 +37,62 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Turn Stats")
     bool SpendMovement(int32 Cost);
     
+    // Give back movement points spent on a move that was reverted
+    UFUNCTION(BlueprintCallable, Category = "Turn Stats")
+    void RefundMovement(int32 Amount);
+    
     // Spend action points (returns true if successful)
     UFUNCTION(BlueprintCallable, Category = "Turn Stats")
     bool SpendAction(int32 Cost);
     
-    // Reset stats for a new turn
+    // Reset stats for a new turn (timed modifiers count down first, so MP/AP refill to the new maximums)
     UFUNCTION(BlueprintCallable, Category = "Turn Stats")
     void ResetForNewTurn();
+
+    // Maximums with modifiers applied
+    UFUNCTION(BlueprintPure, Category = "Turn Stats")
+    int32 GetMaxMovementPoints() const { return Modifiers.GetEffective(ETBStat::MaxMovementPoints, MaxMovementPoints); }
+
+    UFUNCTION(BlueprintPure, Category = "Turn Stats")
+    int32 GetMaxActionPoints() const { return Modifiers.GetEffective(ETBStat::MaxActionPoints, MaxActionPoints); }
+
+    // Buffs, debuffs and equipment of the owning unit (its MaxHP and ability stats included). Returns a handle.
+    UFUNCTION(BlueprintCallable, Category = "Modifiers")
+    int32 AddModifier(const FTBStatModifier& Modifier);
+
+    UFUNCTION(BlueprintCallable, Category = "Modifiers")
+    bool RemoveModifier(int32 Handle);
+
+    // Remove everything one item or effect added; returns how many modifiers went
+    UFUNCTION(BlueprintCallable, Category = "Modifiers")
+    int32 RemoveModifiersFromSource(FName Source);
+
+    // Base with the modifiers of Stat applied; ability stats need the ability's slot
+    int32 GetEffectiveStat(ETBStat Stat, int32 Base, int32 AbilitySlot = INDEX_NONE) const { return Modifiers.GetEffective(Stat, Base, AbilitySlot); }
+
+    const FTBStatModifierStack& GetModifiers() const { return Modifiers; }
+
+    // Swap the whole stack in or out without notifying, handles and turn counts included. An entity proxy takes its
+    // entity's stack when bound and hands it back to the entity store when released.
+    void SetModifiers(FTBStatModifierStack&& InModifiers) { Modifiers = MoveTemp(InModifiers); }
+    FTBStatModifierStack TakeModifiers();
     
-    // Event broadcast when stats change
+    // Event broadcast when stats change (at most once per frame when a UGameplayEventBus is present)
     UPROPERTY(BlueprintAssignable, Category = "Turn Stats")
     FOnStatsChanged OnStatsChanged;
+
+private:
+    UPROPERTY(VisibleAnywhere, Category = "Modifiers")
+    FTBStatModifierStack Modifiers;
+
+    // Tell the HUD and the owning unit about changed maximums (mask of 1 << ETBStat)
+    void NotifyModifiersChanged(uint32 ChangedStats);
+
+    // UnitId of the owning unit for telemetry, or INDEX_NONE
+    int32 GetOwnerUnitId() const;
+
+    void NotifyStatChanged(EGameplayEventType Type, int32 OldValue, int32 NewValue);
+
+    // Forward a stat change to the owning unit's state hash
+    void NotifyStateHashChanged(ETBStateField Field, int32 OldValue, int32 NewValue);
 };
@@ -1,10 +1,165 @@
 #include "UnitCharacter.h"
 #include "TurnStatsComponent.h"
 #include "AGridTile.h"
+#include "AGridManager.h"
+#include "UnitEntityManager.h"
+#include "TBAbilityEffects.h"
+#include "GameplayEventBus.h"
+#include "UnitMovementSubsystem.h"
+#include "TBBoardSubsystem.h"
+#include "TBMemoryTracker.h"
+#include "TBStateHash.h"
+#include "TBTelemetry.h"
 #include "Components/SceneComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Particles/ParticleSystem.h"
 
+namespace
+{
+    // Tile index on its grid, for telemetry records
+    int32 GetTelemetryTileIndex(const AGridTile* Tile)
+    {
+        const AGridManager* Grid = Tile ? Tile->GetGridManager() : nullptr;
+        return Grid ? Tile->Y * Grid->GridWidth + Tile->X : INDEX_NONE;
+    }
+
+    // ExecuteEffect state over the units of one grid: actors, and the data-only entities of its entity managers
+    // (which have no actor to cast to). Unit handles index Units.
+    struct FActorEffectState
+    {
+        struct FUnit
+        {
+            AUnitCharacter* Actor = nullptr;
+            AUnitEntityManager* Manager = nullptr;
+            int32 EntityId = INDEX_NONE;
+
+            bool operator==(const FUnit& Other) const { return Actor == Other.Actor && Manager == Other.Manager && EntityId == Other.EntityId; }
+        };
+
+        AGridManager* Grid;
+        TArray<FUnit, TInlineAllocator<16>> Units;
+        const TArray<AUnitEntityManager*>& Managers;
+
+        explicit FActorEffectState(AGridManager* InGrid) : Grid(InGrid), Managers(InGrid->GetEntityManagers())
+        {
+        }
+
+        int32 GetWidth() const { return Grid->GridWidth; }
+        int32 GetHeight() const { return Grid->GridHeight; }
+
+        int32 GetUnitAt(int32 TileIndex)
+        {
+            FUnit Unit;
+            const AGridTile* Tile = Grid->GetTileByIndex(TileIndex);
+            Unit.Actor = Tile ? Cast<AUnitCharacter>(Tile->Occupant) : nullptr;
+            if (!Unit.Actor)
+            {
+                for (AUnitEntityManager* Manager : Managers)
+                {
+                    Unit.EntityId = Manager->GetEntityAt(TileIndex);
+                    if (Unit.EntityId != INDEX_NONE)
+                    {
+                        Unit.Manager = Manager;
+                        break;
+                    }
+                }
+                if (!Unit.Manager) return INDEX_NONE;
+            }
+            return Units.AddUnique(Unit);
+        }
+
+        const FUnitEntityStore& GetStore(int32 Unit) const { return Units[Unit].Manager->GetStore(); }
+
+        bool IsAlive(int32 Unit) const
+        {
+            const FUnit& Entry = Units[Unit];
+            if (Entry.Manager) return GetStore(Unit).IsAlive(Entry.EntityId) && !GetStore(Unit).IsProxied(Entry.EntityId);
+            return IsValid(Entry.Actor) && Entry.Actor->HP > 0 && Entry.Actor->CurrentTile;
+        }
+
+        int32 GetTeam(int32 Unit) const
+        {
+            return Units[Unit].Manager ? GetStore(Unit).TeamId[Units[Unit].EntityId] : Units[Unit].Actor->TeamId;
+        }
+
+        int32 GetTile(int32 Unit) const
+        {
+            return Units[Unit].Manager ? GetStore(Unit).TileIndex[Units[Unit].EntityId] : GetTelemetryTileIndex(Units[Unit].Actor->CurrentTile);
+        }
+
+        int32 GetStat(int32 Unit, ETBEffectStat Stat) const
+        {
+            if (Units[Unit].Manager)
+            {
+                const FUnitEntityStore& Store = GetStore(Unit);
+                const int32 EntityId = Units[Unit].EntityId;
+                switch (Stat)
+                {
+                case ETBEffectStat::HPPercent: return Store.HP[EntityId] * 100 / FMath::Max(1, Store.GetArchetype(EntityId).MaxHP);
+                case ETBEffectStat::ActionPoints: return Store.ActionPoints[EntityId];
+                case ETBEffectStat::MovementPoints: return Store.MovementPoints[EntityId];
+                default: return Store.HP[EntityId];
+                }
+            }
+
+            const AUnitCharacter* Character = Units[Unit].Actor;
+            switch (Stat)
+            {
+            case ETBEffectStat::HPPercent: return Character->HP * 100 / FMath::Max(1, Character->GetMaxHP());
+            case ETBEffectStat::ActionPoints: return Character->TurnStats ? Character->TurnStats->ActionPoints : 0;
+            case ETBEffectStat::MovementPoints: return Character->TurnStats ? Character->TurnStats->MovementPoints : 0;
+            default: return Character->HP;
+            }
+        }
+
+        // The tile the unit stands on, as the plain single-target roll always used
+        int32 GetRollId(int32 Unit) const { return GetTile(Unit); }
+
+        void ApplyDamage(int32 Unit, int32 Amount, bool bMagical)
+        {
+            const FUnit& Entry = Units[Unit];
+            if (Entry.Manager) Entry.Manager->ApplyDamage(Entry.EntityId, Amount, bMagical);
+            else Entry.Actor->ReceiveDamage(Amount, bMagical);
+        }
+
+        int32 ApplyHeal(int32 Unit, int32 Amount)
+        {
+            const FUnit& Entry = Units[Unit];
+            return Entry.Manager ? Entry.Manager->ApplyHealing(Entry.EntityId, Amount) : Entry.Actor->ReceiveHealing(Amount);
+        }
+
+        bool CanPushInto(int32 TileIndex) const
+        {
+            AGridTile* Tile = Grid->GetTileByIndex(TileIndex);
+            return Tile && Grid->GetPathfinder().GetTileCost(TileIndex) >= 0 && !Tile->Occupant && !Grid->IsTileOccupied(Tile);
+        }
+
+        void MoveUnit(int32 Unit, int32 TileIndex)
+        {
+            const FUnit& Entry = Units[Unit];
+            if (Entry.Manager) Entry.Manager->CommitMove(Entry.EntityId, Grid->GetTileByIndex(TileIndex));
+            else Entry.Actor->ForceMoveToTile(Grid->GetTileByIndex(TileIndex));
+        }
+    };
+}
+
+bool FAbilityData::CompileEffect()
+{
+    FString Error;
+    EffectProgram = FTBEffectProgram::Compile(Effect, &Error);
+    if (!EffectProgram)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Ability %s: effect does not compile, falling back to plain damage: %s"), *AbilityName.ToString(), *Error);
+        return false;
+    }
+    return true;
+}
+
+const FTBEffectProgram& FAbilityData::GetEffectProgram() const
+{
+    return EffectProgram ? *EffectProgram : FTBEffectProgram::GetDefault();
+}
+
 AUnitCharacter::AUnitCharacter()
 {
     PrimaryActorTick.bCanEverTick = false;
@@ -37,27 +192,114 @@ AUnitCharacter::AUnitCharacter()
 void AUnitCharacter::BeginPlay()
 {
     Super::BeginPlay();
+    MagicArrow.CompileEffect();
+    Boulder.CompileEffect();
+
     if (CurrentTile)
     {
         // Ensure occupant set if not already (committed state)
-        CurrentTile->Occupant = this;
+        CurrentTile->SetOccupant(this);
         SnapToTileVisual(CurrentTile);
+
+        if (AGridManager* Grid = GetGridManager())
+        {
+            Grid->UpdateUnitVisibility(this);
+        }
+
+        // Dormant pooled proxies have no tile and register when bound
+        if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+        {
+            Board->RegisterUnit(this);
+        }
     }
 }
 
+void AUnitCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->UnregisterUnit(this);
+    }
+    Super::EndPlay(EndPlayReason);
+}
+
+AGridManager* AUnitCharacter::GetGridManager() const
+{
+    return CurrentTile ? CurrentTile->GetGridManager() : nullptr;
+}
+
 void AUnitCharacter::SnapToTileVisual(AGridTile* Tile)
 {
     if (!Tile) return;
+    if (UUnitMovementSubsystem* Movement = UUnitMovementSubsystem::Get(this))
+    {
+        if (Movement->IsMovingTo(this, Tile->GetTileCenter())) return;
+        Movement->StopMove(this);
+    }
     SetActorLocation(Tile->GetTileCenter());
 }
 
+void AUnitCharacter::MoveAlongPathVisual(const AGridManager* Grid, const FGridPath& Path)
+{
+    if (!Grid || Path.Num() == 0) return;
+
+    UUnitMovementSubsystem* Movement = bAnimateMovement ? UUnitMovementSubsystem::Get(this) : nullptr;
+    if (Movement && Path.IsMove())
+    {
+        TArray<FVector, TInlineAllocator<32>> Points;
+        Points.Reserve(Path.Num());
+        // From coordinates, so a path through chunks that are not streamed in still animates
+        Path.ForEachTile([Grid, &Points](int32 Index)
+        {
+            Points.Add(Grid->GetTileLocation(Index % Grid->GridWidth, Index / Grid->GridWidth));
+        });
+        Movement->StartMoveAlongPoints(this, Points);
+    }
+    else
+    {
+        SnapToTileVisual(Grid->GetTileByIndex(Path.GetGoal()));
+    }
+}
+
 bool AUnitCharacter::RequestPreviewMove(const TArray<AGridTile*>& Path)
 {
     if (Path.Num() < 2) return false; // 0 or 1 means no movement
+    AGridManager* Grid = Path[0] ? Path[0]->GetGridManager() : nullptr;
+    if (!Grid) return false;
+
+    // Edge weights of the grid's connectivity (diagonal and hex steps included), in the pathfinder's cost scale
+    const FGridPathfinder& Pathfinder = Grid->GetPathfinder();
+    FGridPath GridPath;
+    GridPath.CostScale = Pathfinder.GetCostScale();
+    GridPath.Steps.Reserve(Path.Num());
+    int32 Cost = 0;
+    for (const AGridTile* Tile : Path)
+    {
+        if (!Tile || Tile->GetGridManager() != Grid) return false;
+        const int32 TileIndex = Tile->Y * Grid->GridWidth + Tile->X;
+        if (GridPath.Num())
+        {
+            int32 StepCost = INDEX_NONE;
+            Pathfinder.ForEachWalkableEdge(GridPath.Steps.Last().TileIndex, [TileIndex, &StepCost](int32 Neighbor, int32 Weight)
+            {
+                if (Neighbor == TileIndex) StepCost = Weight;
+            });
+            if (StepCost == INDEX_NONE) return false;
+            Cost += StepCost;
+        }
+        GridPath.Steps.Add({ TileIndex, Cost });
+    }
+    return RequestPreviewMove(MoveTemp(GridPath));
+}
+
+bool AUnitCharacter::RequestPreviewMove(FGridPath&& Path)
+{
+    if (!Path.IsMove()) return false; // 0 or 1 tiles means no movement
     if (!TurnStats) return false;
 
-    // Compute cost (1 per step)
-    int32 Cost = Path.Num() - 1;
+    AGridTile* Start = CurrentTile ? CurrentTile : OriginalTile;
+    AGridManager* Grid = Start ? Start->GetGridManager() : nullptr;
+    if (!Grid || !Grid->GetTileByIndex(Path.GetGoal())) return false;
 
     // Save original location/tile for cancellation
     if (!bIsPreviewing)
@@ -66,14 +308,16 @@ bool AUnitCharacter::RequestPreviewMove(const TArray<AGridTile*>& Path)
         OriginalTile = CurrentTile;
     }
 
-    // Record preview path/cost
-    PreviewPath = Path;
-    PreviewCost = Cost;
+    // Record preview path/cost; the path keeps the step costs the search accumulated
+    // Swapped rather than moved, so the caller's buffer gets the previous preview's storage back
+    PreviewCost = Path.GetMovementCost();
+    Swap(PreviewPath, Path);
+    Path.Reset();
+    PreviewGrid = Grid;
     bIsPreviewing = true;
 
-    // Snap visually to final tile center (do NOT change CurrentTile or Occupant)
-    AGridTile* Dest = PreviewPath.Last();
-    SnapToTileVisual(Dest);
+    // Move visually to final tile center (do NOT change CurrentTile or Occupant)
+    MoveAlongPathVisual(PreviewGrid, PreviewPath);
 
     // Mark as not confirmed until confirmed by the player (UI/Confirm button)
     if (TurnStats)
@@ -98,23 +342,37 @@ void AUnitCharacter::CancelPreviewMove()
         SetActorLocation(OriginalLocation);
     }
 
-    PreviewPath.Empty();
+    PreviewPath.Reset();
+    PreviewGrid = nullptr;
     PreviewCost = 0;
     bIsPreviewing = false;
 
     // notify UI if needed (no MP change on cancel)
 }
 
+void AUnitCharacter::RefreshPreviewMove()
+{
+    if (!bIsPreviewing || !PreviewGrid) return;
+
+    const AGridTile* Start = CurrentTile ? CurrentTile : OriginalTile;
+    const AGridTile* Goal = PreviewGrid->GetTileByIndex(PreviewPath.GetGoal());
+    FGridPath Path;
+    if (!Start || !Goal || !PreviewGrid->FindGridPath(Start, Goal, Path) || !RequestPreviewMove(MoveTemp(Path)))
+    {
+        CancelPreviewMove();
+    }
+}
+
 void AUnitCharacter::ConfirmPlacement()
 {
-    if (!bIsPreviewing || PreviewPath.Num() < 2)
+    if (!bIsPreviewing || !PreviewPath.IsMove() || !PreviewGrid)
     {
         // Nothing to confirm (still at committed tile)
         return;
     }
 
     // Check cost and spend MP
-    if (!TurnStats)
+    if (!TurnStats || !PreviewGrid->GetTileByIndex(PreviewPath.GetGoal()))
     {
         CancelPreviewMove();
         return;
@@ -128,17 +386,20 @@ void AUnitCharacter::ConfirmPlacement()
     }
 
     // Commit occupancy change: clear old tile occupant and set new occupant
-    AGridTile* Dest = PreviewPath.Last();
+    AGridTile* Dest = PreviewGrid->GetTileByIndex(PreviewPath.GetGoal());
     if (CurrentTile && CurrentTile->Occupant == this)
     {
-        CurrentTile->Occupant = nullptr;
+        CurrentTile->SetOccupant(nullptr);
     }
 
     // If destination is occupied by someone else unexpectedly, fail and revert
-    if (Dest->Occupant && Dest->Occupant != this)
+    // (data-only entities occupy tiles without setting Occupant, so ask the grid too)
+    AGridManager* DestGrid = Dest->GetGridManager();
+    const bool bDestBlocked = Dest->Occupant ? Dest->Occupant != this : (DestGrid && DestGrid->IsTileOccupied(Dest));
+    if (bDestBlocked)
     {
         // revert and refund the spent MP
-        TurnStats->MovementPoints += PreviewCost;
+        TurnStats->RefundMovement(PreviewCost);
         CancelPreviewMove();
         return;
     }
@@ -146,11 +407,13 @@ void AUnitCharacter::ConfirmPlacement()
     CommitToTile(Dest);
 
     // Clear preview state
-    PreviewPath.Empty();
+    PreviewPath.Reset();
+    PreviewGrid = nullptr;
     PreviewCost = 0;
     bIsPreviewing = false;
 
     // notify UI about MP change (via TurnStats or events)
+    PushToEntity();
 }
 
 int32 AUnitCharacter::GetPreviewCost() const
@@ -158,87 +421,391 @@ int32 AUnitCharacter::GetPreviewCost() const
     return PreviewCost;
 }
 
+TArray<AGridTile*> AUnitCharacter::GetPreviewPathTiles() const
+{
+    TArray<AGridTile*> Tiles;
+    if (!bIsPreviewing || !PreviewGrid) return Tiles;
+
+    Tiles.Reserve(PreviewPath.Num());
+    PreviewPath.ForEachTile([this, &Tiles](int32 Index) { Tiles.Add(PreviewGrid->GetTileByIndex(Index)); });
+    return Tiles;
+}
+
+void AUnitCharacter::SetTeam(int32 NewTeamId)
+{
+    if (TeamId == NewTeamId) return;
+    TeamId = NewTeamId;
+
+    if (CurrentTile && CurrentTile->Occupant == this)
+    {
+        if (AGridManager* Grid = GetGridManager())
+        {
+            // Same occupant in and out: the state hash is unchanged, the team bitboards move
+            Grid->NotifyOccupantChanged(CurrentTile, this);
+            Grid->UpdateUnitVisibility(this);
+        }
+    }
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->UpdateUnitTeam(this);
+    }
+
+    PushToEntity();
+}
+
 void AUnitCharacter::CommitToTile(AGridTile* Tile)
 {
     if (!Tile) return;
     CurrentTile = Tile;
-    Tile->Occupant = this;
+    Tile->SetOccupant(this);
     SnapToTileVisual(Tile);
+
+    // Recompute this unit's field of view from the new tile
+    if (AGridManager* Grid = GetGridManager())
+    {
+        Grid->UpdateUnitVisibility(this);
+        Grid->ValidateStateHash(TEXT("CommitToTile"));
+    }
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->UpdateUnitTile(this);
+    }
+
+    PushToEntity();
 }
 
-bool AUnitCharacter::ApplyAbilityToTile(const FAbilityData& Ability, AGridTile* Tile)
+bool AUnitCharacter::ApplyAbilityToTile(const FAbilityData& Ability, AGridTile* Tile, int32* OutDamage)
 {
-    if (!Tile) return false;
-    AActor* Occ = Tile->Occupant;
-    if (!Occ) return false; // nothing to hit
+    AGridManager* Grid = Tile ? Tile->GetGridManager() : nullptr;
+    if (!Grid) return false;
+
+    FTBEffectContext Context;
+    Context.MatchSeed = (uint64)Grid->MatchSeed;
+    Context.Turn = Grid->TurnNumber;
+    Context.CasterId = UnitId != INDEX_NONE ? UnitId : (CurrentTile ? CurrentTile->Y * Grid->GridWidth + CurrentTile->X : 0);
+    Context.AbilityId = GetAbilitySlot(Ability);
+    // Casts made this turn before this one (the caller has already spent it), so repeated casts at the same target roll differently
+    Context.Sequence = FMath::Max(0, Ability.MaxCastsPerTurn - Ability.CastsRemaining - 1);
+    Context.CasterTeam = TeamId;
+    Context.CasterTile = GetTelemetryTileIndex(GetAbilityOrigin());
+    Context.TargetTile = Tile->Y * Grid->GridWidth + Tile->X;
+    GetAbilityDamage(Ability, Context.MinDamage, Context.MaxDamage);
+    Context.bMagical = Ability.bIsMagical;
+
+    // Counter-based rolls, so independent of call order
+    FActorEffectState State(Grid);
+    const FTBEffectResult Result = ExecuteEffect(Ability.GetEffectProgram(), State, Context);
+    if (OutDamage) *OutDamage = Result.TotalDamage;
+
+    return Result.NumHits > 0;
+}
 
-    // Look for AUnitCharacter on the occupant
-    AUnitCharacter* TargetUnit = Cast<AUnitCharacter>(Occ);
-    if (!TargetUnit) return false;
+FAbilityData* AUnitCharacter::FindAbility(FName AbilityName, int32* OutSlot)
+{
+    int32 Slot = INDEX_NONE;
+    if (AbilityName.IsNone() || AbilityName == MagicArrow.AbilityName || AbilityName == FName("MagicArrow"))
+    {
+        Slot = 0;
+    }
+    else if (AbilityName == Boulder.AbilityName || AbilityName == FName("Boulder"))
+    {
+        Slot = 1;
+    }
 
-    // Random damage in range
-    int32 Damage = FMath::RandRange(Ability.MinDamage, Ability.MaxDamage);
-    TargetUnit->ReceiveDamage(Damage, Ability.bIsMagical);
+    if (OutSlot) *OutSlot = Slot;
+    return Slot == 0 ? &MagicArrow : (Slot == 1 ? &Boulder : nullptr);
+}
 
-    return true;
+AGridTile* AUnitCharacter::GetAbilityOrigin() const
+{
+    if (CurrentTile) return CurrentTile;
+    return bIsPreviewing && PreviewGrid && PreviewPath.Num() ? PreviewGrid->GetTileByIndex(PreviewPath.GetGoal()) : nullptr;
+}
+
+EAbilityBlockReason AUnitCharacter::GetAbilityBlockReason(const FAbilityData& Ability) const
+{
+    if (Ability.CastsRemaining <= 0) return EAbilityBlockReason::NoCastsLeft;
+    if (!TurnStats || TurnStats->ActionPoints < GetAbilityAPCost(Ability)) return EAbilityBlockReason::NotEnoughAP;
+    if (!GetAbilityOrigin()) return EAbilityBlockReason::NoOrigin;
+    return EAbilityBlockReason::None;
 }
 
 bool AUnitCharacter::CastAbilityAtTile(FName AbilityName, AGridTile* TargetTile)
 {
-    if (!TurnStats) return false;
-    if (!TargetTile) return false;
+    int32 Slot = INDEX_NONE;
+    FAbilityData* Chosen = FindAbility(AbilityName, &Slot);
+    const int32 TargetIndex = GetTelemetryTileIndex(TargetTile);
+    auto RecordCast = [this, Slot, TargetIndex](ETBCastResult Result, int32 Damage)
+    {
+        FTBTelemetry::Record(ETBTelemetryEvent::AbilityCast, UnitId, Slot, TargetIndex, Damage, (uint8)Result);
+    };
 
-    // Find ability by name
-    FAbilityData* Chosen = nullptr;
-    if (AbilityName == MagicArrow.AbilityName || AbilityName.IsNone() || AbilityName == FName("MagicArrow"))
+    if (!TurnStats || !TargetTile || !Chosen)
     {
-        Chosen = &MagicArrow;
+        RecordCast(ETBCastResult::Blocked, 0);
+        return false;
     }
-    else if (AbilityName == Boulder.AbilityName || AbilityName == FName("Boulder"))
+
+    // Casts remaining, AP and a tile to cast from
+    if (GetAbilityBlockReason(*Chosen) != EAbilityBlockReason::None)
     {
-        Chosen = &Boulder;
+        RecordCast(ETBCastResult::Blocked, 0);
+        return false;
+    }
+
+    // Range check (Manhattan) relative to current committed tile (or preview dest if previewing)
+    AGridTile* OriginTile = GetAbilityOrigin();
+    const int32 Range = GetAbilityRange(*Chosen);
+
+    // Range + line of sight as a single test against the origin's cached view window
+    bool bHasTarget = true;
+    if (AGridManager* Grid = OriginTile->GetGridManager())
+    {
+        if (!Grid->HasLineOfSight(OriginTile, TargetTile, Range))
+        {
+            RecordCast(ETBCastResult::OutOfReach, 0);
+            return false;
+        }
+
+        // Occupancy bitboard tells us whether there is a unit to hit without touching the occupant
+        bHasTarget = (TargetTile != OriginTile || Chosen->bCanTargetSelf) && Grid->IsUnitTargetInRange(OriginTile, TargetTile, Range);
     }
     else
     {
-        if (AbilityName == FName("MagicArrow")) Chosen = &MagicArrow;
-        else if (AbilityName == FName("Boulder")) Chosen = &Boulder;
+        int32 Dist = FMath::Abs(OriginTile->X - TargetTile->X) + FMath::Abs(OriginTile->Y - TargetTile->Y);
+        if (Dist > Range)
+        {
+            RecordCast(ETBCastResult::OutOfReach, 0);
+            return false;
+        }
     }
 
-    if (!Chosen) return false;
+    // Consume AP and a cast first: an area effect that hits the caster can kill it, after which this
+    // unit is off the grid and its state must not change any more
+    TurnStats->SpendAction(GetAbilityAPCost(*Chosen));
+    const int32 OldCasts = Chosen->CastsRemaining;
+    Chosen->CastsRemaining = FMath::Max(0, Chosen->CastsRemaining - 1);
+    NotifyStateHashChanged(ETBStateField::CastsRemaining, TBStateHash::PackCasts(Slot, OldCasts), TBStateHash::PackCasts(Slot, Chosen->CastsRemaining));
+    PushToEntity();
+
+    // Apply effect (area effects may hit units around an empty target tile)
+    int32 Damage = 0;
+    const bool bAnyTargets = bHasTarget || !Chosen->GetEffectProgram().AffectsTargetTileOnly();
+    const bool bApplied = bAnyTargets && ApplyAbilityToTile(*Chosen, TargetTile, &Damage);
+    RecordCast(bApplied ? ETBCastResult::Hit : ETBCastResult::NoTarget, Damage);
+    return bApplied;
+}
 
-    // Check casts remaining
-    if (Chosen->CastsRemaining <= 0) return false;
+bool AUnitCharacter::FAbilityEvalKey::operator==(const FAbilityEvalKey& Other) const
+{
+    return Origin == Other.Origin && TargetingVersion == Other.TargetingVersion && ActionPoints == Other.ActionPoints
+        && FMemory::Memcmp(CastsRemaining, Other.CastsRemaining, sizeof(CastsRemaining)) == 0
+        && FMemory::Memcmp(APCost, Other.APCost, sizeof(APCost)) == 0
+        && FMemory::Memcmp(Range, Other.Range, sizeof(Range)) == 0;
+}
 
-    // Check AP
-    if (TurnStats->ActionPoints < Chosen->APCost) return false;
+AUnitCharacter::FAbilityEvalKey AUnitCharacter::MakeAbilityEvalKey() const
+{
+    FAbilityEvalKey Key;
+    Key.Origin = GetAbilityOrigin();
+    const AGridManager* Grid = Key.Origin ? Key.Origin->GetGridManager() : nullptr;
+    Key.TargetingVersion = Grid ? Grid->GetTargetingVersion() : 0;
+    Key.ActionPoints = TurnStats ? TurnStats->ActionPoints : 0;
+
+    const FAbilityData* Abilities[] = { &MagicArrow, &Boulder };
+    for (int32 Slot = 0; Slot < UE_ARRAY_COUNT(Abilities); ++Slot)
+    {
+        Key.CastsRemaining[Slot] = Abilities[Slot]->CastsRemaining;
+        Key.APCost[Slot] = GetAbilityAPCost(*Abilities[Slot]);
+        Key.Range[Slot] = GetAbilityRange(*Abilities[Slot]);
+    }
+    return Key;
+}
 
-    // Range check (Manhattan) relative to current committed tile (or preview dest if previewing)
-    AGridTile* OriginTile = CurrentTile;
-    if (!OriginTile && bIsPreviewing && PreviewPath.Num()) OriginTile = PreviewPath.Last();
-    if (!OriginTile) return false;
+const TArray<FAbilityEvaluation>& AUnitCharacter::EvaluateAbilities()
+{
+    const FAbilityEvalKey Key = MakeAbilityEvalKey();
+    if (bAbilityEvalValid && Key == AbilityEvalKey)
+    {
+        return AbilityEvaluations;
+    }
+    AbilityEvalKey = Key;
+    bAbilityEvalValid = true;
+    LLM_SCOPE_BYTAG(TB_Units);
 
-    int32 Dist = FMath::Abs(OriginTile->X - TargetTile->X) + FMath::Abs(OriginTile->Y - TargetTile->Y);
-    if (Dist > Chosen->Range) return false;
+    AGridTile* Origin = GetAbilityOrigin();
+    AGridManager* Grid = Origin ? Origin->GetGridManager() : nullptr;
 
-    // Apply effect (if something to hit)
-    bool bApplied = ApplyAbilityToTile(*Chosen, TargetTile);
+    const FAbilityData* Abilities[] = { &MagicArrow, &Boulder };
+    AbilityEvaluations.SetNum(UE_ARRAY_COUNT(Abilities));
+    for (int32 Slot = 0; Slot < UE_ARRAY_COUNT(Abilities); ++Slot)
+    {
+        const FAbilityData& Ability = *Abilities[Slot];
+        FAbilityEvaluation& Eval = AbilityEvaluations[Slot];
+        Eval.AbilityName = Ability.AbilityName;
+        Eval.BlockReason = GetAbilityBlockReason(Ability);
+        const int32 Range = Key.Range[Slot];
+
+        const bool bSharesFirstRange = Slot > 0 && AbilityEvaluations[0].CanCast() && Key.Range[0] == Range
+            && Abilities[0]->bCanTargetSelf == Ability.bCanTargetSelf;
+        if (!Eval.CanCast() || !Grid)
+        {
+            // Without a grid there is no tile index space; IsLegalAbilityTarget falls back to plain range
+            Eval.TargetTiles.Init(0);
+            Eval.UnitTiles.Init(0);
+        }
+        else if (bSharesFirstRange)
+        {
+            Eval.TargetTiles = AbilityEvaluations[0].TargetTiles;
+            Eval.UnitTiles = AbilityEvaluations[0].UnitTiles;
+        }
+        else
+        {
+            // Same tests as CastAbilityAtTile: one view window for range and sight, the unit bitboard for targets
+            // (which includes the caster itself)
+            Grid->GetVisibility().GetTilesInSight(Origin->X, Origin->Y, Range, Eval.TargetTiles);
+            Eval.UnitTiles.Init(Eval.TargetTiles.NumBits);
+            const int32 Width = Grid->GridWidth;
+            const int32 SelfIndex = Ability.bCanTargetSelf ? INDEX_NONE : Origin->Y * Width + Origin->X;
+            Grid->GetOccupancy().ForEachUnitInRange(Origin->X, Origin->Y, Range, TeamId, false, false, [&Eval, Width, SelfIndex](int32 X, int32 Y)
+            {
+                const int32 Index = Y * Width + X;
+                if (Index != SelfIndex && Eval.TargetTiles.Test(Index)) Eval.UnitTiles.Set(Index);
+            });
+        }
+
+        Eval.NumTargetTiles = Eval.TargetTiles.CountSetBits();
+        Eval.NumUnitTargets = Eval.UnitTiles.CountSetBits();
+    }
+    return AbilityEvaluations;
+}
 
-    // Consume AP and a cast
-    TurnStats->SpendAction(Chosen->APCost);
-    Chosen->CastsRemaining = FMath::Max(0, Chosen->CastsRemaining - 1);
+bool AUnitCharacter::CanCastAbility(FName AbilityName)
+{
+    int32 Slot = INDEX_NONE;
+    if (!FindAbility(AbilityName, &Slot)) return false;
+    return EvaluateAbilities()[Slot].CanCast();
+}
 
-    // Notify UI about AP/ability changes (delegate or TurnStats)
-    return bApplied;
+bool AUnitCharacter::IsLegalAbilityTarget(FName AbilityName, AGridTile* TargetTile)
+{
+    int32 Slot = INDEX_NONE;
+    const FAbilityData* Ability = FindAbility(AbilityName, &Slot);
+    if (!Ability || !TargetTile) return false;
+
+    const FAbilityEvaluation& Eval = EvaluateAbilities()[Slot];
+    if (!Eval.CanCast()) return false;
+
+    AGridTile* Origin = GetAbilityOrigin();
+    const AGridManager* Grid = Origin->GetGridManager();
+    if (!Grid)
+    {
+        return FMath::Abs(Origin->X - TargetTile->X) + FMath::Abs(Origin->Y - TargetTile->Y) <= GetAbilityRange(*Ability);
+    }
+    return Eval.TargetTiles.Test(TargetTile->Y * Grid->GridWidth + TargetTile->X);
+}
+
+TArray<AGridTile*> AUnitCharacter::GetAbilityTargetTiles(FName AbilityName, bool bUnitsOnly)
+{
+    TArray<AGridTile*> Result;
+    int32 Slot = INDEX_NONE;
+    if (!FindAbility(AbilityName, &Slot)) return Result;
+
+    const FAbilityEvaluation& Eval = EvaluateAbilities()[Slot];
+    const AGridManager* Grid = Eval.CanCast() ? GetAbilityOrigin()->GetGridManager() : nullptr;
+    if (!Grid) return Result;
+
+    const FGridBitset& Tiles = bUnitsOnly ? Eval.UnitTiles : Eval.TargetTiles;
+    Result.Reserve(bUnitsOnly ? Eval.NumUnitTargets : Eval.NumTargetTiles);
+    Tiles.ForEachSetBit([Grid, &Result](int32 Index)
+    {
+        if (AGridTile* Tile = Grid->GetTileAt(Index % Grid->GridWidth, Index / Grid->GridWidth))
+        {
+            Result.Add(Tile);
+        }
+    });
+    return Result;
+}
+
+int32 AUnitCharacter::GetAbilityRange(const FAbilityData& Ability) const
+{
+    return TurnStats ? TurnStats->GetEffectiveStat(ETBStat::AbilityRange, Ability.Range, GetAbilitySlot(Ability)) : Ability.Range;
+}
+
+int32 AUnitCharacter::GetAbilityAPCost(const FAbilityData& Ability) const
+{
+    return TurnStats ? TurnStats->GetEffectiveStat(ETBStat::AbilityAPCost, Ability.APCost, GetAbilitySlot(Ability)) : Ability.APCost;
+}
+
+void AUnitCharacter::GetAbilityDamage(const FAbilityData& Ability, int32& OutMinDamage, int32& OutMaxDamage) const
+{
+    OutMinDamage = Ability.MinDamage;
+    OutMaxDamage = Ability.MaxDamage;
+    if (TurnStats)
+    {
+        OutMinDamage = TurnStats->GetEffectiveStat(ETBStat::AbilityDamage, OutMinDamage, GetAbilitySlot(Ability));
+        OutMaxDamage = TurnStats->GetEffectiveStat(ETBStat::AbilityDamage, OutMaxDamage, GetAbilitySlot(Ability));
+    }
+}
+
+SIZE_T AUnitCharacter::GetAbilityAllocatedSize(SIZE_T* OutInlineBytes) const
+{
+    const SIZE_T InlineBytes = sizeof(MagicArrow) + sizeof(Boulder);
+    if (OutInlineBytes) *OutInlineBytes = InlineBytes;
+
+    SIZE_T Size = InlineBytes + AbilityEvaluations.GetAllocatedSize();
+    Size += MagicArrow.Effect.GetAllocatedSize() + Boulder.Effect.GetAllocatedSize();
+    Size += MagicArrow.GetEffectProgram().GetAllocatedSize() + Boulder.GetEffectProgram().GetAllocatedSize();
+    Size += TurnStats ? TurnStats->GetModifiers().GetAllocatedSize() : 0;
+    for (const FAbilityEvaluation& Eval : AbilityEvaluations)
+    {
+        Size += Eval.TargetTiles.Words.GetAllocatedSize() + Eval.UnitTiles.Words.GetAllocatedSize();
+    }
+    return Size;
+}
+
+int32 AUnitCharacter::GetMaxHP() const
+{
+    return TurnStats ? TurnStats->GetEffectiveStat(ETBStat::MaxHP, MaxHP) : MaxHP;
+}
+
+void AUnitCharacter::HandleModifiersChanged(uint32 ChangedStats)
+{
+    if (!(ChangedStats & (1u << (uint32)ETBStat::MaxHP))) return;
+
+    // A lowered maximum takes the excess HP with it; a raised one only changes what the HUD shows
+    const int32 OldHP = HP;
+    HP = FMath::Min(HP, GetMaxHP());
+    if (HP != OldHP)
+    {
+        NotifyStateHashChanged(ETBStateField::HP, OldHP, HP);
+        PushToEntity();
+        if (UGameplayEventBus::Post(this, EGameplayEventType::HPChanged, this, OldHP, HP)) return;
+    }
+    else if (UGameplayEventBus::Get(this))
+    {
+        // The stats component's ModifiersChanged event refreshes the shown maximum
+        return;
+    }
+    OnHPChanged.Broadcast(HP);
 }
 
 void AUnitCharacter::ReceiveDamage(int32 Amount, bool bMagical)
 {
     if (Amount <= 0) return;
+    const int32 OldHP = HP;
     HP -= Amount;
     HP = FMath::Max(0, HP);
+    FTBTelemetry::Record(ETBTelemetryEvent::Damage, UnitId, Amount, HP, bMagical ? 1 : 0);
+    NotifyStateHashChanged(ETBStateField::HP, OldHP, HP);
 
-    // Broadcast HP changed
-    OnHPChanged.Broadcast(HP);
+    PushToEntity();
+
+    // Broadcast HP changed (coalesced by the event bus; immediate if there is none)
+    if (!UGameplayEventBus::Post(this, EGameplayEventType::HPChanged, this, OldHP, HP))
+    {
+        OnHPChanged.Broadcast(HP);
+    }
 
     if (HP <= 0)
     {
@@ -246,12 +813,60 @@ void AUnitCharacter::ReceiveDamage(int32 Amount, bool bMagical)
     }
 }
 
+int32 AUnitCharacter::ReceiveHealing(int32 Amount)
+{
+    const int32 OldHP = HP;
+    HP = FMath::Min(GetMaxHP(), HP + FMath::Max(0, Amount));
+    if (HP == OldHP) return 0;
+    NotifyStateHashChanged(ETBStateField::HP, OldHP, HP);
+
+    PushToEntity();
+
+    if (!UGameplayEventBus::Post(this, EGameplayEventType::HPChanged, this, OldHP, HP))
+    {
+        OnHPChanged.Broadcast(HP);
+    }
+    return HP - OldHP;
+}
+
+void AUnitCharacter::ForceMoveToTile(AGridTile* Tile)
+{
+    if (!Tile || Tile == CurrentTile) return;
+    CancelPreviewMove();
+
+    if (CurrentTile && CurrentTile->Occupant == this)
+    {
+        CurrentTile->SetOccupant(nullptr);
+    }
+    CommitToTile(Tile);
+}
+
 void AUnitCharacter::OnDeath()
 {
+    FTBTelemetry::Record(ETBTelemetryEvent::Death, UnitId, GetTelemetryTileIndex(CurrentTile));
+
     // Clean up occupancy pointer to avoid dangling refs
     if (CurrentTile && CurrentTile->Occupant == this)
     {
-        CurrentTile->Occupant = nullptr;
+        CurrentTile->SetOccupant(nullptr);
+    }
+
+    // Stop contributing to team vision
+    if (AGridManager* Grid = GetGridManager())
+    {
+        Grid->RemoveUnitVisibility(this);
+    }
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->UnregisterUnit(this);
+    }
+
+    // Entity-backed proxies retire their entity as well
+    if (EntityOwner)
+    {
+        EntityOwner->HandleProxyDeath(this);
+        EntityOwner = nullptr;
+        EntityId = INDEX_NONE;
     }
 
     // Spawn death VFX if assigned
@@ -260,7 +875,8 @@ void AUnitCharacter::OnDeath()
         UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), DeathEffect, GetActorLocation(), GetActorRotation(), true);
     }
 
-    // Broadcast death event (UI/other systems can bind)
+    // Broadcast death event (UI/other systems can bind). Immediate, since the actor is destroyed below.
+    UGameplayEventBus::Post(this, EGameplayEventType::Died, this, 0, 0);
     OnDied.Broadcast();
 
     // Destroy actor
@@ -274,7 +890,87 @@ void AUnitCharacter::ResetForNewTurn()
         TurnStats->ResetForNewTurn();
     }
     // Reset ability cast counters
+    const int32 OldArrowCasts = MagicArrow.CastsRemaining;
     MagicArrow.CastsRemaining = MagicArrow.MaxCastsPerTurn;
+    NotifyStateHashChanged(ETBStateField::CastsRemaining, TBStateHash::PackCasts(0, OldArrowCasts), TBStateHash::PackCasts(0, MagicArrow.CastsRemaining));
+
+    const int32 OldBoulderCasts = Boulder.CastsRemaining;
     Boulder.CastsRemaining = Boulder.MaxCastsPerTurn;
+    NotifyStateHashChanged(ETBStateField::CastsRemaining, TBStateHash::PackCasts(1, OldBoulderCasts), TBStateHash::PackCasts(1, Boulder.CastsRemaining));
+    PushToEntity();
+}
+
+uint64 AUnitCharacter::GetStateHashContribution(int32 TileIndex) const
+{
+    using namespace TBStateHash;
+    const int32 Subject = GetStateHashSubject(TileIndex);
+    uint64 Hash = Key(ETBStateField::UnitTile, Subject, TileIndex) ^ Key(ETBStateField::HP, Subject, HP);
+    Hash ^= Key(ETBStateField::MovementPoints, Subject, TurnStats ? TurnStats->MovementPoints : 0);
+    Hash ^= Key(ETBStateField::ActionPoints, Subject, TurnStats ? TurnStats->ActionPoints : 0);
+    Hash ^= Key(ETBStateField::CastsRemaining, Subject, PackCasts(0, MagicArrow.CastsRemaining));
+    Hash ^= Key(ETBStateField::CastsRemaining, Subject, PackCasts(1, Boulder.CastsRemaining));
+    return Hash;
+}
+
+void AUnitCharacter::NotifyStateHashChanged(ETBStateField Field, int32 OldValue, int32 NewValue)
+{
+    // Only units standing on their tile are part of the hash; the rest is folded in when they are committed
+    if (OldValue == NewValue || !CurrentTile || CurrentTile->Occupant != this) return;
+
+    AGridManager* Grid = GetGridManager();
+    if (!Grid) return;
+
+    const int32 TileIndex = CurrentTile->Y * Grid->GridWidth + CurrentTile->X;
+    Grid->ToggleStateHash(TBStateHash::Delta(Field, GetStateHashSubject(TileIndex), OldValue, NewValue));
+    Grid->ValidateStateHash(TEXT("unit stat change"));
+}
+
+void AUnitCharacter::PushToEntity()
+{
+    if (EntityOwner)
+    {
+        EntityOwner->PushFromProxy(this);
+    }
+}
+
+void AUnitCharacter::BindToEntity(AUnitEntityManager* Manager, int32 InEntityId, AGridTile* Tile)
+{
+    if (!Manager || !Tile) return;
+
+    EntityOwner = Manager;
+    EntityId = InEntityId;
+    UnitId = InEntityId;
+    Manager->GetStore().CopyToUnit(InEntityId, this);
+
+    SetActorHiddenInGame(false);
+    SetActorEnableCollision(true);
+
+    CurrentTile = nullptr;
+    CommitToTile(Tile);
+}
+
+void AUnitCharacter::UnbindFromEntity()
+{
+    CancelPreviewMove();
+
+    if (CurrentTile && CurrentTile->Occupant == this)
+    {
+        CurrentTile->SetOccupant(nullptr);
+    }
+    if (AGridManager* Grid = GetGridManager())
+    {
+        Grid->RemoveUnitVisibility(this);
+    }
+    if (UTBBoardSubsystem* Board = UTBBoardSubsystem::Get(this))
+    {
+        Board->UnregisterUnit(this);
+    }
+
+    CurrentTile = nullptr;
+    EntityOwner = nullptr;
+    EntityId = INDEX_NONE;
+
+    SetActorHiddenInGame(true);
+    SetActorEnableCollision(false);
 }
 
@@ -2,11 +2,17 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GridBitset.h"
+#include "GridPathfinding.h"
 #include "UnitCharacter.generated.h"
 
 class UTurnStatsComponent;
+enum class ETBStateField : uint8;
 class AGridTile;
+class AGridManager;
+class AUnitEntityManager;
 class UParticleSystem;
+class FTBEffectProgram;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHPChanged, int32, NewHP);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDied);
@@ -45,9 +51,65 @@ struct FAbilityData
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability")
     bool bIsMagical = false;
 
+    // The caster's own tile counts as a unit target (self heals and buffs)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability")
+    bool bCanTargetSelf = false;
+
+    // What a cast does, in the effect language of TBAbilityEffects.h (e.g. "area diamond 1; filter enemies; damage").
+    // Empty: damage the unit on the target tile.
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ability", meta = (MultiLine = true))
+    FString Effect;
+
+    // Effect compiled by CompileEffect (shared by every copy of this ability)
+    TSharedPtr<const FTBEffectProgram, ESPMode::ThreadSafe> EffectProgram;
+
+    // Compile Effect; on a syntax error logs it, falls back to plain damage and returns false
+    bool CompileEffect();
+
+    // Compiled effect, or plain damage before CompileEffect
+    const FTBEffectProgram& GetEffectProgram() const;
+
     FAbilityData() {}
 };
 
+// Why an ability cannot be cast right now
+UENUM(BlueprintType)
+enum class EAbilityBlockReason : uint8
+{
+    None,
+    NoCastsLeft,
+    NotEnoughAP,
+    // The unit is not on a tile (and has no preview destination)
+    NoOrigin
+};
+
+// One ability's availability and legal targets for the unit's current tile, AP and board (see EvaluateAbilities)
+USTRUCT(BlueprintType)
+struct FAbilityEvaluation
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Ability")
+    FName AbilityName = NAME_None;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Ability")
+    EAbilityBlockReason BlockReason = EAbilityBlockReason::None;
+
+    // Tiles a cast would be accepted on (in range and in line of sight); empty while blocked
+    FGridBitset TargetTiles;
+
+    // Subset of TargetTiles holding a unit to hit
+    FGridBitset UnitTiles;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Ability")
+    int32 NumTargetTiles = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Ability")
+    int32 NumUnitTargets = 0;
+
+    bool CanCast() const { return BlockReason == EAbilityBlockReason::None; }
+};
+
 UCLASS()
 class DENEME_API AUnitCharacter : public AActor
 {
@@ -74,16 +136,47 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
     int32 HP = 100;
 
+    // MaxHP with modifiers applied (see UTurnStatsComponent::AddModifier)
+    UFUNCTION(BlueprintPure, Category = "Stats")
+    int32 GetMaxHP() const;
+
+    // Stable id used to key deterministic rolls; must be unique per unit and identical on every machine.
+    // When left at -1 the unit's committed tile index is used instead.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+    int32 UnitId = INDEX_NONE;
+
+    // Team for fog of war and targeting (units of the same team share vision)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Team")
+    int32 TeamId = 0;
+
+    // Change team at runtime: refreshes the tile's team occupancy bits, this unit's vision and the board registry
+    UFUNCTION(BlueprintCallable, Category = "Team")
+    void SetTeam(int32 NewTeamId);
+
+    // Vision radius in tiles (Manhattan)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+    int32 SightRange = 12;
+
+    // Play moves back along the path; AI-controlled units turn this off to move instantly
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
+    bool bAnimateMovement = true;
+
     // Death VFX to spawn on death (optional)
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects")
     UParticleSystem* DeathEffect;
 
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-    // Preview move: snap visually to the destination (no MP deducted, CurrentTile unchanged).
+    // Preview move: move visually to the destination (no MP deducted, CurrentTile unchanged).
+    // Consecutive tiles must be walkable neighbors; steps cost what the grid's pathfinder charges for them.
     UFUNCTION(BlueprintCallable, Category = "Movement")
     bool RequestPreviewMove(const TArray<AGridTile*>& Path);
 
+    // Same with a path result from AGridManager::FindGridPath. Path is taken over and handed back empty
+    // (with the previous preview's capacity), so callers can keep reusing one buffer.
+    bool RequestPreviewMove(FGridPath&& Path);
+
     // Cancel the preview and snap back to committed tile
     UFUNCTION(BlueprintCallable, Category = "Movement")
     void CancelPreviewMove();
@@ -92,10 +185,21 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Turn")
     void ConfirmPlacement();
 
-    // Returns how many movement points the preview path will cost (1 per tile)
+    // Returns how many movement points the preview path will cost (terrain cost of the tiles entered)
     UFUNCTION(BlueprintCallable, Category = "Movement")
     int32 GetPreviewCost() const;
 
+    // Tiles of the preview path, start first
+    UFUNCTION(BlueprintCallable, Category = "Movement")
+    TArray<AGridTile*> GetPreviewPathTiles() const;
+
+    const FGridPath& GetPreviewPath() const { return PreviewPath; }
+    AGridManager* GetPreviewGrid() const { return PreviewGrid; }
+
+    // Terrain under the preview path changed (AGridManager::CommitTerrainEdit): search the same goal again with the
+    // new costs, or cancel the preview when the goal can no longer be reached
+    void RefreshPreviewMove();
+
     // Abilities
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Abilities")
     FAbilityData MagicArrow;
@@ -107,10 +211,43 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Abilities")
     bool CastAbilityAtTile(FName AbilityName, AGridTile* TargetTile);
 
+    // Side-effect-free CastAbilityAtTile checks for every ability against every tile, in ability bar order
+    // (MagicArrow, Boulder). Cached; recomputed only when the origin tile, AP, casts left or the board change.
+    UFUNCTION(BlueprintCallable, Category = "Abilities")
+    const TArray<FAbilityEvaluation>& EvaluateAbilities();
+
+    UFUNCTION(BlueprintCallable, Category = "Abilities")
+    bool CanCastAbility(FName AbilityName);
+
+    // Whether CastAbilityAtTile would accept TargetTile (answered from the EvaluateAbilities cache)
+    UFUNCTION(BlueprintCallable, Category = "Abilities")
+    bool IsLegalAbilityTarget(FName AbilityName, AGridTile* TargetTile);
+
+    // Legal target tiles of an ability, optionally only those holding a unit
+    UFUNCTION(BlueprintCallable, Category = "Abilities")
+    TArray<AGridTile*> GetAbilityTargetTiles(FName AbilityName, bool bUnitsOnly);
+
+    // Ability stats with modifiers applied; every range, cost and damage check goes through these
+    int32 GetAbilityRange(const FAbilityData& Ability) const;
+    int32 GetAbilityAPCost(const FAbilityData& Ability) const;
+    void GetAbilityDamage(const FAbilityData& Ability, int32& OutMinDamage, int32& OutMaxDamage) const;
+
+    // Bytes of ability state: the ability structs (stored inside the actor, also returned in OutInlineBytes)
+    // plus effect programs, the EvaluateAbilities cache and the stat modifiers
+    SIZE_T GetAbilityAllocatedSize(SIZE_T* OutInlineBytes = nullptr) const;
+
     // Receive damage (applies to HP, calls OnDeath if <= 0)
     UFUNCTION(BlueprintCallable, Category = "Stats")
     void ReceiveDamage(int32 Amount, bool bMagical);
 
+    // Restore HP up to MaxHP; returns the HP actually restored
+    UFUNCTION(BlueprintCallable, Category = "Stats")
+    int32 ReceiveHealing(int32 Amount);
+
+    // Move straight onto Tile without spending MP; cancels any preview. Does no walkability or occupancy checks:
+    // the ability effect state calls it after its own CanPushInto.
+    void ForceMoveToTile(AGridTile* Tile);
+
     // Reset per-turn values on the unit (MP/AP and ability counters)
     UFUNCTION(BlueprintCallable, Category = "Turn")
     void ResetForNewTurn();
@@ -122,13 +259,35 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "Events")
     FOnDied OnDied;
 
+    // Entity this actor is a visual proxy for (INDEX_NONE for a regular, standalone unit)
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Entities")
+    int32 EntityId = INDEX_NONE;
+
+    // Take over an entity's state and tile (called by AUnitEntityManager when the entity becomes relevant)
+    void BindToEntity(AUnitEntityManager* Manager, int32 InEntityId, AGridTile* Tile);
+
+    // Give the tile back and go dormant so the manager can pool this actor
+    void UnbindFromEntity();
+
+    // XOR of this unit's state hash keys (tile, HP, MP/AP, casts left) while it stands on TileIndex
+    uint64 GetStateHashContribution(int32 TileIndex) const;
+
+    // Fold a change of one of those fields into the grid's state hash (called after the new value is written)
+    void NotifyStateHashChanged(ETBStateField Field, int32 OldValue, int32 NewValue);
+
+    // Modifiers on TurnStats changed (mask of 1 << ETBStat): keep HP within a lowered MaxHP and refresh the HUD
+    void HandleModifiersChanged(uint32 ChangedStats);
+
 protected:
     // Preview state
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
     bool bIsPreviewing = false;
 
-    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
-    TArray<AGridTile*> PreviewPath;
+    // Tile indices of the preview path on PreviewGrid
+    FGridPath PreviewPath;
+
+    UPROPERTY()
+    AGridManager* PreviewGrid = nullptr;
 
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
     int32 PreviewCost = 0;
@@ -137,16 +296,66 @@ protected:
     FVector OriginalLocation;
     AGridTile* OriginalTile = nullptr;
 
-    // Helper to visually snap actor to the center of a tile (does not change occupancy)
+    // Helper to visually snap actor to the center of a tile (does not change occupancy).
+    // A movement animation already ending on Tile is left to finish; any other is stopped.
     void SnapToTileVisual(AGridTile* Tile);
 
+    // Animate along Path through the movement subsystem, or snap to its end when animation is off
+    void MoveAlongPathVisual(const AGridManager* Grid, const FGridPath& Path);
+
     // Helper to commit change of occupancy/current tile
     void CommitToTile(AGridTile* Tile);
 
-    // Apply the ability effects to the occupant on a tile (if any)
-    bool ApplyAbilityToTile(const FAbilityData& Ability, AGridTile* Tile);
+    // Ability by name (None picks MagicArrow), and its slot in the ability bar
+    FAbilityData* FindAbility(FName AbilityName, int32* OutSlot = nullptr);
+
+    // Slot in the ability bar of one of this unit's abilities
+    int32 GetAbilitySlot(const FAbilityData& Ability) const { return &Ability == &Boulder ? 1 : 0; }
+
+    // Tile abilities are cast from: the committed tile, else the preview destination
+    AGridTile* GetAbilityOrigin() const;
+
+    // Casts and AP part of the cast checks (range and sight are per target)
+    EAbilityBlockReason GetAbilityBlockReason(const FAbilityData& Ability) const;
+
+    // Run the ability's effect program at a tile; true if it affected any unit. The damage dealt goes to OutDamage.
+    // Rolls are keyed on (match seed, turn, caster, ability, target tile, cast index); the cast is spent before this runs.
+    bool ApplyAbilityToTile(const FAbilityData& Ability, AGridTile* Tile, int32* OutDamage = nullptr);
 
     // Handle death (cleans up occupancy, broadcasts, spawns VFX)
     void OnDeath();
+
+    // Write this proxy's state back to its entity (no-op for standalone units)
+    void PushToEntity();
+
+    // Hash subject: UnitId, or the tile index while it is unset (same fallback as the damage rolls)
+    int32 GetStateHashSubject(int32 TileIndex) const { return UnitId != INDEX_NONE ? UnitId : TileIndex; }
+
+    UPROPERTY()
+    AUnitEntityManager* EntityOwner = nullptr;
+
+    friend class AUnitEntityManager;
+
+    // Everything EvaluateAbilities depends on; the cache is reused while this is unchanged
+    struct FAbilityEvalKey
+    {
+        const AGridTile* Origin = nullptr;
+        uint32 TargetingVersion = 0;
+        int32 ActionPoints = 0;
+        int32 CastsRemaining[2] = {};
+        int32 APCost[2] = {};
+        int32 Range[2] = {};
+
+        bool operator==(const FAbilityEvalKey& Other) const;
+    };
+
+    FAbilityEvalKey MakeAbilityEvalKey() const;
+
+    TArray<FAbilityEvaluation> AbilityEvaluations;
+    FAbilityEvalKey AbilityEvalKey;
+    bool bAbilityEvalValid = false;
+
+    // Grid manager owning the committed tile (nullptr if the unit is not on a spawned grid)
+    AGridManager* GetGridManager() const;
 };
 
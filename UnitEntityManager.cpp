@@ -0,0 +1,396 @@
+#include "UnitEntityManager.h"
+#include "UnitCharacter.h"
+#include "AGridManager.h"
+#include "AGridTile.h"
+#include "TBPlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+AUnitEntityManager::AUnitEntityManager()
+{
+    PrimaryActorTick.bCanEverTick = true;
+}
+
+void AUnitEntityManager::BeginPlay()
+{
+    Super::BeginPlay();
+    if (Grid)
+    {
+        Grid->RegisterEntityManager(this);
+    }
+}
+
+void AUnitEntityManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (Grid)
+    {
+        Grid->UnregisterEntityManager(this);
+    }
+    Proxies.Empty();
+    ProxyPool.Empty();
+    Super::EndPlay(EndPlayReason);
+}
+
+void AUnitEntityManager::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    TimeSinceProxyUpdate += DeltaSeconds;
+    if (TimeSinceProxyUpdate >= ProxyUpdateInterval)
+    {
+        TimeSinceProxyUpdate = 0.0f;
+        UpdateProxies();
+    }
+}
+
+int32 AUnitEntityManager::GetArchetypeFor(TSubclassOf<AUnitCharacter> UnitClass)
+{
+    const int32 Existing = ArchetypeClasses.IndexOfByKey(UnitClass);
+    if (Existing != INDEX_NONE) return Existing;
+
+    Store.AddArchetype(FUnitArchetype::FromUnit(UnitClass->GetDefaultObject<AUnitCharacter>()));
+    return ArchetypeClasses.Add(UnitClass);
+}
+
+AGridTile* AUnitEntityManager::GetEntityTile(int32 EntityId) const
+{
+    if (!Grid || !Store.IsAlive(EntityId) || Grid->GridWidth <= 0) return nullptr;
+    const int32 Index = Store.TileIndex[EntityId];
+    return Index != INDEX_NONE ? Grid->GetTileAt(Index % Grid->GridWidth, Index / Grid->GridWidth) : nullptr;
+}
+
+int32 AUnitEntityManager::SpawnEntity(TSubclassOf<AUnitCharacter> UnitClass, int32 TeamId, AGridTile* Tile)
+{
+    if (!UnitClass || !Tile || !Grid) return INDEX_NONE;
+    if (!Tile->bIsWalkable || Grid->IsTileOccupied(Tile)) return INDEX_NONE;
+
+    const int32 Archetype = GetArchetypeFor(UnitClass);
+    const int32 EntityId = Store.Create(Archetype, TeamId, Tile->Y * Grid->GridWidth + Tile->X);
+
+    Grid->SetTileUnitOccupancy(Tile, TeamId, true);
+    Grid->GetVisibility().UpdateViewer(GetEntityViewerId(EntityId), TeamId, Tile->X, Tile->Y, Store.GetArchetype(EntityId).SightRange);
+    return EntityId;
+}
+
+void AUnitEntityManager::ResetAllForNewTurn()
+{
+    Store.ResetAllForNewTurn();
+
+    // Proxies reset through the actor path so HUD listeners are notified
+    for (auto& Pair : Proxies)
+    {
+        if (AUnitCharacter* Proxy = Pair.Value.Get())
+        {
+            Proxy->ResetForNewTurn();
+        }
+    }
+}
+
+void AUnitEntityManager::ApplyDamage(int32 EntityId, int32 Amount, bool bMagical)
+{
+    if (!Store.IsAlive(EntityId)) return;
+
+    if (AUnitCharacter* Proxy = GetProxy(EntityId))
+    {
+        Proxy->ReceiveDamage(Amount, bMagical);
+        return;
+    }
+
+    if (Store.ApplyDamage(EntityId, Amount))
+    {
+        HandleEntityDeath(EntityId);
+    }
+}
+
+int32 AUnitEntityManager::ApplyHealing(int32 EntityId, int32 Amount)
+{
+    if (!Store.IsAlive(EntityId)) return 0;
+
+    if (AUnitCharacter* Proxy = GetProxy(EntityId))
+    {
+        return Proxy->ReceiveHealing(Amount);
+    }
+    return Store.ApplyHealing(EntityId, Amount);
+}
+
+bool AUnitEntityManager::CommitMove(int32 EntityId, AGridTile* Tile)
+{
+    if (!Grid || !Tile || !Store.IsAlive(EntityId)) return false;
+    if (!Tile->bIsWalkable || Grid->IsTileOccupied(Tile)) return false;
+
+    if (AUnitCharacter* Proxy = GetProxy(EntityId))
+    {
+        if (Proxy->CurrentTile && Proxy->CurrentTile->Occupant == Proxy)
+        {
+            Proxy->CurrentTile->SetOccupant(nullptr);
+        }
+        Proxy->CommitToTile(Tile);
+        return true;
+    }
+
+    // By index: the old tile may belong to a chunk that has streamed out
+    const int32 TeamId = Store.TeamId[EntityId];
+    const int32 OldIndex = Store.TileIndex[EntityId];
+    Grid->SetUnitOccupancyAt(OldIndex % Grid->GridWidth, OldIndex / Grid->GridWidth, TeamId, false);
+
+    Store.CommitMove(EntityId, Tile->Y * Grid->GridWidth + Tile->X);
+    Grid->SetTileUnitOccupancy(Tile, TeamId, true);
+    Grid->GetVisibility().UpdateViewer(GetEntityViewerId(EntityId), TeamId, Tile->X, Tile->Y, Store.GetArchetype(EntityId).SightRange);
+    return true;
+}
+
+AUnitCharacter* AUnitEntityManager::GetProxy(int32 EntityId) const
+{
+    const TWeakObjectPtr<AUnitCharacter>* Proxy = Proxies.Find(EntityId);
+    return Proxy ? Proxy->Get() : nullptr;
+}
+
+int32 AUnitEntityManager::GetEntityAt(int32 TileIndex) const
+{
+    const int32 EntityId = Store.FindAt(TileIndex);
+    return Store.IsAlive(EntityId) && !Store.IsProxied(EntityId) ? EntityId : INDEX_NONE;
+}
+
+void AUnitEntityManager::RestoreOccupancy()
+{
+    if (!Grid || Grid->GridWidth <= 0) return;
+
+    for (int32 EntityId = 0; EntityId < Store.Num(); ++EntityId)
+    {
+        const int32 Index = Store.TileIndex[EntityId];
+        if (!Store.IsAlive(EntityId) || Store.IsProxied(EntityId) || Index == INDEX_NONE) continue;
+        Grid->SetUnitOccupancyAt(Index % Grid->GridWidth, Index / Grid->GridWidth, Store.TeamId[EntityId], true);
+    }
+}
+
+void AUnitEntityManager::PushFromProxy(AUnitCharacter* Proxy)
+{
+    if (!Proxy || !Store.IsAlive(Proxy->EntityId)) return;
+
+    Store.CopyFromUnit(Proxy->EntityId, Proxy);
+    if (Proxy->CurrentTile && Grid)
+    {
+        Store.CommitMove(Proxy->EntityId, Proxy->CurrentTile->Y * Grid->GridWidth + Proxy->CurrentTile->X);
+    }
+}
+
+void AUnitEntityManager::HandleProxyDeath(AUnitCharacter* Proxy)
+{
+    if (!Proxy) return;
+
+    // The actor already cleared its tile and vision in OnDeath
+    Proxies.Remove(Proxy->EntityId);
+    Store.Destroy(Proxy->EntityId);
+}
+
+void AUnitEntityManager::HandleEntityDeath(int32 EntityId)
+{
+    if (Grid && Grid->GridWidth > 0 && Store.IsAlive(EntityId))
+    {
+        const int32 Index = Store.TileIndex[EntityId];
+        if (Index != INDEX_NONE)
+        {
+            Grid->SetUnitOccupancyAt(Index % Grid->GridWidth, Index / Grid->GridWidth, Store.TeamId[EntityId], false);
+        }
+        Grid->GetVisibility().RemoveViewer(GetEntityViewerId(EntityId));
+    }
+    Store.Destroy(EntityId);
+}
+
+void AUnitEntityManager::UpdateProxies()
+{
+    if (!Grid || Grid->GridWidth <= 0 || Grid->TileSize <= 0.0f) return;
+
+    APlayerController* PC = GetWorld()->GetFirstPlayerController();
+    ATBPlayerController* TBPC = Cast<ATBPlayerController>(PC);
+    const AUnitCharacter* Selected = TBPC ? TBPC->SelectedUnit : nullptr;
+
+    // Camera position in tile coordinates
+    int32 CameraX = 0;
+    int32 CameraY = 0;
+    if (PC && PC->PlayerCameraManager)
+    {
+        const FVector Local = PC->PlayerCameraManager->GetCameraLocation() - Grid->GetActorLocation();
+        CameraX = FMath::RoundToInt(Local.X / Grid->TileSize);
+        CameraY = FMath::RoundToInt(Local.Y / Grid->TileSize);
+    }
+
+    // (distance, entity) for every entity in proxy range
+    TArray<TPair<int32, int32>> Wanted;
+    for (int32 EntityId = 0; EntityId < Store.Num(); ++EntityId)
+    {
+        if (!Store.IsAlive(EntityId)) continue;
+        const int32 Index = Store.TileIndex[EntityId];
+        const int32 Distance = FMath::Abs(Index % Grid->GridWidth - CameraX) + FMath::Abs(Index / Grid->GridWidth - CameraY);
+        if (Distance <= ProxyRadiusTiles)
+        {
+            Wanted.Emplace(Distance, EntityId);
+        }
+    }
+
+    if (Wanted.Num() > MaxProxies)
+    {
+        Wanted.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B) { return A.Key < B.Key; });
+        Wanted.SetNum(FMath::Max(0, MaxProxies));
+    }
+
+    TSet<int32> WantedSet;
+    WantedSet.Reserve(Wanted.Num());
+    for (const TPair<int32, int32>& Entry : Wanted)
+    {
+        WantedSet.Add(Entry.Value);
+    }
+
+    // Release proxies that left the camera area (the selected unit always keeps its actor)
+    TArray<int32> ToRelease;
+    for (const auto& Pair : Proxies)
+    {
+        const AUnitCharacter* Proxy = Pair.Value.Get();
+        if (!WantedSet.Contains(Pair.Key) && (!Proxy || Proxy != Selected))
+        {
+            ToRelease.Add(Pair.Key);
+        }
+    }
+    for (int32 EntityId : ToRelease)
+    {
+        ReleaseProxy(EntityId);
+    }
+
+    for (int32 EntityId : WantedSet)
+    {
+        if (!Proxies.Contains(EntityId))
+        {
+            AcquireProxy(EntityId);
+        }
+    }
+}
+
+void AUnitEntityManager::AcquireProxy(int32 EntityId)
+{
+    AGridTile* Tile = GetEntityTile(EntityId);
+    if (!Tile) return;
+
+    UClass* ProxyClass = ArchetypeClasses[Store.ArchetypeIndex[EntityId]];
+    AUnitCharacter* Proxy = nullptr;
+    for (int32 Index = ProxyPool.Num() - 1; Index >= 0; --Index)
+    {
+        if (ProxyPool[Index] && ProxyPool[Index]->GetClass() == ProxyClass)
+        {
+            Proxy = ProxyPool[Index];
+            ProxyPool.RemoveAtSwap(Index);
+            break;
+        }
+    }
+
+    if (!Proxy)
+    {
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.Owner = this;
+        SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+        Proxy = GetWorld()->SpawnActor<AUnitCharacter>(ProxyClass, Tile->GetTileCenter(), FRotator::ZeroRotator, SpawnParams);
+    }
+    if (!Proxy) return;
+
+    // Hand the tile and vision over from the entity to the actor
+    Grid->SetTileUnitOccupancy(Tile, Store.TeamId[EntityId], false);
+    Grid->GetVisibility().RemoveViewer(GetEntityViewerId(EntityId));
+
+    Store.SetProxied(EntityId, true);
+    Proxies.Add(EntityId, Proxy);
+    Proxy->BindToEntity(this, EntityId, Tile);
+}
+
+void AUnitEntityManager::ReleaseProxy(int32 EntityId)
+{
+    TWeakObjectPtr<AUnitCharacter> WeakProxy;
+    Proxies.RemoveAndCopyValue(EntityId, WeakProxy);
+    Store.SetProxied(EntityId, false);
+
+    AUnitCharacter* Proxy = WeakProxy.Get();
+    if (!Proxy || !Store.IsAlive(EntityId)) return;
+
+    Store.ReleaseFromUnit(EntityId, Proxy);
+    Proxy->UnbindFromEntity();
+    ProxyPool.Add(Proxy);
+
+    // Back to the packed representation (by index, so it works whether or not the tile's chunk is loaded)
+    const int32 Index = Store.TileIndex[EntityId];
+    if (Grid && Grid->GridWidth > 0 && Index != INDEX_NONE)
+    {
+        const int32 TeamId = Store.TeamId[EntityId];
+        const int32 X = Index % Grid->GridWidth;
+        const int32 Y = Index / Grid->GridWidth;
+        Grid->SetUnitOccupancyAt(X, Y, TeamId, true);
+        Grid->GetVisibility().UpdateViewer(GetEntityViewerId(EntityId), TeamId, X, Y, Store.GetArchetype(EntityId).SightRange);
+    }
+}
+
+namespace
+{
+    // Batch turn loop (reset, move commit, cast, damage, death) over the packed store at increasing unit counts
+    void RunEntityScalingBenchmark()
+    {
+        const int32 Counts[] = { 100, 1000, 5000, 10000, 20000 };
+        constexpr int32 NumTurns = 20;
+        constexpr int32 BoardWidth = 512;
+
+        const FUnitArchetype Archetype = FUnitArchetype::FromUnit(GetDefault<AUnitCharacter>());
+        const FAbilityData& Ability = Archetype.Abilities[0];
+
+        for (int32 Count : Counts)
+        {
+            FUnitEntityStore Bench;
+            const int32 ArchetypeIndex = Bench.AddArchetype(Archetype);
+            Bench.Reserve(Count);
+            for (int32 Index = 0; Index < Count; ++Index)
+            {
+                Bench.Create(ArchetypeIndex, Index & 1, Index);
+            }
+
+            TArray<int32> Targets;
+            TArray<int32> Amounts;
+            TArray<int32> Died;
+            Targets.Reserve(Count);
+            Amounts.Reserve(Count);
+
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 Turn = 0; Turn < NumTurns; ++Turn)
+            {
+                Bench.ResetAllForNewTurn();
+                Targets.Reset();
+                Amounts.Reset();
+                Died.Reset();
+
+                for (int32 EntityId = 0; EntityId < Bench.Num(); ++EntityId)
+                {
+                    if (!Bench.IsAlive(EntityId)) continue;
+                    if (Bench.SpendMovement(EntityId, 1))
+                    {
+                        Bench.CommitMove(EntityId, (Bench.TileIndex[EntityId] + BoardWidth) % (BoardWidth * BoardWidth));
+                    }
+                    if (Bench.SpendAction(EntityId, Ability.APCost))
+                    {
+                        Targets.Add(EntityId ^ 1);
+                        Amounts.Add(Ability.MinDamage);
+                    }
+                }
+
+                Bench.ApplyDamageBatch(Targets, Amounts, Died);
+                for (int32 Dead : Died)
+                {
+                    Bench.Destroy(Dead);
+                }
+            }
+            const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+            UE_LOG(LogTemp, Display, TEXT("UnitEntities %6d units: %8.3f ms/turn, %6.1f ns/unit/turn, %llu bytes"),
+                Count, ElapsedMs / NumTurns, ElapsedMs * 1.0e6 / (NumTurns * (double)Count), (uint64)Bench.GetAllocatedSize());
+        }
+    }
+
+    FAutoConsoleCommand EntityBenchmarkCommand(
+        TEXT("tb.Bench.UnitEntities"),
+        TEXT("Benchmark batch turn processing of data-oriented units from 100 to 20000 units"),
+        FConsoleCommandDelegate::CreateStatic(&RunEntityScalingBenchmark));
+}
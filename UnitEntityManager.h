@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "UnitEntityStore.h"
+#include "UnitEntityManager.generated.h"
+
+class AGridManager;
+class AGridTile;
+class AUnitCharacter;
+
+// Owns data-oriented units (FUnitEntityStore) for large battles.
+// Only entities near the camera, or the unit selected by ATBPlayerController, get an AUnitCharacter proxy;
+// everything else lives in packed arrays and is processed in batch.
+UCLASS()
+class DENEME_API AUnitEntityManager : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AUnitEntityManager();
+
+    virtual void Tick(float DeltaSeconds) override;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entities")
+    AGridManager* Grid = nullptr;
+
+    // Entities within this many tiles (Manhattan) of the camera get a proxy actor
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entities")
+    int32 ProxyRadiusTiles = 16;
+
+    // Hard cap on live proxies; the closest entities win
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entities")
+    int32 MaxProxies = 256;
+
+    // Seconds between proxy relevance updates
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entities")
+    float ProxyUpdateInterval = 0.1f;
+
+    // Create an entity of the given unit class (its defaults become the archetype). Returns the entity id.
+    UFUNCTION(BlueprintCallable, Category = "Entities")
+    int32 SpawnEntity(TSubclassOf<AUnitCharacter> UnitClass, int32 TeamId, AGridTile* Tile);
+
+    // Batch turn reset for every entity, proxied or not
+    UFUNCTION(BlueprintCallable, Category = "Entities")
+    void ResetAllForNewTurn();
+
+    UFUNCTION(BlueprintCallable, Category = "Entities")
+    void ApplyDamage(int32 EntityId, int32 Amount, bool bMagical);
+
+    // Up to the archetype's max HP; returns the HP actually restored
+    UFUNCTION(BlueprintCallable, Category = "Entities")
+    int32 ApplyHealing(int32 EntityId, int32 Amount);
+
+    // Move an entity to a tile (occupancy, vision and proxy follow). Fails if the tile is taken.
+    UFUNCTION(BlueprintCallable, Category = "Entities")
+    bool CommitMove(int32 EntityId, AGridTile* Tile);
+
+    UFUNCTION(BlueprintCallable, Category = "Entities")
+    AUnitCharacter* GetProxy(int32 EntityId) const;
+
+    UFUNCTION(BlueprintCallable, Category = "Entities")
+    int32 GetNumEntities() const { return Store.NumAlive(); }
+
+    // Entity without a proxy standing on a tile (Y * GridWidth + X), or INDEX_NONE. Proxied entities are found
+    // through the tile's Occupant.
+    int32 GetEntityAt(int32 TileIndex) const;
+
+    // Set the occupancy bit of every entity without a proxy again (AGridManager::RebuildOccupancy clears them)
+    void RestoreOccupancy();
+
+    // Called by proxies after they mutate their own state (write-through)
+    void PushFromProxy(AUnitCharacter* Proxy);
+
+    // Called by a proxy from OnDeath before it is destroyed
+    void HandleProxyDeath(AUnitCharacter* Proxy);
+
+    FUnitEntityStore& GetStore() { return Store; }
+    const FUnitEntityStore& GetStore() const { return Store; }
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    void UpdateProxies();
+    void AcquireProxy(int32 EntityId);
+    void ReleaseProxy(int32 EntityId);
+    void HandleEntityDeath(int32 EntityId);
+    int32 GetArchetypeFor(TSubclassOf<AUnitCharacter> UnitClass);
+    AGridTile* GetEntityTile(int32 EntityId) const;
+
+    // Non-proxied entities see through the grid's visibility engine under their own viewer id
+    static uint32 GetEntityViewerId(int32 EntityId) { return 0x80000000u | (uint32)EntityId; }
+
+    FUnitEntityStore Store;
+
+    // Unit class per archetype index (used to spawn matching proxies)
+    UPROPERTY()
+    TArray<TSubclassOf<AUnitCharacter>> ArchetypeClasses;
+
+    TMap<int32, TWeakObjectPtr<AUnitCharacter>> Proxies;
+
+    // Hidden proxies kept for reuse instead of destroy/spawn churn
+    UPROPERTY()
+    TArray<AUnitCharacter*> ProxyPool;
+
+    float TimeSinceProxyUpdate = 0.0f;
+};
@@ -0,0 +1,282 @@
+#include "UnitEntityStore.h"
+#include "TurnStatsComponent.h"
+
+FUnitArchetype FUnitArchetype::FromUnit(const AUnitCharacter* Unit)
+{
+    FUnitArchetype Archetype;
+    if (!Unit) return Archetype;
+
+    Archetype.MaxHP = Unit->MaxHP;
+    Archetype.SightRange = Unit->SightRange;
+    if (Unit->TurnStats)
+    {
+        Archetype.MaxMovementPoints = Unit->TurnStats->MaxMovementPoints;
+        Archetype.MaxActionPoints = Unit->TurnStats->MaxActionPoints;
+    }
+    Archetype.Abilities[0] = Unit->MagicArrow;
+    Archetype.Abilities[1] = Unit->Boulder;
+
+    // Class defaults never ran BeginPlay
+    for (FAbilityData& Ability : Archetype.Abilities)
+    {
+        if (!Ability.EffectProgram) Ability.CompileEffect();
+    }
+    return Archetype;
+}
+
+int32 FUnitEntityStore::Create(int32 InArchetype, int32 InTeamId, int32 InTileIndex)
+{
+    int32 EntityId;
+    if (FreeList.Num() > 0)
+    {
+        EntityId = FreeList.Pop(false);
+    }
+    else
+    {
+        EntityId = Flags.Num();
+        HP.AddUninitialized();
+        MovementPoints.AddUninitialized();
+        ActionPoints.AddUninitialized();
+        Casts.AddUninitialized(NumAbilitySlots);
+        TileIndex.AddUninitialized();
+        TeamId.AddUninitialized();
+        ArchetypeIndex.AddUninitialized();
+        Flags.AddUninitialized();
+    }
+
+    const FUnitArchetype& Archetype = Archetypes[InArchetype];
+    HP[EntityId] = Archetype.MaxHP;
+    MovementPoints[EntityId] = (int16)Archetype.MaxMovementPoints;
+    ActionPoints[EntityId] = (int16)Archetype.MaxActionPoints;
+    for (int32 Slot = 0; Slot < NumAbilitySlots; ++Slot)
+    {
+        CastsRemaining(EntityId, Slot) = (uint8)Archetype.Abilities[Slot].MaxCastsPerTurn;
+    }
+    TileIndex[EntityId] = InTileIndex;
+    EntityByTile.Add(InTileIndex, EntityId);
+    TeamId[EntityId] = InTeamId;
+    ArchetypeIndex[EntityId] = (uint16)InArchetype;
+    Flags[EntityId] = Alive;
+    return EntityId;
+}
+
+void FUnitEntityStore::Destroy(int32 EntityId)
+{
+    if (!IsAlive(EntityId)) return;
+    Flags[EntityId] = 0;
+    if (FindAt(TileIndex[EntityId]) == EntityId)
+    {
+        EntityByTile.Remove(TileIndex[EntityId]);
+    }
+    TileIndex[EntityId] = INDEX_NONE;
+    Modifiers.Remove(EntityId);
+    FreeList.Add(EntityId);
+}
+
+void FUnitEntityStore::Reserve(int32 InNum)
+{
+    HP.Reserve(InNum);
+    MovementPoints.Reserve(InNum);
+    ActionPoints.Reserve(InNum);
+    Casts.Reserve(InNum * NumAbilitySlots);
+    TileIndex.Reserve(InNum);
+    TeamId.Reserve(InNum);
+    ArchetypeIndex.Reserve(InNum);
+    Flags.Reserve(InNum);
+}
+
+void FUnitEntityStore::Empty()
+{
+    HP.Empty();
+    MovementPoints.Empty();
+    ActionPoints.Empty();
+    Casts.Empty();
+    TileIndex.Empty();
+    TeamId.Empty();
+    ArchetypeIndex.Empty();
+    Flags.Empty();
+    FreeList.Empty();
+    EntityByTile.Empty();
+    Modifiers.Empty();
+}
+
+void FUnitEntityStore::SetProxied(int32 EntityId, bool bProxied)
+{
+    if (!IsAlive(EntityId)) return;
+    if (bProxied) Flags[EntityId] |= Proxied;
+    else Flags[EntityId] &= ~Proxied;
+}
+
+void FUnitEntityStore::ResetAllForNewTurn()
+{
+    const int32 Count = Flags.Num();
+    for (int32 EntityId = 0; EntityId < Count; ++EntityId)
+    {
+        if (!(Flags[EntityId] & Alive)) continue;
+        const FUnitArchetype& Archetype = Archetypes[ArchetypeIndex[EntityId]];
+        if (FTBStatModifierStack* Stack = Modifiers.Find(EntityId))
+        {
+            // Same order as UTurnStatsComponent::ResetForNewTurn: expire first, then refill to the new maximums
+            if (Stack->ExpireTurn() & (1u << (uint32)ETBStat::MaxHP))
+            {
+                HP[EntityId] = FMath::Min(HP[EntityId], GetMaxHP(EntityId));
+            }
+            if (Stack->GetModifiers().Num() == 0)
+            {
+                Modifiers.Remove(EntityId);
+            }
+        }
+        MovementPoints[EntityId] = (int16)GetMaxMovementPoints(EntityId);
+        ActionPoints[EntityId] = (int16)GetMaxActionPoints(EntityId);
+        for (int32 Slot = 0; Slot < NumAbilitySlots; ++Slot)
+        {
+            Casts[EntityId * NumAbilitySlots + Slot] = (uint8)Archetype.Abilities[Slot].MaxCastsPerTurn;
+        }
+    }
+}
+
+void FUnitEntityStore::ApplyDamageBatch(const TArray<int32>& Entities, const TArray<int32>& Amounts, TArray<int32>& OutDied)
+{
+    check(Entities.Num() == Amounts.Num());
+    for (int32 Index = 0; Index < Entities.Num(); ++Index)
+    {
+        const int32 EntityId = Entities[Index];
+        if (!IsAlive(EntityId) || Amounts[Index] <= 0 || HP[EntityId] <= 0) continue;
+        HP[EntityId] = FMath::Max(0, HP[EntityId] - Amounts[Index]);
+        if (HP[EntityId] == 0)
+        {
+            OutDied.Add(EntityId);
+        }
+    }
+}
+
+bool FUnitEntityStore::ApplyDamage(int32 EntityId, int32 Amount)
+{
+    if (!IsAlive(EntityId) || Amount <= 0) return false;
+    HP[EntityId] = FMath::Max(0, HP[EntityId] - Amount);
+    return HP[EntityId] == 0;
+}
+
+int32 FUnitEntityStore::ApplyHealing(int32 EntityId, int32 Amount)
+{
+    if (!IsAlive(EntityId) || Amount <= 0) return 0;
+    const int32 OldHP = HP[EntityId];
+    HP[EntityId] = FMath::Min(GetMaxHP(EntityId), OldHP + Amount);
+    return FMath::Max(0, HP[EntityId] - OldHP);
+}
+
+void FUnitEntityStore::CommitMove(int32 EntityId, int32 NewTileIndex)
+{
+    if (FindAt(TileIndex[EntityId]) == EntityId)
+    {
+        EntityByTile.Remove(TileIndex[EntityId]);
+    }
+    TileIndex[EntityId] = NewTileIndex;
+    EntityByTile.Add(NewTileIndex, EntityId);
+}
+
+int32 FUnitEntityStore::FindAt(int32 InTileIndex) const
+{
+    const int32* EntityId = EntityByTile.Find(InTileIndex);
+    return EntityId ? *EntityId : INDEX_NONE;
+}
+
+int32 FUnitEntityStore::GetMaxHP(int32 EntityId) const
+{
+    const FTBStatModifierStack* Stack = Modifiers.Find(EntityId);
+    const int32 Base = GetArchetype(EntityId).MaxHP;
+    return Stack ? Stack->GetEffective(ETBStat::MaxHP, Base) : Base;
+}
+
+int32 FUnitEntityStore::GetMaxMovementPoints(int32 EntityId) const
+{
+    const FTBStatModifierStack* Stack = Modifiers.Find(EntityId);
+    const int32 Base = GetArchetype(EntityId).MaxMovementPoints;
+    return Stack ? Stack->GetEffective(ETBStat::MaxMovementPoints, Base) : Base;
+}
+
+int32 FUnitEntityStore::GetMaxActionPoints(int32 EntityId) const
+{
+    const FTBStatModifierStack* Stack = Modifiers.Find(EntityId);
+    const int32 Base = GetArchetype(EntityId).MaxActionPoints;
+    return Stack ? Stack->GetEffective(ETBStat::MaxActionPoints, Base) : Base;
+}
+
+bool FUnitEntityStore::SpendMovement(int32 EntityId, int32 Cost)
+{
+    if (!IsAlive(EntityId) || Cost < 0 || MovementPoints[EntityId] < Cost) return false;
+    MovementPoints[EntityId] -= (int16)Cost;
+    return true;
+}
+
+bool FUnitEntityStore::SpendAction(int32 EntityId, int32 Cost)
+{
+    if (!IsAlive(EntityId) || Cost < 0 || ActionPoints[EntityId] < Cost) return false;
+    ActionPoints[EntityId] -= (int16)Cost;
+    return true;
+}
+
+void FUnitEntityStore::CopyToUnit(int32 EntityId, AUnitCharacter* Unit)
+{
+    if (!Unit || !IsAlive(EntityId)) return;
+    const FUnitArchetype& Archetype = GetArchetype(EntityId);
+
+    Unit->TeamId = TeamId[EntityId];
+    Unit->MaxHP = Archetype.MaxHP;
+    Unit->HP = HP[EntityId];
+    Unit->SightRange = Archetype.SightRange;
+    Unit->MagicArrow = Archetype.Abilities[0];
+    Unit->MagicArrow.CastsRemaining = CastsRemaining(EntityId, 0);
+    Unit->Boulder = Archetype.Abilities[1];
+    Unit->Boulder.CastsRemaining = CastsRemaining(EntityId, 1);
+    if (Unit->TurnStats)
+    {
+        FTBStatModifierStack Stack;
+        Modifiers.RemoveAndCopyValue(EntityId, Stack);
+        Unit->TurnStats->SetModifiers(MoveTemp(Stack));
+        Unit->TurnStats->MaxMovementPoints = Archetype.MaxMovementPoints;
+        Unit->TurnStats->MovementPoints = MovementPoints[EntityId];
+        Unit->TurnStats->MaxActionPoints = Archetype.MaxActionPoints;
+        Unit->TurnStats->ActionPoints = ActionPoints[EntityId];
+    }
+}
+
+void FUnitEntityStore::CopyFromUnit(int32 EntityId, const AUnitCharacter* Unit)
+{
+    if (!Unit || !IsAlive(EntityId)) return;
+
+    HP[EntityId] = Unit->HP;
+    TeamId[EntityId] = Unit->TeamId;
+    CastsRemaining(EntityId, 0) = (uint8)FMath::Clamp(Unit->MagicArrow.CastsRemaining, 0, 255);
+    CastsRemaining(EntityId, 1) = (uint8)FMath::Clamp(Unit->Boulder.CastsRemaining, 0, 255);
+    if (Unit->TurnStats)
+    {
+        MovementPoints[EntityId] = (int16)Unit->TurnStats->MovementPoints;
+        ActionPoints[EntityId] = (int16)Unit->TurnStats->ActionPoints;
+    }
+}
+
+void FUnitEntityStore::ReleaseFromUnit(int32 EntityId, AUnitCharacter* Unit)
+{
+    if (!Unit || !IsAlive(EntityId)) return;
+
+    CopyFromUnit(EntityId, Unit);
+    if (Unit->TurnStats && Unit->TurnStats->GetModifiers().GetModifiers().Num() > 0)
+    {
+        Modifiers.Add(EntityId, Unit->TurnStats->TakeModifiers());
+    }
+}
+
+SIZE_T FUnitEntityStore::GetAllocatedSize() const
+{
+    SIZE_T Size = HP.GetAllocatedSize() + MovementPoints.GetAllocatedSize() + ActionPoints.GetAllocatedSize()
+        + Casts.GetAllocatedSize() + TileIndex.GetAllocatedSize() + TeamId.GetAllocatedSize()
+        + ArchetypeIndex.GetAllocatedSize() + Flags.GetAllocatedSize()
+        + Archetypes.GetAllocatedSize() + FreeList.GetAllocatedSize() + EntityByTile.GetAllocatedSize()
+        + Modifiers.GetAllocatedSize();
+    for (const TPair<int32, FTBStatModifierStack>& Pair : Modifiers)
+    {
+        Size += Pair.Value.GetAllocatedSize();
+    }
+    return Size;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UnitCharacter.h"
+#include "TBStatModifiers.h"
+
+// Shared, read-only stats for a kind of unit (one per unit class, not per unit)
+struct FUnitArchetype
+{
+    int32 MaxHP = 100;
+    int32 MaxMovementPoints = 10;
+    int32 MaxActionPoints = 5;
+    int32 SightRange = 12;
+    FAbilityData Abilities[2];
+
+    // Snapshot max stats and abilities from a unit (usually a class default object)
+    static FUnitArchetype FromUnit(const AUnitCharacter* Unit);
+};
+
+// Data-oriented unit storage: one packed array per fragment, indexed by entity id.
+// Used for large battles where most units never need an actor; see AUnitEntityManager.
+class DENEME_API FUnitEntityStore
+{
+public:
+    // Ability slots per entity, matching AUnitCharacter::MagicArrow / Boulder
+    static constexpr int32 NumAbilitySlots = 2;
+
+    enum EFlags : uint8
+    {
+        Alive = 1 << 0,
+        Proxied = 1 << 1,
+    };
+
+    int32 AddArchetype(const FUnitArchetype& Archetype) { return Archetypes.Add(Archetype); }
+    const FUnitArchetype& GetArchetype(int32 EntityId) const { return Archetypes[ArchetypeIndex[EntityId]]; }
+
+    // Create an entity at full HP/MP/AP on a tile. Reuses dead slots.
+    int32 Create(int32 InArchetype, int32 InTeamId, int32 InTileIndex);
+    void Destroy(int32 EntityId);
+    void Reserve(int32 Num);
+    void Empty();
+
+    bool IsAlive(int32 EntityId) const { return Flags.IsValidIndex(EntityId) && (Flags[EntityId] & Alive); }
+    bool IsProxied(int32 EntityId) const { return IsAlive(EntityId) && (Flags[EntityId] & Proxied); }
+    void SetProxied(int32 EntityId, bool bProxied);
+
+    // Number of slots (alive or free); iterate 0..Num()-1 and test IsAlive
+    int32 Num() const { return Flags.Num(); }
+    int32 NumAlive() const { return Flags.Num() - FreeList.Num(); }
+
+    // Batch operations over every live entity
+    void ResetAllForNewTurn();
+
+    // Apply Amounts[i] damage to Entities[i]; appends entities that reached 0 HP to OutDied
+    void ApplyDamageBatch(const TArray<int32>& Entities, const TArray<int32>& Amounts, TArray<int32>& OutDied);
+
+    // Single-entity operations mirroring AUnitCharacter
+    bool ApplyDamage(int32 EntityId, int32 Amount);
+    bool SpendMovement(int32 EntityId, int32 Cost);
+    bool SpendAction(int32 EntityId, int32 Cost);
+    int32 ApplyHealing(int32 EntityId, int32 Amount);
+    void CommitMove(int32 EntityId, int32 NewTileIndex);
+
+    // Live entity standing on a tile (proxied or not), or INDEX_NONE
+    int32 FindAt(int32 InTileIndex) const;
+
+    // Stat modifiers of an entity without a proxy, or null if it has none. A bound proxy holds the stack itself.
+    const FTBStatModifierStack* FindModifiers(int32 EntityId) const { return Modifiers.Find(EntityId); }
+
+    // Archetype maximums with the entity's modifiers applied
+    int32 GetMaxHP(int32 EntityId) const;
+    int32 GetMaxMovementPoints(int32 EntityId) const;
+    int32 GetMaxActionPoints(int32 EntityId) const;
+
+    uint8& CastsRemaining(int32 EntityId, int32 Slot) { return Casts[EntityId * NumAbilitySlots + Slot]; }
+    uint8 CastsRemaining(int32 EntityId, int32 Slot) const { return Casts[EntityId * NumAbilitySlots + Slot]; }
+
+    // Copy state between an entity and its visual proxy actor. CopyToUnit also hands the entity's modifier stack to the
+    // proxy; ReleaseFromUnit takes it back when the proxy goes.
+    void CopyToUnit(int32 EntityId, AUnitCharacter* Unit);
+    void CopyFromUnit(int32 EntityId, const AUnitCharacter* Unit);
+    void ReleaseFromUnit(int32 EntityId, AUnitCharacter* Unit);
+
+    SIZE_T GetAllocatedSize() const;
+
+    // Fragments
+    TArray<int32> HP;
+    TArray<int16> MovementPoints;
+    TArray<int16> ActionPoints;
+    TArray<uint8> Casts;
+    TArray<int32> TileIndex;
+    TArray<int32> TeamId;
+    TArray<uint16> ArchetypeIndex;
+    TArray<uint8> Flags;
+
+private:
+    TArray<FUnitArchetype> Archetypes;
+    TArray<int32> FreeList;
+
+    // Tile index -> entity, kept in step with TileIndex
+    TMap<int32, int32> EntityByTile;
+
+    // Sparse: only entities that carry modifiers and have no proxy
+    TMap<int32, FTBStatModifierStack> Modifiers;
+};
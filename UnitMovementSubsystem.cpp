@@ -0,0 +1,255 @@
+#include "UnitMovementSubsystem.h"
+#include "UnitCharacter.h"
+#include "AGridTile.h"
+#include "TBMemoryTracker.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+UUnitMovementSubsystem* UUnitMovementSubsystem::Get(const UObject* WorldContextObject)
+{
+    UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+    return World ? World->GetSubsystem<UUnitMovementSubsystem>() : nullptr;
+}
+
+TStatId UUnitMovementSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UUnitMovementSubsystem, STATGROUP_Tickables);
+}
+
+int32 UUnitMovementSubsystem::FindMove(const AUnitCharacter* Unit) const
+{
+    const int32* Index = Unit ? MoveIndex.Find(Unit) : nullptr;
+
+    // A destroyed unit's address can be reused before its move is compacted away
+    return Index && Moves[*Index].Unit.Get() == Unit ? *Index : INDEX_NONE;
+}
+
+void UUnitMovementSubsystem::FinishMove(int32 Index)
+{
+    FActiveMove& Move = Moves[Index];
+    Move.bFinished = true;
+    if (const int32* Existing = MoveIndex.Find(Move.Key))
+    {
+        if (*Existing == Index) MoveIndex.Remove(Move.Key);
+    }
+}
+
+bool UUnitMovementSubsystem::IsMovingTo(const AUnitCharacter* Unit, const FVector& Location) const
+{
+    const int32 Index = FindMove(Unit);
+    if (Index == INDEX_NONE) return false;
+    const FActiveMove& Move = Moves[Index];
+    return Waypoints[Move.FirstWaypoint + Move.NumWaypoints - 1].Equals(Location, 1.0f);
+}
+
+void UUnitMovementSubsystem::StartMove(AUnitCharacter* Unit, const TArray<AGridTile*>& Path)
+{
+    TArray<FVector, TInlineAllocator<32>> Points;
+    Points.Reserve(Path.Num());
+    for (const AGridTile* Tile : Path)
+    {
+        if (Tile) Points.Add(Tile->GetTileCenter());
+    }
+    StartMoveAlongPoints(Unit, Points);
+}
+
+void UUnitMovementSubsystem::StartMoveAlongPoints(AUnitCharacter* Unit, TArrayView<const FVector> Points)
+{
+    if (!Unit) return;
+    StopMove(Unit);
+    if (Points.Num() < 2) return;
+
+    LLM_SCOPE_BYTAG(TB_Units);
+
+    MoveIndex.Add(Unit, Moves.Num());
+    FActiveMove& Move = Moves.AddDefaulted_GetRef();
+    Move.Unit = Unit;
+    Move.Key = Unit;
+    Move.FirstWaypoint = Waypoints.Num();
+    Move.NumWaypoints = Points.Num();
+
+    // Start from where the unit is drawn now, so a re-planned preview does not pop
+    Waypoints.Add(Unit->GetActorLocation());
+    Waypoints.Append(Points.GetData() + 1, Points.Num() - 1);
+    Locations.Add(Unit->GetActorLocation());
+}
+
+void UUnitMovementSubsystem::StopMove(AUnitCharacter* Unit)
+{
+    const int32 Index = FindMove(Unit);
+    if (Index != INDEX_NONE)
+    {
+        FinishMove(Index);
+    }
+}
+
+void UUnitMovementSubsystem::SkipToEnd(AUnitCharacter* Unit)
+{
+    const int32 Index = FindMove(Unit);
+    if (Index == INDEX_NONE) return;
+
+    FActiveMove& Move = Moves[Index];
+    Unit->SetActorLocation(Waypoints[Move.FirstWaypoint + Move.NumWaypoints - 1]);
+    FinishMove(Index);
+    OnMovementFinished.Broadcast(Unit);
+}
+
+void UUnitMovementSubsystem::SkipAll()
+{
+    for (FActiveMove& Move : Moves)
+    {
+        if (Move.bFinished) continue;
+        if (AUnitCharacter* Unit = Move.Unit.Get())
+        {
+            Unit->SetActorLocation(Waypoints[Move.FirstWaypoint + Move.NumWaypoints - 1]);
+            OnMovementFinished.Broadcast(Unit);
+        }
+        Move.bFinished = true;
+    }
+    MoveIndex.Reset();
+    CompactMoves();
+}
+
+void UUnitMovementSubsystem::Tick(float DeltaTime)
+{
+    if (Moves.Num() == 0) return;
+
+    // Pass 1: advance and interpolate in the packed arrays (no actor access)
+    const float Step = FMath::Max(0.0f, TilesPerSecond) * DeltaTime;
+    bool bAnyFinished = false;
+    for (int32 Index = 0; Index < Moves.Num(); ++Index)
+    {
+        FActiveMove& Move = Moves[Index];
+        if (Move.bFinished)
+        {
+            bAnyFinished = true;
+            continue;
+        }
+
+        const int32 NumSegments = Move.NumWaypoints - 1;
+        Move.Progress = FMath::Min(Move.Progress + Step, (float)NumSegments);
+
+        const int32 Segment = FMath::Min((int32)Move.Progress, NumSegments - 1);
+        const float Alpha = Move.Progress - Segment;
+        const FVector* Path = Waypoints.GetData() + Move.FirstWaypoint;
+        Locations[Index] = FMath::Lerp(Path[Segment], Path[Segment + 1], Alpha);
+    }
+
+    // Pass 2: write every transform in one sweep-free batch
+    for (int32 Index = 0; Index < Moves.Num(); ++Index)
+    {
+        FActiveMove& Move = Moves[Index];
+        if (Move.bFinished) continue;
+
+        AUnitCharacter* Unit = Move.Unit.Get();
+        if (!Unit)
+        {
+            FinishMove(Index);
+            bAnyFinished = true;
+            continue;
+        }
+
+        Unit->SetActorLocation(Locations[Index], false, nullptr, ETeleportType::None);
+        if (Move.Progress >= (float)(Move.NumWaypoints - 1))
+        {
+            FinishMove(Index);
+            bAnyFinished = true;
+            OnMovementFinished.Broadcast(Unit);
+        }
+    }
+
+    if (bAnyFinished)
+    {
+        CompactMoves();
+    }
+}
+
+void UUnitMovementSubsystem::CompactMoves()
+{
+    TArray<FVector> Compacted;
+    Compacted.Reserve(Waypoints.Num());
+
+    int32 Write = 0;
+    for (int32 Read = 0; Read < Moves.Num(); ++Read)
+    {
+        FActiveMove Move = Moves[Read];
+        if (Move.bFinished) continue;
+
+        const int32 NewFirst = Compacted.Num();
+        Compacted.Append(Waypoints.GetData() + Move.FirstWaypoint, Move.NumWaypoints);
+        Move.FirstWaypoint = NewFirst;
+        MoveIndex.Add(Move.Key, Write);
+
+        Locations[Write] = Locations[Read];
+        Moves[Write++] = Move;
+    }
+
+    Moves.SetNum(Write, false);
+    Locations.SetNum(Write, false);
+    Waypoints = MoveTemp(Compacted);
+}
+
+namespace
+{
+    // Spawns Count bare units in the current world, moves them all along 8-tile paths and reports the per-tick cost
+    void RunUnitMovementBenchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        UUnitMovementSubsystem* Movement = World ? World->GetSubsystem<UUnitMovementSubsystem>() : nullptr;
+        if (!Movement) return;
+
+        const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 500;
+        constexpr float TileSize = 100.0f;
+        constexpr int32 PathTiles = 8;
+        constexpr int32 NumFrames = 120;
+        constexpr float FrameTime = 1.0f / 60.0f;
+
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+        TArray<AUnitCharacter*> Units;
+        Units.Reserve(Count);
+        TArray<FVector, TInlineAllocator<PathTiles + 1>> Points;
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            const FVector Start((Index % 64) * TileSize, (Index / 64) * TileSize * PathTiles, -10000.0f);
+            AUnitCharacter* Unit = World->SpawnActor<AUnitCharacter>(AUnitCharacter::StaticClass(), Start, FRotator::ZeroRotator, SpawnParams);
+            if (!Unit) continue;
+            Units.Add(Unit);
+
+            Points.Reset();
+            for (int32 Step = 0; Step <= PathTiles; ++Step)
+            {
+                Points.Add(Start + FVector(0.0f, Step * TileSize, 0.0f));
+            }
+            Movement->StartMoveAlongPoints(Unit, Points);
+        }
+
+        double TotalMs = 0.0;
+        double WorstMs = 0.0;
+        int32 TimedFrames = 0;
+        for (int32 Frame = 0; Frame < NumFrames && Movement->GetNumMoving() > 0; ++Frame)
+        {
+            const double StartTime = FPlatformTime::Seconds();
+            Movement->Tick(FrameTime);
+            const double Ms = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+            TotalMs += Ms;
+            WorstMs = FMath::Max(WorstMs, Ms);
+            ++TimedFrames;
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("UnitMovement %d units: avg %.3f ms, worst %.3f ms per tick over %d ticks (budget 2 ms)"),
+            Units.Num(), TimedFrames ? TotalMs / TimedFrames : 0.0, WorstMs, TimedFrames);
+
+        Movement->SkipAll();
+        for (AUnitCharacter* Unit : Units)
+        {
+            Unit->Destroy();
+        }
+    }
+
+    FAutoConsoleCommandWithWorldAndArgs UnitMovementBenchmarkCommand(
+        TEXT("tb.Bench.UnitMovement"),
+        TEXT("Animate N units (default 500) along 8-tile paths and report the movement subsystem's tick cost"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunUnitMovementBenchmark));
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UnitMovementSubsystem.generated.h"
+
+class AUnitCharacter;
+class AGridTile;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnUnitMovementFinished, AUnitCharacter* /*Unit*/);
+
+// Plays back unit movement along tile paths for every unit from one tick.
+// Positions are interpolated in packed arrays first, then all actor transforms are written in a single pass,
+// so hundreds of moving units cost one tick function instead of one per unit.
+UCLASS(Config = Game)
+class DENEME_API UUnitMovementSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UUnitMovementSubsystem* Get(const UObject* WorldContextObject);
+
+    // Playback speed in tiles per second ([/Script/Deneme.UnitMovementSubsystem] in DefaultGame.ini)
+    UPROPERTY(Config, BlueprintReadOnly, Category = "Movement")
+    float TilesPerSecond = 6.0f;
+
+    // Animate Unit along Path (tile centers). Replaces any move already playing for the unit.
+    UFUNCTION(BlueprintCallable, Category = "Movement")
+    void StartMove(AUnitCharacter* Unit, const TArray<AGridTile*>& Path);
+
+    // Same as StartMove with explicit world-space waypoints; the first point is replaced by the unit's current location
+    void StartMoveAlongPoints(AUnitCharacter* Unit, TArrayView<const FVector> Points);
+
+    // Stop playback where the unit currently is
+    UFUNCTION(BlueprintCallable, Category = "Movement")
+    void StopMove(AUnitCharacter* Unit);
+
+    // Jump straight to the end of the unit's path
+    UFUNCTION(BlueprintCallable, Category = "Movement")
+    void SkipToEnd(AUnitCharacter* Unit);
+
+    // Finish every playing move instantly (e.g. AI turns)
+    UFUNCTION(BlueprintCallable, Category = "Movement")
+    void SkipAll();
+
+    UFUNCTION(BlueprintCallable, Category = "Movement")
+    bool IsMoving(const AUnitCharacter* Unit) const { return FindMove(Unit) != INDEX_NONE; }
+
+    // True if the unit is playing a move whose final waypoint is Location
+    bool IsMovingTo(const AUnitCharacter* Unit, const FVector& Location) const;
+
+    int32 GetNumMoving() const { return Moves.Num(); }
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return Moves.GetAllocatedSize() + Waypoints.GetAllocatedSize() + Locations.GetAllocatedSize() + MoveIndex.GetAllocatedSize();
+    }
+
+    FOnUnitMovementFinished OnMovementFinished;
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+private:
+    struct FActiveMove
+    {
+        TWeakObjectPtr<AUnitCharacter> Unit;
+
+        // Key of the move in MoveIndex, kept for units destroyed mid-move
+        const AUnitCharacter* Key = nullptr;
+        int32 FirstWaypoint = 0;
+        int32 NumWaypoints = 0;
+
+        // Distance travelled along the path, in tiles (segments)
+        float Progress = 0.0f;
+        bool bFinished = false;
+    };
+
+    int32 FindMove(const AUnitCharacter* Unit) const;
+
+    // Flag a move finished and drop it from MoveIndex
+    void FinishMove(int32 Index);
+
+    // Remove finished moves and compact the waypoint buffer
+    void CompactMoves();
+
+    TArray<FActiveMove> Moves;
+
+    // Unit -> index in Moves of its playing move, so starting or querying N moves stays O(N)
+    TMap<const AUnitCharacter*, int32> MoveIndex;
+
+    // Waypoints of all moves, each move owning a contiguous range
+    TArray<FVector> Waypoints;
+
+    // Interpolated location per move, written to actors in one pass
+    TArray<FVector> Locations;
+};